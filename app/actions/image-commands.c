@@ -101,6 +101,7 @@ static void   image_convert_indexed_callback   (GtkWidget              *dialog,
                                                 GimpConvertPaletteType  palette_type,
                                                 gint                    max_colors,
                                                 gboolean                remove_duplicates,
+                                                gboolean                refine_palette,
                                                 GimpConvertDitherType   dither_type,
                                                 gboolean                dither_alpha,
                                                 gboolean                dither_text_layers,
@@ -334,6 +335,7 @@ image_convert_base_type_cmd_callback (GimpAction *action,
                                            config->image_convert_indexed_palette_type,
                                            config->image_convert_indexed_max_colors,
                                            config->image_convert_indexed_remove_duplicates,
+                                           config->image_convert_indexed_refine_palette,
                                            config->image_convert_indexed_dither_type,
                                            config->image_convert_indexed_dither_alpha,
                                            config->image_convert_indexed_dither_text_layers,
@@ -1157,6 +1159,7 @@ image_convert_indexed_callback (GtkWidget              *dialog,
                                 GimpConvertPaletteType  palette_type,
                                 gint                    max_colors,
                                 gboolean                remove_duplicates,
+                                gboolean                refine_palette,
                                 GimpConvertDitherType   dither_type,
                                 gboolean                dither_alpha,
                                 gboolean                dither_text_layers,
@@ -1172,6 +1175,7 @@ image_convert_indexed_callback (GtkWidget              *dialog,
                 "image-convert-indexed-palette-type",       palette_type,
                 "image-convert-indexed-max-colors",         max_colors,
                 "image-convert-indexed-remove-duplicates",  remove_duplicates,
+                "image-convert-indexed-refine-palette",     refine_palette,
                 "image-convert-indexed-dither-type",        dither_type,
                 "image-convert-indexed-dither-alpha",       dither_alpha,
                 "image-convert-indexed-dither-text-layers", dither_text_layers,
@@ -1186,6 +1190,7 @@ image_convert_indexed_callback (GtkWidget              *dialog,
                                     config->image_convert_indexed_palette_type,
                                     config->image_convert_indexed_max_colors,
                                     config->image_convert_indexed_remove_duplicates,
+                                    config->image_convert_indexed_refine_palette,
                                     config->image_convert_indexed_dither_type,
                                     config->image_convert_indexed_dither_alpha,
                                     config->image_convert_indexed_dither_text_layers,
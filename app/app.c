@@ -78,6 +78,7 @@
 #include "gimp-debug.h"
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 #include "gimp-update.h"
 
 
@@ -231,6 +232,7 @@ app_run (const gchar         *full_prog_name,
   /*  Create an instance of the "Gimp" object which is the root of the
    *  core object system
    */
+  GIMP_TRACE_BEGIN ("gimp_new");
   gimp = gimp_new (full_prog_name,
                    session_name,
                    default_folder,
@@ -245,6 +247,7 @@ app_run (const gchar         *full_prog_name,
                    show_debug_menu,
                    stack_trace_mode,
                    pdb_compat_mode);
+  GIMP_TRACE_END ();
 
   g_clear_object (&default_folder);
 
@@ -281,7 +284,9 @@ app_run (const gchar         *full_prog_name,
 
   g_object_unref (gimpdir);
 
+  GIMP_TRACE_BEGIN ("load config");
   gimp_load_config (gimp, alternate_system_gimprc, alternate_gimprc);
+  GIMP_TRACE_END ();
 
   /* Initialize the error handling after creating/migrating the config
    * directory because it will create some folders for backup and crash
@@ -304,7 +309,9 @@ app_run (const gchar         *full_prog_name,
     app_abort (no_interface, abort_message);
 
   /*  initialize lowlevel stuff  */
+  GIMP_TRACE_BEGIN ("gegl init");
   gimp_gegl_init (gimp);
+  GIMP_TRACE_END ();
 
   /*  Connect our restore_after callback before gui_init() connects
    *  theirs, so ours runs first and can grab the initial monitor
@@ -384,8 +391,12 @@ app_activate_callback (GimpCoreApp *app,
   current_language = language_init (NULL, &system_lang_l10n);
 #ifndef GIMP_CONSOLE_COMPILATION
   if (! gimp->no_interface)
-    update_status_func = gui_init (gimp, gimp_app_get_no_splash (GIMP_APP (app)),
-                                   GIMP_APP (app), NULL, system_lang_l10n);
+    {
+      GIMP_TRACE_BEGIN ("gui init");
+      update_status_func = gui_init (gimp, gimp_app_get_no_splash (GIMP_APP (app)),
+                                     GIMP_APP (app), NULL, system_lang_l10n);
+      GIMP_TRACE_END ();
+    }
 #endif
 
   if (! update_status_func)
@@ -394,7 +405,9 @@ app_activate_callback (GimpCoreApp *app,
   /*  Create all members of the global Gimp instance which need an already
    *  parsed gimprc, e.g. the data factories
    */
+  GIMP_TRACE_BEGIN ("initialize");
   gimp_initialize (gimp, update_status_func);
+  GIMP_TRACE_END ();
 
   g_object_get (gimp->edit_config,
                 "prev-language", &prev_language,
@@ -405,7 +418,9 @@ app_activate_callback (GimpCoreApp *app,
   g_free (prev_language);
 
   /*  Load all data files */
+  GIMP_TRACE_BEGIN ("restore");
   gimp_restore (gimp, update_status_func, &font_error);
+  GIMP_TRACE_END ();
 
   /*  enable autosave late so we don't autosave when the
    *  monitor resolution is set in gui_init()
@@ -488,6 +503,8 @@ app_activate_callback (GimpCoreApp *app,
     {
       gint i;
 
+      GIMP_TRACE_BEGIN ("open files");
+
       for (i = 0; filenames[i] != NULL; i++)
         {
           GFile *file = g_file_new_for_commandline_arg (filenames[i]);
@@ -498,6 +515,8 @@ app_activate_callback (GimpCoreApp *app,
 
           g_object_unref (file);
         }
+
+      GIMP_TRACE_END ();
     }
 
   /* The software is now fully loaded and ready to be used and get
@@ -505,6 +524,13 @@ app_activate_callback (GimpCoreApp *app,
    */
   gimp->initialized = TRUE;
 
+  /*  write out the startup trace, if any, before running batch
+   *  commands, unless loading the data was deferred to them: then the
+   *  batch commands are traced too, to include the deferred load
+   */
+  if (! gimp->defer_data)
+    gimp_trace_finish ();
+
   if (font_error)
     {
       gimp_message_literal (gimp, NULL,
@@ -513,9 +539,13 @@ app_activate_callback (GimpCoreApp *app,
       g_error_free (font_error);
     }
 
+  GIMP_TRACE_BEGIN ("batch commands");
   batch_retval = gimp_batch_run (gimp,
                                  gimp_core_app_get_batch_interpreter (app),
                                  gimp_core_app_get_batch_commands (app));
+  GIMP_TRACE_END ();
+
+  gimp_trace_finish ();
 
   if (gimp_core_app_get_quit (app))
     {
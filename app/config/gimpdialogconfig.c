@@ -61,6 +61,7 @@ enum
   PROP_IMAGE_CONVERT_INDEXED_PALETTE_TYPE,
   PROP_IMAGE_CONVERT_INDEXED_MAX_COLORS,
   PROP_IMAGE_CONVERT_INDEXED_REMOVE_DUPLICATES,
+  PROP_IMAGE_CONVERT_INDEXED_REFINE_PALETTE,
   PROP_IMAGE_CONVERT_INDEXED_DITHER_TYPE,
   PROP_IMAGE_CONVERT_INDEXED_DITHER_ALPHA,
   PROP_IMAGE_CONVERT_INDEXED_DITHER_TEXT_LAYERS,
@@ -263,6 +264,14 @@ gimp_dialog_config_class_init (GimpDialogConfigClass *klass)
                             TRUE,
                             GIMP_PARAM_STATIC_STRINGS);
 
+  GIMP_CONFIG_PROP_BOOLEAN (object_class,
+                            PROP_IMAGE_CONVERT_INDEXED_REFINE_PALETTE,
+                            "image-convert-indexed-refine-palette",
+                            "Default refine palette for indexed conversion",
+                            IMAGE_CONVERT_INDEXED_REFINE_PALETTE_BLURB,
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   GIMP_CONFIG_PROP_ENUM (object_class,
                          PROP_IMAGE_CONVERT_INDEXED_DITHER_TYPE,
                          "image-convert-indexed-dither-type",
@@ -666,6 +675,9 @@ gimp_dialog_config_set_property (GObject      *object,
     case PROP_IMAGE_CONVERT_INDEXED_REMOVE_DUPLICATES:
       config->image_convert_indexed_remove_duplicates = g_value_get_boolean (value);
       break;
+    case PROP_IMAGE_CONVERT_INDEXED_REFINE_PALETTE:
+      config->image_convert_indexed_refine_palette = g_value_get_boolean (value);
+      break;
     case PROP_IMAGE_CONVERT_INDEXED_DITHER_TYPE:
       config->image_convert_indexed_dither_type = g_value_get_enum (value);
       break;
@@ -868,6 +880,9 @@ gimp_dialog_config_get_property (GObject    *object,
     case PROP_IMAGE_CONVERT_INDEXED_REMOVE_DUPLICATES:
       g_value_set_boolean (value, config->image_convert_indexed_remove_duplicates);
       break;
+    case PROP_IMAGE_CONVERT_INDEXED_REFINE_PALETTE:
+      g_value_set_boolean (value, config->image_convert_indexed_refine_palette);
+      break;
     case PROP_IMAGE_CONVERT_INDEXED_DITHER_TYPE:
       g_value_set_enum (value, config->image_convert_indexed_dither_type);
       break;
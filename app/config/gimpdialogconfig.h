@@ -59,6 +59,7 @@ struct _GimpDialogConfig
   GimpConvertPaletteType    image_convert_indexed_palette_type;
   gint                      image_convert_indexed_max_colors;
   gboolean                  image_convert_indexed_remove_duplicates;
+  gboolean                  image_convert_indexed_refine_palette;
   GimpConvertDitherType     image_convert_indexed_dither_type;
   gboolean                  image_convert_indexed_dither_alpha;
   gboolean                  image_convert_indexed_dither_text_layers;
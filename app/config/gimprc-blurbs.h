@@ -595,6 +595,9 @@ _("Sets the default maximum number of colors for the 'Convert to Indexed' dialog
 #define IMAGE_CONVERT_INDEXED_REMOVE_DUPLICATES_BLURB \
 _("Sets the default 'Remove duplicate colors' state for the 'Convert to Indexed' dialog.")
 
+#define IMAGE_CONVERT_INDEXED_REFINE_PALETTE_BLURB \
+_("Sets the default 'Refine palette' state for the 'Convert to Indexed' dialog.")
+
 #define IMAGE_CONVERT_INDEXED_DITHER_TYPE_BLURB \
 _("Sets the default dithering type for the 'Convert to Indexed' dialog.")
 
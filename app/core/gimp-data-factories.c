@@ -58,6 +58,7 @@
 #include "text/gimpfontfactory.h"
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 
 
 void
@@ -216,6 +217,8 @@ gimp_data_factories_init (Gimp *gimp)
                                        gimp_tool_preset_load,
                                        GIMP_TOOL_PRESET_FILE_EXTENSION,
                                        TRUE);
+  /*  tool presets look up tool infos while loading  */
+  gimp_data_loader_factory_set_threaded (gimp->tool_preset_factory, FALSE);
 
   gimp->tag_cache = gimp_tag_cache_new ();
 }
@@ -352,37 +355,46 @@ void
 gimp_data_factories_load (Gimp               *gimp,
                           GimpInitStatusFunc  status_callback)
 {
+  gboolean no_data;
+  gboolean no_fonts;
+
   g_return_if_fail (GIMP_IS_GIMP (gimp));
 
+  /*  with defer_data, only the standard data is set up here, and the
+   *  data files are read by gimp_data_factories_load_deferred()
+   */
+  no_data  = gimp->no_data  || gimp->defer_data;
+  no_fonts = gimp->no_fonts || gimp->defer_data;
+
   /*  initialize the list of gimp brushes    */
   status_callback (NULL, _("Brushes"), 0.1);
   gimp_data_factory_data_init (gimp->brush_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the list of gimp dynamics   */
   status_callback (NULL, _("Dynamics"), 0.15);
   gimp_data_factory_data_init (gimp->dynamics_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the list of mypaint brushes    */
   status_callback (NULL, _("MyPaint Brushes"), 0.2);
   gimp_data_factory_data_init (gimp->mybrush_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the list of gimp patterns   */
   status_callback (NULL, _("Patterns"), 0.3);
   gimp_data_factory_data_init (gimp->pattern_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the list of gimp palettes   */
   status_callback (NULL, _("Palettes"), 0.4);
   gimp_data_factory_data_init (gimp->palette_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the list of gimp gradients  */
   status_callback (NULL, _("Gradients"), 0.5);
   gimp_data_factory_data_init (gimp->gradient_factory, gimp->user_context,
-                               gimp->no_data);
+                               no_data);
 
   /*  initialize the color history   */
   status_callback (NULL, _("Color History"), 0.55);
@@ -391,18 +403,19 @@ gimp_data_factories_load (Gimp               *gimp,
   /*  initialize the list of gimp fonts   */
   status_callback (NULL, _("Fonts"), 0.6);
   gimp_data_factory_data_init (gimp->font_factory, gimp->user_context,
-                               gimp->no_fonts);
+                               no_fonts);
 
   /*  initialize the list of gimp tool presets if we have a GUI  */
   if (! gimp->no_interface)
     {
       status_callback (NULL, _("Tool Presets"), 0.7);
       gimp_data_factory_data_init (gimp->tool_preset_factory, gimp->user_context,
-                                   gimp->no_data);
+                                   no_data);
     }
 
   /* update tag cache */
   status_callback (NULL, _("Updating tag cache"), 0.75);
+  GIMP_TRACE_BEGIN ("tag cache");
   gimp_tag_cache_load (gimp->tag_cache);
   gimp_tag_cache_add_container (gimp->tag_cache,
                                 gimp_data_factory_get_container (gimp->brush_factory));
@@ -420,6 +433,59 @@ gimp_data_factories_load (Gimp               *gimp,
                                 gimp_data_factory_get_container (gimp->font_factory));
   gimp_tag_cache_add_container (gimp->tag_cache,
                                 gimp_data_factory_get_container (gimp->tool_preset_factory));
+  GIMP_TRACE_END ();
+}
+
+/**
+ * gimp_data_factories_load_deferred:
+ * @gimp: a #Gimp object
+ *
+ * Reads the data files which gimp_data_factories_load() skipped
+ * because @gimp->defer_data was set. This is called when something
+ * actually needs the data, and does nothing when there is nothing
+ * left to load.
+ **/
+void
+gimp_data_factories_load_deferred (Gimp *gimp)
+{
+  g_return_if_fail (GIMP_IS_GIMP (gimp));
+
+  if (! gimp->defer_data)
+    return;
+
+  gimp->defer_data = FALSE;
+
+  if (gimp->be_verbose)
+    g_print ("Loading deferred data files\n");
+
+  GIMP_TRACE_BEGIN ("deferred data factories");
+
+  if (! gimp->no_data)
+    {
+      gimp_data_factory_data_refresh (gimp->brush_factory,
+                                      gimp->user_context);
+      gimp_data_factory_data_refresh (gimp->dynamics_factory,
+                                      gimp->user_context);
+      gimp_data_factory_data_refresh (gimp->mybrush_factory,
+                                      gimp->user_context);
+      gimp_data_factory_data_refresh (gimp->pattern_factory,
+                                      gimp->user_context);
+      gimp_data_factory_data_refresh (gimp->palette_factory,
+                                      gimp->user_context);
+      gimp_data_factory_data_refresh (gimp->gradient_factory,
+                                      gimp->user_context);
+    }
+
+  /*  fonts are loaded asynchronously, users of the font factory wait
+   *  for them with gimp_data_factory_data_wait()
+   */
+  if (! gimp->no_fonts)
+    gimp_data_factory_data_refresh (gimp->font_factory,
+                                    gimp->user_context);
+
+  gimp_data_factories_data_clean (gimp);
+
+  GIMP_TRACE_END ();
 }
 
 void
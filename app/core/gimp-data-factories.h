@@ -30,6 +30,8 @@ void      gimp_data_factories_data_clean  (Gimp   *gimp);
 
 void      gimp_data_factories_load        (Gimp               *gimp,
                                            GimpInitStatusFunc  status_callback);
+void      gimp_data_factories_load_deferred
+                                          (Gimp               *gimp);
 void      gimp_data_factories_save        (Gimp               *gimp);
 
 
@@ -34,6 +34,7 @@
 #include "gimp-modules.h"
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 
 
 void
@@ -147,7 +148,9 @@ gimp_modules_load (Gimp *gimp)
       g_free (module_load_inhibit);
     }
 
+  GIMP_TRACE_BEGIN ("module db");
   gimp_module_db_load (gimp->module_db, gimp->config->module_path);
+  GIMP_TRACE_END ();
 }
 
 void
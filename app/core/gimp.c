@@ -76,6 +76,7 @@
 #include "gimptreeproxy.h"
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 
 
 /*  we need to register all enum types so they are known to the type
@@ -227,6 +228,7 @@ gimp_init (Gimp *gimp)
 {
   gimp->be_verbose       = FALSE;
   gimp->no_data          = FALSE;
+  gimp->defer_data       = FALSE;
   gimp->no_interface     = FALSE;
   gimp->show_gui         = TRUE;
   gimp->use_shm          = FALSE;
@@ -551,10 +553,14 @@ gimp_real_initialize (Gimp               *gimp,
 
   /*  register all internal procedures  */
   status_callback (NULL, _("Internal Procedures"), 0.2);
+  GIMP_TRACE_BEGIN ("internal procedures");
   internal_procs_init (gimp->pdb);
   gimp_pdb_compat_procs_register (gimp->pdb, gimp->pdb_compat_mode);
+  GIMP_TRACE_END ();
 
+  GIMP_TRACE_BEGIN ("plug-in manager initialize");
   gimp_plug_in_manager_initialize (gimp->plug_in_manager, status_callback);
+  GIMP_TRACE_END ();
 
   status_callback (NULL, "", 1.0);
 }
@@ -566,12 +572,16 @@ gimp_real_restore (Gimp               *gimp,
   if (gimp->be_verbose)
     g_print ("INIT: %s\n", G_STRFUNC);
 
+  GIMP_TRACE_BEGIN ("plug-ins");
   gimp_plug_in_manager_restore (gimp->plug_in_manager,
                                 gimp_get_user_context (gimp), status_callback);
+  GIMP_TRACE_END ();
 
   /*  initialize babl fishes  */
   status_callback (_("Initialization"), "Babl Fishes", 0.0);
+  GIMP_TRACE_BEGIN ("babl fishes");
   gimp_babl_init_fishes (status_callback);
+  GIMP_TRACE_END ();
 
   gimp->restored = TRUE;
 }
@@ -851,18 +861,26 @@ gimp_restore (Gimp                *gimp,
 
   /*  initialize  the global parasite table  */
   status_callback (_("Looking for data files"), _("Parasites"), 0.0);
+  GIMP_TRACE_BEGIN ("parasites");
   gimp_parasiterc_load (gimp);
+  GIMP_TRACE_END ();
 
   /*  initialize the lists of gimp brushes, dynamics, patterns etc.  */
+  GIMP_TRACE_BEGIN ("data factories");
   gimp_data_factories_load (gimp, status_callback);
+  GIMP_TRACE_END ();
 
   /*  initialize the template list  */
   status_callback (NULL, _("Templates"), 0.8);
+  GIMP_TRACE_BEGIN ("templates");
   gimp_templates_load (gimp);
+  GIMP_TRACE_END ();
 
   /*  initialize the module list  */
   status_callback (NULL, _("Modules"), 0.9);
+  GIMP_TRACE_BEGIN ("modules");
   gimp_modules_load (gimp);
+  GIMP_TRACE_END ();
 
   g_signal_emit (gimp, gimp_signals[RESTORE], 0, status_callback);
 
@@ -48,6 +48,7 @@ struct _Gimp
   gboolean                be_verbose;
   gboolean                no_data;
   gboolean                no_fonts;
+  gboolean                defer_data;  /* load data files on first use */
   gboolean                no_interface;
   gboolean                show_gui;
   gboolean                use_shm;
@@ -32,6 +32,14 @@
 /* GimpBoundSeg array growth parameter */
 #define MAX_SEGS_INC  2048
 
+/* size of the cells of a GimpBoundaryCache */
+#define CACHE_TILE_SIZE 256
+
+/* minimal band size when finding the boundary in parallel */
+#define MIN_BAND_HEIGHT 64
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 256.0 * 256.0 /* pixels */)
+
 
 typedef struct _GimpBoundary GimpBoundary;
 
@@ -52,6 +60,72 @@ struct _GimpBoundary
   gint          max_empty_segs;
 };
 
+typedef struct
+{
+  gboolean      valid;
+  GimpBoundSeg *segs;
+  gint          num_segs;
+} GimpBoundaryCacheTile;
+
+typedef struct
+{
+  GimpBoundary *boundary;
+
+  /*  per vertical pixel edge line, the index of the segment touching
+   *  the band's top and bottom, or -1
+   */
+  gint         *starts;
+  gint         *ends;
+} GimpBoundaryBand;
+
+typedef struct
+{
+  GeglBuffer          *buffer;
+  const GeglRectangle *region;
+  const Babl          *format;
+  GimpBoundaryType     type;
+  gint                 x1, y1;
+  gint                 x2, y2;
+  gfloat               threshold;
+
+  /*  the pixel columns and the horizontal edge lines to look at  */
+  gint                 start_x, end_x;
+  gint                 start_y, end_y;
+
+  GimpBoundaryBand    *bands;
+  gint                 n_bands;
+} GimpBoundaryBandsData;
+
+typedef struct
+{
+  gint x;
+  gint y;
+  gint seg;
+  gint next;
+} GimpBoundaryPoint;
+
+struct _GimpBoundaryCache
+{
+  /*  the buffer's "changed" signal may be emitted from any thread  */
+  GMutex                 mutex;
+
+  /*  the parameters the cached segments were found with; the buffer
+   *  is only compared, not referenced
+   */
+  GeglBuffer            *buffer;
+  GeglRectangle          extent;
+  const Babl            *format;
+  GimpBoundaryType       type;
+  gint                   x1, y1;
+  gint                   x2, y2;
+  gfloat                 threshold;
+
+  /*  the segments, per cell of a grid over the pixel edges of extent  */
+  GimpBoundaryCacheTile *tiles;
+  gint                   n_tiles_x;
+  gint                   n_tiles_y;
+};
+
 
 /*  local function prototypes  */
 
@@ -101,32 +175,47 @@ static GimpBoundary * generate_boundary        (GeglBuffer          *buffer,
                                                 gint                 y2,
                                                 gfloat               threshold);
 
-static gint       cmp_segptr_xy1_addr     (const GimpBoundSeg **seg_ptr_a,
-                                           const GimpBoundSeg **seg_ptr_b);
-static gint       cmp_segptr_xy2_addr     (const GimpBoundSeg **seg_ptr_a,
-                                           const GimpBoundSeg **seg_ptr_b);
-
-static gint       cmp_segptr_xy1          (const GimpBoundSeg **seg_ptr_a,
-                                           const GimpBoundSeg **seg_ptr_b);
-static gint       cmp_segptr_xy2          (const GimpBoundSeg **seg_ptr_a,
-                                           const GimpBoundSeg **seg_ptr_b);
-
-static const GimpBoundSeg * find_segment  (const GimpBoundSeg **segs_by_xy1,
-                                           const GimpBoundSeg **segs_by_xy2,
-                                           gint                 num_segs,
-                                           gint                 x,
-                                           gint                 y);
-
-static const GimpBoundSeg * find_segment_with_func (const GimpBoundSeg **segs,
-                                                    gint                 num_segs,
-                                                    const GimpBoundSeg  *search_seg,
-                                                    GCompareFunc         cmp_func);
+static GimpBoundary * generate_boundary_parallel (GeglBuffer          *buffer,
+                                                   const GeglRectangle *region,
+                                                   const Babl          *format,
+                                                   GimpBoundaryType     type,
+                                                   gint                 x1,
+                                                   gint                 y1,
+                                                   gint                 x2,
+                                                   gint                 y2,
+                                                   gfloat               threshold);
+static void           find_band_row        (GimpBoundaryBandsData *data,
+                                            gint                   y,
+                                            gfloat                *line_data,
+                                            guint8                *inside);
+static void           find_band            (gint                   band,
+                                            gint                   n_bands,
+                                            GimpBoundaryBandsData *data);
+
+static gint       points_lookup           (const GimpBoundaryPoint *points,
+                                           const gint              *table,
+                                           guint                    mask,
+                                           gint                     x,
+                                           gint                     y);
+static const GimpBoundSeg * find_segment  (const GimpBoundSeg      *segs,
+                                           const GimpBoundaryPoint *points,
+                                           const gint              *table,
+                                           guint                    mask,
+                                           gint                     x,
+                                           gint                     y);
 
 static void       simplify_subdivide  (const GimpBoundSeg  *segs,
                                        gint                 start_idx,
                                        gint                 end_idx,
                                        GArray             **ret_points);
 
+static void       cache_invalidate    (GimpBoundaryCache     *cache,
+                                       const GeglRectangle   *rect);
+static void       cache_tile_find     (GimpBoundaryCache     *cache,
+                                       GimpBoundaryCacheTile *tile,
+                                       GeglBuffer            *buffer,
+                                       const GeglRectangle   *rect);
+
 
 /*  public functions  */
 
@@ -150,6 +239,9 @@ static void       simplify_subdivide  (const GimpBoundSeg  *segs,
  * more than 1 bytes/pixel, the last byte of each pixel is used to
  * determine the boundary outline.
  *
+ * Large regions are searched in horizontal bands in parallel, unless
+ * GEGL is limited to a single thread.
+ *
  * Returns: the boundary array.
  **/
 GimpBoundSeg *
@@ -183,8 +275,12 @@ gimp_boundary_find (GeglBuffer          *buffer,
       rect.height = gegl_buffer_get_height (buffer);
     }
 
-  boundary = generate_boundary (buffer, &rect, format, type,
-                                x1, y1, x2, y2, threshold);
+  boundary = generate_boundary_parallel (buffer, &rect, format, type,
+                                         x1, y1, x2, y2, threshold);
+
+  if (! boundary)
+    boundary = generate_boundary (buffer, &rect, format, type,
+                                  x1, y1, x2, y2, threshold);
 
   *num_segs = boundary->num_segs;
 
@@ -209,12 +305,13 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
                     gint                num_segs,
                     gint               *num_groups)
 {
-  GimpBoundary        *boundary;
-  const GimpBoundSeg **segs_ptrs_by_xy1;
-  const GimpBoundSeg **segs_ptrs_by_xy2;
-  gint                 index;
-  gint                 x, y;
-  gint                 startx, starty;
+  GimpBoundary      *boundary;
+  GimpBoundaryPoint *points;
+  gint              *table;
+  guint              mask;
+  gint               index;
+  gint               x, y;
+  gint               startx, starty;
 
   g_return_val_if_fail ((segs == NULL && num_segs == 0) ||
                         (segs != NULL && num_segs >  0), NULL);
@@ -225,22 +322,34 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
   if (num_segs == 0)
     return NULL;
 
-  /* prepare arrays with GimpBoundSeg pointers sorted by xy1 and xy2
-   * accordingly
+  /* hash both end points of all segments, each table slot holding
+   * the list of segments touching one point, open addressing
    */
-  segs_ptrs_by_xy1 = g_new (const GimpBoundSeg *, num_segs);
-  segs_ptrs_by_xy2 = g_new (const GimpBoundSeg *, num_segs);
+  mask = 1;
+  while (mask < 4 * num_segs)
+    mask <<= 1;
+  mask--;
 
-  for (index = 0; index < num_segs; index++)
+  table  = g_new (gint, mask + 1);
+  points = g_new (GimpBoundaryPoint, 2 * num_segs);
+
+  memset (table, -1, (mask + 1) * sizeof (gint));
+
+  for (index = 0; index < 2 * num_segs; index++)
     {
-      segs_ptrs_by_xy1[index] = segs + index;
-      segs_ptrs_by_xy2[index] = segs + index;
-    }
+      const GimpBoundSeg *seg = &segs[index / 2];
+      guint               slot;
+
+      points[index].x   = (index & 1) ? seg->x2 : seg->x1;
+      points[index].y   = (index & 1) ? seg->y2 : seg->y1;
+      points[index].seg = index / 2;
 
-  qsort (segs_ptrs_by_xy1, num_segs, sizeof (GimpBoundSeg *),
-         (GCompareFunc) cmp_segptr_xy1_addr);
-  qsort (segs_ptrs_by_xy2, num_segs, sizeof (GimpBoundSeg *),
-         (GCompareFunc) cmp_segptr_xy2_addr);
+      slot = points_lookup (points, table, mask,
+                            points[index].x, points[index].y);
+
+      points[index].next = table[slot];
+      table[slot]        = index;
+    }
 
   for (index = 0; index < num_segs; index++)
     ((GimpBoundSeg *) segs)[index].visited = FALSE;
@@ -266,8 +375,8 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
       x = segs[index].x2;
       y = segs[index].y2;
 
-      while ((cur_seg = find_segment (segs_ptrs_by_xy1, segs_ptrs_by_xy2,
-                                      num_segs, x, y)) != NULL)
+      while ((cur_seg = find_segment (segs, points, table, mask,
+                                      x, y)) != NULL)
         {
           /*  make sure ordering is correct  */
           if (x == cur_seg->x1 && y == cur_seg->y1)
@@ -300,8 +409,8 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
       gimp_boundary_add_seg (boundary, -1, -1, -1, -1, 0);
   }
 
-  g_free (segs_ptrs_by_xy1);
-  g_free (segs_ptrs_by_xy2);
+  g_free (points);
+  g_free (table);
 
   return gimp_boundary_free (boundary, FALSE);
 }
@@ -381,6 +490,317 @@ gimp_boundary_simplify (GimpBoundSeg *sorted_segs,
   return (GimpBoundSeg *) g_array_free (new_bounds, FALSE);
 }
 
+/**
+ * gimp_boundary_cache_new:
+ *
+ * Creates a cache for gimp_boundary_cache_find(), which keeps the
+ * segments found in a grid of cells, so that after a change of the
+ * buffer only the cells touched by the change need to be searched
+ * again.
+ *
+ * Returns: the new cache.
+ **/
+GimpBoundaryCache *
+gimp_boundary_cache_new (void)
+{
+  GimpBoundaryCache *cache = g_slice_new0 (GimpBoundaryCache);
+
+  g_mutex_init (&cache->mutex);
+
+  return cache;
+}
+
+void
+gimp_boundary_cache_free (GimpBoundaryCache *cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  cache_invalidate (cache, NULL);
+
+  g_free (cache->tiles);
+
+  g_mutex_clear (&cache->mutex);
+
+  g_slice_free (GimpBoundaryCache, cache);
+}
+
+/**
+ * gimp_boundary_cache_invalidate:
+ * @cache: a #GimpBoundaryCache
+ * @rect:  (nullable): the changed area of the buffer, or %NULL
+ *
+ * Forgets the segments which might have been affected by a change of
+ * the pixels in @rect, or all segments if @rect is %NULL.
+ **/
+void
+gimp_boundary_cache_invalidate (GimpBoundaryCache   *cache,
+                                const GeglRectangle *rect)
+{
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&cache->mutex);
+
+  cache_invalidate (cache, rect);
+
+  g_mutex_unlock (&cache->mutex);
+}
+
+gint64
+gimp_boundary_cache_get_memsize (GimpBoundaryCache *cache)
+{
+  gint64 memsize = 0;
+  gint   i;
+
+  if (! cache)
+    return 0;
+
+  memsize += sizeof (GimpBoundaryCache);
+  memsize += (gint64) cache->n_tiles_x * cache->n_tiles_y *
+             sizeof (GimpBoundaryCacheTile);
+
+  for (i = 0; i < cache->n_tiles_x * cache->n_tiles_y; i++)
+    memsize += cache->tiles[i].num_segs * sizeof (GimpBoundSeg);
+
+  return memsize;
+}
+
+/**
+ * gimp_boundary_cache_find:
+ * @cache:     a #GimpBoundaryCache
+ * @buffer:    a #GeglBuffer
+ * @region:    (nullable): the area to look at
+ * @format:    a #Babl float format representing the component to analyze
+ * @type:      type of bounds
+ * @x1:        left side of bounds
+ * @y1:        top side of bounds
+ * @x2:        right side of bounds
+ * @y2:        bottom side of bounds
+ * @threshold: pixel value of boundary line
+ * @num_segs:  number of returned #GimpBoundSeg's
+ *
+ * Like gimp_boundary_find(), but only searches the parts of @buffer
+ * which were invalidated since the last call with the same
+ * parameters, and reuses the segments found in the rest.
+ *
+ * Unlike with gimp_boundary_find(), all pixels of @buffer above
+ * @threshold must lie within @region; it only limits the area to
+ * look at.  The segments are cached per cell, and the ones continuing
+ * across cell borders are merged again, so the same segments as
+ * gimp_boundary_find()'s are returned, in a different order.
+ *
+ * Returns: the boundary array.
+ **/
+GimpBoundSeg *
+gimp_boundary_cache_find (GimpBoundaryCache   *cache,
+                          GeglBuffer          *buffer,
+                          const GeglRectangle *region,
+                          const Babl          *format,
+                          GimpBoundaryType     type,
+                          gint                 x1,
+                          gint                 y1,
+                          gint                 x2,
+                          gint                 y2,
+                          gfloat               threshold,
+                          gint                *num_segs)
+{
+  const GeglRectangle *extent;
+  GeglRectangle        area;
+  GimpBoundSeg        *segs;
+  gint                *h_prev;
+  gint                *h_next;
+  gint                *v_prev;
+  gint                *v_next;
+  gint                 tx1, ty1;
+  gint                 tx2, ty2;
+  gint                 tx, ty;
+  gint                 n;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (num_segs != NULL, NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (babl_format_get_bytes_per_pixel (format) ==
+                        sizeof (gfloat), NULL);
+
+  extent = gegl_buffer_get_extent (buffer);
+
+  g_mutex_lock (&cache->mutex);
+
+  if (buffer    != cache->buffer    ||
+      format    != cache->format    ||
+      type      != cache->type      ||
+      x1        != cache->x1        ||
+      y1        != cache->y1        ||
+      x2        != cache->x2        ||
+      y2        != cache->y2        ||
+      threshold != cache->threshold ||
+      ! gegl_rectangle_equal (extent, &cache->extent))
+    {
+      cache_invalidate (cache, NULL);
+
+      cache->buffer    = buffer;
+      cache->extent    = *extent;
+      cache->format    = format;
+      cache->type      = type;
+      cache->x1        = x1;
+      cache->y1        = y1;
+      cache->x2        = x2;
+      cache->y2        = y2;
+      cache->threshold = threshold;
+
+      /*  the edges run along pixel borders, from the left/top side of
+       *  the extent's first pixel to the right/bottom side of its last
+       */
+      cache->n_tiles_x = extent->width  / CACHE_TILE_SIZE + 1;
+      cache->n_tiles_y = extent->height / CACHE_TILE_SIZE + 1;
+
+      g_free (cache->tiles);
+      cache->tiles = g_new0 (GimpBoundaryCacheTile,
+                             cache->n_tiles_x * cache->n_tiles_y);
+    }
+
+  /*  only the edges of the pixels within region can be boundary  */
+  if (region)
+    area = *region;
+  else
+    area = *extent;
+
+  if (type == GIMP_BOUNDARY_WITHIN_BOUNDS)
+    gegl_rectangle_intersect (&area, &area,
+                              GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1));
+
+  *num_segs = 0;
+
+  if (gegl_rectangle_is_empty (&area))
+    {
+      g_mutex_unlock (&cache->mutex);
+      return NULL;
+    }
+
+  tx1 = (area.x - extent->x) / CACHE_TILE_SIZE;
+  ty1 = (area.y - extent->y) / CACHE_TILE_SIZE;
+  tx2 = (area.x + area.width  - extent->x) / CACHE_TILE_SIZE + 1;
+  ty2 = (area.y + area.height - extent->y) / CACHE_TILE_SIZE + 1;
+
+  tx1 = CLAMP (tx1, 0, cache->n_tiles_x);
+  ty1 = CLAMP (ty1, 0, cache->n_tiles_y);
+  tx2 = CLAMP (tx2, 0, cache->n_tiles_x);
+  ty2 = CLAMP (ty2, 0, cache->n_tiles_y);
+
+  for (ty = ty1; ty < ty2; ty++)
+    for (tx = tx1; tx < tx2; tx++)
+      {
+        GimpBoundaryCacheTile *tile = &cache->tiles[ty * cache->n_tiles_x + tx];
+
+        if (! tile->valid)
+          {
+            GeglRectangle rect;
+
+            rect.x      = extent->x + tx * CACHE_TILE_SIZE;
+            rect.y      = extent->y + ty * CACHE_TILE_SIZE;
+            rect.width  = MIN (CACHE_TILE_SIZE,
+                               extent->x + extent->width  + 1 - rect.x);
+            rect.height = MIN (CACHE_TILE_SIZE,
+                               extent->y + extent->height + 1 - rect.y);
+
+            cache_tile_find (cache, tile, buffer, &rect);
+          }
+
+        *num_segs += tile->num_segs;
+      }
+
+  if (*num_segs == 0)
+    {
+      g_mutex_unlock (&cache->mutex);
+      return NULL;
+    }
+
+  segs = g_new (GimpBoundSeg, *num_segs);
+  n    = 0;
+
+  /*  the indices of the segments ending on the border to the next cell,
+   *  per horizontal edge line of a row of cells, and per vertical edge
+   *  line of the area, or -1
+   */
+  h_prev = g_new (gint, CACHE_TILE_SIZE);
+  h_next = g_new (gint, CACHE_TILE_SIZE);
+  v_prev = g_new (gint, (tx2 - tx1) * CACHE_TILE_SIZE);
+  v_next = g_new (gint, (tx2 - tx1) * CACHE_TILE_SIZE);
+
+  for (ty = ty1; ty < ty2; ty++)
+    {
+      gint  top = extent->y + ty * CACHE_TILE_SIZE;
+      gint *tmp;
+
+      tmp    = v_prev;
+      v_prev = v_next;
+      v_next = tmp;
+
+      memset (v_next, -1, (tx2 - tx1) * CACHE_TILE_SIZE * sizeof (gint));
+
+      for (tx = tx1; tx < tx2; tx++)
+        {
+          GimpBoundaryCacheTile *tile = &cache->tiles[ty * cache->n_tiles_x + tx];
+          gint                   left = extent->x + tx  * CACHE_TILE_SIZE;
+          gint                   base = extent->x + tx1 * CACHE_TILE_SIZE;
+          gint                   i;
+
+          tmp    = h_prev;
+          h_prev = h_next;
+          h_next = tmp;
+
+          memset (h_next, -1, CACHE_TILE_SIZE * sizeof (gint));
+
+          /*  join the segments continuing from the cells on the left
+           *  and above to the ones ending there
+           */
+          for (i = 0; i < tile->num_segs; i++)
+            {
+              const GimpBoundSeg *seg   = &tile->segs[i];
+              gint                index = -1;
+
+              if (seg->y1 == seg->y2)
+                {
+                  if (tx > tx1 && seg->x1 == left)
+                    index = h_prev[seg->y1 - top];
+
+                  if (index >= 0 && segs[index].open == seg->open)
+                    segs[index].x2 = seg->x2;
+                  else
+                    segs[index = n++] = *seg;
+
+                  if (seg->x2 == left + CACHE_TILE_SIZE)
+                    h_next[seg->y1 - top] = index;
+                }
+              else
+                {
+                  if (ty > ty1 && seg->y1 == top)
+                    index = v_prev[seg->x1 - base];
+
+                  if (index >= 0 && segs[index].open == seg->open)
+                    segs[index].y2 = seg->y2;
+                  else
+                    segs[index = n++] = *seg;
+
+                  if (seg->y2 == top + CACHE_TILE_SIZE)
+                    v_next[seg->x1 - base] = index;
+                }
+            }
+        }
+    }
+
+  g_free (h_prev);
+  g_free (h_next);
+  g_free (v_prev);
+  g_free (v_next);
+
+  g_mutex_unlock (&cache->mutex);
+
+  *num_segs = n;
+
+  return segs;
+}
+
 void
 gimp_boundary_offset (GimpBoundSeg *segs,
                       gint          num_segs,
@@ -477,11 +897,12 @@ gimp_boundary_add_seg (GimpBoundary *boundary,
       boundary->segs = g_renew (GimpBoundSeg, boundary->segs, boundary->max_segs);
     }
 
-  boundary->segs[boundary->num_segs].x1   = x1;
-  boundary->segs[boundary->num_segs].y1   = y1;
-  boundary->segs[boundary->num_segs].x2   = x2;
-  boundary->segs[boundary->num_segs].y2   = y2;
-  boundary->segs[boundary->num_segs].open = open;
+  boundary->segs[boundary->num_segs].x1      = x1;
+  boundary->segs[boundary->num_segs].y1      = y1;
+  boundary->segs[boundary->num_segs].x2      = x2;
+  boundary->segs[boundary->num_segs].y2      = y2;
+  boundary->segs[boundary->num_segs].open    = open;
+  boundary->segs[boundary->num_segs].visited = FALSE;
 
   boundary->num_segs ++;
 }
@@ -769,172 +1190,382 @@ generate_boundary (GeglBuffer          *buffer,
   return boundary;
 }
 
-/*  sorting utility functions  */
+/*  parallel boundary finding  */
 
-static inline gint
-cmp_xy (const gint ax,
-        const gint ay,
-        const gint bx,
-        const gint by)
+static GimpBoundary *
+generate_boundary_parallel (GeglBuffer          *buffer,
+                            const GeglRectangle *region,
+                            const Babl          *format,
+                            GimpBoundaryType     type,
+                            gint                 x1,
+                            gint                 y1,
+                            gint                 x2,
+                            gint                 y2,
+                            gfloat               threshold)
 {
-  if (ay < by)
+  GimpBoundaryBandsData  data;
+  GimpBoundary          *boundary;
+  GimpBoundSeg         **chains;
+  gint                   n_lines;
+  gint                   width;
+  gint                   max_bands;
+  gint                   n_threads;
+  gint                   i, j;
+
+  /*  on a single thread, the bands would only add stitching  */
+  g_object_get (gegl_config (),
+                "threads", &n_threads,
+                NULL);
+
+  if (n_threads < 2)
+    return NULL;
+
+  data.buffer    = buffer;
+  data.region    = region;
+  data.format    = format;
+  data.type      = type;
+  data.x1        = x1;
+  data.y1        = y1;
+  data.x2        = x2;
+  data.y2        = y2;
+  data.threshold = threshold;
+
+  if (type == GIMP_BOUNDARY_WITHIN_BOUNDS)
     {
-      return -1;
+      data.start_x = x1;
+      data.end_x   = x2;
+      data.start_y = y1;
+      data.end_y   = y2;
     }
-  else if (ay > by)
+  else
     {
-      return 1;
+      data.start_x = region->x;
+      data.end_x   = region->x + region->width;
+      data.start_y = region->y;
+      data.end_y   = region->y + region->height;
     }
-  else if (ax < bx)
+
+  width   = data.end_x - data.start_x;
+  n_lines = data.end_y - data.start_y + 1;
+
+  if (width <= 0 || n_lines <= 1)
+    return NULL;
+
+  max_bands = MIN (n_lines / MIN_BAND_HEIGHT,
+                   (gdouble) width * n_lines / PIXELS_PER_THREAD);
+
+  if (max_bands < 2)
+    return NULL;
+
+  data.bands   = g_new0 (GimpBoundaryBand, max_bands);
+  data.n_bands = 0;
+
+  gegl_parallel_distribute (max_bands,
+                            (GeglParallelDistributeFunc) find_band,
+                            &data);
+
+  /*  stitch the vertical segments crossing the band borders  */
+  chains = g_new (GimpBoundSeg *, width + 1);
+
+  for (i = 0; i <= width; i++)
     {
-      return -1;
+      GimpBoundaryBand *band = &data.bands[0];
+
+      chains[i] = band->ends[i] >= 0 ? &band->boundary->segs[band->ends[i]] :
+                                       NULL;
     }
-  else if (ax > bx)
+
+  for (j = 1; j < data.n_bands; j++)
     {
-      return 1;
+      GimpBoundaryBand *band = &data.bands[j];
+
+      for (i = 0; i <= width; i++)
+        {
+          GimpBoundSeg *start = NULL;
+          GimpBoundSeg *end   = NULL;
+
+          if (band->starts[i] >= 0)
+            start = &band->boundary->segs[band->starts[i]];
+
+          if (band->ends[i] >= 0)
+            end = &band->boundary->segs[band->ends[i]];
+
+          if (chains[i] && start && chains[i]->open == start->open)
+            {
+              chains[i]->y2 = start->y2;
+
+              /*  mark as merged  */
+              start->visited = TRUE;
+
+              if (end == start)
+                end = chains[i];
+            }
+
+          chains[i] = end;
+        }
     }
-  else
+
+  g_free (chains);
+
+  boundary = gimp_boundary_new (NULL);
+
+  for (j = 0; j < data.n_bands; j++)
     {
-      return 0;
+      GimpBoundaryBand *band = &data.bands[j];
+
+      for (i = 0; i < band->boundary->num_segs; i++)
+        {
+          const GimpBoundSeg *seg = &band->boundary->segs[i];
+
+          if (! seg->visited)
+            gimp_boundary_add_seg (boundary,
+                                   seg->x1, seg->y1, seg->x2, seg->y2,
+                                   seg->open);
+        }
+
+      gimp_boundary_free (band->boundary, TRUE);
+      g_free (band->starts);
+      g_free (band->ends);
     }
-}
 
+  g_free (data.bands);
 
-/*
- * Compares (x1, y1) pairs in specified segments, using their addresses if
- * (x1, y1) pairs are equal.
+  return boundary;
+}
+
+/*  computes which pixels of row y are inside, for the pixel columns
+ *  start_x - 1 to end_x, the outer ones always being outside
  */
-static gint
-cmp_segptr_xy1_addr (const GimpBoundSeg **seg_ptr_a,
-                     const GimpBoundSeg **seg_ptr_b)
+static void
+find_band_row (GimpBoundaryBandsData *data,
+               gint                   y,
+               gfloat                *line_data,
+               guint8                *inside)
 {
-  const GimpBoundSeg *seg_a = *seg_ptr_a;
-  const GimpBoundSeg *seg_b = *seg_ptr_b;
+  gint width = data->end_x - data->start_x;
+  gint x;
+
+  memset (inside, 0, width + 2);
+
+  if (y < data->region->y || y >= data->region->y + data->region->height)
+    return;
 
-  gint result = cmp_xy (seg_a->x1, seg_a->y1, seg_b->x1, seg_b->y1);
+  if (y < data->start_y || y >= data->end_y)
+    return;
 
-  if (result == 0)
+  gegl_buffer_get (data->buffer,
+                   GEGL_RECTANGLE (data->start_x, y, width, 1), 1.0,
+                   data->format, line_data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (data->type == GIMP_BOUNDARY_IGNORE_BOUNDS &&
+      y >= data->y1 && y < data->y2)
     {
-      if (seg_a < seg_b)
-        result = -1;
-      else if (seg_a > seg_b)
-        result = 1;
-    }
+      for (x = 0; x < width; x++)
+        {
+          gint px = data->start_x + x;
 
-  return result;
+          inside[x + 1] = (line_data[x] > data->threshold &&
+                           ! (px >= data->x1 && px < data->x2));
+        }
+    }
+  else
+    {
+      for (x = 0; x < width; x++)
+        inside[x + 1] = line_data[x] > data->threshold;
+    }
 }
 
-/*
- * Compares (x2, y2) pairs in specified segments, using their addresses if
- * (x2, y2) pairs are equal.
+/*  finds the segments along the horizontal pixel edge lines of one
+ *  band, and the vertical ones between them.  horizontal segments are
+ *  open if the pixel below them is inside, vertical ones if the pixel
+ *  on their right is, like generate_boundary() does.
  */
-static gint
-cmp_segptr_xy2_addr (const GimpBoundSeg **seg_ptr_a,
-                     const GimpBoundSeg **seg_ptr_b)
+static void
+find_band (gint                   band_index,
+           gint                   n_bands,
+           GimpBoundaryBandsData *data)
 {
-  const GimpBoundSeg *seg_a = *seg_ptr_a;
-  const GimpBoundSeg *seg_b = *seg_ptr_b;
+  GimpBoundaryBand *band    = &data->bands[band_index];
+  gint              width   = data->end_x - data->start_x;
+  gint              n_lines = data->end_y - data->start_y + 1;
+  gint              band_y1;
+  gint              band_y2;
+  gfloat           *line_data;
+  guint8           *prev;
+  guint8           *cur;
+  guint8           *run_edge;
+  gint             *run_start;
+  gint              x, y;
+
+  if (band_index == 0)
+    data->n_bands = n_bands;
+
+  band_y1 = data->start_y + (gint64) n_lines * band_index       / n_bands;
+  band_y2 = data->start_y + (gint64) n_lines * (band_index + 1) / n_bands;
+
+  band->boundary = gimp_boundary_new (NULL);
+  band->starts   = g_new (gint, width + 1);
+  band->ends     = g_new (gint, width + 1);
+
+  line_data = g_new  (gfloat, width);
+  prev      = g_new  (guint8, width + 2);
+  cur       = g_new  (guint8, width + 2);
+  run_edge  = g_new0 (guint8, width + 1);
+  run_start = g_new0 (gint,   width + 1);
+
+  for (x = 0; x <= width; x++)
+    {
+      band->starts[x] = -1;
+      band->ends[x]   = -1;
+    }
+
+  find_band_row (data, band_y1 - 1, line_data, prev);
+
+  for (y = band_y1; y < band_y2; y++)
+    {
+      guint8 *tmp;
+      gint    edge  = 0;
+      gint    start = 0;
+
+      find_band_row (data, y, line_data, cur);
+
+      /*  the horizontal segments between the previous row and this
+       *  one; 0: no edge, 1: inside above, 2: inside below
+       */
+      for (x = 1; x <= width + 1; x++)
+        {
+          gint e = 0;
+
+          if (x <= width && prev[x] != cur[x])
+            e = cur[x] ? 2 : 1;
+
+          if (e != edge)
+            {
+              if (edge)
+                gimp_boundary_add_seg (band->boundary,
+                                       data->start_x + start - 1, y,
+                                       data->start_x + x - 1,     y,
+                                       edge == 2);
+
+              edge  = e;
+              start = x;
+            }
+        }
+
+      /*  continue the vertical segments between the pixels of this row;
+       *  0: no edge, 1: inside on the left, 2: inside on the right
+       */
+      for (x = 0; x <= width; x++)
+        {
+          gint e = 0;
+
+          if (cur[x] != cur[x + 1])
+            e = cur[x + 1] ? 2 : 1;
+
+          if (e != run_edge[x])
+            {
+              if (run_edge[x])
+                {
+                  if (run_start[x] == band_y1)
+                    band->starts[x] = band->boundary->num_segs;
+
+                  gimp_boundary_add_seg (band->boundary,
+                                         data->start_x + x, run_start[x],
+                                         data->start_x + x, y,
+                                         run_edge[x] == 2);
+                }
+
+              run_edge[x]  = e;
+              run_start[x] = y;
+            }
+        }
 
-  gint result = cmp_xy (seg_a->x2, seg_a->y2, seg_b->x2, seg_b->y2);
+      tmp  = prev;
+      prev = cur;
+      cur  = tmp;
+    }
 
-  if (result == 0)
+  /*  close the vertical segments reaching the bottom of the band  */
+  for (x = 0; x <= width; x++)
     {
-      if (seg_a < seg_b)
-        result = -1;
-      else if (seg_a > seg_b)
-        result = 1;
+      if (run_edge[x])
+        {
+          if (run_start[x] == band_y1)
+            band->starts[x] = band->boundary->num_segs;
+
+          band->ends[x] = band->boundary->num_segs;
+
+          gimp_boundary_add_seg (band->boundary,
+                                 data->start_x + x, run_start[x],
+                                 data->start_x + x, band_y2,
+                                 run_edge[x] == 2);
+        }
     }
 
-  return result;
+  g_free (line_data);
+  g_free (prev);
+  g_free (cur);
+  g_free (run_edge);
+  g_free (run_start);
 }
 
 
-/*
- * Compares (x1, y1) pairs in specified segments.
- */
-static gint
-cmp_segptr_xy1 (const GimpBoundSeg **seg_ptr_a,
-                const GimpBoundSeg **seg_ptr_b)
+/*  sorting utility functions  */
+
+static inline guint
+points_hash (gint x,
+             gint y)
 {
-  const GimpBoundSeg *seg_a = *seg_ptr_a, *seg_b = *seg_ptr_b;
+  guint hash = (guint) x * 73856093u ^ (guint) y * 19349663u;
 
-  return cmp_xy (seg_a->x1, seg_a->y1, seg_b->x1, seg_b->y1);
+  return hash ^ (hash >> 15);
 }
 
-/*
- * Compares (x2, y2) pairs in specified segments.
+/*  returns the table slot of the point (x, y), which is either the
+ *  slot of the list of segments touching it, or an empty one
  */
 static gint
-cmp_segptr_xy2 (const GimpBoundSeg **seg_ptr_a,
-                const GimpBoundSeg **seg_ptr_b)
+points_lookup (const GimpBoundaryPoint *points,
+               const gint              *table,
+               guint                    mask,
+               gint                     x,
+               gint                     y)
 {
-  const GimpBoundSeg *seg_a = *seg_ptr_a;
-  const GimpBoundSeg *seg_b = *seg_ptr_b;
-
-  return cmp_xy (seg_a->x2, seg_a->y2, seg_b->x2, seg_b->y2);
-}
+  guint slot = points_hash (x, y) & mask;
 
+  while (table[slot] >= 0 &&
+         (points[table[slot]].x != x || points[table[slot]].y != y))
+    {
+      slot = (slot + 1) & mask;
+    }
 
-static const GimpBoundSeg *
-find_segment (const GimpBoundSeg **segs_by_xy1,
-              const GimpBoundSeg **segs_by_xy2,
-              gint                 num_segs,
-              gint                 x,
-              gint                 y)
-{
-  const GimpBoundSeg *segptr_xy1;
-  const GimpBoundSeg *segptr_xy2;
-  GimpBoundSeg        search_seg;
-
-  search_seg.x1 = search_seg.x2 = x;
-  search_seg.y1 = search_seg.y2 = y;
-
-  segptr_xy1 = find_segment_with_func (segs_by_xy1, num_segs, &search_seg,
-                                       (GCompareFunc) cmp_segptr_xy1);
-  segptr_xy2 = find_segment_with_func (segs_by_xy2, num_segs, &search_seg,
-                                       (GCompareFunc) cmp_segptr_xy2);
-
-  /* return segment with smaller address */
-  if (segptr_xy1 != NULL && segptr_xy2 != NULL)
-    return MIN(segptr_xy1, segptr_xy2);
-  else if (segptr_xy1 != NULL)
-    return segptr_xy1;
-  else if (segptr_xy2 != NULL)
-    return segptr_xy2;
-
-  return NULL;
+  return slot;
 }
 
-
+/*  returns the first unvisited segment touching the point (x, y)  */
 static const GimpBoundSeg *
-find_segment_with_func (const GimpBoundSeg **segs,
-                        gint                 num_segs,
-                        const GimpBoundSeg  *search_seg,
-                        GCompareFunc         cmp_func)
+find_segment (const GimpBoundSeg      *segs,
+              const GimpBoundaryPoint *points,
+              const gint              *table,
+              guint                    mask,
+              gint                     x,
+              gint                     y)
 {
-  const GimpBoundSeg **seg;
-  const GimpBoundSeg *found_seg = NULL;
-
-  seg = bsearch (&search_seg, segs, num_segs, sizeof (GimpBoundSeg *), cmp_func);
+  gint found = -1;
+  gint index;
 
-  if (seg != NULL)
+  for (index = table[points_lookup (points, table, mask, x, y)];
+       index >= 0;
+       index = points[index].next)
     {
-      /* find first matching segment */
-      while (seg > segs && cmp_func (seg - 1, &search_seg) == 0)
-        seg--;
+      gint seg = points[index].seg;
 
-      /* find first non-visited segment */
-      while (seg != segs + num_segs && cmp_func (seg, &search_seg) == 0)
-        if (!(*seg)->visited)
-          {
-            found_seg = *seg;
-            break;
-          }
-        else
-          seg++;
+      if (! segs[seg].visited && (found < 0 || seg < found))
+        found = seg;
     }
 
-    return found_seg;
+  return found >= 0 ? &segs[found] : NULL;
 }
 
 
@@ -1014,3 +1645,177 @@ simplify_subdivide (const GimpBoundSeg *segs,
   simplify_subdivide (segs, start_idx, maxdist_idx, ret_points);
   simplify_subdivide (segs, maxdist_idx, end_idx, ret_points);
 }
+
+
+/*  cache utility functions  */
+
+static void
+cache_invalidate (GimpBoundaryCache   *cache,
+                  const GeglRectangle *rect)
+{
+  gint tx1, ty1;
+  gint tx2, ty2;
+  gint tx, ty;
+
+  if (! cache->tiles)
+    return;
+
+  if (rect)
+    {
+      /*  a pixel's value affects the edges on its left and top, which
+       *  belong to its own cell, and the edges on its right and bottom,
+       *  which might belong to the next cells
+       */
+      tx1 = (rect->x - cache->extent.x) / CACHE_TILE_SIZE;
+      ty1 = (rect->y - cache->extent.y) / CACHE_TILE_SIZE;
+      tx2 = (rect->x + rect->width  - cache->extent.x) / CACHE_TILE_SIZE + 1;
+      ty2 = (rect->y + rect->height - cache->extent.y) / CACHE_TILE_SIZE + 1;
+
+      tx1 = CLAMP (tx1, 0, cache->n_tiles_x);
+      ty1 = CLAMP (ty1, 0, cache->n_tiles_y);
+      tx2 = CLAMP (tx2, 0, cache->n_tiles_x);
+      ty2 = CLAMP (ty2, 0, cache->n_tiles_y);
+    }
+  else
+    {
+      tx1 = 0;
+      ty1 = 0;
+      tx2 = cache->n_tiles_x;
+      ty2 = cache->n_tiles_y;
+    }
+
+  for (ty = ty1; ty < ty2; ty++)
+    for (tx = tx1; tx < tx2; tx++)
+      {
+        GimpBoundaryCacheTile *tile = &cache->tiles[ty * cache->n_tiles_x + tx];
+
+        g_clear_pointer (&tile->segs, g_free);
+        tile->num_segs = 0;
+        tile->valid    = FALSE;
+      }
+}
+
+/*  finds the boundary segments along the left and top pixel edges
+ *  of the pixels in rect.  horizontal segments are open if the pixel
+ *  below them is inside, vertical ones if the pixel on their right is,
+ *  which is what generate_boundary() produces.
+ */
+static void
+cache_tile_find (GimpBoundaryCache     *cache,
+                 GimpBoundaryCacheTile *tile,
+                 GeglBuffer            *buffer,
+                 const GeglRectangle   *rect)
+{
+  GimpBoundary *boundary;
+  gfloat       *data;
+  guint8       *inside;
+  gint          width  = rect->width  + 1;
+  gint          height = rect->height + 1;
+  gint          x, y;
+  gint          i, j;
+
+  data   = g_new (gfloat, width * height);
+  inside = g_new (guint8, width * height);
+
+  /*  include the column on the left and the row above  */
+  gegl_buffer_get (buffer,
+                   GEGL_RECTANGLE (rect->x - 1, rect->y - 1, width, height),
+                   1.0, cache->format, data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (j = 0; j < height; j++)
+    {
+      y = rect->y - 1 + j;
+
+      for (i = 0; i < width; i++)
+        {
+          gboolean in_bounds;
+
+          x = rect->x - 1 + i;
+
+          in_bounds = (x >= cache->x1 && x < cache->x2 &&
+                       y >= cache->y1 && y < cache->y2);
+
+          if (cache->type == GIMP_BOUNDARY_IGNORE_BOUNDS)
+            in_bounds = ! in_bounds;
+
+          inside[j * width + i] = (in_bounds &&
+                                   data[j * width + i] > cache->threshold);
+        }
+    }
+
+  g_free (data);
+
+  boundary = gimp_boundary_new (NULL);
+
+  /*  horizontal segments  */
+  for (j = 1; j < height; j++)
+    {
+      const guint8 *above = inside + (j - 1) * width;
+      const guint8 *below = inside + j * width;
+      gint          edge  = 0;
+      gint          start = 0;
+
+      y = rect->y - 1 + j;
+
+      for (i = 1; i <= width; i++)
+        {
+          /*  0: no edge, 1: inside above, 2: inside below  */
+          gint e = 0;
+
+          if (i < width && above[i] != below[i])
+            e = below[i] ? 2 : 1;
+
+          if (e != edge)
+            {
+              if (edge)
+                gimp_boundary_add_seg (boundary,
+                                       rect->x - 1 + start, y,
+                                       rect->x - 1 + i,     y,
+                                       edge == 2);
+
+              edge  = e;
+              start = i;
+            }
+        }
+    }
+
+  /*  vertical segments  */
+  for (i = 1; i < width; i++)
+    {
+      gint edge  = 0;
+      gint start = 0;
+
+      x = rect->x - 1 + i;
+
+      for (j = 1; j <= height; j++)
+        {
+          /*  0: no edge, 1: inside on the left, 2: inside on the right  */
+          gint e = 0;
+
+          if (j < height &&
+              inside[j * width + i - 1] != inside[j * width + i])
+            {
+              e = inside[j * width + i] ? 2 : 1;
+            }
+
+          if (e != edge)
+            {
+              if (edge)
+                gimp_boundary_add_seg (boundary,
+                                       x, rect->y - 1 + start,
+                                       x, rect->y - 1 + j,
+                                       edge == 2);
+
+              edge  = e;
+              start = j;
+            }
+        }
+    }
+
+  g_free (inside);
+
+  tile->num_segs = boundary->num_segs;
+  tile->segs     = gimp_boundary_free (boundary, FALSE);
+  tile->valid    = TRUE;
+}
@@ -27,6 +27,7 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-mask.h"
 #include "gegl/gimp-gegl-mask-combine.h"
 
 #include "gimp.h"
@@ -472,6 +473,8 @@ gimp_channel_combine_buffer (GimpChannel    *mask,
 
       gimp_gegl_mask_combine_buffer (buffer, add_on_buffer, op,
                                      off_x, off_y);
+
+      gimp_gegl_mask_compact (buffer, &data.rect, NULL);
     }
 
   gimp_channel_combine_end (mask, &data);
@@ -203,6 +203,8 @@ static void       gimp_channel_real_flood    (GimpChannel         *channel,
 static void      gimp_channel_buffer_changed (GeglBuffer          *buffer,
                                               const GeglRectangle *rect,
                                               GimpChannel         *channel);
+static void      gimp_channel_compact        (GimpChannel         *channel,
+                                              const GeglRectangle *rect);
 
 
 G_DEFINE_TYPE_WITH_CODE (GimpChannel, gimp_channel, GIMP_TYPE_DRAWABLE,
@@ -335,6 +337,8 @@ gimp_channel_finalize (GObject *object)
 
   g_clear_pointer (&channel->segs_in,  g_free);
   g_clear_pointer (&channel->segs_out, g_free);
+  g_clear_pointer (&channel->boundary_cache_in,  gimp_boundary_cache_free);
+  g_clear_pointer (&channel->boundary_cache_out, gimp_boundary_cache_free);
   g_clear_object (&channel->color);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -348,6 +352,8 @@ gimp_channel_get_memsize (GimpObject *object,
 
   *gui_size += channel->num_segs_in  * sizeof (GimpBoundSeg);
   *gui_size += channel->num_segs_out * sizeof (GimpBoundSeg);
+  *gui_size += gimp_boundary_cache_get_memsize (channel->boundary_cache_in);
+  *gui_size += gimp_boundary_cache_get_memsize (channel->boundary_cache_out);
 
   return GIMP_OBJECT_CLASS (parent_class)->get_memsize (object, gui_size);
 }
@@ -901,28 +907,18 @@ gimp_channel_convert_type (GimpDrawable     *drawable,
 {
   GeglBuffer *dest_buffer;
 
-  dest_buffer =
-    gegl_buffer_new (GEGL_RECTANGLE (0, 0,
-                                     gimp_item_get_width  (GIMP_ITEM (drawable)),
-                                     gimp_item_get_height (GIMP_ITEM (drawable))),
-                     new_format);
+  dest_buffer = gimp_drawable_take_converted_buffer (drawable, new_format);
 
-  if (mask_dither_type == GEGL_DITHER_NONE)
+  if (! dest_buffer)
     {
-      gimp_gegl_buffer_copy (gimp_drawable_get_buffer (drawable), NULL,
-                             GEGL_ABYSS_NONE,
-                             dest_buffer, NULL);
-    }
-  else
-    {
-      gint bits;
-
-      bits = (babl_format_get_bytes_per_pixel (new_format) * 8 /
-              babl_format_get_n_components (new_format));
+      dest_buffer =
+        gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                         gimp_item_get_width  (GIMP_ITEM (drawable)),
+                                         gimp_item_get_height (GIMP_ITEM (drawable))),
+                         new_format);
 
-      gimp_gegl_apply_dither (gimp_drawable_get_buffer (drawable),
-                              NULL, NULL,
-                              dest_buffer, 1 << bits, mask_dither_type);
+      gimp_gegl_apply_convert (gimp_drawable_get_buffer (drawable), NULL,
+                               NULL, dest_buffer, NULL, mask_dither_type);
     }
 
   gimp_drawable_set_buffer (drawable, push_undo, NULL, dest_buffer);
@@ -964,6 +960,12 @@ gimp_channel_set_buffer (GimpDrawable        *drawable,
                                             channel);
     }
 
+  if (channel->boundary_cache_in)
+    gimp_boundary_cache_invalidate (channel->boundary_cache_in, NULL);
+
+  if (channel->boundary_cache_out)
+    gimp_boundary_cache_invalidate (channel->boundary_cache_out, NULL);
+
   GIMP_DRAWABLE_CLASS (parent_class)->set_buffer (drawable,
                                                   push_undo, undo_desc,
                                                   buffer, bounds);
@@ -1042,12 +1044,22 @@ gimp_channel_real_boundary (GimpChannel         *channel,
 
           buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (channel));
 
-          channel->segs_out = gimp_boundary_find (buffer, &rect,
-                                                  babl_format ("Y float"),
-                                                  GIMP_BOUNDARY_IGNORE_BOUNDS,
-                                                  x1, y1, x2, y2,
-                                                  GIMP_BOUNDARY_HALF_WAY,
-                                                  &channel->num_segs_out);
+          /*  keep the segments per tile, so that after a change of the
+           *  mask, only the changed tiles need to be searched again
+           */
+          if (! channel->boundary_cache_in)
+            channel->boundary_cache_in = gimp_boundary_cache_new ();
+
+          if (! channel->boundary_cache_out)
+            channel->boundary_cache_out = gimp_boundary_cache_new ();
+
+          channel->segs_out = gimp_boundary_cache_find (channel->boundary_cache_out,
+                                                        buffer, &rect,
+                                                        babl_format ("Y float"),
+                                                        GIMP_BOUNDARY_IGNORE_BOUNDS,
+                                                        x1, y1, x2, y2,
+                                                        GIMP_BOUNDARY_HALF_WAY,
+                                                        &channel->num_segs_out);
           x1 = MAX (x1, x3);
           y1 = MAX (y1, y3);
           x2 = MIN (x2, x4);
@@ -1055,12 +1067,13 @@ gimp_channel_real_boundary (GimpChannel         *channel,
 
           if (x2 > x1 && y2 > y1)
             {
-              channel->segs_in = gimp_boundary_find (buffer, NULL,
-                                                     babl_format ("Y float"),
-                                                     GIMP_BOUNDARY_WITHIN_BOUNDS,
-                                                     x1, y1, x2, y2,
-                                                     GIMP_BOUNDARY_HALF_WAY,
-                                                     &channel->num_segs_in);
+              channel->segs_in = gimp_boundary_cache_find (channel->boundary_cache_in,
+                                                           buffer, &rect,
+                                                           babl_format ("Y float"),
+                                                           GIMP_BOUNDARY_WITHIN_BOUNDS,
+                                                           x1, y1, x2, y2,
+                                                           GIMP_BOUNDARY_HALF_WAY,
+                                                           &channel->num_segs_in);
             }
           else
             {
@@ -1166,6 +1179,8 @@ gimp_channel_real_feather (GimpChannel *channel,
                            radius_y,
                            edge_lock);
 
+  gimp_channel_compact (channel, GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1));
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
 }
 
@@ -1184,6 +1199,8 @@ gimp_channel_real_sharpen (GimpChannel *channel,
                              gimp_drawable_get_buffer (drawable),
                              0.5);
 
+  gimp_channel_compact (channel, NULL);
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
 }
 
@@ -1288,6 +1305,8 @@ gimp_channel_real_invert (GimpChannel *channel,
                                      NULL, NULL,
                                      gimp_drawable_get_buffer (drawable));
 
+      gimp_channel_compact (channel, NULL);
+
       gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
     }
 }
@@ -1360,6 +1379,8 @@ gimp_channel_real_border (GimpChannel            *channel,
                           GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
                           radius_x, radius_y, style, edge_lock);
 
+  gimp_channel_compact (channel, GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1));
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
 }
 
@@ -1422,6 +1443,8 @@ gimp_channel_real_grow (GimpChannel *channel,
                         GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
                         radius_x, radius_y);
 
+  gimp_channel_compact (channel, GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1));
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
 }
 
@@ -1474,6 +1497,8 @@ gimp_channel_real_shrink (GimpChannel *channel,
                           GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
                           radius_x, radius_y, edge_lock);
 
+  gimp_channel_compact (channel, GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1));
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), 0, 0, -1, -1);
 }
 
@@ -1498,6 +1523,8 @@ gimp_channel_real_flood (GimpChannel *channel,
                          gimp_drawable_get_buffer (GIMP_DRAWABLE (channel)),
                          GEGL_RECTANGLE (x, y, width, height));
 
+  gimp_channel_compact (channel, GEGL_RECTANGLE (x, y, width, height));
+
   gimp_drawable_update (GIMP_DRAWABLE (channel), x, y, width, height);
 }
 
@@ -1506,9 +1533,47 @@ gimp_channel_buffer_changed (GeglBuffer          *buffer,
                              const GeglRectangle *rect,
                              GimpChannel         *channel)
 {
+  /*  only the cached boundary segments around rect are out of date  */
+  if (channel->boundary_cache_in)
+    gimp_boundary_cache_invalidate (channel->boundary_cache_in, rect);
+
+  if (channel->boundary_cache_out)
+    gimp_boundary_cache_invalidate (channel->boundary_cache_out, rect);
+
   gimp_drawable_invalidate_boundary (GIMP_DRAWABLE (channel));
 }
 
+/*  only for masks which are empty outside @rect: compacts them, and
+ *  keeps the bounds found on the way
+ */
+static void
+gimp_channel_compact (GimpChannel         *channel,
+                      const GeglRectangle *rect)
+{
+  GeglRectangle bounds;
+
+  gimp_gegl_mask_compact (gimp_drawable_get_buffer (GIMP_DRAWABLE (channel)),
+                          rect, &bounds);
+
+  channel->bounds_known = TRUE;
+  channel->empty        = gegl_rectangle_is_empty (&bounds);
+
+  if (channel->empty)
+    {
+      channel->x1 = 0;
+      channel->y1 = 0;
+      channel->x2 = gimp_item_get_width  (GIMP_ITEM (channel));
+      channel->y2 = gimp_item_get_height (GIMP_ITEM (channel));
+    }
+  else
+    {
+      channel->x1 = bounds.x;
+      channel->y1 = bounds.y;
+      channel->x2 = bounds.x + bounds.width;
+      channel->y2 = bounds.y + bounds.height;
+    }
+}
+
 
 /*  public functions  */
 
@@ -1599,6 +1664,8 @@ gimp_channel_new_from_alpha (GimpImage    *image,
                          dest_buffer, NULL);
   gegl_buffer_set_format (dest_buffer, NULL);
 
+  gimp_channel_compact (channel, NULL);
+
   return channel;
 }
 
@@ -1635,6 +1702,8 @@ gimp_channel_new_from_component (GimpImage       *image,
   gimp_gegl_buffer_copy (src_buffer, NULL, GEGL_ABYSS_NONE, dest_buffer, NULL);
   gegl_buffer_set_format (dest_buffer, NULL);
 
+  gimp_channel_compact (channel, NULL);
+
   return channel;
 }
 
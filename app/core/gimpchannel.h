@@ -49,6 +49,8 @@ struct _GimpChannel
   GimpBoundSeg *segs_out;          /*  outline of selected region     */
   gint          num_segs_in;       /*  number of lines in boundary    */
   gint          num_segs_out;      /*  number of lines in boundary    */
+  GimpBoundaryCache *boundary_cache_in;  /*  per-tile segs_in            */
+  GimpBoundaryCache *boundary_cache_out; /*  per-tile segs_out           */
   gboolean      empty;             /*  is the region empty?           */
   gboolean      bounds_known;      /*  recalculate the bounds?        */
   gint          x1, y1;            /*  coordinates for bounding box   */
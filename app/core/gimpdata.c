@@ -125,6 +125,7 @@ G_DEFINE_TYPE_WITH_CODE (GimpData, gimp_data, GIMP_TYPE_RESOURCE,
 static guint data_signals[LAST_SIGNAL] = { 0 };
 
 static GimpIdTable *data_id_table = NULL;
+static GMutex       data_id_table_mutex;
 
 
 static void
@@ -214,7 +215,13 @@ gimp_data_init (GimpData *data)
 
   data->priv = private;
 
+  /*  data objects are created on worker threads by the data loader
+   *  factories, so guard the ID table
+   */
+  g_mutex_lock (&data_id_table_mutex);
   private->ID        = gimp_id_table_insert (data_id_table, data);
+  g_mutex_unlock (&data_id_table_mutex);
+
   private->writable  = TRUE;
   private->deletable = TRUE;
   private->dirty     = TRUE;
@@ -241,7 +248,9 @@ gimp_data_finalize (GObject *object)
 {
   GimpDataPrivate *private = GIMP_DATA_GET_PRIVATE (object);
 
+  g_mutex_lock (&data_id_table_mutex);
   gimp_id_table_remove (data_id_table, private->ID);
+  g_mutex_unlock (&data_id_table_mutex);
 
   g_clear_object (&private->file);
   g_clear_weak_pointer (&private->image);
@@ -594,7 +603,13 @@ gimp_data_get_id (GimpData *data)
 GimpData *
 gimp_data_get_by_id (gint data_id)
 {
-  return (GimpData *) gimp_id_table_lookup (data_id_table, data_id);
+  GimpData *data;
+
+  g_mutex_lock (&data_id_table_mutex);
+  data = (GimpData *) gimp_id_table_lookup (data_id_table, data_id);
+  g_mutex_unlock (&data_id_table_mutex);
+
+  return data;
 }
 
 /**
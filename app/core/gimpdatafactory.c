@@ -31,6 +31,9 @@
 #include "core-types.h"
 
 #include "gimp.h"
+#include "gimp-data-factories.h"
+#include "gimp-log.h"
+#include "gimp-trace.h"
 #include "gimp-utils.h"
 #include "gimpasyncset.h"
 #include "gimpcancelable.h"
@@ -524,6 +527,8 @@ gimp_data_factory_data_init (GimpDataFactory *factory,
 
   if (! no_data)
     {
+      gint64 start_time = g_get_monotonic_time ();
+
       if (priv->gimp->be_verbose)
         {
           const gchar *name = gimp_object_get_name (factory);
@@ -531,7 +536,14 @@ gimp_data_factory_data_init (GimpDataFactory *factory,
           g_print ("Loading '%s' data\n", name ? name : "???");
         }
 
+      GIMP_TRACE_BEGIN (gimp_object_get_name (factory));
       GIMP_DATA_FACTORY_GET_CLASS (factory)->data_init (factory, context);
+      GIMP_TRACE_END ();
+
+      GIMP_LOG (DATA_FACTORY, "'%s': %d items loaded in %.3f s",
+                gimp_object_get_name (factory),
+                gimp_container_get_n_children (priv->container),
+                (g_get_monotonic_time () - start_time) / (gdouble) G_TIME_SPAN_SECOND);
     }
 
   gimp_container_thaw (priv->container);
@@ -631,6 +643,9 @@ gimp_data_factory_data_wait (GimpDataFactory *factory)
 
   priv = GET_PRIVATE (factory);
 
+  /*  whoever waits for the data actually needs it  */
+  gimp_data_factories_load_deferred (priv->gimp);
+
   /* don't allow cancellation for now */
   waitable = gimp_uncancelable_waitable_new (GIMP_WAITABLE (priv->async_set));
 
@@ -30,6 +30,7 @@
 #include "core-types.h"
 
 #include "gimp.h"
+#include "gimp-log.h"
 #include "gimp-utils.h"
 #include "gimpcontainer.h"
 #include "gimpdata.h"
@@ -55,10 +56,35 @@ struct _GimpDataLoader
 };
 
 
+typedef struct _GimpDataLoadJob GimpDataLoadJob;
+
+struct _GimpDataLoadJob
+{
+  GimpDataLoader *loader;
+  GFile          *file;
+  GFile          *top_directory;
+  gboolean        dir_writable;
+  guint64         mtime;
+
+  GList          *cached_data;
+  GList          *data_list;
+  GError         *error;
+  GList          *messages;
+};
+
+typedef struct
+{
+  GimpContext *context;
+  GPtrArray   *jobs;
+  gint         next_job;
+} GimpDataLoadJobs;
+
+
 struct _GimpDataLoaderFactoryPrivate
 {
   GList          *loaders;
   GimpDataLoader *fallback;
+  gboolean        threaded;
 };
 
 #define GET_PRIVATE(obj) (((GimpDataLoaderFactory *) (obj))->priv)
@@ -79,18 +105,27 @@ static void   gimp_data_loader_factory_load           (GimpDataFactory *factory,
                                                        GimpContext     *context,
                                                        GHashTable      *cache);
 static void   gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
-                                                       GimpContext     *context,
                                                        GHashTable      *cache,
+                                                       GPtrArray       *jobs,
                                                        gboolean         dir_writable,
                                                        GFile           *directory,
                                                        GFile           *top_directory);
-static void   gimp_data_loader_factory_load_data      (GimpDataFactory *factory,
-                                                       GimpContext     *context,
+static void   gimp_data_loader_factory_queue_data     (GimpDataFactory *factory,
                                                        GHashTable      *cache,
+                                                       GPtrArray       *jobs,
                                                        gboolean         dir_writable,
                                                        GFile           *file,
                                                        GFileInfo       *info,
                                                        GFile           *top_directory);
+static void   gimp_data_loader_factory_run_jobs       (GimpDataFactory *factory,
+                                                       GimpContext     *context,
+                                                       GPtrArray       *jobs);
+static void   gimp_data_loader_factory_run_job        (GimpContext     *context,
+                                                       GimpDataLoadJob *job);
+static void   gimp_data_loader_factory_add_data       (GimpDataFactory *factory,
+                                                       GimpDataLoadJob *job);
+
+static void   gimp_data_load_job_free                 (GimpDataLoadJob *job);
 
 static GimpDataLoader * gimp_data_loader_new          (const gchar     *name,
                                                        GimpDataLoadFunc load_func,
@@ -104,6 +139,9 @@ G_DEFINE_TYPE_WITH_PRIVATE (GimpDataLoaderFactory, gimp_data_loader_factory,
 
 #define parent_class gimp_data_loader_factory_parent_class
 
+/*  the job whose load function runs on the current thread  */
+static GPrivate current_job = G_PRIVATE_INIT (NULL);
+
 
 static void
 gimp_data_loader_factory_class_init (GimpDataLoaderFactoryClass *klass)
@@ -121,6 +159,8 @@ static void
 gimp_data_loader_factory_init (GimpDataLoaderFactory *factory)
 {
   factory->priv = gimp_data_loader_factory_get_instance_private (factory);
+
+  factory->priv->threaded = TRUE;
 }
 
 static void
@@ -289,6 +329,60 @@ gimp_data_loader_factory_add_fallback (GimpDataFactory  *factory,
   priv->fallback = gimp_data_loader_new (name, load_func, NULL, FALSE);
 }
 
+/**
+ * gimp_data_loader_factory_set_threaded:
+ * @factory:  a #GimpDataLoaderFactory
+ * @threaded: whether the factory's load functions may run on worker
+ *            threads
+ *
+ * By default, the files found in the data path are parsed
+ * concurrently, and only adding the resulting data objects to the
+ * factory's container happens on the main thread. Factories whose load
+ * functions touch global state which is not thread-safe (like tool
+ * presets, which look up tool infos) must disable this.
+ **/
+void
+gimp_data_loader_factory_set_threaded (GimpDataFactory *factory,
+                                       gboolean         threaded)
+{
+  g_return_if_fail (GIMP_IS_DATA_LOADER_FACTORY (factory));
+
+  GET_PRIVATE (factory)->threaded = threaded ? TRUE : FALSE;
+}
+
+/**
+ * gimp_data_loader_factory_message:
+ * @format: printf-style format string
+ * @...:    arguments for @format
+ *
+ * Reports a problem a load function could work around. While a
+ * factory loads its data, possibly on worker threads, the message is
+ * kept with the file, and is shown on the main thread once the file's
+ * data was added. Otherwise, this is the same as g_message().
+ **/
+void
+gimp_data_loader_factory_message (const gchar *format,
+                                  ...)
+{
+  GimpDataLoadJob *job = g_private_get (&current_job);
+  gchar           *message;
+  va_list          args;
+
+  va_start (args, format);
+  message = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  if (job)
+    {
+      job->messages = g_list_prepend (job->messages, message);
+    }
+  else
+    {
+      g_message ("%s", message);
+      g_free (message);
+    }
+}
+
 
 /*  private functions  */
 
@@ -319,6 +413,10 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
   GList       *path;
   GList       *writable_path;
   GList       *list;
+  GPtrArray   *jobs;
+  gint         i;
+
+  jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) gimp_data_load_job_free);
 
   path          = gimp_data_factory_get_data_path          (factory);
   writable_path = gimp_data_factory_get_data_path_writable (factory);
@@ -331,7 +429,7 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
        * writable, since writability of extension is only taken into
        * account for extension update).
        */
-      gimp_data_loader_factory_load_directory (factory, context, cache,
+      gimp_data_loader_factory_load_directory (factory, cache, jobs,
                                                FALSE,
                                                list->data,
                                                list->data);
@@ -345,7 +443,7 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
                               (GCompareFunc) gimp_file_compare))
         dir_writable = TRUE;
 
-      gimp_data_loader_factory_load_directory (factory, context, cache,
+      gimp_data_loader_factory_load_directory (factory, cache, jobs,
                                                dir_writable,
                                                list->data,
                                                list->data);
@@ -353,12 +451,22 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
 
   g_list_free_full (path,          (GDestroyNotify) g_object_unref);
   g_list_free_full (writable_path, (GDestroyNotify) g_object_unref);
+
+  /*  parse the files, possibly on worker threads, and add the results
+   *  to the container in directory order on the main thread
+   */
+  gimp_data_loader_factory_run_jobs (factory, context, jobs);
+
+  for (i = 0; i < jobs->len; i++)
+    gimp_data_loader_factory_add_data (factory, g_ptr_array_index (jobs, i));
+
+  g_ptr_array_unref (jobs);
 }
 
 static void
 gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
-                                         GimpContext     *context,
                                          GHashTable      *cache,
+                                         GPtrArray       *jobs,
                                          gboolean         dir_writable,
                                          GFile           *directory,
                                          GFile           *top_directory)
@@ -393,17 +501,17 @@ gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
 
           if (file_type == G_FILE_TYPE_DIRECTORY)
             {
-              gimp_data_loader_factory_load_directory (factory, context, cache,
+              gimp_data_loader_factory_load_directory (factory, cache, jobs,
                                                        dir_writable,
                                                        child,
                                                        top_directory);
             }
           else if (file_type == G_FILE_TYPE_REGULAR)
             {
-              gimp_data_loader_factory_load_data (factory, context, cache,
-                                                  dir_writable,
-                                                  child, info,
-                                                  top_directory);
+              gimp_data_loader_factory_queue_data (factory, cache, jobs,
+                                                   dir_writable,
+                                                   child, info,
+                                                   top_directory);
             }
 
           g_object_unref (child);
@@ -415,30 +523,23 @@ gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
 }
 
 static void
-gimp_data_loader_factory_load_data (GimpDataFactory *factory,
-                                    GimpContext     *context,
-                                    GHashTable      *cache,
-                                    gboolean         dir_writable,
-                                    GFile           *file,
-                                    GFileInfo       *info,
-                                    GFile           *top_directory)
+gimp_data_loader_factory_queue_data (GimpDataFactory *factory,
+                                     GHashTable      *cache,
+                                     GPtrArray       *jobs,
+                                     gboolean         dir_writable,
+                                     GFile           *file,
+                                     GFileInfo       *info,
+                                     GFile           *top_directory)
 {
-  GimpDataLoader *loader;
-  GimpContainer  *container;
-  GimpContainer  *container_obsolete;
-  GList          *data_list = NULL;
-  GInputStream   *input;
-  guint64         mtime;
-  GError         *error = NULL;
+  GimpDataLoader  *loader;
+  GimpDataLoadJob *job;
+  guint64          mtime;
 
   loader = gimp_data_loader_factory_get_loader (factory, file);
 
   if (! loader)
     return;
 
-  container          = gimp_data_factory_get_container          (factory);
-  container_obsolete = gimp_data_factory_get_container_obsolete (factory);
-
   if (gimp_data_factory_get_gimp (factory)->be_verbose)
     g_print ("  Loading %s\n", gimp_file_get_utf8_name (file));
 
@@ -453,34 +554,116 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
           gimp_data_get_mtime (cached_data->data) != 0 &&
           gimp_data_get_mtime (cached_data->data) == mtime)
         {
-          GList *list;
+          /*  still queue a job, so the cached data is added in
+           *  directory order along with the parsed files
+           */
+          job = g_slice_new0 (GimpDataLoadJob);
+
+          job->loader        = loader;
+          job->file          = g_object_ref (file);
+          job->top_directory = g_object_ref (top_directory);
+          job->cached_data   = cached_data;
 
-          for (list = cached_data; list; list = g_list_next (list))
-            gimp_container_add (container, list->data);
+          g_ptr_array_add (jobs, job);
 
           return;
         }
     }
 
-  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  job = g_slice_new0 (GimpDataLoadJob);
+
+  job->loader        = loader;
+  job->file          = g_object_ref (file);
+  job->top_directory = g_object_ref (top_directory);
+  job->dir_writable  = dir_writable;
+  job->mtime         = mtime;
+
+  g_ptr_array_add (jobs, job);
+}
+
+static void
+gimp_data_loader_factory_run_jobs_func (gint              i,
+                                        gint              n,
+                                        GimpDataLoadJobs *load_jobs)
+{
+  gint index;
+
+  /*  files vary wildly in size, so let each thread grab the next
+   *  job instead of splitting the list up front
+   */
+  while ((index = g_atomic_int_add (&load_jobs->next_job, 1)) <
+         (gint) load_jobs->jobs->len)
+    {
+      gimp_data_loader_factory_run_job (load_jobs->context,
+                                        g_ptr_array_index (load_jobs->jobs,
+                                                           index));
+    }
+}
+
+static void
+gimp_data_loader_factory_run_jobs (GimpDataFactory *factory,
+                                   GimpContext     *context,
+                                   GPtrArray       *jobs)
+{
+  GimpDataLoaderFactoryPrivate *priv = GET_PRIVATE (factory);
+
+  if (priv->threaded && jobs->len > 1)
+    {
+      GimpDataLoadJobs load_jobs;
+
+      load_jobs.context  = context;
+      load_jobs.jobs     = jobs;
+      load_jobs.next_job = 0;
+
+      gegl_parallel_distribute (
+        jobs->len,
+        (GeglParallelDistributeFunc) gimp_data_loader_factory_run_jobs_func,
+        &load_jobs);
+    }
+  else
+    {
+      gint i;
+
+      for (i = 0; i < jobs->len; i++)
+        gimp_data_loader_factory_run_job (context, g_ptr_array_index (jobs, i));
+    }
+
+  GIMP_LOG (DATA_FACTORY, "'%s': queued %d files%s",
+            gimp_object_get_name (factory), jobs->len,
+            priv->threaded ? " in parallel" : "");
+}
+
+static void
+gimp_data_loader_factory_run_job (GimpContext     *context,
+                                  GimpDataLoadJob *job)
+{
+  GInputStream *input;
+
+  if (job->cached_data)
+    return;
+
+  g_private_set (&current_job, job);
+
+  input = G_INPUT_STREAM (g_file_read (job->file, NULL, &job->error));
 
   if (input)
     {
       GInputStream *buffered = g_buffered_input_stream_new (input);
 
-      data_list = loader->load_func (context, file, buffered, &error);
+      job->data_list = job->loader->load_func (context, job->file, buffered,
+                                               &job->error);
 
-      if (error)
+      if (job->error)
         {
-          g_prefix_error (&error,
+          g_prefix_error (&job->error,
                           _("Error loading '%s': "),
-                          gimp_file_get_utf8_name (file));
+                          gimp_file_get_utf8_name (job->file));
         }
-      else if (! data_list)
+      else if (! job->data_list)
         {
-          g_set_error (&error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+          g_set_error (&job->error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
                        _("Error loading '%s'"),
-                       gimp_file_get_utf8_name (file));
+                       gimp_file_get_utf8_name (job->file));
         }
 
       g_object_unref (buffered);
@@ -488,20 +671,43 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
     }
   else
     {
-      g_prefix_error (&error,
+      g_prefix_error (&job->error,
                       _("Could not open '%s' for reading: "),
-                      gimp_file_get_utf8_name (file));
+                      gimp_file_get_utf8_name (job->file));
     }
 
-  if (G_LIKELY (data_list))
+  g_private_set (&current_job, NULL);
+}
+
+static void
+gimp_data_loader_factory_add_data (GimpDataFactory *factory,
+                                   GimpDataLoadJob *job)
+{
+  GList *list;
+
+  if (job->cached_data)
     {
-      GList    *list;
-      gchar    *uri;
-      gboolean  obsolete;
-      gboolean  writable  = FALSE;
-      gboolean  deletable = FALSE;
+      GimpContainer *container = gimp_data_factory_get_container (factory);
+
+      for (list = job->cached_data; list; list = g_list_next (list))
+        gimp_container_add (container, list->data);
 
-      uri = g_file_get_uri (file);
+      return;
+    }
+
+  if (G_LIKELY (job->data_list))
+    {
+      GimpContainer *container;
+      GimpContainer *container_obsolete;
+      gchar         *uri;
+      gboolean       obsolete;
+      gboolean       writable  = FALSE;
+      gboolean       deletable = FALSE;
+
+      container          = gimp_data_factory_get_container          (factory);
+      container_obsolete = gimp_data_factory_get_container_obsolete (factory);
+
+      uri = g_file_get_uri (job->file);
 
       obsolete = (strstr (uri, GIMP_OBSOLETE_DATA_DIR_NAME) != 0);
 
@@ -510,16 +716,17 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
       /* obsolete files are immutable, don't check their writability */
       if (! obsolete)
         {
-          deletable = (g_list_length (data_list) == 1 && dir_writable);
-          writable  = (deletable && loader->writable);
+          deletable = (g_list_length (job->data_list) == 1 &&
+                       job->dir_writable);
+          writable  = (deletable && job->loader->writable);
         }
 
-      for (list = data_list; list; list = g_list_next (list))
+      for (list = job->data_list; list; list = g_list_next (list))
         {
           GimpData *data = list->data;
 
-          gimp_data_set_file (data, file, writable, deletable);
-          gimp_data_set_mtime (data, mtime);
+          gimp_data_set_file (data, job->file, writable, deletable);
+          gimp_data_set_mtime (data, job->mtime);
           gimp_data_clean (data);
 
           if (obsolete)
@@ -529,7 +736,7 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
             }
           else
             {
-              gimp_data_set_folder_tags (data, top_directory);
+              gimp_data_set_folder_tags (data, job->top_directory);
 
               gimp_container_add (container,
                                   GIMP_OBJECT (data));
@@ -538,22 +745,45 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
           g_object_unref (data);
         }
 
-      g_list_free (data_list);
+      g_clear_pointer (&job->data_list, g_list_free);
+    }
+
+  /*  the load function's messages, in the order it reported them  */
+  for (list = g_list_last (job->messages); list; list = g_list_previous (list))
+    {
+      gimp_message_literal (gimp_data_factory_get_gimp (factory), NULL,
+                            GIMP_MESSAGE_WARNING, list->data);
     }
 
+  g_list_free_full (job->messages, g_free);
+  job->messages = NULL;
+
   /*  not else { ... } because loader->load_func() can return a list
    *  of data objects *and* an error message if loading failed after
    *  something was already loaded
    */
-  if (G_UNLIKELY (error))
+  if (G_UNLIKELY (job->error))
     {
       gimp_message (gimp_data_factory_get_gimp (factory), NULL,
                     GIMP_MESSAGE_ERROR,
-                    _("Failed to load data:\n\n%s"), error->message);
-      g_clear_error (&error);
+                    _("Failed to load data:\n\n%s"), job->error->message);
+      g_clear_error (&job->error);
     }
 }
 
+static void
+gimp_data_load_job_free (GimpDataLoadJob *job)
+{
+  g_list_free_full (job->data_list, g_object_unref);
+  g_clear_error (&job->error);
+  g_list_free_full (job->messages, g_free);
+
+  g_object_unref (job->file);
+  g_object_unref (job->top_directory);
+
+  g_slice_free (GimpDataLoadJob, job);
+}
+
 static GimpDataLoader *
 gimp_data_loader_new (const gchar      *name,
                       GimpDataLoadFunc  load_func,
@@ -74,5 +74,11 @@ void              gimp_data_loader_factory_add_fallback (GimpDataFactory
                                                          const gchar             *name,
                                                          GimpDataLoadFunc         load_func);
 
+void              gimp_data_loader_factory_set_threaded (GimpDataFactory         *factory,
+                                                         gboolean                 threaded);
+
+void              gimp_data_loader_factory_message      (const gchar             *format,
+                                                         ...) G_GNUC_PRINTF (1, 2);
+
 
 #endif  /*  __GIMP_DATA_LOADER_FACTORY_H__  */
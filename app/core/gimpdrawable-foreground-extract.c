@@ -22,20 +22,115 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include "libgimpbase/gimpbase.h"
+#include "libgimpmath/gimpmath.h"
 
 #include "core-types.h"
 
 #include "gegl/gimp-gegl-utils.h"
 
+#include "gimp-parallel.h"
+#include "gimpasync.h"
 #include "gimpchannel.h"
 #include "gimpdrawable.h"
 #include "gimpdrawable-foreground-extract.h"
 #include "gimpimage.h"
 #include "gimpprogress.h"
+#include "gimpwaitable.h"
 
 #include "gimp-intl.h"
 
 
+/*  the unknown band of the trimap is solved in tiles of this size,
+ *  each with a margin of context around it
+ */
+#define TILE_SIZE          256
+#define TILE_MARGIN        32
+
+/*  drawables larger than this get a coarse matte, solved on a
+ *  downscaled copy of about COARSE_N_PIXELS pixels
+ */
+#define COARSE_MIN_PIXELS  (1024 * 1024)
+#define COARSE_N_PIXELS    (512 * 512)
+
+#define TRIMAP_BACKGROUND  0.25
+#define TRIMAP_FOREGROUND  0.75
+
+
+typedef enum
+{
+  CELL_BACKGROUND = 1 << 0,
+  CELL_FOREGROUND = 1 << 1,
+  CELL_UNKNOWN    = 1 << 2
+} CellFlags;
+
+
+typedef struct
+{
+  GeglBuffer        *buffer;
+  gint               off_x;
+  gint               off_y;
+  GeglBuffer        *trimap;
+  GimpMattingEngine  engine;
+  gint               global_iterations;
+  gint               levin_levels;
+  gint               levin_active_levels;
+} ExtractContext;
+
+/*  an area to solve, and the cells of it to keep  */
+typedef struct
+{
+  GeglRectangle  rect;
+  GArray        *cores;
+} RefineTile;
+
+typedef struct
+{
+  ExtractContext *context;
+  GimpAsync      *async;
+  GeglBuffer     *output;
+  GArray         *tiles;
+  gint            next_tile;
+  gint            n_done;
+} RefineData;
+
+
+/*  local function prototypes  */
+
+static void         gimp_drawable_foreground_extract_init        (ExtractContext      *context,
+                                                                  GimpDrawable        *drawable,
+                                                                  GimpMattingEngine    engine,
+                                                                  gint                 global_iterations,
+                                                                  gint                 levin_levels,
+                                                                  gint                 levin_active_levels,
+                                                                  GeglBuffer          *trimap);
+static void         gimp_drawable_foreground_extract_clear       (ExtractContext      *context);
+static void         gimp_drawable_foreground_extract_free        (ExtractContext      *context);
+
+static GeglBuffer * gimp_drawable_foreground_extract_solve       (ExtractContext      *context,
+                                                                  const GeglRectangle *rect,
+                                                                  gdouble              scale);
+static guchar     * gimp_drawable_foreground_extract_prepare     (GeglBuffer          *trimap,
+                                                                  GeglBuffer          *matte,
+                                                                  GeglBuffer          *output,
+                                                                  gint                *n_columns,
+                                                                  gint                *n_rows);
+static GArray     * gimp_drawable_foreground_extract_get_tiles   (const GeglRectangle *extent,
+                                                                  const guchar        *cells,
+                                                                  gint                 n_columns,
+                                                                  gint                 n_rows);
+static void         gimp_drawable_foreground_extract_tile_clear  (RefineTile          *tile);
+static void         gimp_drawable_foreground_extract_tiles_func  (gint                 i,
+                                                                  gint                 n,
+                                                                  RefineData          *data);
+static void         gimp_drawable_foreground_extract_tiles       (GimpAsync           *async,
+                                                                  RefineData          *data);
+static GeglBuffer * gimp_drawable_foreground_extract_refine      (ExtractContext      *context,
+                                                                  GimpAsync           *async,
+                                                                  GimpProgress        *progress);
+static void         gimp_drawable_foreground_extract_async_func  (GimpAsync           *async,
+                                                                  ExtractContext      *context);
+
+
 /*  public functions  */
 
 GeglBuffer *
@@ -47,16 +142,8 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
                                   GeglBuffer        *trimap,
                                   GimpProgress      *progress)
 {
-  GeglBuffer    *drawable_buffer;
-  GeglNode      *gegl;
-  GeglNode      *input_node;
-  GeglNode      *trimap_node;
-  GeglNode      *matting_node;
-  GeglNode      *output_node;
-  GeglBuffer    *buffer;
-  GeglProcessor *processor;
-  gdouble        value;
-  gint           off_x, off_y;
+  ExtractContext  context;
+  GeglBuffer     *buffer;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
   g_return_val_if_fail (GEGL_IS_BUFFER (trimap), NULL);
@@ -65,17 +152,186 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
   progress = gimp_progress_start (progress, FALSE,
                                   _("Computing alpha of unknown pixels"));
 
-  drawable_buffer = gimp_drawable_get_buffer (drawable);
+  gimp_drawable_foreground_extract_init (&context, drawable, engine,
+                                         global_iterations,
+                                         levin_levels, levin_active_levels,
+                                         trimap);
+
+  buffer = gimp_drawable_foreground_extract_refine (&context, NULL, progress);
+
+  gimp_drawable_foreground_extract_clear (&context);
+
+  if (progress)
+    gimp_progress_end (progress);
+
+  return buffer;
+}
+
+/**
+ * gimp_drawable_foreground_extract_coarse:
+ *
+ * Solves the matte on a downscaled copy of @drawable and @trimap, and
+ * scales it back up.  This takes a fraction of the time of
+ * gimp_drawable_foreground_extract(), and is meant to be shown while
+ * the full-resolution matte is being calculated.
+ *
+ * Returns: the coarse matte, in the coordinates of @trimap, or %NULL
+ *          if @drawable is small enough to be solved right away.
+ **/
+GeglBuffer *
+gimp_drawable_foreground_extract_coarse (GimpDrawable      *drawable,
+                                         GimpMattingEngine  engine,
+                                         gint               global_iterations,
+                                         gint               levin_levels,
+                                         gint               levin_active_levels,
+                                         GeglBuffer        *trimap)
+{
+  ExtractContext  context;
+  GeglBuffer     *matte;
+  GeglBuffer     *buffer;
+  guchar         *cells;
+  gint            n_columns;
+  gint            n_rows;
+  gint64          n_pixels;
+  gdouble         scale;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (trimap), NULL);
+
+  n_pixels = (gint64) gimp_item_get_width  (GIMP_ITEM (drawable)) *
+             (gint64) gimp_item_get_height (GIMP_ITEM (drawable));
+
+  if (n_pixels <= COARSE_MIN_PIXELS)
+    return NULL;
+
+  scale = sqrt ((gdouble) COARSE_N_PIXELS / (gdouble) n_pixels);
+
+  gimp_drawable_foreground_extract_init (&context, drawable, engine,
+                                         global_iterations,
+                                         levin_levels, levin_active_levels,
+                                         trimap);
+
+  matte = gimp_drawable_foreground_extract_solve (&context, NULL, scale);
+
+  buffer = gegl_buffer_new (gegl_buffer_get_extent (trimap),
+                            babl_format ("Y float"));
+
+  cells = gimp_drawable_foreground_extract_prepare (trimap, matte, buffer,
+                                                    &n_columns, &n_rows);
+  g_free (cells);
+
+  g_object_unref (matte);
+
+  gimp_drawable_foreground_extract_clear (&context);
+
+  return buffer;
+}
+
+/**
+ * gimp_drawable_foreground_extract_async:
+ *
+ * Same as gimp_drawable_foreground_extract(), but calculates the
+ * matte in the background.  The pixels of @drawable and @trimap are
+ * copied, so both may change while it runs.
+ *
+ * Returns: a #GimpAsync, whose result is the matte.
+ **/
+GimpAsync *
+gimp_drawable_foreground_extract_async (GimpDrawable      *drawable,
+                                        GimpMattingEngine  engine,
+                                        gint               global_iterations,
+                                        gint               levin_levels,
+                                        gint               levin_active_levels,
+                                        GeglBuffer        *trimap)
+{
+  ExtractContext *context;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (trimap), NULL);
+
+  context = g_slice_new0 (ExtractContext);
+
+  gimp_drawable_foreground_extract_init (context, drawable, engine,
+                                         global_iterations,
+                                         levin_levels, levin_active_levels,
+                                         trimap);
+
+  return gimp_parallel_run_async_full (
+    +1,
+    (GimpRunAsyncFunc) gimp_drawable_foreground_extract_async_func,
+    context,
+    (GDestroyNotify) gimp_drawable_foreground_extract_free);
+}
+
+
+/*  private functions  */
+
+static void
+gimp_drawable_foreground_extract_init (ExtractContext    *context,
+                                       GimpDrawable      *drawable,
+                                       GimpMattingEngine  engine,
+                                       gint               global_iterations,
+                                       gint               levin_levels,
+                                       gint               levin_active_levels,
+                                       GeglBuffer        *trimap)
+{
+  /*  work on copies, so that the drawable and the trimap may change
+   *  while the matte is being calculated
+   */
+  context->buffer = gimp_gegl_buffer_dup (gimp_drawable_get_buffer (drawable));
+  context->trimap = gimp_gegl_buffer_dup (trimap);
+
+  gimp_item_get_offset (GIMP_ITEM (drawable),
+                        &context->off_x, &context->off_y);
+
+  context->engine              = engine;
+  context->global_iterations   = global_iterations;
+  context->levin_levels        = levin_levels;
+  context->levin_active_levels = levin_active_levels;
+}
+
+static void
+gimp_drawable_foreground_extract_clear (ExtractContext *context)
+{
+  g_clear_object (&context->buffer);
+  g_clear_object (&context->trimap);
+}
+
+static void
+gimp_drawable_foreground_extract_free (ExtractContext *context)
+{
+  gimp_drawable_foreground_extract_clear (context);
+
+  g_slice_free (ExtractContext, context);
+}
+
+/*  solves the matte of 'rect', or of the whole drawable if 'rect' is
+ *  NULL, at 'scale'.  the result is in the coordinates of the trimap.
+ */
+static GeglBuffer *
+gimp_drawable_foreground_extract_solve (ExtractContext      *context,
+                                        const GeglRectangle *rect,
+                                        gdouble              scale)
+{
+  GeglNode   *gegl;
+  GeglNode   *input_node;
+  GeglNode   *trimap_node;
+  GeglNode   *matting_node;
+  GeglNode   *output_node;
+  GeglNode   *input;
+  GeglNode   *trimap;
+  GeglNode   *output;
+  GeglBuffer *buffer;
 
   gegl = gegl_node_new ();
 
   trimap_node = gegl_node_new_child (gegl,
                                      "operation", "gegl:buffer-source",
-                                     "buffer",    trimap,
+                                     "buffer",    context->trimap,
                                      NULL);
   input_node = gegl_node_new_child (gegl,
                                     "operation", "gegl:buffer-source",
-                                    "buffer",    drawable_buffer,
+                                    "buffer",    context->buffer,
                                     NULL);
   output_node = gegl_node_new_child (gegl,
                                      "operation", "gegl:buffer-sink",
@@ -83,65 +339,448 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
                                      "format",    NULL,
                                      NULL);
 
-  if (engine == GIMP_MATTING_ENGINE_GLOBAL)
+  if (context->engine == GIMP_MATTING_ENGINE_GLOBAL)
     {
       matting_node = gegl_node_new_child (gegl,
                                           "operation",  "gegl:matting-global",
-                                          "iterations", global_iterations,
+                                          "iterations", context->global_iterations,
                                           NULL);
     }
   else
     {
       matting_node = gegl_node_new_child (gegl,
                                           "operation",     "gegl:matting-levin",
-                                          "levels",        levin_levels,
-                                          "active_levels", levin_active_levels,
+                                          "levels",        context->levin_levels,
+                                          "active_levels", context->levin_active_levels,
                                           NULL);
     }
 
-  gimp_item_get_offset (GIMP_ITEM (drawable), &off_x, &off_y);
+  input  = input_node;
+  trimap = trimap_node;
+  output = matting_node;
 
-  if (off_x || off_y)
+  if (context->off_x || context->off_y)
     {
-      GeglNode *pre;
-      GeglNode *post;
-
-      pre = gegl_node_new_child (gegl,
-                                 "operation", "gegl:translate",
-                                 "x", -1.0 * off_x,
-                                 "y", -1.0 * off_y,
-                                 NULL);
-      post = gegl_node_new_child (gegl,
-                                  "operation", "gegl:translate",
-                                  "x", 1.0 * off_x,
-                                  "y", 1.0 * off_y,
-                                  NULL);
-
-      gegl_node_link (trimap_node, pre);
-      gegl_node_connect (pre,  "output", matting_node, "aux");
-      gegl_node_link_many (input_node, matting_node, post, output_node, NULL);
+      GeglNode *translate;
+
+      translate = gegl_node_new_child (gegl,
+                                       "operation", "gegl:translate",
+                                       "x", 1.0 * context->off_x,
+                                       "y", 1.0 * context->off_y,
+                                       NULL);
+
+      gegl_node_link (input, translate);
+      input = translate;
     }
-  else
+
+  if (rect)
     {
-      gegl_node_connect (input_node,   "output", matting_node, "input");
-      gegl_node_connect (trimap_node,  "output", matting_node, "aux");
-      gegl_node_connect (matting_node, "output", output_node,  "input");
-    }
+      GeglNode *input_crop;
+      GeglNode *trimap_crop;
+
+      input_crop = gegl_node_new_child (gegl,
+                                        "operation", "gegl:crop",
+                                        "x",         (gdouble) rect->x,
+                                        "y",         (gdouble) rect->y,
+                                        "width",     (gdouble) rect->width,
+                                        "height",    (gdouble) rect->height,
+                                        NULL);
+      trimap_crop = gegl_node_new_child (gegl,
+                                         "operation", "gegl:crop",
+                                         "x",         (gdouble) rect->x,
+                                         "y",         (gdouble) rect->y,
+                                         "width",     (gdouble) rect->width,
+                                         "height",    (gdouble) rect->height,
+                                         NULL);
 
-  processor = gegl_node_new_processor (output_node, NULL);
+      gegl_node_link (input,  input_crop);
+      gegl_node_link (trimap, trimap_crop);
 
-  while (gegl_processor_work (processor, &value))
+      input  = input_crop;
+      trimap = trimap_crop;
+    }
+
+  if (scale != 1.0)
     {
-      if (progress)
-        gimp_progress_set_value (progress, value);
+      GeglNode *input_scale;
+      GeglNode *trimap_scale;
+      GeglNode *output_scale;
+
+      input_scale = gegl_node_new_child (gegl,
+                                         "operation",    "gegl:scale-ratio",
+                                         "origin-x",     0.0,
+                                         "origin-y",     0.0,
+                                         "sampler",      GEGL_SAMPLER_LINEAR,
+                                         "abyss-policy", GEGL_ABYSS_CLAMP,
+                                         "x",            scale,
+                                         "y",            scale,
+                                         NULL);
+      /*  keep the trimap's three values apart  */
+      trimap_scale = gegl_node_new_child (gegl,
+                                          "operation",    "gegl:scale-ratio",
+                                          "origin-x",     0.0,
+                                          "origin-y",     0.0,
+                                          "sampler",      GEGL_SAMPLER_NEAREST,
+                                          "abyss-policy", GEGL_ABYSS_CLAMP,
+                                          "x",            scale,
+                                          "y",            scale,
+                                          NULL);
+      output_scale = gegl_node_new_child (gegl,
+                                          "operation",    "gegl:scale-ratio",
+                                          "origin-x",     0.0,
+                                          "origin-y",     0.0,
+                                          "sampler",      GEGL_SAMPLER_LINEAR,
+                                          "abyss-policy", GEGL_ABYSS_CLAMP,
+                                          "x",            1.0 / scale,
+                                          "y",            1.0 / scale,
+                                          NULL);
+
+      gegl_node_link (input,  input_scale);
+      gegl_node_link (trimap, trimap_scale);
+      gegl_node_link (output, output_scale);
+
+      input  = input_scale;
+      trimap = trimap_scale;
+      output = output_scale;
     }
 
-  if (progress)
-    gimp_progress_end (progress);
+  gegl_node_connect (input,  "output", matting_node, "input");
+  gegl_node_connect (trimap, "output", matting_node, "aux");
+  gegl_node_connect (output, "output", output_node,  "input");
 
-  g_object_unref (processor);
+  gegl_node_process (output_node);
 
   g_object_unref (gegl);
 
   return buffer;
 }
+
+/*  fills 'output' with the known pixels of 'trimap', and the unknown
+ *  ones with 'matte', if not NULL.  returns which kinds of pixels each
+ *  TILE_SIZE cell of the trimap contains, as CellFlags.
+ */
+static guchar *
+gimp_drawable_foreground_extract_prepare (GeglBuffer *trimap,
+                                          GeglBuffer *matte,
+                                          GeglBuffer *output,
+                                          gint       *n_columns,
+                                          gint       *n_rows)
+{
+  const GeglRectangle *extent = gegl_buffer_get_extent (trimap);
+  GeglBufferIterator  *iter;
+  guchar              *cells;
+
+  *n_columns = (extent->width  + TILE_SIZE - 1) / TILE_SIZE;
+  *n_rows    = (extent->height + TILE_SIZE - 1) / TILE_SIZE;
+
+  cells = g_new0 (guchar, *n_columns * *n_rows);
+
+  iter = gegl_buffer_iterator_new (trimap, extent, 0,
+                                   babl_format ("Y float"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 3);
+
+  gegl_buffer_iterator_add (iter, output, extent, 0,
+                            babl_format ("Y float"),
+                            GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+  if (matte)
+    {
+      gegl_buffer_iterator_add (iter, matte, extent, 0,
+                                babl_format ("Y float"),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_CLAMP);
+    }
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi     = &iter->items[0].roi;
+      const gfloat        *src     = iter->items[0].data;
+      gfloat              *dest    = iter->items[1].data;
+      const gfloat        *matte_p = matte ? iter->items[2].data : NULL;
+      gint                 x, y;
+
+      for (y = 0; y < roi->height; y++)
+        {
+          guchar *row = cells + ((roi->y + y - extent->y) / TILE_SIZE) *
+                                *n_columns;
+
+          for (x = 0; x < roi->width; x++)
+            {
+              guchar *cell = row + (roi->x + x - extent->x) / TILE_SIZE;
+
+              if (*src <= TRIMAP_BACKGROUND)
+                {
+                  *dest  = 0.0;
+                  *cell |= CELL_BACKGROUND;
+                }
+              else if (*src >= TRIMAP_FOREGROUND)
+                {
+                  *dest  = 1.0;
+                  *cell |= CELL_FOREGROUND;
+                }
+              else
+                {
+                  *dest  = matte_p ? *matte_p : 0.0;
+                  *cell |= CELL_UNKNOWN;
+                }
+
+              src++;
+              dest++;
+
+              if (matte_p)
+                matte_p++;
+            }
+        }
+    }
+
+  return cells;
+}
+
+/*  returns the cells which contain unknown pixels, each with the area
+ *  to solve it in.  the area is grown until it contains both known
+ *  background and foreground, which the matting needs to sample.
+ *  cells which grow to the same area are solved together, and when the
+ *  areas add up to more than the whole trimap, it is solved in one go.
+ */
+static GArray *
+gimp_drawable_foreground_extract_get_tiles (const GeglRectangle *extent,
+                                            const guchar        *cells,
+                                            gint                 n_columns,
+                                            gint                 n_rows)
+{
+  GArray *tiles;
+  gint64  area = 0;
+  gint    column;
+  gint    row;
+
+  tiles = g_array_new (FALSE, FALSE, sizeof (RefineTile));
+  g_array_set_clear_func (tiles,
+                          (GDestroyNotify) gimp_drawable_foreground_extract_tile_clear);
+
+  for (row = 0; row < n_rows; row++)
+    {
+      for (column = 0; column < n_columns; column++)
+        {
+          RefineTile    tile;
+          GeglRectangle core;
+          gint          x1, y1, x2, y2;
+          gint          radius;
+          gint          i;
+
+          if (! (cells[row * n_columns + column] & CELL_UNKNOWN))
+            continue;
+
+          for (radius = 0; ; radius++)
+            {
+              guchar flags = 0;
+              gint   x, y;
+
+              x1 = MAX (column - radius, 0);
+              y1 = MAX (row    - radius, 0);
+              x2 = MIN (column + radius, n_columns - 1);
+              y2 = MIN (row    + radius, n_rows    - 1);
+
+              for (y = y1; y <= y2; y++)
+                for (x = x1; x <= x2; x++)
+                  flags |= cells[y * n_columns + x];
+
+              if ((flags & CELL_BACKGROUND) && (flags & CELL_FOREGROUND))
+                break;
+
+              if (x1 == 0 && y1 == 0 &&
+                  x2 == n_columns - 1 && y2 == n_rows - 1)
+                break;
+            }
+
+          core.x      = extent->x + column * TILE_SIZE;
+          core.y      = extent->y + row    * TILE_SIZE;
+          core.width  = TILE_SIZE;
+          core.height = TILE_SIZE;
+
+          tile.rect.x      = extent->x + x1 * TILE_SIZE - TILE_MARGIN;
+          tile.rect.y      = extent->y + y1 * TILE_SIZE - TILE_MARGIN;
+          tile.rect.width  = (x2 - x1 + 1) * TILE_SIZE + 2 * TILE_MARGIN;
+          tile.rect.height = (y2 - y1 + 1) * TILE_SIZE + 2 * TILE_MARGIN;
+
+          gegl_rectangle_intersect (&core,      &core,      extent);
+          gegl_rectangle_intersect (&tile.rect, &tile.rect, extent);
+
+          /*  a cell in the middle of a large unknown area grows to the
+           *  same area as its neighbors, solve them all at once
+           */
+          for (i = 0; i < tiles->len; i++)
+            {
+              RefineTile *other = &g_array_index (tiles, RefineTile, i);
+
+              if (gegl_rectangle_equal (&other->rect, &tile.rect))
+                {
+                  g_array_append_val (other->cores, core);
+                  break;
+                }
+            }
+
+          if (i < tiles->len)
+            continue;
+
+          area += (gint64) tile.rect.width * (gint64) tile.rect.height;
+
+          if (area >= (gint64) extent->width * (gint64) extent->height)
+            {
+              /*  the overlapping areas would cost more than solving
+               *  the whole trimap, solve it in one go
+               */
+              g_array_set_size (tiles, 0);
+
+              tile.rect  = *extent;
+              tile.cores = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+              g_array_append_val (tile.cores, *extent);
+
+              g_array_append_val (tiles, tile);
+
+              return tiles;
+            }
+
+          tile.cores = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+          g_array_append_val (tile.cores, core);
+
+          g_array_append_val (tiles, tile);
+        }
+    }
+
+  return tiles;
+}
+
+static void
+gimp_drawable_foreground_extract_tile_clear (RefineTile *tile)
+{
+  g_array_free (tile->cores, TRUE);
+}
+
+static void
+gimp_drawable_foreground_extract_tiles_func (gint        i,
+                                             gint        n,
+                                             RefineData *data)
+{
+  gint index;
+
+  /*  the time it takes to solve a tile depends on how much of it is
+   *  unknown, so let each thread grab the next tile
+   */
+  while ((index = g_atomic_int_add (&data->next_tile, 1)) <
+         (gint) data->tiles->len)
+    {
+      RefineTile *tile = &g_array_index (data->tiles, RefineTile, index);
+      GeglBuffer *matte;
+      gint        j;
+
+      if (data->async && gimp_async_is_canceled (data->async))
+        break;
+
+      matte = gimp_drawable_foreground_extract_solve (data->context,
+                                                      &tile->rect, 1.0);
+
+      for (j = 0; j < tile->cores->len; j++)
+        {
+          const GeglRectangle *core = &g_array_index (tile->cores,
+                                                      GeglRectangle, j);
+
+          gimp_gegl_buffer_copy (matte, core, GEGL_ABYSS_NONE,
+                                 data->output, core);
+        }
+
+      g_object_unref (matte);
+
+      g_atomic_int_inc (&data->n_done);
+    }
+}
+
+static void
+gimp_drawable_foreground_extract_tiles (GimpAsync  *async,
+                                        RefineData *data)
+{
+  gegl_parallel_distribute (
+    data->tiles->len,
+    (GeglParallelDistributeFunc) gimp_drawable_foreground_extract_tiles_func,
+    data);
+
+  gimp_async_finish (async, NULL);
+}
+
+/*  solves the unknown band of the trimap at full resolution, one tile
+ *  of it at a time, on all cores
+ */
+static GeglBuffer *
+gimp_drawable_foreground_extract_refine (ExtractContext *context,
+                                         GimpAsync      *async,
+                                         GimpProgress   *progress)
+{
+  const GeglRectangle *extent = gegl_buffer_get_extent (context->trimap);
+  RefineData           data;
+  guchar              *cells;
+  gint                 n_columns;
+  gint                 n_rows;
+
+  data.context   = context;
+  data.async     = async;
+  data.output    = gegl_buffer_new (extent, babl_format ("Y float"));
+  data.next_tile = 0;
+  data.n_done    = 0;
+
+  cells = gimp_drawable_foreground_extract_prepare (context->trimap, NULL,
+                                                    data.output,
+                                                    &n_columns, &n_rows);
+
+  data.tiles = gimp_drawable_foreground_extract_get_tiles (extent, cells,
+                                                           n_columns, n_rows);
+
+  g_free (cells);
+
+  if (progress && data.tiles->len > 1)
+    {
+      GimpAsync *tiles_async;
+
+      tiles_async = gimp_parallel_run_async_independent (
+        (GimpRunAsyncFunc) gimp_drawable_foreground_extract_tiles,
+        &data);
+
+      while (! gimp_waitable_wait_for (GIMP_WAITABLE (tiles_async),
+                                       0.1 * G_TIME_SPAN_SECOND))
+        {
+          gimp_progress_set_value (progress,
+                                   (gdouble) g_atomic_int_get (&data.n_done) /
+                                   (gdouble) data.tiles->len);
+        }
+
+      g_object_unref (tiles_async);
+    }
+  else if (data.tiles->len > 0)
+    {
+      gegl_parallel_distribute (
+        data.tiles->len,
+        (GeglParallelDistributeFunc) gimp_drawable_foreground_extract_tiles_func,
+        &data);
+    }
+
+  g_array_free (data.tiles, TRUE);
+
+  return data.output;
+}
+
+static void
+gimp_drawable_foreground_extract_async_func (GimpAsync      *async,
+                                             ExtractContext *context)
+{
+  GeglBuffer *buffer;
+
+  buffer = gimp_drawable_foreground_extract_refine (context, async, NULL);
+
+  if (gimp_async_is_canceled (async))
+    {
+      g_object_unref (buffer);
+
+      gimp_async_abort (async);
+
+      return;
+    }
+
+  gimp_async_finish_full (async, buffer, g_object_unref);
+}
@@ -19,13 +19,25 @@
 #define  __GIMP_DRAWABLE_FOREGROUND_EXTRACT_H__
 
 
-GeglBuffer * gimp_drawable_foreground_extract (GimpDrawable       *drawable,
-                                               GimpMattingEngine   engine,
-                                               gint                global_iterations,
-                                               gint                levin_levels,
-                                               gint                levin_active_levels,
-                                               GeglBuffer         *trimap,
-                                               GimpProgress       *progress);
+GeglBuffer * gimp_drawable_foreground_extract        (GimpDrawable       *drawable,
+                                                      GimpMattingEngine   engine,
+                                                      gint                global_iterations,
+                                                      gint                levin_levels,
+                                                      gint                levin_active_levels,
+                                                      GeglBuffer         *trimap,
+                                                      GimpProgress       *progress);
+GeglBuffer * gimp_drawable_foreground_extract_coarse (GimpDrawable       *drawable,
+                                                      GimpMattingEngine   engine,
+                                                      gint                global_iterations,
+                                                      gint                levin_levels,
+                                                      gint                levin_active_levels,
+                                                      GeglBuffer         *trimap);
+GimpAsync  * gimp_drawable_foreground_extract_async  (GimpDrawable       *drawable,
+                                                      GimpMattingEngine   engine,
+                                                      gint                global_iterations,
+                                                      gint                levin_levels,
+                                                      gint                levin_active_levels,
+                                                      GeglBuffer         *trimap);
 
 
 #endif  /*  __GIMP_DRAWABLE_FOREGROUND_EXTRACT_H__  */
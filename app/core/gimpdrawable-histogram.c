@@ -39,20 +39,24 @@
 
 /*  local function prototypes  */
 
-static GimpAsync * gimp_drawable_calculate_histogram_internal (GimpDrawable  *drawable,
-                                                               GimpHistogram *histogram,
-                                                               gboolean       with_filters,
-                                                               gboolean       run_async);
+static GimpAsync * gimp_drawable_calculate_histogram_internal (GimpDrawable         *drawable,
+                                                               GimpHistogram        *histogram,
+                                                               gboolean              with_filters,
+                                                               gboolean              run_async,
+                                                               gboolean              update,
+                                                               const cairo_region_t *update_region);
 
 
 /*  private functions  */
 
 
 static GimpAsync *
-gimp_drawable_calculate_histogram_internal (GimpDrawable  *drawable,
-                                            GimpHistogram *histogram,
-                                            gboolean       with_filters,
-                                            gboolean       run_async)
+gimp_drawable_calculate_histogram_internal (GimpDrawable         *drawable,
+                                            GimpHistogram        *histogram,
+                                            gboolean              with_filters,
+                                            gboolean              run_async,
+                                            gboolean              update,
+                                            const cairo_region_t *update_region)
 {
   GimpAsync   *async = NULL;
   GimpImage   *image;
@@ -190,7 +194,18 @@ gimp_drawable_calculate_histogram_internal (GimpDrawable  *drawable,
         }
       else
         {
-          if (run_async)
+          if (run_async && update && ! projectable &&
+              buffer == gimp_drawable_get_buffer (drawable))
+            {
+              /*  the update region is in drawable coordinates, which
+               *  are the buffer's coordinates
+               */
+              async = gimp_histogram_update_async (
+                histogram, buffer,
+                GEGL_RECTANGLE (x, y, width, height),
+                update_region);
+            }
+          else if (run_async)
             {
               async = gimp_histogram_calculate_async (
                 histogram, buffer,
@@ -238,7 +253,7 @@ gimp_drawable_calculate_histogram (GimpDrawable  *drawable,
 
   gimp_drawable_calculate_histogram_internal (drawable,
                                               histogram, with_filters,
-                                              FALSE);
+                                              FALSE, FALSE, NULL);
 }
 
 GimpAsync *
@@ -252,5 +267,26 @@ gimp_drawable_calculate_histogram_async (GimpDrawable  *drawable,
 
   return gimp_drawable_calculate_histogram_internal (drawable,
                                                      histogram, with_filters,
-                                                     TRUE);
+                                                     TRUE, FALSE, NULL);
+}
+
+/*  Like gimp_drawable_calculate_histogram_async(), but for keeping a
+ *  histogram up to date: when nothing but the pixels in @update_region
+ *  changed since the last update, only those are scanned again.  Pass
+ *  %NULL to scan everything.
+ */
+GimpAsync *
+gimp_drawable_update_histogram_async (GimpDrawable         *drawable,
+                                      GimpHistogram        *histogram,
+                                      gboolean              with_filters,
+                                      const cairo_region_t *update_region)
+{
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (gimp_item_is_attached (GIMP_ITEM (drawable)), NULL);
+  g_return_val_if_fail (histogram != NULL, NULL);
+
+  return gimp_drawable_calculate_histogram_internal (drawable,
+                                                     histogram, with_filters,
+                                                     TRUE, TRUE,
+                                                     update_region);
 }
@@ -43,6 +43,8 @@ struct _GimpDrawablePrivate
   cairo_region_t   *paint_update_region;
 
   gboolean          push_resize_undo;
+
+  GeglBuffer       *converted_buffer; /* result of a pending convert_type */
 };
 
 #endif /* __GIMP_DRAWABLE_PRIVATE_H__ */
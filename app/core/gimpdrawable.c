@@ -379,6 +379,7 @@ gimp_drawable_finalize (GObject *object)
     gimp_drawable_end_paint (drawable);
 
   g_clear_object (&drawable->private->buffer);
+  g_clear_object (&drawable->private->converted_buffer);
   g_clear_object (&drawable->private->format_profile);
 
   gimp_drawable_free_shadow_buffer (drawable);
@@ -1418,10 +1419,58 @@ gimp_drawable_convert_type (GimpDrawable      *drawable,
         }
     }
 
+  /*  drop a pre-converted buffer the class didn't use  */
+  g_clear_object (&drawable->private->converted_buffer);
+
   if (progress)
     gimp_progress_set_value (progress, 1.0);
 }
 
+/*  Lets a caller convert the pixels of several drawables ahead of
+ *  gimp_drawable_convert_type(), for example concurrently.  The
+ *  convert_type() implementations pick up @buffer instead of converting
+ *  the drawable's own buffer, as long as it has the format and size
+ *  they would have produced.
+ */
+void
+gimp_drawable_set_converted_buffer (GimpDrawable *drawable,
+                                    GeglBuffer   *buffer)
+{
+  g_return_if_fail (GIMP_IS_DRAWABLE (drawable));
+  g_return_if_fail (buffer == NULL || GEGL_IS_BUFFER (buffer));
+
+  g_set_object (&drawable->private->converted_buffer, buffer);
+}
+
+GeglBuffer *
+gimp_drawable_take_converted_buffer (GimpDrawable *drawable,
+                                     const Babl   *format)
+{
+  GeglBuffer *buffer;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+
+  buffer = g_steal_pointer (&drawable->private->converted_buffer);
+
+  if (buffer &&
+      (gegl_buffer_get_format (buffer) != format ||
+       ! gegl_rectangle_equal (gegl_buffer_get_extent (buffer),
+                               GEGL_RECTANGLE (0, 0,
+                                               gimp_item_get_width  (GIMP_ITEM (drawable)),
+                                               gimp_item_get_height (GIMP_ITEM (drawable))))))
+    {
+      g_warning ("%s: converted buffer of '%s' doesn't match format '%s', "
+                 "converting again",
+                 G_STRFUNC, gimp_object_get_name (drawable),
+                 babl_format_get_encoding (format));
+
+      g_clear_object (&buffer);
+    }
+
+  return buffer;
+}
+
 void
 gimp_drawable_apply_buffer (GimpDrawable           *drawable,
                             GeglBuffer             *buffer,
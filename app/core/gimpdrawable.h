@@ -153,6 +153,11 @@ void            gimp_drawable_convert_type            (GimpDrawable       *drawa
                                                        gboolean            push_undo,
                                                        GimpProgress       *progress);
 
+void            gimp_drawable_set_converted_buffer    (GimpDrawable       *drawable,
+                                                       GeglBuffer         *buffer);
+GeglBuffer    * gimp_drawable_take_converted_buffer   (GimpDrawable       *drawable,
+                                                       const Babl         *format);
+
 void            gimp_drawable_apply_buffer            (GimpDrawable        *drawable,
                                                        GeglBuffer          *buffer,
                                                        const GeglRectangle *buffer_rect,
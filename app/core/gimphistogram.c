@@ -33,6 +33,7 @@
 
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-loops.h"
+#include "gegl/gimp-gegl-loops-sse2.h"
 
 #include "gimp-atomic.h"
 #include "gimp-parallel.h"
@@ -47,6 +48,13 @@
 #define PIXELS_PER_THREAD \
   (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
 
+/*  areas larger than this get an approximate histogram from a sample
+ *  of about APPROXIMATE_N_SAMPLES pixels first
+ */
+#define APPROXIMATE_MIN_PIXELS (4096 * 4096)
+#define APPROXIMATE_N_SAMPLES  (512 * 512)
+#define ROWS_PER_THREAD        8
+
 
 enum
 {
@@ -62,22 +70,52 @@ struct _GimpHistogramPrivate
   gint         n_channels;
   gint         n_bins;
   gdouble     *values;
+  gboolean     approximate;
   GimpAsync   *calculate_async;
+
+  /*  the pixels the values were calculated from, for updates  */
+  GeglBuffer    *source;
+  GeglRectangle  source_rect;
 };
 
+/*  an approximate histogram, calculated by the worker before the exact
+ *  one, and set from an idle
+ */
+typedef struct
+{
+  GimpHistogram  *histogram;
+  GimpAsync      *async;
+
+  gint            n_components;
+  gint            n_bins;
+  gdouble        *values;
+} SampleResult;
+
 typedef struct
 {
   /*  input  */
-  GimpHistogram *histogram;
-  GeglBuffer    *buffer;
-  GeglRectangle  buffer_rect;
-  GeglBuffer    *mask;
-  GeglRectangle  mask_rect;
+  GimpHistogram  *histogram;
+  GeglBuffer     *buffer;
+  GeglRectangle   buffer_rect;
+  GeglBuffer     *mask;
+  GeglRectangle   mask_rect;
+
+  /*  input of incremental updates  */
+  GeglBuffer     *prev_buffer;
+  gdouble        *prev_values;
+  cairo_region_t *update_region;
+  gboolean        keep_source;
+
+  /*  only calculate from a sample of buffer_rect  */
+  gboolean        sample;
+
+  /*  deliver an approximate histogram first  */
+  SampleResult   *approximate;
 
   /*  output  */
-  gint           n_components;
-  gint           n_bins;
-  gdouble       *values;
+  gint            n_components;
+  gint            n_bins;
+  gdouble        *values;
 } CalculateContext;
 
 typedef struct
@@ -85,10 +123,24 @@ typedef struct
   GimpAsync        *async;
   CalculateContext *context;
 
+  GeglBuffer       *buffer;
   const Babl       *format;
+  const Babl       *fish;
   GSList           *values_list;
+
+  /*  the sample grid  */
+  gint              step;
+  gint              n_sample_columns;
 } CalculateData;
 
+typedef struct
+{
+  gint             *bins;
+  gfloat           *derived;
+  gint             *derived_bins;
+  gint              max_length;
+} CalculateScratch;
+
 
 /*  local function prototypes  */
 
@@ -111,12 +163,40 @@ static gboolean   gimp_histogram_map_channel              (GimpHistogram
 static void       gimp_histogram_set_values               (GimpHistogram        *histogram,
                                                            gint                  n_components,
                                                            gint                  n_bins,
-                                                           gdouble              *values);
+                                                           gdouble              *values,
+                                                           gboolean              approximate);
 
+static SampleResult *
+                  gimp_histogram_prepare_approximate      (GimpHistogram        *histogram,
+                                                           CalculateContext     *context);
+static void       gimp_histogram_calculate_approximate    (GimpAsync            *async,
+                                                           CalculateContext     *context);
+static gboolean   gimp_histogram_approximate_idle         (SampleResult         *data);
+static void       gimp_histogram_approximate_free         (SampleResult         *data);
 static void       gimp_histogram_calculate_internal       (GimpAsync            *async,
                                                            CalculateContext     *context);
+static void       gimp_histogram_calculate_rect           (CalculateData        *data,
+                                                           GeglBuffer           *buffer,
+                                                           const GeglRectangle  *rect);
+static gdouble  * gimp_histogram_merge_values             (gdouble              *total_values,
+                                                           GSList               *values_list,
+                                                           gint                  n_values,
+                                                           gdouble               factor);
+static void       gimp_histogram_calculate_bins           (const gfloat         *src,
+                                                           gint                 *dest,
+                                                           gint                  count,
+                                                           gfloat                max_bin);
+static void       gimp_histogram_calculate_chunk          (CalculateData        *data,
+                                                           CalculateScratch     *scratch,
+                                                           gdouble              *values,
+                                                           const gfloat         *src,
+                                                           const gfloat         *mask_data,
+                                                           gint                  length);
 static void       gimp_histogram_calculate_area           (const GeglRectangle  *area,
                                                            CalculateData        *data);
+static void       gimp_histogram_calculate_sample_rows    (gint                  offset,
+                                                           gint                  size,
+                                                           CalculateData        *data);
 static void       gimp_histogram_calculate_async_callback (GimpAsync            *async,
                                                            CalculateContext     *context);
 
@@ -288,6 +368,8 @@ gimp_histogram_calculate (GimpHistogram       *histogram,
   if (histogram->priv->calculate_async)
     gimp_async_cancel_and_wait (histogram->priv->calculate_async);
 
+  g_clear_object (&histogram->priv->source);
+
   context.histogram   = histogram;
   context.buffer      = buffer;
   context.buffer_rect = *buffer_rect;
@@ -306,9 +388,26 @@ gimp_histogram_calculate (GimpHistogram       *histogram,
 
   gimp_histogram_set_values (histogram,
                              context.n_components, context.n_bins,
-                             context.values);
+                             context.values, FALSE);
 }
 
+/**
+ * gimp_histogram_calculate_async:
+ * @histogram:   a %GimpHistogram
+ * @buffer:      the buffer to calculate the histogram of
+ * @buffer_rect: the area of @buffer to consider
+ * @mask:        (nullable): a mask to weight the pixels with
+ * @mask_rect:   (nullable): the area of @mask matching @buffer_rect
+ *
+ * Calculates the histogram in the background.  For large areas, an
+ * approximate histogram, from a sample of the pixels spread evenly over
+ * @buffer_rect, is calculated first and set as soon as it's ready;
+ * gimp_histogram_is_approximate() returns %TRUE until the exact values
+ * replace it, when the returned #GimpAsync finishes.  Both emit
+ * "notify::values".
+ *
+ * Returns: the #GimpAsync of the exact calculation
+ **/
 GimpAsync *
 gimp_histogram_calculate_async (GimpHistogram       *histogram,
                                 GeglBuffer          *buffer,
@@ -317,6 +416,7 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
                                 const GeglRectangle *mask_rect)
 {
   CalculateContext *context;
+  SampleResult     *approximate;
   GeglRectangle     rect;
 
   g_return_val_if_fail (GIMP_IS_HISTOGRAM (histogram), NULL);
@@ -326,6 +426,8 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
   if (histogram->priv->calculate_async)
     gimp_async_cancel_and_wait (histogram->priv->calculate_async);
 
+  g_clear_object (&histogram->priv->source);
+
   gegl_rectangle_align_to_buffer (&rect, buffer_rect, buffer,
                                   GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
 
@@ -355,10 +457,15 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
                              context->mask, NULL);
     }
 
+  approximate = gimp_histogram_prepare_approximate (histogram, context);
+
   histogram->priv->calculate_async = gimp_parallel_run_async (
     (GimpRunAsyncFunc) gimp_histogram_calculate_internal,
     context);
 
+  if (approximate)
+    approximate->async = g_object_ref (histogram->priv->calculate_async);
+
   gimp_async_add_callback (
     histogram->priv->calculate_async,
     (GimpAsyncCallback) gimp_histogram_calculate_async_callback,
@@ -367,6 +474,89 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
   return histogram->priv->calculate_async;
 }
 
+/**
+ * gimp_histogram_update_async:
+ * @histogram:     a %GimpHistogram
+ * @buffer:        the buffer to calculate the histogram of
+ * @buffer_rect:   the area of @buffer to consider
+ * @update_region: (nullable): the part of @buffer_rect which changed
+ *                 since the last update, or %NULL
+ *
+ * Like gimp_histogram_calculate_async() without a mask, but keeps a
+ * copy of the pixels the values were calculated from.  When the last
+ * update of @histogram was for the same @buffer_rect, only the pixels
+ * in @update_region are scanned again: their old contribution is
+ * subtracted from the values and their new one added.
+ *
+ * Returns: the #GimpAsync of the calculation
+ **/
+GimpAsync *
+gimp_histogram_update_async (GimpHistogram        *histogram,
+                             GeglBuffer           *buffer,
+                             const GeglRectangle  *buffer_rect,
+                             const cairo_region_t *update_region)
+{
+  GimpHistogramPrivate *priv;
+  CalculateContext     *context;
+  SampleResult         *approximate = NULL;
+  GeglRectangle         rect;
+
+  g_return_val_if_fail (GIMP_IS_HISTOGRAM (histogram), NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (buffer_rect != NULL, NULL);
+
+  priv = histogram->priv;
+
+  if (priv->calculate_async)
+    gimp_async_cancel_and_wait (priv->calculate_async);
+
+  gegl_rectangle_align_to_buffer (&rect, buffer_rect, buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+
+  context = g_slice_new0 (CalculateContext);
+
+  context->histogram   = histogram;
+  context->buffer      = gegl_buffer_new (&rect,
+                                          gegl_buffer_get_format (buffer));
+  context->buffer_rect = *buffer_rect;
+  context->keep_source = TRUE;
+
+  gimp_gegl_buffer_copy (buffer, &rect, GEGL_ABYSS_NONE,
+                         context->buffer, NULL);
+
+  if (update_region && priv->source && priv->values &&
+      gegl_rectangle_equal (&priv->source_rect, buffer_rect) &&
+      gegl_buffer_get_format (priv->source) == gegl_buffer_get_format (buffer))
+    {
+      context->prev_buffer   = g_object_ref (priv->source);
+      context->prev_values   = g_memdup2 (priv->values,
+                                          sizeof (gdouble) *
+                                          priv->n_channels * priv->n_bins);
+      context->update_region = cairo_region_copy (update_region);
+
+      cairo_region_intersect_rectangle (context->update_region,
+                                        (const cairo_rectangle_int_t *) buffer_rect);
+    }
+  else
+    {
+      approximate = gimp_histogram_prepare_approximate (histogram, context);
+    }
+
+  priv->calculate_async = gimp_parallel_run_async (
+    (GimpRunAsyncFunc) gimp_histogram_calculate_internal,
+    context);
+
+  if (approximate)
+    approximate->async = g_object_ref (priv->calculate_async);
+
+  gimp_async_add_callback (
+    priv->calculate_async,
+    (GimpAsyncCallback) gimp_histogram_calculate_async_callback,
+    context);
+
+  return priv->calculate_async;
+}
+
 void
 gimp_histogram_clear_values (GimpHistogram *histogram,
                              gint           n_components)
@@ -376,7 +566,9 @@ gimp_histogram_clear_values (GimpHistogram *histogram,
   if (histogram->priv->calculate_async)
     gimp_async_cancel_and_wait (histogram->priv->calculate_async);
 
-  gimp_histogram_set_values (histogram, n_components, 0, NULL);
+  g_clear_object (&histogram->priv->source);
+
+  gimp_histogram_set_values (histogram, n_components, 0, NULL, FALSE);
 }
 
 
@@ -485,6 +677,21 @@ gimp_histogram_n_bins (GimpHistogram *histogram)
   return histogram->priv->n_bins;
 }
 
+/**
+ * gimp_histogram_is_approximate:
+ * @histogram: a %GimpHistogram
+ *
+ * Returns: %TRUE if the values of @histogram were calculated from a
+ *          sample only, while the exact ones are still being calculated
+ **/
+gboolean
+gimp_histogram_is_approximate (GimpHistogram *histogram)
+{
+  g_return_val_if_fail (GIMP_IS_HISTOGRAM (histogram), FALSE);
+
+  return histogram->priv->approximate;
+}
+
 gboolean
 gimp_histogram_has_channel (GimpHistogram        *histogram,
                             GimpHistogramChannel  channel)
@@ -837,7 +1044,8 @@ static void
 gimp_histogram_set_values (GimpHistogram *histogram,
                            gint           n_components,
                            gint           n_bins,
-                           gdouble       *values)
+                           gdouble       *values,
+                           gboolean       approximate)
 {
   GimpHistogramPrivate *priv                = histogram->priv;
   gint                  n_channels          = n_components;
@@ -869,6 +1077,8 @@ gimp_histogram_set_values (GimpHistogram *histogram,
       priv->values = values;
     }
 
+  priv->approximate = approximate;
+
   if (notify_n_components)
     g_object_notify (G_OBJECT (histogram), "n-components");
 
@@ -878,6 +1088,94 @@ gimp_histogram_set_values (GimpHistogram *histogram,
   g_object_notify (G_OBJECT (histogram), "values");
 }
 
+static SampleResult *
+gimp_histogram_prepare_approximate (GimpHistogram    *histogram,
+                                    CalculateContext *context)
+{
+  SampleResult *data;
+
+  if ((gint64) context->buffer_rect.width *
+      (gint64) context->buffer_rect.height < APPROXIMATE_MIN_PIXELS)
+    return NULL;
+
+  data = g_slice_new0 (SampleResult);
+
+  data->histogram = histogram;
+  g_object_add_weak_pointer (G_OBJECT (histogram),
+                             (gpointer) &data->histogram);
+
+  context->approximate = data;
+
+  return data;
+}
+
+static void
+gimp_histogram_calculate_approximate (GimpAsync        *async,
+                                      CalculateContext *context)
+{
+  CalculateContext sample_context;
+
+  sample_context             = *context;
+  sample_context.sample      = TRUE;
+  sample_context.approximate = NULL;
+  sample_context.values      = NULL;
+
+  gimp_histogram_calculate_internal (NULL, &sample_context);
+
+  if (sample_context.values && ! gimp_async_is_canceled (async))
+    {
+      SampleResult *data = context->approximate;
+
+      data->n_components = sample_context.n_components;
+      data->n_bins       = sample_context.n_bins;
+      data->values       = sample_context.values;
+
+      /*  the idle owns it now  */
+      context->approximate = NULL;
+
+      g_idle_add_full (G_PRIORITY_DEFAULT,
+                       (GSourceFunc) gimp_histogram_approximate_idle,
+                       data, NULL);
+    }
+  else
+    {
+      g_free (sample_context.values);
+    }
+}
+
+static gboolean
+gimp_histogram_approximate_idle (SampleResult *data)
+{
+  /*  only if the exact histogram isn't done, or replaced, meanwhile  */
+  if (data->histogram                                        &&
+      data->histogram->priv->calculate_async == data->async &&
+      ! gimp_async_is_stopped (data->async))
+    {
+      gimp_histogram_set_values (data->histogram,
+                                 data->n_components, data->n_bins,
+                                 g_steal_pointer (&data->values), TRUE);
+    }
+
+  gimp_histogram_approximate_free (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gimp_histogram_approximate_free (SampleResult *data)
+{
+  if (data->histogram)
+    {
+      g_object_remove_weak_pointer (G_OBJECT (data->histogram),
+                                    (gpointer) &data->histogram);
+    }
+
+  g_clear_object (&data->async);
+  g_free (data->values);
+
+  g_slice_free (SampleResult, data);
+}
+
 static void
 gimp_histogram_calculate_internal (GimpAsync        *async,
                                    CalculateContext *context)
@@ -886,6 +1184,8 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
   GimpHistogramPrivate *priv;
   const Babl           *format;
   const Babl           *space;
+  GSList               *added_list = NULL;
+  gint                  n_values;
 
   priv = context->histogram->priv;
 
@@ -927,41 +1227,118 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
 
   data.async       = async;
   data.context     = context;
+  data.buffer      = context->buffer;
   data.format      = format;
+  data.fish        = babl_fish (format, babl_format ("Y float"));
   data.values_list = NULL;
 
-  gegl_parallel_distribute_area (
-    &context->buffer_rect, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
-    (GeglParallelDistributeAreaFunc) gimp_histogram_calculate_area,
-    &data);
+  n_values = (context->n_components + N_DERIVED_CHANNELS) * context->n_bins;
+
+  if (context->approximate)
+    gimp_histogram_calculate_approximate (async, context);
+
+  if (context->sample)
+    {
+      const GeglRectangle *rect = &context->buffer_rect;
+      gint64               n_pixels;
+      gint                 n_rows;
+
+      n_pixels = (gint64) rect->width * rect->height;
+
+      /*  a regular grid of cells, sampled at their centers, which keeps
+       *  the sample spread evenly over the whole area
+       */
+      data.step = MAX (1, (gint) ceil (sqrt ((gdouble) n_pixels /
+                                             APPROXIMATE_N_SAMPLES)));
+
+      n_rows                = (rect->height + data.step - 1) / data.step;
+      data.n_sample_columns = (rect->width  + data.step - 1) / data.step;
+
+      gegl_parallel_distribute_range (
+        n_rows, ROWS_PER_THREAD,
+        (GeglParallelDistributeRangeFunc) gimp_histogram_calculate_sample_rows,
+        &data);
+
+      /*  scale the counts up to the whole area  */
+      context->values = gimp_histogram_merge_values (
+        NULL, data.values_list, n_values, 1.0);
+
+      if (context->values)
+        {
+          gdouble factor = (gdouble) n_pixels /
+                           ((gdouble) n_rows * data.n_sample_columns);
+          gint    i;
+
+          for (i = 0; i < n_values; i++)
+            context->values[i] *= factor;
+        }
+
+      return;
+    }
+
+  if (context->prev_values)
+    {
+      gint n_rects = cairo_region_num_rectangles (context->update_region);
+      gint i;
+
+      /*  add the new pixels of the updated area...  */
+      for (i = 0; i < n_rects; i++)
+        {
+          GeglRectangle rect;
+
+          cairo_region_get_rectangle (context->update_region, i,
+                                      (cairo_rectangle_int_t *) &rect);
+
+          gimp_histogram_calculate_rect (&data, context->buffer, &rect);
+        }
+
+      added_list       = data.values_list;
+      data.values_list = NULL;
+
+      /*  ...and remove the ones they replace  */
+      for (i = 0; i < n_rects; i++)
+        {
+          GeglRectangle rect;
+
+          cairo_region_get_rectangle (context->update_region, i,
+                                      (cairo_rectangle_int_t *) &rect);
+
+          gimp_histogram_calculate_rect (&data, context->prev_buffer, &rect);
+        }
+    }
+  else
+    {
+      gimp_histogram_calculate_rect (&data, context->buffer,
+                                     &context->buffer_rect);
+    }
 
   if (! async || ! gimp_async_is_canceled (async))
     {
       gdouble *total_values = NULL;
-      gint     n_values     = (context->n_components + N_DERIVED_CHANNELS) *
-                              context->n_bins;
-      GSList  *iter;
 
-      for (iter = data.values_list; iter; iter = g_slist_next (iter))
+      if (context->prev_values)
         {
-          gdouble *values = iter->data;
+          gint i;
 
-          if (! total_values)
-            {
-              total_values = values;
-            }
-          else
-            {
-              gint i;
+          total_values = g_steal_pointer (&context->prev_values);
 
-              for (i = 0; i < n_values; i++)
-                total_values[i] += values[i];
+          total_values = gimp_histogram_merge_values (total_values,
+                                                      added_list,
+                                                      n_values, 1.0);
+          total_values = gimp_histogram_merge_values (total_values,
+                                                      data.values_list,
+                                                      n_values, -1.0);
 
-              g_free (values);
-            }
+          /*  don't let rounding errors leave negative counts behind  */
+          for (i = 0; i < n_values; i++)
+            total_values[i] = MAX (total_values[i], 0.0);
+        }
+      else
+        {
+          total_values = gimp_histogram_merge_values (NULL,
+                                                      data.values_list,
+                                                      n_values, 1.0);
         }
-
-      g_slist_free (data.values_list);
 
       context->values = total_values;
 
@@ -970,6 +1347,7 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
     }
   else
     {
+      g_slist_free_full (added_list, g_free);
       g_slist_free_full (data.values_list, g_free);
 
       if (async)
@@ -978,255 +1356,348 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
 }
 
 static void
-gimp_histogram_calculate_area (const GeglRectangle *area,
-                               CalculateData       *data)
+gimp_histogram_calculate_rect (CalculateData       *data,
+                               GeglBuffer          *buffer,
+                               const GeglRectangle *rect)
 {
-  GimpAsync            *async;
-  CalculateContext     *context;
-  GeglBufferIterator   *iter;
-  const Babl           *fish;
-  gdouble              *values;
-  gint                  n_components;
-  gint                  n_bins;
-  gfloat                n_bins_1f;
-  gfloat                temp;
-
-  async   = data->async;
-  context = data->context;
+  data->buffer = buffer;
 
-  n_bins       = context->n_bins;
-  n_components = context->n_components;
-
-  fish = babl_fish (data->format, babl_format ("Y float"));
-
-  values = g_new0 (gdouble, (n_components + N_DERIVED_CHANNELS) * n_bins);
-  gimp_atomic_slist_push_head (&data->values_list, values);
+  gegl_parallel_distribute_area (
+    rect, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_histogram_calculate_area,
+    data);
+}
 
-  iter = gegl_buffer_iterator_new (context->buffer, area, 0,
-                                   data->format,
-                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+static gdouble *
+gimp_histogram_merge_values (gdouble *total_values,
+                             GSList  *values_list,
+                             gint     n_values,
+                             gdouble  factor)
+{
+  GSList *iter;
 
-  if (context->mask)
+  for (iter = values_list; iter; iter = g_slist_next (iter))
     {
-      GeglRectangle mask_area = *area;
+      gdouble *values = iter->data;
 
-      mask_area.x += context->mask_rect.x - context->buffer_rect.x;
-      mask_area.y += context->mask_rect.y - context->buffer_rect.y;
+      if (! total_values)
+        {
+          total_values = values;
+        }
+      else
+        {
+          gint i;
 
-      gegl_buffer_iterator_add (iter, context->mask, &mask_area, 0,
-                                babl_format ("Y float"),
-                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+          for (i = 0; i < n_values; i++)
+            total_values[i] += factor * values[i];
+
+          g_free (values);
+        }
     }
 
-  n_bins_1f = n_bins - 1;
-
-#define VALUE(c,i) (*(temp = (i) * n_bins_1f,                                  \
-                      &values[(c) * n_bins +                                   \
-                              SIGNED_ROUND (SAFE_CLAMP (temp,                  \
-                                                        0.0f,                  \
-                                                        n_bins_1f))]))
-
-#define CHECK_CANCELED(length)                                                 \
-  G_STMT_START                                                                 \
-    {                                                                          \
-      if ((length) % 128 == 0 && async && gimp_async_is_canceled (async))      \
-        {                                                                      \
-          gegl_buffer_iterator_stop (iter);                                    \
-                                                                               \
-          return;                                                              \
-        }                                                                      \
-    }                                                                          \
-  G_STMT_END
+  g_slist_free (values_list);
 
-  while (gegl_buffer_iterator_next (iter))
+  return total_values;
+}
+
+static void
+gimp_histogram_calculate_bins (const gfloat *src,
+                               gint         *dest,
+                               gint          count,
+                               gfloat        max_bin)
+{
+#if COMPILE_SSE2_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2)
     {
-      const gfloat *data   = iter->items[0].data;
-      gint          length = iter->length;
-      gfloat        max;
-      gfloat        luminance;
+      gimp_gegl_histogram_bins_sse2 (src, dest, count, max_bin);
 
-      CHECK_CANCELED (0);
+      return;
+    }
+#endif
 
-      if (context->mask)
-        {
-          const gfloat *mask_data = iter->items[1].data;
+  while (count--)
+    {
+      gfloat temp = *src++ * max_bin;
 
-          switch (n_components)
-            {
-            case 1:
-              while (length--)
-                {
-                  const gdouble masked = *mask_data;
+      *dest++ = SIGNED_ROUND (SAFE_CLAMP (temp, 0.0f, max_bin));
+    }
+}
 
-                  VALUE (0, data[0]) += masked;
+static void
+gimp_histogram_calculate_chunk (CalculateData    *data,
+                                CalculateScratch *scratch,
+                                gdouble          *values,
+                                const gfloat     *src,
+                                const gfloat     *mask_data,
+                                gint              length)
+{
+  gint   n_components = data->context->n_components;
+  gint   n_bins       = data->context->n_bins;
+  gfloat n_bins_1f    = n_bins - 1;
+  gint  *bins;
+  gint  *derived_bins;
+  gint   i;
+
+  if (length > scratch->max_length)
+    {
+      scratch->max_length   = length;
+      scratch->bins         = g_renew (gint,   scratch->bins,
+                                       n_components * length);
+      scratch->derived      = g_renew (gfloat, scratch->derived,
+                                       2 * length);
+      scratch->derived_bins = g_renew (gint,   scratch->derived_bins,
+                                       2 * length);
+    }
 
-                  data += n_components;
-                  mask_data += 1;
+  bins         = scratch->bins;
+  derived_bins = scratch->derived_bins;
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+  /*  map all components of the chunk to their bins in one go,
+   *  and only then scatter them into the histogram
+   */
+  gimp_histogram_calculate_bins (src, bins, n_components * length,
+                                 n_bins_1f);
 
-            case 2:
-              while (length--)
-                {
-                  const gdouble masked = *mask_data;
-                  const gdouble weight = data[1];
+  if (n_components >= 3)
+    {
+      const gfloat *pixel   = src;
+      gfloat       *derived = scratch->derived;
 
-                  VALUE (0, data[0]) += weight * masked;
-                  VALUE (1, data[1]) += masked;
+      /*  the value and luminance channels  */
+      for (i = 0; i < length; i++)
+        {
+          derived[i] = MAX (MAX (pixel[0], pixel[1]), pixel[2]);
 
-                  data += n_components;
-                  mask_data += 1;
+          pixel += n_components;
+        }
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+      babl_process (data->fish, src, derived + length, length);
 
-            case 3: /* calculate separate value values */
-              while (length--)
-                {
-                  const gdouble masked = *mask_data;
+      gimp_histogram_calculate_bins (derived, derived_bins, 2 * length,
+                                     n_bins_1f);
+    }
 
-                  VALUE (1, data[0]) += masked;
-                  VALUE (2, data[1]) += masked;
-                  VALUE (3, data[2]) += masked;
+#define VALUE(c,b) (values[(c) * n_bins + (b)])
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += masked;
+  switch (n_components)
+    {
+    case 1:
+      for (i = 0; i < length; i++)
+        {
+          const gdouble masked = mask_data ? mask_data[i] : 1.0;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (4, luminance) += masked;
+          VALUE (0, bins[i]) += masked;
+        }
+      break;
 
-                  data += n_components;
-                  mask_data += 1;
+    case 2:
+      for (i = 0; i < length; i++)
+        {
+          const gdouble masked = mask_data ? mask_data[i] : 1.0;
+          const gdouble weight = src[2 * i + 1];
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+          VALUE (0, bins[2 * i + 0]) += weight * masked;
+          VALUE (1, bins[2 * i + 1]) += masked;
+        }
+      break;
 
-            case 4: /* calculate separate value values */
-              while (length--)
-                {
-                  const gdouble masked = *mask_data;
-                  const gdouble weight = data[3];
+    case 3: /* calculate separate value values */
+      for (i = 0; i < length; i++)
+        {
+          const gdouble masked = mask_data ? mask_data[i] : 1.0;
 
-                  VALUE (1, data[0]) += weight * masked;
-                  VALUE (2, data[1]) += weight * masked;
-                  VALUE (3, data[2]) += weight * masked;
-                  VALUE (4, data[3]) += masked;
+          VALUE (1, bins[3 * i + 0]) += masked;
+          VALUE (2, bins[3 * i + 1]) += masked;
+          VALUE (3, bins[3 * i + 2]) += masked;
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += weight * masked;
+          VALUE (0, derived_bins[i])          += masked;
+          VALUE (4, derived_bins[length + i]) += masked;
+        }
+      break;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (5, luminance) += weight * masked;
+    case 4: /* calculate separate value values */
+      for (i = 0; i < length; i++)
+        {
+          const gdouble masked = mask_data ? mask_data[i] : 1.0;
+          const gdouble weight = src[4 * i + 3];
 
-                  data += n_components;
-                  mask_data += 1;
+          VALUE (1, bins[4 * i + 0]) += weight * masked;
+          VALUE (2, bins[4 * i + 1]) += weight * masked;
+          VALUE (3, bins[4 * i + 2]) += weight * masked;
+          VALUE (4, bins[4 * i + 3]) += masked;
 
-                  CHECK_CANCELED (length);
-                }
-              break;
-            }
+          VALUE (0, derived_bins[i])          += weight * masked;
+          VALUE (5, derived_bins[length + i]) += weight * masked;
         }
-      else /* no mask */
-        {
-          switch (n_components)
-            {
-            case 1:
-              while (length--)
-                {
-                  VALUE (0, data[0]) += 1.0;
+      break;
+    }
 
-                  data += n_components;
+#undef VALUE
+}
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+static void
+gimp_histogram_calculate_area (const GeglRectangle *area,
+                               CalculateData       *data)
+{
+  GimpAsync          *async;
+  CalculateContext   *context;
+  GeglBufferIterator *iter;
+  CalculateScratch    scratch = { 0, };
+  gdouble            *values;
+
+  async   = data->async;
+  context = data->context;
+
+  /*  each area accumulates into its own histogram, they are only
+   *  merged once all areas are done
+   */
+  values = g_new0 (gdouble, (context->n_components + N_DERIVED_CHANNELS) *
+                            context->n_bins);
+  gimp_atomic_slist_push_head (&data->values_list, values);
+
+  iter = gegl_buffer_iterator_new (data->buffer, area, 0,
+                                   data->format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
 
-            case 2:
-              while (length--)
-                {
-                  const gdouble weight = data[1];
+  if (context->mask)
+    {
+      GeglRectangle mask_area = *area;
 
-                  VALUE (0, data[0]) += weight;
-                  VALUE (1, data[1]) += 1.0;
+      mask_area.x += context->mask_rect.x - context->buffer_rect.x;
+      mask_area.y += context->mask_rect.y - context->buffer_rect.y;
 
-                  data += n_components;
+      gegl_buffer_iterator_add (iter, context->mask, &mask_area, 0,
+                                babl_format ("Y float"),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+    }
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+  while (gegl_buffer_iterator_next (iter))
+    {
+      if (async && gimp_async_is_canceled (async))
+        {
+          gegl_buffer_iterator_stop (iter);
 
-            case 3: /* calculate separate value values */
-              while (length--)
-                {
-                  VALUE (1, data[0]) += 1.0;
-                  VALUE (2, data[1]) += 1.0;
-                  VALUE (3, data[2]) += 1.0;
+          break;
+        }
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += 1.0;
+      gimp_histogram_calculate_chunk (data, &scratch, values,
+                                      iter->items[0].data,
+                                      context->mask ?
+                                      iter->items[1].data : NULL,
+                                      iter->length);
+    }
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (4, luminance) += 1.0;
+  g_free (scratch.bins);
+  g_free (scratch.derived);
+  g_free (scratch.derived_bins);
+}
 
-                  data += n_components;
+static void
+gimp_histogram_calculate_sample_rows (gint           offset,
+                                      gint           size,
+                                      CalculateData *data)
+{
+  CalculateContext    *context = data->context;
+  const GeglRectangle *rect    = &context->buffer_rect;
+  CalculateScratch     scratch = { 0, };
+  gdouble             *values;
+  gfloat              *row;
+  gfloat              *mask_row = NULL;
+  gint                 n_components;
+  gint                 step;
+  gint                 n_columns;
+  gint                 i;
 
-                  CHECK_CANCELED (length);
-                }
-              break;
+  n_components = context->n_components;
+  step         = data->step;
+  n_columns    = data->n_sample_columns;
 
-            case 4: /* calculate separate value values */
-              while (length--)
-                {
-                  const gdouble weight = data[3];
+  values = g_new0 (gdouble, (n_components + N_DERIVED_CHANNELS) *
+                            context->n_bins);
+  gimp_atomic_slist_push_head (&data->values_list, values);
 
-                  VALUE (1, data[0]) += weight;
-                  VALUE (2, data[1]) += weight;
-                  VALUE (3, data[2]) += weight;
-                  VALUE (4, data[3]) += 1.0;
+  row = g_new (gfloat, rect->width * n_components);
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += weight;
+  if (context->mask)
+    mask_row = g_new (gfloat, rect->width);
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (5, luminance) += weight;
+  for (i = offset; i < offset + size; i++)
+    {
+      /*  one row at the center of each stratum, and one pixel at the
+       *  center of each cell of that row
+       */
+      gint y = rect->y + MIN (i * step + step / 2, rect->height - 1);
+      gint x;
+
+      gegl_buffer_get (data->buffer,
+                       GEGL_RECTANGLE (rect->x, y, rect->width, 1), 1.0,
+                       data->format, row,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (x = 0; x < n_columns; x++)
+        {
+          gint src_x = MIN (x * step + step / 2, rect->width - 1);
 
-                  data += n_components;
+          memmove (row + x * n_components,
+                   row + src_x * n_components,
+                   sizeof (gfloat) * n_components);
+        }
 
-                  CHECK_CANCELED (length);
-                }
-              break;
-            }
+      if (mask_row)
+        {
+          gegl_buffer_get (context->mask,
+                           GEGL_RECTANGLE (context->mask_rect.x,
+                                           context->mask_rect.y +
+                                           (y - rect->y),
+                                           rect->width, 1), 1.0,
+                           babl_format ("Y float"), mask_row,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          for (x = 0; x < n_columns; x++)
+            mask_row[x] = mask_row[MIN (x * step + step / 2, rect->width - 1)];
         }
+
+      gimp_histogram_calculate_chunk (data, &scratch, values,
+                                      row, mask_row, n_columns);
     }
 
-#undef VALUE
-#undef CHECK_CANCELED
+  g_free (row);
+  g_free (mask_row);
+
+  g_free (scratch.bins);
+  g_free (scratch.derived);
+  g_free (scratch.derived_bins);
 }
 
 static void
 gimp_histogram_calculate_async_callback (GimpAsync        *async,
                                          CalculateContext *context)
 {
-  context->histogram->priv->calculate_async = NULL;
+  GimpHistogramPrivate *priv = context->histogram->priv;
+
+  priv->calculate_async = NULL;
 
   if (gimp_async_is_finished (async))
     {
+      if (context->keep_source)
+        {
+          g_set_object (&priv->source, context->buffer);
+          priv->source_rect = context->buffer_rect;
+        }
+
       gimp_histogram_set_values (context->histogram,
                                  context->n_components, context->n_bins,
-                                 context->values);
+                                 context->values, FALSE);
     }
 
   g_object_unref (context->buffer);
   if (context->mask)
     g_object_unref (context->mask);
 
+  g_clear_object (&context->prev_buffer);
+  g_clear_pointer (&context->prev_values, g_free);
+  g_clear_pointer (&context->update_region, cairo_region_destroy);
+  g_clear_pointer (&context->approximate, gimp_histogram_approximate_free);
+
   g_slice_free (CalculateContext, context);
 }
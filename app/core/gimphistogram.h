@@ -64,6 +64,10 @@ GimpAsync     * gimp_histogram_calculate_async (GimpHistogram        *histogram,
                                                 const GeglRectangle  *buffer_rect,
                                                 GeglBuffer           *mask,
                                                 const GeglRectangle  *mask_rect);
+GimpAsync     * gimp_histogram_update_async    (GimpHistogram        *histogram,
+                                                GeglBuffer           *buffer,
+                                                const GeglRectangle  *buffer_rect,
+                                                const cairo_region_t *update_region);
 
 void            gimp_histogram_clear_values    (GimpHistogram        *histogram,
                                                 gint                  n_components);
@@ -100,6 +104,7 @@ gint            gimp_histogram_n_components    (GimpHistogram        *histogram)
 gint            gimp_histogram_n_bins          (GimpHistogram        *histogram);
 gboolean        gimp_histogram_has_channel     (GimpHistogram        *histogram,
                                                 GimpHistogramChannel  channel);
+gboolean        gimp_histogram_is_approximate  (GimpHistogram        *histogram);
 
 
 #endif /* __GIMP_HISTOGRAM_H__ */
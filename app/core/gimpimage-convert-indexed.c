@@ -157,6 +157,8 @@
 #include "gegl/gimp-gegl-utils.h"
 
 #include "gimp.h"
+#include "gimp-parallel.h"
+#include "gimpasync.h"
 #include "gimpcontainer.h"
 #include "gimpdrawable.h"
 #include "gimperror.h"
@@ -169,6 +171,7 @@
 #include "gimpobjectqueue.h"
 #include "gimppalette.h"
 #include "gimpprogress.h"
+#include "gimpwaitable.h"
 
 #include "text/gimptextlayer.h"
 
@@ -201,6 +204,20 @@
 #define G_SCALE 24              /*  scale G (a*) distances by this much  */
 #define B_SCALE 26              /*  and B (b*) by this much              */
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+#define CELLS_PER_THREAD      4096
+
+/* the number of locks the RGB histogram is striped over */
+#define HISTOGRAM_N_LOCKS     64
+#define REFINE_MAX_ITERATIONS 10
+
+/* how long to remember the colormap of the last conversion, and keep
+ * its inverse colormap, in ms
+ */
+#define INVERSE_CMAP_CACHE_TIMEOUT 10000
+
 
 typedef struct _Color Color;
 typedef struct _QuantizeObj QuantizeObj;
@@ -332,6 +349,23 @@ static const Babl *linear_to_rgb_float_fish = NULL;
 static const Babl *linear_to_gray_float_fish = NULL;
 static const Babl *lab_to_rgb_fish = NULL;
 
+static inline void
+lab_to_unshifted_lin (const gfloat *lab,
+                      gint         *hr,
+                      gint         *hg,
+                      gint         *hb)
+{
+  gint or, og, ob;
+
+  or = RINT(lab[0] * LRAT);
+  og = RINT((lab[1] - LOWA) * ARAT);
+  ob = RINT((lab[2] - LOWB) * BRAT);
+
+  *hr = CLAMP(or, 0, 255);
+  *hg = CLAMP(og, 0, 255);
+  *hb = CLAMP(ob, 0, 255);
+}
+
 static inline void
 rgb_to_unshifted_lin (const guchar  r,
                       const guchar  g,
@@ -340,7 +374,6 @@ rgb_to_unshifted_lin (const guchar  r,
                       gint         *hg,
                       gint         *hb)
 {
-  gint   or, og, ob;
   gfloat rgb[3] = { r / 255.0, g / 255.0, b / 255.0 };
   gfloat lab[3];
 
@@ -348,13 +381,7 @@ rgb_to_unshifted_lin (const guchar  r,
 
   /* fprintf(stderr, " %d-%d-%d -> %0.3f,%0.3f,%0.3f ", r, g, b, sL, sa, sb);*/
 
-  or = RINT(lab[0] * LRAT);
-  og = RINT((lab[1] - LOWA) * ARAT);
-  ob = RINT((lab[2] - LOWB) * BRAT);
-
-  *hr = CLAMP(or, 0, 255);
-  *hg = CLAMP(og, 0, 255);
-  *hb = CLAMP(ob, 0, 255);
+  lab_to_unshifted_lin (lab, hr, hg, hb);
 
   /*  fprintf(stderr, " %d:%d:%d ", *hr, *hg, *hb); */
 }
@@ -484,6 +511,78 @@ HIST_RGB (ColorFreq  *hist_ptr,
 }
 
 
+/* Scratch space for converting runs of pixels to histogram space
+ * with a single babl conversion, see rgb_to_lin_n().
+ */
+typedef struct
+{
+  gfloat *rgb;
+  gfloat *lab;
+  gint   *lin;
+  gint    size;
+} LinBuffer;
+
+static inline void
+lin_buffer_ensure (LinBuffer *buf,
+                   gint       n)
+{
+  if (n > buf->size)
+    {
+      buf->size = n;
+      buf->rgb  = g_renew (gfloat, buf->rgb, 3 * n);
+      buf->lab  = g_renew (gfloat, buf->lab, 3 * n);
+      buf->lin  = g_renew (gint,   buf->lin, 3 * n);
+    }
+}
+
+static inline void
+lin_buffer_clear (LinBuffer *buf)
+{
+  g_clear_pointer (&buf->rgb, g_free);
+  g_clear_pointer (&buf->lab, g_free);
+  g_clear_pointer (&buf->lin, g_free);
+
+  buf->size = 0;
+}
+
+static inline void
+lin_buffer_set_rgb (LinBuffer    *buf,
+                    gint          i,
+                    const guchar  r,
+                    const guchar  g,
+                    const guchar  b)
+{
+  buf->rgb[3 * i + 0] = r / 255.0;
+  buf->rgb[3 * i + 1] = g / 255.0;
+  buf->rgb[3 * i + 2] = b / 255.0;
+}
+
+/* Convert the first n colors of buf->rgb to histogram coordinates,
+ * stored as triplets in buf->lin.  This gives the same results as
+ * calling rgb_to_lin() for each color, but is much cheaper for
+ * large runs of pixels.
+ */
+static inline void
+rgb_to_lin_n (LinBuffer *buf,
+              gint       n)
+{
+  gint i;
+
+  babl_process (rgb_to_lab_fish, buf->rgb, buf->lab, n);
+
+  for (i = 0; i < 3 * n; i += 3)
+    {
+      gint hr, hg, hb;
+
+      lab_to_unshifted_lin (buf->lab + i, &hr, &hg, &hb);
+
+      buf->lin[i + 0] = RSDF (hr);
+      buf->lin[i + 1] = GSDF (hg);
+      buf->lin[i + 2] = BSDF (hb);
+    }
+}
+
+
 static inline void
 lin_to_rgb (const gdouble  hr,
             const gdouble  hg,
@@ -540,9 +639,11 @@ struct _QuantizeObj
   Color         clin[256];                /* .. converted to linear space */
   guint64       index_used_count[256];    /* how many times an index was used  */
   CFHistogram   histogram;                /* holds the histogram               */
+  gint         *inverse_cmap;             /* nearest-color cache of pass 2     */
 
   gboolean      want_dither_alpha;
   gint          error_freedom;            /* 0=much bleed, 1=controlled bleed */
+  gboolean      refine_palette;           /* k-means refinement of the colormap */
 
   GimpProgress *progress;
 
@@ -607,6 +708,84 @@ static gboolean  had_white;
 static gboolean  had_black;
 
 
+/* The colormap of the last conversion, and its inverse colormap if the
+ * colormap was repeated, see inverse_cmap_cache_store().  Only valid
+ * while inverse_cmap_cache_timeout_id is set.
+ */
+static struct
+{
+  gint  *inverse_cmap;
+  guint  hash;
+  gint   n_colors;
+  Color  clab[256];
+} inverse_cmap_cache;
+
+static guint     inverse_cmap_cache_timeout_id = 0;
+
+
+/* a pass over all pixels of a buffer, run on the thread pool while the
+ * calling thread reports the number of pixels done as progress
+ */
+typedef struct
+{
+  const GeglRectangle            *area;
+  GeglParallelDistributeAreaFunc  func;
+  gpointer                        data;
+} ParallelPass;
+
+typedef struct
+{
+  CFHistogram       histogram;
+  GeglBuffer       *buffer;
+  const Babl       *format;
+  gint              bpp;
+  gboolean          has_alpha;
+  gboolean          dither_alpha;
+  gint              col_limit;
+  gint              offset_x;
+  gint              offset_y;
+  gsize             n_done;
+  GMutex            histogram_mutex[HISTOGRAM_N_LOCKS];
+  GMutex            mutex;
+} HistogramRGBData;
+
+typedef struct
+{
+  QuantizeObj      *quantobj;
+  GeglBuffer       *src_buffer;
+  GeglBuffer       *dest_buffer;
+  gint              src_bpp;
+  gint              dest_bpp;
+  gboolean          has_alpha;
+  gint              red_pix;
+  gint              green_pix;
+  gint              blue_pix;
+  gint              alpha_pix;
+  gint              offset_x;
+  gint              offset_y;
+  gsize             n_done;
+  GMutex            mutex;
+} Pass2RGBData;
+
+typedef struct
+{
+  ColorFreq weight;
+  guchar    lin[3];   /* histogram coordinates of the cell */
+  guchar    label;    /* colormap index of the nearest color */
+} RefineCell;
+
+typedef struct
+{
+  GArray    *cells;
+  gint       n_centers;
+  gdouble    centers[MAXNUMCOLORS][3];
+  gdouble   *center_dists;
+  ColorFreq  sums[MAXNUMCOLORS][4];
+  gint       n_changed;
+  GMutex     mutex;
+} RefineData;
+
+
 /**********************************************************/
 typedef struct
 {
@@ -809,11 +988,19 @@ color_quicksort (const void *c1,
     return 0;
 }
 
+static gint
+found_cols_compare (const void *c1,
+                    const void *c2)
+{
+  return memcmp (c1, c2, sizeof (found_cols[0]));
+}
+
 gboolean
 gimp_image_convert_indexed (GimpImage               *image,
                             GimpConvertPaletteType   palette_type,
                             gint                     max_colors,
                             gboolean                 remove_duplicates,
+                            gboolean                 refine_palette,
                             GimpConvertDitherType    dither_type,
                             gboolean                 dither_alpha,
                             gboolean                 dither_text_layers,
@@ -908,7 +1095,8 @@ gimp_image_convert_indexed (GimpImage               *image,
                                     palette_type, custom_palette,
                                     dither_alpha,
                                     sub_progress);
-  quantobj->space = space;
+  quantobj->space          = space;
+  quantobj->refine_palette = refine_palette;
 
   if (palette_type == GIMP_CONVERT_PALETTE_GENERATE)
     {
@@ -984,6 +1172,13 @@ gimp_image_convert_indexed (GimpImage               *image,
                                         sub_progress);
       /* We can skip the first pass (palette creation) */
 
+      /* The histogram is built in parallel, so the colors are found
+       * in no particular order; sort them to get a deterministic
+       * colormap.
+       */
+      qsort (found_cols, num_found_cols, sizeof (found_cols[0]),
+             found_cols_compare);
+
       quantobj->actual_number_of_colors = num_found_cols;
       for (i = 0; i < num_found_cols; i++)
         {
@@ -1236,223 +1431,314 @@ generate_histogram_gray (CFHistogram  histogram,
 }
 
 static void
-check_white_or_black (const guchar *data)
+parallel_pass_run (GimpAsync    *async,
+                   ParallelPass *pass)
 {
-  if (data[RED]   == 255 &&
-      data[GREEN] == 255 &&
-      data[BLUE]  == 255)
-    had_white = TRUE;
-  if (data[RED]  ==0 &&
-      data[GREEN]==0 &&
-      data[BLUE] ==0)
-    had_black = TRUE;
+  gegl_parallel_distribute_area (pass->area, PIXELS_PER_THREAD,
+                                 GEGL_SPLIT_STRATEGY_AUTO,
+                                 pass->func, pass->data);
+
+  gimp_async_finish (async, NULL);
 }
 
+/*  run func over area in parallel.  the area functions add the number of
+ *  pixels they processed to *n_done atomically, which is polled here to
+ *  report progress from the calling thread only
+ */
 static void
-generate_histogram_rgb (CFHistogram   histogram,
-                        GimpLayer    *layer,
-                        gint          col_limit,
-                        gboolean      dither_alpha,
-                        GimpProgress *progress)
+parallel_pass (const GeglRectangle            *area,
+               GeglParallelDistributeAreaFunc  func,
+               gpointer                        data,
+               gsize                          *n_done,
+               GimpProgress                   *progress)
 {
-  GeglBufferIterator *iter;
-  const Babl         *format;
-  GeglRectangle      *roi;
-  ColorFreq          *colfreq;
-  gint                nfc_iter;
-  gint                row, col, coledge;
-  gint                offsetx, offsety;
-  gint64              layer_size;
-  gint64              total_size = 0;
-  gint                count      = 0;
-  gint                bpp;
-  gboolean            has_alpha;
+  ParallelPass  pass;
+  GimpAsync    *async;
+  gdouble       n_pixels = (gdouble) area->width * area->height;
 
-  format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
+  *n_done = 0;
 
-  g_return_if_fail (format == babl_format_with_space ("R'G'B' u8", format) ||
-                    format == babl_format_with_space ("R'G'B'A u8", format));
+  if (! progress)
+    {
+      gegl_parallel_distribute_area (area, PIXELS_PER_THREAD,
+                                     GEGL_SPLIT_STRATEGY_AUTO,
+                                     func, data);
+      return;
+    }
 
-  bpp       = babl_format_get_bytes_per_pixel (format);
-  has_alpha = babl_format_has_alpha (format);
+  gimp_progress_set_value (progress, 0.0);
 
-  gimp_item_get_offset (GIMP_ITEM (layer), &offsetx, &offsety);
+  pass.area = area;
+  pass.func = func;
+  pass.data = data;
 
-  layer_size = (gimp_item_get_width  (GIMP_ITEM (layer)) *
-                gimp_item_get_height (GIMP_ITEM (layer)));
+  async = gimp_parallel_run_async_independent (
+    (GimpRunAsyncFunc) parallel_pass_run,
+    &pass);
 
-  /*  g_printerr ("col_limit = %d, nfc = %d\n", col_limit, num_found_cols); */
+  while (! gimp_waitable_wait_for (GIMP_WAITABLE (async),
+                                   0.1 * G_TIME_SPAN_SECOND))
+    {
+      gimp_progress_set_value (progress,
+                               (gsize) g_atomic_pointer_get (n_done) /
+                               MAX (n_pixels, 1.0));
+    }
 
-  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
-                                   NULL, 0, format,
-                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
-  roi = &iter->items[0].roi;
+  gimp_progress_set_value (progress, 1.0);
 
-  if (progress)
-    gimp_progress_set_value (progress, 0.0);
+  g_object_unref (async);
+}
 
-  while (gegl_buffer_iterator_next (iter))
+/*  add the first n cells of buf to the histogram.  the histogram is
+ *  striped over HISTOGRAM_N_LOCKS locks, and the cells are grouped by
+ *  stripe first, so that each lock is only taken once per chunk
+ */
+static void
+generate_histogram_rgb_add (HistogramRGBData *data,
+                            const LinBuffer  *buf,
+                            gint              n)
+{
+  guint32 *cells  = gegl_scratch_new (guint32, 2 * n);
+  guint32 *sorted = cells + n;
+  gint     offsets[HISTOGRAM_N_LOCKS + 1] = { 0, };
+  gint     next[HISTOGRAM_N_LOCKS];
+  gint     i;
+
+  for (i = 0; i < n; i++)
     {
-      const guchar *data   = iter->items[0].data;
-      gint          length = iter->length;
+      const gint *lin = buf->lin + 3 * i;
 
-      total_size += length;
+      cells[i] = REF_FUNC (lin[0], lin[1], lin[2]);
 
-      /* g_printerr (" [%d,%d - %d,%d]", srcPR.x, src_roi->y, offsetx, offsety); */
+      offsets[cells[i] % HISTOGRAM_N_LOCKS + 1]++;
+    }
 
-      if (needs_quantize)
-        {
-          if (dither_alpha)
-            {
-              /* if alpha-dithering,
-                 we need to be deterministic w.r.t. offsets */
+  for (i = 0; i < HISTOGRAM_N_LOCKS; i++)
+    {
+      offsets[i + 1] += offsets[i];
+      next[i]         = offsets[i];
+    }
 
-              col = roi->x + offsetx;
-              coledge = col + roi->width;
-              row = roi->y + offsety;
+  for (i = 0; i < n; i++)
+    sorted[next[cells[i] % HISTOGRAM_N_LOCKS]++] = cells[i];
 
-              while (length--)
-                {
-                  gboolean transparent = FALSE;
+  for (i = 0; i < HISTOGRAM_N_LOCKS; i++)
+    {
+      gint j;
 
-                  if (has_alpha &&
-                      data[ALPHA] <
-                      DM[col & DM_WIDTHMASK][row & DM_HEIGHTMASK])
-                    transparent = TRUE;
+      if (offsets[i] == offsets[i + 1])
+        continue;
 
-                  if (! transparent)
-                    {
-                      colfreq = HIST_RGB (histogram,
-                                          data[RED],
-                                          data[GREEN],
-                                          data[BLUE]);
-                      check_white_or_black (data);
-                      (*colfreq)++;
-                    }
+      g_mutex_lock (&data->histogram_mutex[i]);
 
-                  col++;
-                  if (col == coledge)
-                    {
-                      col = roi->x + offsetx;
-                      row++;
-                    }
+      for (j = offsets[i]; j < offsets[i + 1]; j++)
+        data->histogram[sorted[j]]++;
 
-                  data += bpp;
-                }
-            }
-          else
-            {
-              while (length--)
-                {
-                  if ((has_alpha && ((data[ALPHA] > 127)))
-                      || (!has_alpha))
-                    {
-                      colfreq = HIST_RGB (histogram,
-                                          data[RED],
-                                          data[GREEN],
-                                          data[BLUE]);
-                      check_white_or_black (data);
-                      (*colfreq)++;
-                    }
+      g_mutex_unlock (&data->histogram_mutex[i]);
+    }
 
-                  data += bpp;
-                }
-            }
-        }
-      else
+  gegl_scratch_free (cells);
+}
+
+static void
+generate_histogram_rgb_area (const GeglRectangle *area,
+                             HistogramRGBData    *data)
+{
+  GeglBufferIterator *iter;
+  GeglRectangle      *roi;
+  LinBuffer           buf       = { 0, };
+  guchar              cols[MAXNUMCOLORS][3];
+  gint                n_cols    = 0;
+  gboolean            overflow  = FALSE;
+  gboolean            white     = FALSE;
+  gboolean            black     = FALSE;
+  gint                i;
+
+  iter = gegl_buffer_iterator_new (data->buffer, area, 0, data->format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+  roi = &iter->items[0].roi;
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guchar *src       = iter->items[0].data;
+      gboolean      count_cols;
+      gint          n         = 0;
+      gint          row;
+
+      lin_buffer_ensure (&buf, iter->length);
+
+      /*  once the image is known to need quantization, there is no
+       *  point in collecting its colors anymore
+       */
+      count_cols = ! overflow && ! g_atomic_int_get (&needs_quantize);
+
+      for (row = 0; row < roi->height; row++)
         {
-          /* if alpha-dithering, we need to be deterministic w.r.t. offsets */
-          col = roi->x + offsetx;
-          coledge = col + roi->width;
-          row = roi->y + offsety;
+          gint col;
 
-          while (length--)
+          for (col = 0; col < roi->width; col++, src += data->bpp)
             {
-              gboolean transparent = FALSE;
-
-              if (has_alpha)
+              if (data->has_alpha)
                 {
-                  if (dither_alpha)
+                  /* if alpha-dithering, we need to be deterministic
+                   * w.r.t. offsets
+                   */
+                  if (data->dither_alpha)
                     {
-                      if (data[ALPHA] <
-                          DM[col & DM_WIDTHMASK][row & DM_HEIGHTMASK])
-                        transparent = TRUE;
+                      gint dither_x = (roi->x + col + data->offset_x) & DM_WIDTHMASK;
+                      gint dither_y = (roi->y + row + data->offset_y) & DM_HEIGHTMASK;
+
+                      if (src[ALPHA] < DM[dither_x][dither_y])
+                        continue;
                     }
-                  else
+                  else if (src[ALPHA] <= 127)
                     {
-                      if (data[ALPHA] <= 127)
-                        transparent = TRUE;
+                      continue;
                     }
                 }
 
-              if (! transparent)
-                {
-                  colfreq = HIST_RGB (histogram,
-                                      data[RED],
-                                      data[GREEN],
-                                      data[BLUE]);
-                  (*colfreq)++;
-
-                  if (!needs_quantize)
-                    {
-                      for (nfc_iter = 0;
-                           nfc_iter < num_found_cols;
-                           nfc_iter++)
-                        {
-                          if ((data[RED]   == found_cols[nfc_iter][0]) &&
-                              (data[GREEN] == found_cols[nfc_iter][1]) &&
-                              (data[BLUE]  == found_cols[nfc_iter][2]))
-                            goto already_found;
-                        }
+              lin_buffer_set_rgb (&buf, n++, src[RED], src[GREEN], src[BLUE]);
 
-                      /* Color was not in the table of
-                       * existing colors
-                       */
+              if (src[RED] == 255 && src[GREEN] == 255 && src[BLUE] == 255)
+                white = TRUE;
+              else if (src[RED] == 0 && src[GREEN] == 0 && src[BLUE] == 0)
+                black = TRUE;
 
-                      num_found_cols++;
+              if (count_cols)
+                {
+                  for (i = 0; i < n_cols; i++)
+                    {
+                      if (src[RED]   == cols[i][0] &&
+                          src[GREEN] == cols[i][1] &&
+                          src[BLUE]  == cols[i][2])
+                        break;
+                    }
 
-                      if (num_found_cols > col_limit)
+                  if (i == n_cols)
+                    {
+                      if (n_cols == data->col_limit)
                         {
-                          /* There are more colors in the image than
-                           *  were allowed.  We switch to plain
-                           *  histogram calculation with a view to
-                           *  quantizing at a later stage.
+                          /*  this area alone has more colors than were
+                           *  allowed
                            */
-                          needs_quantize = TRUE;
-                          /* g_print ("\nmax colors exceeded - needs quantize.\n");*/
-                          goto already_found;
+                          overflow   = TRUE;
+                          count_cols = FALSE;
                         }
                       else
                         {
-                          /* Remember the new color we just found.
-                           */
-                          found_cols[num_found_cols-1][0] = data[RED];
-                          found_cols[num_found_cols-1][1] = data[GREEN];
-                          found_cols[num_found_cols-1][2] = data[BLUE];
-
-                          check_white_or_black (data);
+                          cols[n_cols][0] = src[RED];
+                          cols[n_cols][1] = src[GREEN];
+                          cols[n_cols][2] = src[BLUE];
+                          n_cols++;
                         }
                     }
                 }
-            already_found:
+            }
+        }
 
-              col++;
-              if (col == coledge)
-                {
-                  col = roi->x + offsetx;
-                  row++;
-                }
+      g_atomic_pointer_add (&data->n_done, iter->length);
 
-              data += bpp;
+      if (n == 0)
+        continue;
+
+      rgb_to_lin_n (&buf, n);
+
+      generate_histogram_rgb_add (data, &buf, n);
+    }
+
+  lin_buffer_clear (&buf);
+
+  g_mutex_lock (&data->mutex);
+
+  had_white |= white;
+  had_black |= black;
+
+  if (overflow)
+    {
+      g_atomic_int_set (&needs_quantize, TRUE);
+    }
+  else if (! g_atomic_int_get (&needs_quantize))
+    {
+      /*  merge the colors found in this area into the table of
+       *  existing colors
+       */
+      for (i = 0; i < n_cols; i++)
+        {
+          gint j;
+
+          for (j = 0; j < num_found_cols; j++)
+            {
+              if (cols[i][0] == found_cols[j][0] &&
+                  cols[i][1] == found_cols[j][1] &&
+                  cols[i][2] == found_cols[j][2])
+                break;
             }
-        }
 
-      if (progress && (count % 16 == 0))
-        gimp_progress_set_value (progress,
-                                 (gdouble) total_size / (gdouble) layer_size);
+          if (j < num_found_cols)
+            continue;
+
+          if (num_found_cols == data->col_limit)
+            {
+              /* There are more colors in the image than were allowed.
+               *  We switch to plain histogram calculation with a view
+               *  to quantizing at a later stage.
+               */
+              g_atomic_int_set (&needs_quantize, TRUE);
+              break;
+            }
+
+          found_cols[num_found_cols][0] = cols[i][0];
+          found_cols[num_found_cols][1] = cols[i][1];
+          found_cols[num_found_cols][2] = cols[i][2];
+          num_found_cols++;
+        }
     }
 
-/*  g_print ("O: col_limit = %d, nfc = %d\n", col_limit, num_found_cols);*/
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+generate_histogram_rgb (CFHistogram   histogram,
+                        GimpLayer    *layer,
+                        gint          col_limit,
+                        gboolean      dither_alpha,
+                        GimpProgress *progress)
+{
+  HistogramRGBData  data;
+  GeglBuffer       *buffer;
+  const Babl       *format;
+  gint              i;
+
+  format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
+
+  g_return_if_fail (format == babl_format_with_space ("R'G'B' u8", format) ||
+                    format == babl_format_with_space ("R'G'B'A u8", format));
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  data.histogram    = histogram;
+  data.buffer       = buffer;
+  data.format       = format;
+  data.bpp          = babl_format_get_bytes_per_pixel (format);
+  data.has_alpha    = babl_format_has_alpha (format);
+  data.dither_alpha = dither_alpha;
+  data.col_limit    = MIN (col_limit, MAXNUMCOLORS);
+
+  gimp_item_get_offset (GIMP_ITEM (layer), &data.offset_x, &data.offset_y);
+
+  for (i = 0; i < HISTOGRAM_N_LOCKS; i++)
+    g_mutex_init (&data.histogram_mutex[i]);
+
+  g_mutex_init (&data.mutex);
+
+  parallel_pass (gegl_buffer_get_extent (buffer),
+                 (GeglParallelDistributeAreaFunc) generate_histogram_rgb_area,
+                 &data, &data.n_done, progress);
+
+  for (i = 0; i < HISTOGRAM_N_LOCKS; i++)
+    g_mutex_clear (&data.histogram_mutex[i]);
+
+  g_mutex_clear (&data.mutex);
 }
 
 
@@ -2407,8 +2693,9 @@ select_colors_rgb (QuantizeObj *quantobj,
  * These routines are concerned with the time-critical task of mapping input
  * colors to the nearest color in the selected colormap.
  *
- * We re-use the histogram space as an "inverse color map", essentially a
- * cache for the results of nearest-color searches.  All colors within a
+ * Once the colormap is known, we replace the histogram by an "inverse color
+ * map" of the same shape, essentially a cache for the results of
+ * nearest-color searches.  All colors within a
  * histogram cell will be mapped to the same colormap entry, namely the one
  * closest to the cell's center.  This may not be quite the closest entry to
  * the actual input color, but it's almost as good.  A zero in the cache
@@ -2416,7 +2703,9 @@ select_colors_rgb (QuantizeObj *quantobj,
  * is cleared to zeroes before starting the mapping pass.  When we find the
  * nearest color for a cell, its colormap index plus one is recorded in the
  * cache for future use.  The pass2 scanning routines call fill_inverse_cmap
- * when they need to use an unfilled entry in the cache.
+ * when they need to use an unfilled entry in the cache.  Since an entry
+ * only ever changes from zero to its final value, the RGB cache may be
+ * filled from several threads at once, see lookup_inverse_cmap_rgb().
  *
  * Our method of efficiently finding nearest colors is based on the "locally
  * sorted search" idea described by Heckbert and on the incremental distance
@@ -2788,7 +3077,6 @@ fill_inverse_cmap_gray (QuantizeObj *quantobj,
  */
 static void
 fill_inverse_cmap_rgb (QuantizeObj *quantobj,
-                       CFHistogram  histogram,
                        gint         R,
                        gint         G,
                        gint         B)
@@ -2835,12 +3123,37 @@ fill_inverse_cmap_rgb (QuantizeObj *quantobj,
         {
           for (iB = 0; iB < BOX_B_ELEMS; iB++)
             {
-              *HIST_LIN (histogram, R + iR, G + iG, B + iB) = (*cptr++) + 1;
+              g_atomic_int_set (&quantobj->inverse_cmap[REF_FUNC (R + iR,
+                                                                  G + iG,
+                                                                  B + iB)],
+                                (*cptr++) + 1);
             }
         }
     }
 }
 
+/* Return the colormap index for histogram cell R/G/B, filling its
+ * inverse-colormap entry first if we haven't seen it before.
+ */
+static inline gint
+lookup_inverse_cmap_rgb (QuantizeObj *quantobj,
+                         gint         R,
+                         gint         G,
+                         gint         B)
+{
+  gint *cachep = &quantobj->inverse_cmap[REF_FUNC (R, G, B)];
+  gint  value  = g_atomic_int_get (cachep);
+
+  if (value == 0)
+    {
+      fill_inverse_cmap_rgb (quantobj, R, G, B);
+
+      value = g_atomic_int_get (cachep);
+    }
+
+  return value - 1;
+}
+
 
 /*  This is pass 1  */
 
@@ -2909,19 +3222,214 @@ snap_to_black_and_white (QuantizeObj *quantobj)
 }
 
 static void
-median_cut_pass1_rgb (QuantizeObj *quantobj)
+refine_colors_rgb_range (gsize       offset,
+                         gsize       size,
+                         RefineData *data)
 {
-  select_colors_rgb (quantobj, quantobj->histogram);
-  snap_to_black_and_white (quantobj);
-}
+  ColorFreq sums[MAXNUMCOLORS][4] = { { 0, } };
+  gint      n_changed             = 0;
+  gsize     i;
+  gint      k;
 
+  for (i = offset; i < offset + size; i++)
+    {
+      RefineCell *cell = &g_array_index (data->cells, RefineCell, i);
+      gint        best = cell->label;
+      gdouble     best_dist;
 
-static void
-monopal_pass1 (QuantizeObj *quantobj)
-{
-  quantobj->actual_number_of_colors = 2;
+#define REFINE_DIST(c, k)                                               \
+      (R_SCALE * SQR ((c)->lin[0] - data->centers[k][0]) +              \
+       G_SCALE * SQR ((c)->lin[1] - data->centers[k][1]) +              \
+       B_SCALE * SQR ((c)->lin[2] - data->centers[k][2]))
 
-  quantobj->cmap[0].red   = 0;
+      best_dist = REFINE_DIST (cell, best);
+
+      for (k = 0; k < data->n_centers && best_dist > 0.0; k++)
+        {
+          gdouble dist;
+
+          /* by the triangle inequality, a center at least twice as
+           * far from the current best center as the cell itself can't
+           * be any closer to the cell.
+           */
+          if (data->center_dists[best * data->n_centers + k] >= 4.0 * best_dist)
+            continue;
+
+          dist = REFINE_DIST (cell, k);
+
+          if (dist < best_dist)
+            {
+              best      = k;
+              best_dist = dist;
+            }
+        }
+
+#undef REFINE_DIST
+
+      if (best != cell->label)
+        {
+          cell->label = best;
+          n_changed++;
+        }
+
+      sums[best][0] += cell->weight;
+      sums[best][1] += cell->weight * cell->lin[0];
+      sums[best][2] += cell->weight * cell->lin[1];
+      sums[best][3] += cell->weight * cell->lin[2];
+    }
+
+  g_mutex_lock (&data->mutex);
+
+  for (k = 0; k < data->n_centers; k++)
+    {
+      data->sums[k][0] += sums[k][0];
+      data->sums[k][1] += sums[k][1];
+      data->sums[k][2] += sums[k][2];
+      data->sums[k][3] += sums[k][3];
+    }
+
+  data->n_changed += n_changed;
+
+  g_mutex_unlock (&data->mutex);
+}
+
+/* Refine the median-cut colormap with a few rounds of k-means
+ * (Lloyd's algorithm) over the histogram: map every populated cell
+ * to its nearest color, then move each color to the pixel-weighted
+ * mean of its cells.  The sums are integral, so the result does not
+ * depend on how the work is split between threads.
+ */
+static void
+refine_colors_rgb (QuantizeObj *quantobj,
+                   CFHistogram  histogram)
+{
+  RefineData data;
+  gint       n_centers = quantobj->actual_number_of_colors;
+  gint       R, G, B;
+  gint       iteration;
+  gint       i, j;
+
+  if (n_centers < 2)
+    return;
+
+  data.cells = g_array_new (FALSE, FALSE, sizeof (RefineCell));
+
+  for (R = 0; R < HIST_R_ELEMS; R++)
+    for (G = 0; G < HIST_G_ELEMS; G++)
+      for (B = 0; B < HIST_B_ELEMS; B++)
+        {
+          ColorFreq freq = *HIST_LIN (histogram, R, G, B);
+
+          if (freq != 0)
+            {
+              RefineCell cell = { freq, { R, G, B }, 0 };
+
+              g_array_append_val (data.cells, cell);
+            }
+        }
+
+  if (data.cells->len <= (guint) n_centers)
+    {
+      /* every populated cell has a color of its own already */
+      g_array_unref (data.cells);
+
+      return;
+    }
+
+  data.n_centers    = n_centers;
+  data.center_dists = g_new (gdouble, n_centers * n_centers);
+
+  for (i = 0; i < n_centers; i++)
+    {
+      gint hr, hg, hb;
+
+      rgb_to_lin (quantobj->cmap[i].red,
+                  quantobj->cmap[i].green,
+                  quantobj->cmap[i].blue,
+                  &hr, &hg, &hb);
+
+      data.centers[i][0] = hr;
+      data.centers[i][1] = hg;
+      data.centers[i][2] = hb;
+    }
+
+  g_mutex_init (&data.mutex);
+
+  for (iteration = 0; iteration < REFINE_MAX_ITERATIONS; iteration++)
+    {
+      for (i = 0; i < n_centers; i++)
+        {
+          for (j = 0; j < n_centers; j++)
+            {
+              data.center_dists[i * n_centers + j] =
+                R_SCALE * SQR (data.centers[i][0] - data.centers[j][0]) +
+                G_SCALE * SQR (data.centers[i][1] - data.centers[j][1]) +
+                B_SCALE * SQR (data.centers[i][2] - data.centers[j][2]);
+            }
+        }
+
+      memset (data.sums, 0, sizeof (data.sums));
+      data.n_changed = 0;
+
+      gegl_parallel_distribute_range (
+        data.cells->len, CELLS_PER_THREAD,
+        (GeglParallelDistributeRangeFunc) refine_colors_rgb_range,
+        &data);
+
+      /* after the first round, stop as soon as the cells settle */
+      if (iteration > 0 && data.n_changed == 0)
+        break;
+
+      for (i = 0; i < n_centers; i++)
+        {
+          /* a color which lost all of its cells stays where it is */
+          if (data.sums[i][0] > 0)
+            {
+              data.centers[i][0] = (gdouble) data.sums[i][1] / data.sums[i][0];
+              data.centers[i][1] = (gdouble) data.sums[i][2] / data.sums[i][0];
+              data.centers[i][2] = (gdouble) data.sums[i][3] / data.sums[i][0];
+            }
+        }
+    }
+
+  g_mutex_clear (&data.mutex);
+
+  for (i = 0; i < n_centers; i++)
+    {
+      guchar red, green, blue;
+
+      lin_to_rgb (data.centers[i][0],
+                  data.centers[i][1],
+                  data.centers[i][2],
+                  &red, &green, &blue);
+
+      quantobj->cmap[i].red   = red;
+      quantobj->cmap[i].green = green;
+      quantobj->cmap[i].blue  = blue;
+    }
+
+  g_free (data.center_dists);
+  g_array_unref (data.cells);
+}
+
+static void
+median_cut_pass1_rgb (QuantizeObj *quantobj)
+{
+  select_colors_rgb (quantobj, quantobj->histogram);
+
+  if (quantobj->refine_palette)
+    refine_colors_rgb (quantobj, quantobj->histogram);
+
+  snap_to_black_and_white (quantobj);
+}
+
+
+static void
+monopal_pass1 (QuantizeObj *quantobj)
+{
+  quantobj->actual_number_of_colors = 2;
+
+  quantobj->cmap[0].red   = 0;
   quantobj->cmap[0].green = 0;
   quantobj->cmap[0].blue  = 0;
   quantobj->cmap[1].red   = 255;
@@ -3243,203 +3751,217 @@ median_cut_pass2_fixed_dither_gray (QuantizeObj *quantobj,
     }
 }
 
+/* Sort out the transparent pixels of a pass 2 chunk, mark them in
+ * the destination, and convert the colors of the others, in order,
+ * to histogram coordinates in buf->lin.
+ */
 static void
-median_cut_pass2_no_dither_rgb (QuantizeObj *quantobj,
-                                GimpLayer   *layer,
-                                GeglBuffer  *new_buffer)
+pass2_rgb_collect (Pass2RGBData        *data,
+                   const GeglRectangle *roi,
+                   const guchar        *src,
+                   guchar              *dest,
+                   LinBuffer           *buf)
 {
-  GeglBufferIterator *iter;
-  CFHistogram         histogram = quantobj->histogram;
-  ColorFreq          *cachep;
-  const Babl         *src_format;
-  const Babl         *dest_format;
-  GeglRectangle      *src_roi;
-  gint                src_bpp;
-  gint                dest_bpp;
-  gint                has_alpha;
-  gint                R, G, B;
-  gint                red_pix          = RED;
-  gint                green_pix        = GREEN;
-  gint                blue_pix         = BLUE;
-  gint                alpha_pix        = ALPHA;
-  gboolean            dither_alpha     = quantobj->want_dither_alpha;
-  gint                offsetx, offsety;
-  guint64            *index_used_count = quantobj->index_used_count;
-  gint64              total_size       = 0;
-  gint64              layer_size;
-  gint                count            = 0;
+  gint n = 0;
+  gint row;
 
-  gimp_item_get_offset (GIMP_ITEM (layer), &offsetx, &offsety);
+  lin_buffer_ensure (buf, roi->width * roi->height);
 
-  src_format  = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
-  dest_format = gegl_buffer_get_format (new_buffer);
+  for (row = 0; row < roi->height; row++)
+    {
+      gint col;
 
-  src_bpp  = babl_format_get_bytes_per_pixel (src_format);
-  dest_bpp = babl_format_get_bytes_per_pixel (dest_format);
+      for (col = 0; col < roi->width; col++)
+        {
+          if (data->has_alpha)
+            {
+              gboolean transparent = FALSE;
 
-  has_alpha = babl_format_has_alpha (src_format);
+              if (data->quantobj->want_dither_alpha)
+                {
+                  gint dither_x = (col + data->offset_x + roi->x) & DM_WIDTHMASK;
+                  gint dither_y = (row + data->offset_y + roi->y) & DM_HEIGHTMASK;
+
+                  if (src[data->alpha_pix] < DM[dither_x][dither_y])
+                    transparent = TRUE;
+                }
+              else
+                {
+                  if (src[data->alpha_pix] <= 127)
+                    transparent = TRUE;
+                }
+
+              dest[ALPHA_I] = transparent ? 0 : 255;
+
+              if (transparent)
+                goto next_pixel;
+            }
+
+          lin_buffer_set_rgb (buf, n++,
+                              src[data->red_pix],
+                              src[data->green_pix],
+                              src[data->blue_pix]);
+
+        next_pixel:
+
+          src  += data->src_bpp;
+          dest += data->dest_bpp;
+        }
+    }
+
+  rgb_to_lin_n (buf, n);
+}
+
+static void
+pass2_rgb_distribute (QuantizeObj                    *quantobj,
+                      GimpLayer                      *layer,
+                      GeglBuffer                     *new_buffer,
+                      GeglParallelDistributeAreaFunc  func)
+{
+  Pass2RGBData  data;
+  const Babl   *src_format;
+
+  src_format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
+
+  data.quantobj    = quantobj;
+  data.src_buffer  = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+  data.dest_buffer = new_buffer;
+  data.src_bpp     = babl_format_get_bytes_per_pixel (src_format);
+  data.dest_bpp    = babl_format_get_bytes_per_pixel (gegl_buffer_get_format (new_buffer));
+  data.has_alpha   = babl_format_has_alpha (src_format);
+  data.red_pix     = RED;
+  data.green_pix   = GREEN;
+  data.blue_pix    = BLUE;
+  data.alpha_pix   = ALPHA;
 
   /*  In the case of web/mono palettes, we actually force
    *   grayscale drawables through the rgb pass2 functions
    */
   if (gimp_drawable_is_gray (GIMP_DRAWABLE (layer)))
     {
-      red_pix = green_pix = blue_pix = GRAY;
-      alpha_pix = ALPHA_G;
+      data.red_pix = data.green_pix = data.blue_pix = GRAY;
+      data.alpha_pix = ALPHA_G;
     }
 
-  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
-                                   NULL, 0, NULL,
+  gimp_item_get_offset (GIMP_ITEM (layer), &data.offset_x, &data.offset_y);
+
+  g_mutex_init (&data.mutex);
+
+  parallel_pass (gegl_buffer_get_extent (data.src_buffer), func,
+                 &data, &data.n_done, quantobj->progress);
+
+  g_mutex_clear (&data.mutex);
+}
+
+static void
+pass2_rgb_merge_index_used_count (Pass2RGBData  *data,
+                                  const guint64 *index_used_count)
+{
+  gint i;
+
+  g_mutex_lock (&data->mutex);
+
+  for (i = 0; i < 256; i++)
+    data->quantobj->index_used_count[i] += index_used_count[i];
+
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+median_cut_pass2_no_dither_rgb_area (const GeglRectangle *area,
+                                     Pass2RGBData        *data)
+{
+  QuantizeObj        *quantobj              = data->quantobj;
+  GeglBufferIterator *iter;
+  GeglRectangle      *src_roi;
+  LinBuffer           buf                   = { 0, };
+  guint64             index_used_count[256] = { 0, };
+
+  iter = gegl_buffer_iterator_new (data->src_buffer,
+                                   area, 0, NULL,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
   src_roi = &iter->items[0].roi;
 
-  gegl_buffer_iterator_add (iter, new_buffer,
-                            NULL, 0, NULL,
+  gegl_buffer_iterator_add (iter, data->dest_buffer,
+                            area, 0, NULL,
                             GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
 
-  layer_size = (gimp_item_get_width  (GIMP_ITEM (layer)) *
-                gimp_item_get_height (GIMP_ITEM (layer)));
-
   while (gegl_buffer_iterator_next (iter))
     {
-      const guchar *src  = iter->items[0].data;
-      guchar       *dest = iter->items[1].data;
-      gint          row;
-
-      total_size += src_roi->height * src_roi->width;
+      guchar     *dest = iter->items[1].data;
+      const gint *lin;
+      gint        i;
 
-      for (row = 0; row < src_roi->height; row++)
-        {
-          gint col;
+      g_atomic_pointer_add (&data->n_done, iter->length);
 
-          for (col = 0; col < src_roi->width; col++)
-            {
-              if (has_alpha)
-                {
-                  gboolean transparent = FALSE;
+      pass2_rgb_collect (data, src_roi, iter->items[0].data, dest, &buf);
 
-                  if (dither_alpha)
-                    {
-                      gint dither_x = (col + offsetx + src_roi->x) & DM_WIDTHMASK;
-                      gint dither_y = (row + offsety + src_roi->y) & DM_HEIGHTMASK;
+      lin = buf.lin;
 
-                      if ((src[alpha_pix]) < DM[dither_x][dither_y])
-                        transparent = TRUE;
-                    }
-                  else
-                    {
-                      if (src[alpha_pix] <= 127)
-                        transparent = TRUE;
-                    }
-
-                  if (transparent)
-                    {
-                      dest[ALPHA_I] = 0;
-                      goto next_pixel;
-                    }
-                  else
-                    {
-                      dest[ALPHA_I] = 255;
-                    }
-                }
+      for (i = 0; i < iter->length; i++, dest += data->dest_bpp)
+        {
+          gint index;
 
-              /* get pixel value and index into the cache */
-              rgb_to_lin (src[red_pix], src[green_pix], src[blue_pix],
-                          &R, &G, &B);
+          if (data->has_alpha && ! dest[ALPHA_I])
+            continue;
 
-              cachep = HIST_LIN (histogram, R, G, B);
-              /* If we have not seen this color before, find nearest
-               * colormap entry and update the cache
-               */
-              if (*cachep == 0)
-                fill_inverse_cmap_rgb (quantobj, histogram, R, G, B);
+          index = lookup_inverse_cmap_rgb (quantobj, lin[0], lin[1], lin[2]);
+          lin += 3;
 
-              /* Now emit the colormap index for this cell, barfbarf */
-              index_used_count[dest[INDEXED] = *cachep - 1]++;
+          /* Now emit the colormap index for this cell, barfbarf */
+          index_used_count[dest[INDEXED] = index]++;
+        }
+    }
 
-            next_pixel:
+  lin_buffer_clear (&buf);
 
-              src  += src_bpp;
-              dest += dest_bpp;
-            }
-        }
+  pass2_rgb_merge_index_used_count (data, index_used_count);
+}
 
-      if (quantobj->progress && (count % 16 == 0))
-         gimp_progress_set_value (quantobj->progress,
-                                  (gdouble) total_size / (gdouble) layer_size);
-    }
+static void
+median_cut_pass2_no_dither_rgb (QuantizeObj *quantobj,
+                                GimpLayer   *layer,
+                                GeglBuffer  *new_buffer)
+{
+  pass2_rgb_distribute (quantobj, layer, new_buffer,
+                        (GeglParallelDistributeAreaFunc)
+                        median_cut_pass2_no_dither_rgb_area);
 }
 
 static void
-median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
-                                   GimpLayer   *layer,
-                                   GeglBuffer  *new_buffer)
+median_cut_pass2_fixed_dither_rgb_area (const GeglRectangle *area,
+                                        Pass2RGBData        *data)
 {
+  QuantizeObj        *quantobj              = data->quantobj;
   GeglBufferIterator *iter;
-  CFHistogram         histogram = quantobj->histogram;
-  ColorFreq          *cachep;
-  const Babl         *src_format;
-  const Babl         *dest_format;
   GeglRectangle      *src_roi;
-  gint                src_bpp;
-  gint                dest_bpp;
-  gint                has_alpha;
-  gint                pixval1 = 0;
-  gint                pixval2 = 0;
-  Color              *color1;
-  Color              *color2;
-  gint                R, G, B;
-  gint                err1;
-  gint                err2;
-  gint                red_pix          = RED;
-  gint                green_pix        = GREEN;
-  gint                blue_pix         = BLUE;
-  gint                alpha_pix        = ALPHA;
-  gboolean            dither_alpha     = quantobj->want_dither_alpha;
-  gint                offsetx, offsety;
-  guint64            *index_used_count = quantobj->index_used_count;
-  gint64              total_size       = 0;
-  gint64              layer_size;
-  gint                count            = 0;
-
-  gimp_item_get_offset (GIMP_ITEM (layer), &offsetx, &offsety);
-
-  src_format  = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
-  dest_format = gegl_buffer_get_format (new_buffer);
-
-  src_bpp  = babl_format_get_bytes_per_pixel (src_format);
-  dest_bpp = babl_format_get_bytes_per_pixel (dest_format);
-
-  has_alpha = babl_format_has_alpha (src_format);
-
-  /*  In the case of web/mono palettes, we actually force
-   *   grayscale drawables through the rgb pass2 functions
-   */
-  if (gimp_drawable_is_gray (GIMP_DRAWABLE (layer)))
-    {
-      red_pix = green_pix = blue_pix = GRAY;
-      alpha_pix = ALPHA_G;
-    }
-
-  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
-                                   NULL, 0, NULL,
+  LinBuffer           buf                   = { 0, };
+  guint64             index_used_count[256] = { 0, };
+  gint                red_pix               = data->red_pix;
+  gint                green_pix             = data->green_pix;
+  gint                blue_pix              = data->blue_pix;
+
+  iter = gegl_buffer_iterator_new (data->src_buffer,
+                                   area, 0, NULL,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
   src_roi = &iter->items[0].roi;
 
-  gegl_buffer_iterator_add (iter, new_buffer,
-                            NULL, 0, NULL,
+  gegl_buffer_iterator_add (iter, data->dest_buffer,
+                            area, 0, NULL,
                             GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
 
-  layer_size = (gimp_item_get_width  (GIMP_ITEM (layer)) *
-                gimp_item_get_height (GIMP_ITEM (layer)));
-
   while (gegl_buffer_iterator_next (iter))
     {
       const guchar *src  = iter->items[0].data;
       guchar       *dest = iter->items[1].data;
+      const gint   *lin;
       gint          row;
 
-      total_size += src_roi->height * src_roi->width;
+      g_atomic_pointer_add (&data->n_done, iter->length);
+
+      pass2_rgb_collect (data, src_roi, src, dest, &buf);
+
+      lin = buf.lin;
 
       for (row = 0; row < src_roi->height; row++)
         {
@@ -3448,45 +3970,22 @@ median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
           for (col = 0; col < src_roi->width; col++)
             {
               const int dmval =
-                DM[(col + offsetx + src_roi->x) & DM_WIDTHMASK]
-                [(row + offsety + src_roi->y) & DM_HEIGHTMASK];
-
-              if (has_alpha)
-                {
-                  gboolean transparent = FALSE;
-
-                  if (dither_alpha)
-                    {
-                      if (src[alpha_pix] < dmval)
-                        transparent = TRUE;
-                    }
-                  else
-                    {
-                      if (src[alpha_pix] <= 127)
-                        transparent = TRUE;
-                    }
-
-                  if (transparent)
-                    {
-                      dest[ALPHA_I] = 0;
-                      goto next_pixel;
-                    }
-                  else
-                    {
-                      dest[ALPHA_I] = 255;
-                    }
-                }
-
-              /* get pixel value and index into the cache */
-              rgb_to_lin (src[red_pix], src[green_pix], src[blue_pix],
-                          &R, &G, &B);
-
-              cachep = HIST_LIN (histogram, R, G, B);
-              /* If we have not seen this color before, find nearest
-               * colormap entry and update the cache
-               */
-              if (*cachep == 0)
-                fill_inverse_cmap_rgb (quantobj, histogram, R, G, B);
+                DM[(col + data->offset_x + src_roi->x) & DM_WIDTHMASK]
+                [(row + data->offset_y + src_roi->y) & DM_HEIGHTMASK];
+              gint      pixval1;
+              gint      pixval2 = 0;
+              Color    *color1;
+              Color    *color2;
+              gint      err1;
+              gint      err2;
+
+              if (data->has_alpha && ! dest[ALPHA_I])
+                goto next_pixel;
+
+              /* get the colormap index of the pixel's cell */
+              pixval1 = lookup_inverse_cmap_rgb (quantobj,
+                                                 lin[0], lin[1], lin[2]);
+              lin += 3;
 
               /* We now try to find a color which, when mixed in some
                * fashion with the closest match, yields something
@@ -3497,7 +3996,6 @@ median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
                * intended color to determine their relative
                * probabilities of being chosen.
                */
-              pixval1 = *cachep - 1;
               color1 = &quantobj->cmap[pixval1];
 
               if (quantobj->actual_number_of_colors > 2)
@@ -3508,6 +4006,7 @@ median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
                   gint       RV = src[red_pix]   + re;
                   gint       GV = src[green_pix] + ge;
                   gint       BV = src[blue_pix]  + be;
+                  gint       R, G, B;
 
                   do
                     {
@@ -3516,14 +4015,7 @@ median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
                                   (CLAMP0255(BV)),
                                   &R, &G, &B);
 
-                      cachep = HIST_LIN (histogram, R, G, B);
-                      /* If we have not seen this color before, find
-                       * nearest colormap entry and update the cache
-                       */
-                      if (*cachep == 0)
-                        fill_inverse_cmap_rgb (quantobj, histogram, R, G, B);
-
-                      pixval2 = *cachep - 1;
+                      pixval2 = lookup_inverse_cmap_rgb (quantobj, R, G, B);
                       RV += re;  GV += ge;  BV += be;
                     }
                   while ((pixval1 == pixval2) &&
@@ -3591,15 +4083,25 @@ median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
 
             next_pixel:
 
-              src  += src_bpp;
-              dest += dest_bpp;
+              src  += data->src_bpp;
+              dest += data->dest_bpp;
             }
         }
-
-      if (quantobj->progress && (count % 16 == 0))
-        gimp_progress_set_value (quantobj->progress,
-                                 (gdouble) total_size / (gdouble) layer_size);
     }
+
+  lin_buffer_clear (&buf);
+
+  pass2_rgb_merge_index_used_count (data, index_used_count);
+}
+
+static void
+median_cut_pass2_fixed_dither_rgb (QuantizeObj *quantobj,
+                                   GimpLayer   *layer,
+                                   GeglBuffer  *new_buffer)
+{
+  pass2_rgb_distribute (quantobj, layer, new_buffer,
+                        (GeglParallelDistributeAreaFunc)
+                        median_cut_pass2_fixed_dither_rgb_area);
 }
 
 static void
@@ -3979,12 +4481,108 @@ median_cut_pass2_fs_dither_gray (QuantizeObj *quantobj,
   g_free (dest_buf);
 }
 
+static guint
+inverse_cmap_hash (QuantizeObj *quantobj)
+{
+  const guchar *p   = (const guchar *) quantobj->clab;
+  gsize         len = quantobj->actual_number_of_colors * sizeof (Color);
+  guint         h   = 2166136261u;
+  gsize         i;
+
+  for (i = 0; i < len; i++)
+    h = (h ^ p[i]) * 16777619u;
+
+  return h;
+}
+
+static gboolean
+inverse_cmap_cache_expire (gpointer data)
+{
+  inverse_cmap_cache_timeout_id = 0;
+
+  g_clear_pointer (&inverse_cmap_cache.inverse_cmap, g_free);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Whether quantobj's colormap is the one of the last conversion.  Only
+ * the L*a*b* version of the colormap is looked at when filling the
+ * inverse colormap, so that is what we compare.
+ */
+static gboolean
+inverse_cmap_cache_matches (QuantizeObj *quantobj)
+{
+  return (inverse_cmap_cache_timeout_id                                  &&
+          inverse_cmap_cache.hash     == inverse_cmap_hash (quantobj)     &&
+          inverse_cmap_cache.n_colors == quantobj->actual_number_of_colors &&
+          ! memcmp (inverse_cmap_cache.clab, quantobj->clab,
+                    quantobj->actual_number_of_colors * sizeof (Color)));
+}
+
+/* Take the cached inverse colormap if it was built for the same
+ * colormap as quantobj's, or start a new one.
+ */
+static void
+inverse_cmap_cache_take (QuantizeObj *quantobj)
+{
+  if (inverse_cmap_cache.inverse_cmap &&
+      inverse_cmap_cache_matches (quantobj))
+    {
+      quantobj->inverse_cmap = g_steal_pointer (&inverse_cmap_cache.inverse_cmap);
+    }
+  else
+    {
+      quantobj->inverse_cmap = g_new0 (gint,
+                                       HIST_R_ELEMS *
+                                       HIST_G_ELEMS *
+                                       HIST_B_ELEMS);
+    }
+}
+
+/* Remember quantobj's colormap for a few seconds.  Its inverse
+ * colormap, which takes 64 MB, is only kept when the colormap is the
+ * same as the last conversion's: a single conversion never holds on
+ * to it, while a script converting a batch of images to the same
+ * custom or web palette fills it once from the second image on.
+ */
+static void
+inverse_cmap_cache_store (QuantizeObj *quantobj)
+{
+  gboolean repeated = inverse_cmap_cache_matches (quantobj);
+
+  if (inverse_cmap_cache_timeout_id)
+    {
+      g_source_remove (inverse_cmap_cache_timeout_id);
+      inverse_cmap_cache_timeout_id = 0;
+    }
+
+  g_clear_pointer (&inverse_cmap_cache.inverse_cmap, g_free);
+
+  if (repeated)
+    inverse_cmap_cache.inverse_cmap = g_steal_pointer (&quantobj->inverse_cmap);
+  else
+    g_clear_pointer (&quantobj->inverse_cmap, g_free);
+
+  inverse_cmap_cache.hash     = inverse_cmap_hash (quantobj);
+  inverse_cmap_cache.n_colors = quantobj->actual_number_of_colors;
+
+  memcpy (inverse_cmap_cache.clab, quantobj->clab,
+          quantobj->actual_number_of_colors * sizeof (Color));
+
+  inverse_cmap_cache_timeout_id =
+    g_timeout_add (INVERSE_CMAP_CACHE_TIMEOUT,
+                   inverse_cmap_cache_expire, NULL);
+}
+
 static void
 median_cut_pass2_rgb_init (QuantizeObj *quantobj)
 {
   int i;
 
-  zero_histogram_rgb (quantobj->histogram);
+  /* The histogram is not needed anymore once we have the colormap,
+   * trade it for the (smaller) inverse-colormap cache.
+   */
+  g_clear_pointer (&quantobj->histogram, g_free);
 
   /* Mark all indices as currently unused */
   memset (quantobj->index_used_count, 0, 256 * sizeof (guint64));
@@ -3999,6 +4597,10 @@ median_cut_pass2_rgb_init (QuantizeObj *quantobj)
                             &quantobj->clab[i].green,
                             &quantobj->clab[i].blue);
     }
+
+  /* Reuse the inverse colormap of a previous conversion, if any */
+  inverse_cmap_cache_take (quantobj);
+
   /* Make a version of our discovered colormap in linear space */
   for (i = 0; i < quantobj->actual_number_of_colors; i++)
     {
@@ -4037,8 +4639,6 @@ median_cut_pass2_fs_dither_rgb (QuantizeObj *quantobj,
                                 GeglBuffer  *new_buffer)
 {
   GeglBuffer   *src_buffer;
-  CFHistogram   histogram = quantobj->histogram;
-  ColorFreq    *cachep;
   Color        *linearcolor;
   const Babl   *src_format;
   const Babl   *dest_format;
@@ -4253,21 +4853,15 @@ median_cut_pass2_fs_dither_rgb (QuantizeObj *quantobj,
             gint lab8[3];
             babl_process (linear_to_rgb_float_fish, rgb16, rgbF, 1);
             rgb_to_unshifted_lin(rgbF[0]*255,rgbF[1]*255,rgbF[2]*255, &lab8[0], &lab8[1], &lab8[2]);
-            cachep = HIST_LIN (histogram,
-                               RSDF (lab8[0]),
-                               GSDF (lab8[1]),
-                               BSDF (lab8[2]));
             /* If we have not seen this color before, find nearest
              * colormap entry and update the cache
              */
-            if (*cachep == 0)
-              fill_inverse_cmap_rgb (quantobj, histogram,
-                                     RSDF (lab8[0]),
-                                     GSDF (lab8[1]),
-                                     BSDF (lab8[2]));
+            index = lookup_inverse_cmap_rgb (quantobj,
+                                             RSDF (lab8[0]),
+                                             GSDF (lab8[1]),
+                                             BSDF (lab8[2]));
           }
 
-          index = *cachep - 1;
           index_used_count[index]++;
           dest[INDEXED] = index;
 
@@ -4357,6 +4951,9 @@ median_cut_pass2_fs_dither_rgb (QuantizeObj *quantobj,
 static void
 delete_median_cut (QuantizeObj *quantobj)
 {
+  if (quantobj->inverse_cmap)
+    inverse_cmap_cache_store (quantobj);
+
   g_free (quantobj->histogram);
   g_free (quantobj);
 }
@@ -4412,6 +5009,8 @@ initialize_median_cut (GimpImageBaseType       type,
     quantobj->histogram = g_new (ColorFreq,
                                  HIST_R_ELEMS * HIST_G_ELEMS * HIST_B_ELEMS);
 
+  quantobj->inverse_cmap             = NULL;
+  quantobj->refine_palette           = FALSE;
   quantobj->custom_palette           = custom_palette;
   quantobj->desired_number_of_colors = num_colors;
   quantobj->want_dither_alpha        = want_dither_alpha;
@@ -26,6 +26,7 @@ gboolean   gimp_image_convert_indexed      (GimpImage               *image,
                                             GimpConvertPaletteType   palette_type,
                                             gint                     max_colors,
                                             gboolean                 remove_duplicates,
+                                            gboolean                 refine_palette,
                                             GimpConvertDitherType    dither_type,
                                             gboolean                 dither_alpha,
                                             gboolean                 dither_text_layers,
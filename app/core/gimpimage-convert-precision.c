@@ -30,8 +30,11 @@
 #include "core-types.h"
 
 #include "gegl/gimp-babl.h"
+#include "gegl/gimp-gegl-apply-operation.h"
 #include "gegl/gimp-gegl-loops.h"
 
+#include "gimp-parallel.h"
+#include "gimpasync.h"
 #include "gimpchannel.h"
 #include "gimpdrawable.h"
 #include "gimpdrawable-operation.h"
@@ -40,14 +43,66 @@
 #include "gimpimage-convert-precision.h"
 #include "gimpimage-undo.h"
 #include "gimpimage-undo-push.h"
+#include "gimplayer.h"
 #include "gimpobjectqueue.h"
 #include "gimpprogress.h"
+#include "gimpsubprogress.h"
+#include "gimpwaitable.h"
 
 #include "text/gimptextlayer.h"
 
 #include "gimp-intl.h"
 
 
+/*  the share of the progress taken by converting the pixels up front,
+ *  the rest is taken by installing the converted drawables
+ */
+#define PREPARE_PROGRESS 0.9
+
+
+typedef struct
+{
+  GimpDrawable     *drawable;
+  GeglBuffer       *src_buffer;
+  GeglBuffer       *dest_buffer;
+  GimpColorProfile *profile;
+  GeglDitherMethod  dither_type;
+} ConvertJob;
+
+typedef struct
+{
+  GArray *jobs;
+  gint    next_job;
+  gint    n_done;
+} ConvertJobs;
+
+
+/*  local function prototypes  */
+
+static GeglDitherMethod gimp_image_convert_precision_get_dither    (GimpDrawable     *drawable,
+                                                                    const Babl       *format,
+                                                                    GeglDitherMethod  dither_type);
+static void             gimp_image_convert_precision_add_job       (GArray           *jobs,
+                                                                    GimpDrawable     *drawable,
+                                                                    const Babl       *format,
+                                                                    GimpColorProfile *profile,
+                                                                    GeglDitherMethod  dither_type);
+static void             gimp_image_convert_precision_run_jobs_func (gint              i,
+                                                                    gint              n,
+                                                                    ConvertJobs      *convert_jobs);
+static void             gimp_image_convert_precision_run_jobs      (GimpAsync        *async,
+                                                                    ConvertJobs      *convert_jobs);
+static gboolean         gimp_image_convert_precision_prepare       (GimpImage        *image,
+                                                                    GimpPrecision     precision,
+                                                                    GimpColorProfile *profile,
+                                                                    GeglDitherMethod  layer_dither_type,
+                                                                    GeglDitherMethod  text_layer_dither_type,
+                                                                    GeglDitherMethod  mask_dither_type,
+                                                                    GimpProgress     *progress);
+
+
+/*  public functions  */
+
 void
 gimp_image_convert_precision (GimpImage        *image,
                               GimpPrecision     precision,
@@ -58,6 +113,8 @@ gimp_image_convert_precision (GimpImage        *image,
 {
   GimpColorProfile *profile;
   GimpObjectQueue  *queue;
+  GimpProgress     *prepare_progress;
+  GimpProgress     *queue_progress;
   GimpProgress     *sub_progress;
   GList            *layers;
   GimpDrawable     *drawable;
@@ -79,7 +136,13 @@ gimp_image_convert_precision (GimpImage        *image,
   if (progress)
     gimp_progress_start (progress, FALSE, "%s", undo_desc);
 
-  queue        = gimp_object_queue_new (progress);
+  prepare_progress = gimp_sub_progress_new (progress);
+  queue_progress   = gimp_sub_progress_new (progress);
+
+  gimp_sub_progress_set_range (GIMP_SUB_PROGRESS (prepare_progress),
+                               0.0, PREPARE_PROGRESS);
+
+  queue        = gimp_object_queue_new (queue_progress);
   sub_progress = GIMP_PROGRESS (queue);
 
   layers = gimp_image_get_layer_list (image);
@@ -110,6 +173,19 @@ gimp_image_convert_precision (GimpImage        *image,
   /*  Set the new precision  */
   g_object_set (image, "precision", precision, NULL);
 
+  /*  Convert the pixels of all plain drawables concurrently, the loop
+   *  below then only installs the results
+   */
+  if (gimp_image_convert_precision_prepare (image, precision, profile,
+                                            layer_dither_type,
+                                            text_layer_dither_type,
+                                            mask_dither_type,
+                                            prepare_progress))
+    {
+      gimp_sub_progress_set_range (GIMP_SUB_PROGRESS (queue_progress),
+                                   PREPARE_PROGRESS, 1.0);
+    }
+
   while ((drawable = gimp_object_queue_pop (queue)))
     {
       if (drawable == GIMP_DRAWABLE (gimp_image_get_mask (image)))
@@ -163,6 +239,8 @@ gimp_image_convert_precision (GimpImage        *image,
   g_object_thaw_notify (G_OBJECT (image));
 
   g_object_unref (queue);
+  g_object_unref (queue_progress);
+  g_object_unref (prepare_progress);
 
   if (progress)
     gimp_progress_end (progress);
@@ -228,3 +306,229 @@ gimp_image_convert_dither_u8 (GimpImage    *image,
       g_object_unref (dither);
     }
 }
+
+
+/*  private functions  */
+
+static GeglDitherMethod
+gimp_image_convert_precision_get_dither (GimpDrawable     *drawable,
+                                         const Babl       *format,
+                                         GeglDitherMethod  dither_type)
+{
+  const Babl *old_format = gimp_drawable_get_format (drawable);
+  gint        old_bits;
+  gint        new_bits;
+
+  old_bits = (babl_format_get_bytes_per_pixel (old_format) * 8 /
+              babl_format_get_n_components (old_format));
+  new_bits = (babl_format_get_bytes_per_pixel (format) * 8 /
+              babl_format_get_n_components (format));
+
+  /*  same as gimp_drawable_convert_type()  */
+  if (old_bits <= new_bits || new_bits > 16)
+    return GEGL_DITHER_NONE;
+
+  return dither_type;
+}
+
+static void
+gimp_image_convert_precision_add_job (GArray           *jobs,
+                                      GimpDrawable     *drawable,
+                                      const Babl       *format,
+                                      GimpColorProfile *profile,
+                                      GeglDitherMethod  dither_type)
+{
+  ConvertJob job;
+
+  job.drawable    = drawable;
+  job.src_buffer  = g_object_ref (gimp_drawable_get_buffer (drawable));
+  job.dest_buffer =
+    gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                     gimp_item_get_width  (GIMP_ITEM (drawable)),
+                                     gimp_item_get_height (GIMP_ITEM (drawable))),
+                     format);
+  job.profile     = profile;
+  job.dither_type = gimp_image_convert_precision_get_dither (drawable, format,
+                                                             dither_type);
+
+  g_array_append_val (jobs, job);
+}
+
+static void
+gimp_image_convert_precision_run_jobs_func (gint         i,
+                                            gint         n,
+                                            ConvertJobs *convert_jobs)
+{
+  gint index;
+
+  /*  layers vary wildly in size, so let each thread grab the next
+   *  drawable instead of splitting the list up front
+   */
+  while ((index = g_atomic_int_add (&convert_jobs->next_job, 1)) <
+         (gint) convert_jobs->jobs->len)
+    {
+      ConvertJob *job = &g_array_index (convert_jobs->jobs, ConvertJob, index);
+
+      gimp_gegl_apply_convert (job->src_buffer,  job->profile, NULL,
+                               job->dest_buffer, job->profile,
+                               job->dither_type);
+
+      g_atomic_int_inc (&convert_jobs->n_done);
+    }
+}
+
+static void
+gimp_image_convert_precision_run_jobs (GimpAsync   *async,
+                                       ConvertJobs *convert_jobs)
+{
+  gegl_parallel_distribute (
+    convert_jobs->jobs->len,
+    (GeglParallelDistributeFunc) gimp_image_convert_precision_run_jobs_func,
+    convert_jobs);
+
+  gimp_async_finish (async, NULL);
+}
+
+static gboolean
+gimp_image_convert_precision_prepare (GimpImage        *image,
+                                      GimpPrecision     precision,
+                                      GimpColorProfile *profile,
+                                      GeglDitherMethod  layer_dither_type,
+                                      GeglDitherMethod  text_layer_dither_type,
+                                      GeglDitherMethod  mask_dither_type,
+                                      GimpProgress     *progress)
+{
+  ConvertJobs  convert_jobs;
+  GimpAsync   *async;
+  const Babl  *space     = NULL;
+  gboolean     converted = FALSE;
+  GList       *layers;
+  GList       *list;
+  gint         i;
+
+  /*  as in gimp_layer_convert_type()  */
+  if (profile)
+    space = gimp_color_profile_get_space (profile,
+                                          GIMP_COLOR_RENDERING_INTENT_RELATIVE_COLORIMETRIC,
+                                          NULL);
+
+  convert_jobs.jobs     = g_array_new (FALSE, FALSE, sizeof (ConvertJob));
+  convert_jobs.next_job = 0;
+  convert_jobs.n_done   = 0;
+
+  layers = gimp_image_get_layer_list (image);
+
+  for (list = layers; list; list = g_list_next (list))
+    {
+      GimpDrawable     *drawable = list->data;
+      GimpLayerMask    *mask     = gimp_layer_get_mask (list->data);
+      GeglDitherMethod  dither_type;
+      const Babl       *format;
+
+      /*  group layers render their projection, and text layers
+       *  re-render their text when not dithered
+       */
+      if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+        continue;
+
+      if (gimp_item_is_text_layer (GIMP_ITEM (drawable)))
+        dither_type = text_layer_dither_type;
+      else
+        dither_type = layer_dither_type;
+
+      format = gimp_image_get_format (image,
+                                      gimp_drawable_get_base_type (drawable),
+                                      precision,
+                                      gimp_drawable_has_alpha (drawable),
+                                      NULL);
+      format = babl_format_with_space ((const gchar *) format, space);
+
+      dither_type = gimp_image_convert_precision_get_dither (drawable, format,
+                                                             dither_type);
+
+      if (! gimp_item_is_text_layer (GIMP_ITEM (drawable)) ||
+          dither_type != GEGL_DITHER_NONE)
+        {
+          gimp_image_convert_precision_add_job (convert_jobs.jobs, drawable,
+                                                format, profile, dither_type);
+        }
+
+      if (mask &&
+          gimp_drawable_get_precision (GIMP_DRAWABLE (mask)) != precision)
+        {
+          /*  the format gimp_layer_convert_type() converts the mask to  */
+          format = gimp_image_get_format (image, GIMP_GRAY, precision,
+                                          gimp_drawable_has_alpha (GIMP_DRAWABLE (mask)),
+                                          NULL);
+
+          gimp_image_convert_precision_add_job (convert_jobs.jobs,
+                                                GIMP_DRAWABLE (mask),
+                                                format, NULL,
+                                                mask_dither_type);
+        }
+    }
+
+  g_list_free (layers);
+
+  for (list = gimp_image_get_channel_iter (image);
+       list;
+       list = g_list_next (list))
+    {
+      GimpDrawable *drawable = list->data;
+      const Babl   *format;
+
+      format = gimp_image_get_format (image,
+                                      gimp_drawable_get_base_type (drawable),
+                                      precision,
+                                      gimp_drawable_has_alpha (drawable),
+                                      NULL);
+
+      gimp_image_convert_precision_add_job (convert_jobs.jobs, drawable,
+                                            format, NULL, mask_dither_type);
+    }
+
+  if (convert_jobs.jobs->len > 1)
+    {
+      async = gimp_parallel_run_async_independent (
+        (GimpRunAsyncFunc) gimp_image_convert_precision_run_jobs,
+        &convert_jobs);
+
+      /*  report progress per finished drawable  */
+      while (! gimp_waitable_wait_for (GIMP_WAITABLE (async),
+                                       0.1 * G_TIME_SPAN_SECOND))
+        {
+          gimp_progress_set_value (progress,
+                                   (gdouble) g_atomic_int_get (&convert_jobs.n_done) /
+                                   (gdouble) convert_jobs.jobs->len);
+        }
+
+      gimp_progress_set_value (progress, 1.0);
+
+      gimp_waitable_wait (GIMP_WAITABLE (async));
+      g_object_unref (async);
+
+      /*  the drawables pick up their converted buffers in
+       *  gimp_drawable_convert_type()
+       */
+      for (i = 0; i < convert_jobs.jobs->len; i++)
+        {
+          ConvertJob *job = &g_array_index (convert_jobs.jobs, ConvertJob, i);
+
+          gimp_drawable_set_converted_buffer (job->drawable, job->dest_buffer);
+        }
+
+      converted = TRUE;
+    }
+
+  for (i = 0; i < convert_jobs.jobs->len; i++)
+    {
+      ConvertJob *job = &g_array_index (convert_jobs.jobs, ConvertJob, i);
+
+      g_object_unref (job->src_buffer);
+      g_object_unref (job->dest_buffer);
+    }
+
+  g_array_free (convert_jobs.jobs, TRUE);
+
+  return converted;
+}
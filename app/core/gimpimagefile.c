@@ -51,6 +51,20 @@
 #include "gimp-intl.h"
 
 
+/*  the maximal number of thumbnail files being loaded in parallel  */
+#define MAX_THUMB_LOADS 4
+
+/*  a queued load that no view asked for within this time is dropped,
+ *  see gimp_imagefile_start_thumbs()
+ */
+#define THUMB_REQUEST_TIMEOUT (G_TIME_SPAN_SECOND / 2)
+
+/*  how long a loaded thumbnail is kept for the views to pick it up,
+ *  in milliseconds
+ */
+#define THUMB_PIXBUF_TIMEOUT  1000
+
+
 enum
 {
   INFO_CHANGED,
@@ -58,6 +72,21 @@ enum
 };
 
 
+/*  a thumbnail load, there is one for each thumbnail size, so that
+ *  views showing the imagefile at different sizes don't cancel each
+ *  other's loads
+ */
+typedef struct
+{
+  GimpImagefile *imagefile;
+  GimpThumbSize  size;
+  GCancellable  *cancellable;
+  gint64         request_time;
+  GdkPixbuf     *pixbuf;
+  guint          pixbuf_timeout_id;
+  gboolean       failed;
+} ThumbLoad;
+
 typedef struct _GimpImagefilePrivate GimpImagefilePrivate;
 
 struct _GimpImagefilePrivate
@@ -69,6 +98,9 @@ struct _GimpImagefilePrivate
   GIcon         *icon;
   GCancellable  *icon_cancellable;
 
+  ThumbLoad      thumb_loads[2];
+  gboolean       thumb_notifying;
+
   gchar         *description;
   gboolean       static_desc;
 };
@@ -87,6 +119,8 @@ static GdkPixbuf * gimp_imagefile_get_new_pixbuf   (GimpViewable   *viewable,
                                                     gint            height);
 static gchar     * gimp_imagefile_get_description  (GimpViewable   *viewable,
                                                     gchar         **tooltip);
+static void        gimp_imagefile_invalidate_preview
+                                                   (GimpViewable   *viewable);
 
 static void        gimp_imagefile_info_changed     (GimpImagefile  *imagefile);
 static void        gimp_imagefile_notify_thumbnail (GimpImagefile  *imagefile,
@@ -99,6 +133,21 @@ static void        gimp_imagefile_icon_callback    (GObject        *source_objec
 static GdkPixbuf * gimp_imagefile_load_thumb       (GimpImagefile  *imagefile,
                                                     gint            width,
                                                     gint            height);
+static ThumbLoad * gimp_imagefile_get_thumb_load  (GimpImagefile  *imagefile,
+                                                    gint            size);
+static void        gimp_imagefile_queue_thumb      (ThumbLoad      *load);
+static void        gimp_imagefile_cancel_thumb     (ThumbLoad      *load);
+static void        gimp_imagefile_cancel_thumbs    (GimpImagefile  *imagefile);
+static void        gimp_imagefile_start_thumbs     (void);
+static void        gimp_imagefile_thumb_callback   (GObject        *source_object,
+                                                    GAsyncResult   *result,
+                                                    gpointer        data);
+static void        gimp_imagefile_thumb_loaded     (ThumbLoad      *load,
+                                                    GdkPixbuf      *pixbuf,
+                                                    GError         *error);
+static void        gimp_imagefile_hold_thumb       (ThumbLoad      *load);
+static gboolean    gimp_imagefile_drop_thumb       (gpointer        data);
+static void        gimp_imagefile_notify_thumb     (GimpImagefile  *imagefile);
 static gboolean    gimp_imagefile_save_thumb       (GimpImagefile  *imagefile,
                                                     GimpImage      *image,
                                                     gint            size,
@@ -122,6 +171,13 @@ G_DEFINE_TYPE_WITH_PRIVATE (GimpImagefile, gimp_imagefile, GIMP_TYPE_VIEWABLE)
 
 static guint gimp_imagefile_signals[LAST_SIGNAL] = { 0 };
 
+/*  ThumbLoads waiting for their thumbnail to be loaded, most recently
+ *  requested first, so the entries a view currently shows are served
+ *  before the ones it has scrolled away from
+ */
+static GQueue thumb_queue     = G_QUEUE_INIT;
+static gint   thumb_n_running = 0;
+
 
 static void
 gimp_imagefile_class_init (GimpImagefileClass *klass)
@@ -147,6 +203,7 @@ gimp_imagefile_class_init (GimpImagefileClass *klass)
   viewable_class->name_changed_signal = "info-changed";
   viewable_class->get_new_pixbuf      = gimp_imagefile_get_new_pixbuf;
   viewable_class->get_description     = gimp_imagefile_get_description;
+  viewable_class->invalidate_preview  = gimp_imagefile_invalidate_preview;
 
   g_type_class_ref (GIMP_TYPE_IMAGE_TYPE);
 
@@ -165,6 +222,11 @@ gimp_imagefile_init (GimpImagefile *imagefile)
 
   private->thumbnail = gimp_thumbnail_new ();
 
+  private->thumb_loads[0].imagefile = imagefile;
+  private->thumb_loads[0].size      = GIMP_THUMB_SIZE_NORMAL;
+  private->thumb_loads[1].imagefile = imagefile;
+  private->thumb_loads[1].size      = GIMP_THUMB_SIZE_LARGE;
+
   g_signal_connect_object (private->thumbnail, "notify",
                            G_CALLBACK (gimp_imagefile_notify_thumbnail),
                            imagefile, G_CONNECT_SWAPPED);
@@ -181,6 +243,8 @@ gimp_imagefile_dispose (GObject *object)
       g_clear_object (&private->icon_cancellable);
     }
 
+  gimp_imagefile_cancel_thumbs (GIMP_IMAGEFILE (object));
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -212,6 +276,8 @@ gimp_imagefile_name_changed (GimpObject *object)
   if (GIMP_OBJECT_CLASS (parent_class)->name_changed)
     GIMP_OBJECT_CLASS (parent_class)->name_changed (object);
 
+  gimp_imagefile_cancel_thumbs (GIMP_IMAGEFILE (object));
+
   gimp_thumbnail_set_uri (private->thumbnail, gimp_object_get_name (object));
 
   g_clear_object (&private->file);
@@ -283,6 +349,20 @@ gimp_imagefile_get_description (GimpViewable   *viewable,
   return basename;
 }
 
+static void
+gimp_imagefile_invalidate_preview (GimpViewable *viewable)
+{
+  GimpImagefilePrivate *private = GET_PRIVATE (viewable);
+
+  GIMP_VIEWABLE_CLASS (parent_class)->invalidate_preview (viewable);
+
+  /*  the thumbnail file might have changed, load it again, unless we
+   *  are only announcing a loaded or dropped thumbnail
+   */
+  if (! private->thumb_notifying)
+    gimp_imagefile_cancel_thumbs (GIMP_IMAGEFILE (viewable));
+}
+
 
 /*  public functions  */
 
@@ -643,6 +723,38 @@ gimp_imagefile_check_thumbnail (GimpImagefile *imagefile)
   return TRUE;
 }
 
+/*  loads the thumbnail for @size right away, for previews that are
+ *  shown once and can't wait for the thumbnail queue, like drag icons
+ */
+void
+gimp_imagefile_load_thumbnail (GimpImagefile *imagefile,
+                               gint           size)
+{
+  GimpImagefilePrivate *private;
+  ThumbLoad            *load;
+  GdkPixbuf            *pixbuf;
+  GError               *error = NULL;
+
+  g_return_if_fail (GIMP_IS_IMAGEFILE (imagefile));
+
+  private = GET_PRIVATE (imagefile);
+  load    = gimp_imagefile_get_thumb_load (imagefile, size);
+
+  if (! private->file || load->pixbuf || load->failed)
+    return;
+
+  if (gimp_thumbnail_peek_thumb (private->thumbnail,
+                                 load->size) < GIMP_THUMB_STATE_EXISTS)
+    return;
+
+  gimp_imagefile_cancel_thumb (load);
+
+  pixbuf = gimp_thumbnail_load_thumb (private->thumbnail, load->size, &error);
+
+  gimp_imagefile_thumb_loaded (load, pixbuf, error);
+  g_clear_error (&error);
+}
+
 gboolean
 gimp_imagefile_save_thumbnail (GimpImagefile  *imagefile,
                                const gchar    *mime_type,
@@ -924,49 +1036,43 @@ gimp_imagefile_load_thumb (GimpImagefile *imagefile,
   GimpImagefilePrivate *private   = GET_PRIVATE (imagefile);
   GimpThumbnail        *thumbnail = private->thumbnail;
   GimpThumbState        image_state;
-  gchar                *image_uri;
-  gint                  image_width;
-  gint                  image_height;
   GdkPixbuf            *pixbuf    = NULL;
-  GError               *error     = NULL;
   gint                  size      = MAX (width, height);
+  ThumbLoad            *load;
   gint                  pixbuf_width;
   gint                  pixbuf_height;
   gint                  preview_width;
   gint                  preview_height;
 
-  g_object_get (thumbnail,
-                "image-state",  &image_state,
-                "image-uri",    &image_uri,
-                "image-width",  &image_width,
-                "image-height", &image_height,
-                NULL);
+  load = gimp_imagefile_get_thumb_load (imagefile, size);
 
-  if (gimp_thumbnail_peek_thumb (thumbnail, size) < GIMP_THUMB_STATE_EXISTS)
-    return NULL;
-
-  if (image_state == GIMP_THUMB_STATE_NOT_FOUND)
-    return NULL;
+  /*  a thumbnail loaded by gimp_imagefile_queue_thumb() is waiting,
+   *  keep it a little longer for other views of the same size
+   */
+  if (load->pixbuf)
+    {
+      pixbuf = g_object_ref (load->pixbuf);
 
-  pixbuf = gimp_thumbnail_load_thumb (thumbnail, size, &error);
+      gimp_imagefile_hold_thumb (load);
+    }
 
   if (! pixbuf)
     {
-      if (error)
-        {
-          GimpThumbSize  thumb_size = size;
-          gchar         *thumb_filename;
+      g_object_get (thumbnail,
+                    "image-state", &image_state,
+                    NULL);
 
-          thumb_filename = gimp_thumb_find_thumb (image_uri, &thumb_size);
+      if (gimp_thumbnail_peek_thumb (thumbnail, size) < GIMP_THUMB_STATE_EXISTS)
+        return NULL;
 
-          gimp_message (private->gimp, NULL, GIMP_MESSAGE_ERROR,
-                        _("Could not open thumbnail '%s': %s"),
-                        thumb_filename, error->message);
-          g_clear_error (&error);
+      if (image_state == GIMP_THUMB_STATE_NOT_FOUND)
+        return NULL;
 
-          if (thumb_filename)
-            g_free (thumb_filename);
-        }
+      /*  don't retry a thumbnail that failed to load, until the
+       *  preview is invalidated
+       */
+      if (! load->failed)
+        gimp_imagefile_queue_thumb (load);
 
       return NULL;
     }
@@ -1015,6 +1121,218 @@ gimp_imagefile_load_thumb (GimpImagefile *imagefile,
   return pixbuf;
 }
 
+/*  Thumbnail files are decoded in worker threads, at most
+ *  MAX_THUMB_LOADS at a time, so that a view showing many imagefiles
+ *  (the document history, or a folder in the file dialog) neither
+ *  blocks the user interface nor floods the thread pool.
+ */
+static ThumbLoad *
+gimp_imagefile_get_thumb_load (GimpImagefile *imagefile,
+                               gint           size)
+{
+  GimpImagefilePrivate *private = GET_PRIVATE (imagefile);
+
+  /*  the same size gimp_thumb_find_thumb() looks for first  */
+  if (size <= GIMP_THUMB_SIZE_NORMAL)
+    return &private->thumb_loads[0];
+  else
+    return &private->thumb_loads[1];
+}
+
+static void
+gimp_imagefile_queue_thumb (ThumbLoad *load)
+{
+  load->request_time = g_get_monotonic_time ();
+
+  if (load->cancellable)
+    {
+      /*  already queued or running, move a queued one to the front  */
+      if (g_queue_remove (&thumb_queue, load))
+        g_queue_push_head (&thumb_queue, load);
+
+      return;
+    }
+
+  load->failed      = FALSE;
+  load->cancellable = g_cancellable_new ();
+
+  g_queue_push_head (&thumb_queue, load);
+
+  gimp_imagefile_start_thumbs ();
+}
+
+static void
+gimp_imagefile_cancel_thumb (ThumbLoad *load)
+{
+  if (load->cancellable)
+    {
+      g_queue_remove (&thumb_queue, load);
+
+      g_cancellable_cancel (load->cancellable);
+      g_clear_object (&load->cancellable);
+    }
+}
+
+static void
+gimp_imagefile_cancel_thumbs (GimpImagefile *imagefile)
+{
+  GimpImagefilePrivate *private = GET_PRIVATE (imagefile);
+  gint                  i;
+
+  for (i = 0; i < G_N_ELEMENTS (private->thumb_loads); i++)
+    {
+      ThumbLoad *load = &private->thumb_loads[i];
+
+      gimp_imagefile_cancel_thumb (load);
+
+      g_clear_handle_id (&load->pixbuf_timeout_id, g_source_remove);
+      g_clear_object (&load->pixbuf);
+
+      load->failed = FALSE;
+    }
+}
+
+static void
+gimp_imagefile_start_thumbs (void)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  while (thumb_n_running < MAX_THUMB_LOADS &&
+         ! g_queue_is_empty (&thumb_queue))
+    {
+      ThumbLoad            *load    = g_queue_pop_head (&thumb_queue);
+      GimpImagefilePrivate *private = GET_PRIVATE (load->imagefile);
+
+      /*  views only ask for the thumbnails they draw, so a load nobody
+       *  asked for lately belongs to an entry that was scrolled away, or
+       *  whose view is gone.  Drop it, and invalidate the preview, so
+       *  that a view still showing the entry asks for it again.
+       */
+      if (now - load->request_time > THUMB_REQUEST_TIMEOUT)
+        {
+          g_clear_object (&load->cancellable);
+
+          gimp_imagefile_notify_thumb (load->imagefile);
+          continue;
+        }
+
+      thumb_n_running++;
+
+      gimp_thumbnail_load_thumb_async (private->thumbnail,
+                                       load->size,
+                                       load->cancellable,
+                                       gimp_imagefile_thumb_callback,
+                                       load);
+    }
+}
+
+static void
+gimp_imagefile_thumb_callback (GObject      *source_object,
+                               GAsyncResult *result,
+                               gpointer      data)
+{
+  GimpThumbnail *thumbnail = GIMP_THUMBNAIL (source_object);
+  ThumbLoad     *load;
+  GdkPixbuf     *pixbuf;
+  GError        *error = NULL;
+
+  thumb_n_running--;
+
+  pixbuf = gimp_thumbnail_load_thumb_finish (thumbnail, result, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      /*  we were cancelled from dispose() or because the file
+       *  changed, the imagefile might be long gone, bail out
+       */
+      g_clear_error (&error);
+      gimp_imagefile_start_thumbs ();
+      return;
+    }
+
+  load = data;
+
+  g_clear_object (&load->cancellable);
+
+  gimp_imagefile_thumb_loaded (load, pixbuf, error);
+  g_clear_error (&error);
+
+  gimp_imagefile_start_thumbs ();
+}
+
+static void
+gimp_imagefile_thumb_loaded (ThumbLoad *load,
+                             GdkPixbuf *pixbuf,
+                             GError    *error)
+{
+  GimpImagefilePrivate *private = GET_PRIVATE (load->imagefile);
+
+  if (pixbuf)
+    {
+      g_clear_object (&load->pixbuf);
+      load->pixbuf = pixbuf;
+
+      gimp_imagefile_hold_thumb (load);
+      gimp_imagefile_notify_thumb (load->imagefile);
+    }
+  else
+    {
+      if (error)
+        {
+          const gchar   *image_uri  = gimp_object_get_name (load->imagefile);
+          GimpThumbSize  thumb_size = load->size;
+          gchar         *thumb_filename;
+
+          thumb_filename = gimp_thumb_find_thumb (image_uri, &thumb_size);
+
+          gimp_message (private->gimp, NULL, GIMP_MESSAGE_ERROR,
+                        _("Could not open thumbnail '%s': %s"),
+                        thumb_filename, error->message);
+
+          g_free (thumb_filename);
+        }
+
+      load->failed = TRUE;
+    }
+}
+
+/*  (re)start the timeout dropping a loaded thumbnail, the views get
+ *  their previews from the viewable's preview cache afterwards
+ */
+static void
+gimp_imagefile_hold_thumb (ThumbLoad *load)
+{
+  if (load->pixbuf_timeout_id)
+    g_source_remove (load->pixbuf_timeout_id);
+
+  load->pixbuf_timeout_id = g_timeout_add (THUMB_PIXBUF_TIMEOUT,
+                                           gimp_imagefile_drop_thumb,
+                                           load);
+}
+
+static gboolean
+gimp_imagefile_drop_thumb (gpointer data)
+{
+  ThumbLoad *load = data;
+
+  load->pixbuf_timeout_id = 0;
+
+  g_clear_object (&load->pixbuf);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*  invalidate the preview without cancelling the thumbnail loads  */
+static void
+gimp_imagefile_notify_thumb (GimpImagefile *imagefile)
+{
+  GimpImagefilePrivate *private = GET_PRIVATE (imagefile);
+
+  private->thumb_notifying = TRUE;
+  gimp_viewable_invalidate_preview (GIMP_VIEWABLE (imagefile));
+  private->thumb_notifying = FALSE;
+}
+
 static gboolean
 gimp_imagefile_save_thumb (GimpImagefile  *imagefile,
                            GimpImage      *image,
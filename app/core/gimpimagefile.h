@@ -80,6 +80,8 @@ void            gimp_imagefile_create_thumbnail_weak (GimpImagefile  *imagefile,
                                                       gint            size,
                                                       gboolean        replace);
 gboolean        gimp_imagefile_check_thumbnail       (GimpImagefile  *imagefile);
+void            gimp_imagefile_load_thumbnail        (GimpImagefile  *imagefile,
+                                                      gint            size);
 gboolean        gimp_imagefile_save_thumbnail        (GimpImagefile  *imagefile,
                                                       const gchar    *mime_type,
                                                       GimpImage      *image,
@@ -1734,57 +1734,29 @@ gimp_layer_real_convert_type (GimpLayer        *layer,
                               GimpProgress     *progress)
 {
   GimpDrawable *drawable = GIMP_DRAWABLE (layer);
-  GeglBuffer   *src_buffer;
   GeglBuffer   *dest_buffer;
 
-  if (layer_dither_type == GEGL_DITHER_NONE)
-    {
-      src_buffer = g_object_ref (gimp_drawable_get_buffer (drawable));
-    }
-  else
-    {
-      gint bits;
+  dest_buffer = gimp_drawable_take_converted_buffer (drawable, new_format);
 
-      src_buffer =
+  if (! dest_buffer)
+    {
+      dest_buffer =
         gegl_buffer_new (GEGL_RECTANGLE (0, 0,
                                          gimp_item_get_width  (GIMP_ITEM (layer)),
                                          gimp_item_get_height (GIMP_ITEM (layer))),
-                         gimp_drawable_get_format (drawable));
-
-      bits = (babl_format_get_bytes_per_pixel (new_format) * 8 /
-              babl_format_get_n_components (new_format));
-
-      gimp_gegl_apply_dither (gimp_drawable_get_buffer (drawable),
-                              NULL, NULL,
-                              src_buffer, 1 << bits, layer_dither_type);
-    }
-
-  dest_buffer =
-    gegl_buffer_new (GEGL_RECTANGLE (0, 0,
-                                     gimp_item_get_width  (GIMP_ITEM (layer)),
-                                     gimp_item_get_height (GIMP_ITEM (layer))),
-                     new_format);
+                         new_format);
 
-  if (dest_profile)
-    {
-      if (! src_profile)
+      if (dest_profile && ! src_profile)
         src_profile =
           gimp_color_managed_get_color_profile (GIMP_COLOR_MANAGED (layer));
 
-      gimp_gegl_convert_color_profile (src_buffer,  NULL, src_profile,
-                                       dest_buffer, NULL, dest_profile,
-                                       GIMP_COLOR_RENDERING_INTENT_PERCEPTUAL,
-                                       TRUE, progress);
-    }
-  else
-    {
-      gimp_gegl_buffer_copy (src_buffer, NULL, GEGL_ABYSS_NONE,
-                             dest_buffer, NULL);
+      gimp_gegl_apply_convert (gimp_drawable_get_buffer (drawable),
+                               src_profile, progress,
+                               dest_buffer, dest_profile,
+                               layer_dither_type);
     }
 
   gimp_drawable_set_buffer (drawable, push_undo, NULL, dest_buffer);
-
-  g_object_unref (src_buffer);
   g_object_unref (dest_buffer);
 }
 
@@ -79,6 +79,13 @@ struct _GimpLineArtPrivate
   GeglBuffer   *closed;
   gfloat       *distmap;
 
+  /* Used to only recompute the updated part of the input. */
+  GPtrArray    *closures;
+  GeglRectangle update_area;
+  gboolean      update_all;
+  gboolean      closed_select_transparent;
+  guchar        closed_max_value;
+
   /* Used in the closing step. */
   gboolean      select_transparent;
   gdouble       threshold;
@@ -93,21 +100,34 @@ struct _GimpLineArtPrivate
 
 typedef struct
 {
-  GeglBuffer  *buffer;
+  GeglBuffer    *buffer;
 
-  gboolean     select_transparent;
-  gdouble      threshold;
-  gboolean     automatic_closure;
-  gint         spline_max_len;
-  gint         segment_max_len;
+  gboolean       select_transparent;
+  gdouble        threshold;
+  gboolean       automatic_closure;
+  gint           spline_max_len;
+  gint           segment_max_len;
+
+  /* The previous result, if only @area needs to be recomputed. */
+  GeglBuffer    *closed;
+  GPtrArray     *closures;
+  GeglRectangle  area;
+  gboolean       closed_select_transparent;
+  guchar         closed_max_value;
 } LineArtData;
 
 typedef struct
 {
   GeglBuffer *closed;
+  GPtrArray  *closures;
   gfloat     *distmap;
+  gboolean    select_transparent;
+  guchar      max_value;
 } LineArtResult;
 
+#define PIXELS_PER_THREAD (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+#define EDGELS_PER_THREAD 4096
+
 static int DeltaX[4] = {+1, -1, 0, 0};
 static int DeltaY[4] = {0, 0, +1, -1};
 
@@ -136,6 +156,19 @@ typedef struct _SplineCandidate
   float quality;
 } SplineCandidate;
 
+/* A spline or segment drawn to close the line art, with the pixels
+ * filled in the insignificant regions it created.  Shared between
+ * successive results, hence reference counted.
+ */
+typedef struct
+{
+  Pixel   p1;
+  Pixel   p2;
+  GArray *pixels;
+  GList  *seeds;
+  GArray *fills;
+} LineArtClosure;
+
 typedef struct _Edgel
 {
   gint      x, y;
@@ -147,6 +180,76 @@ typedef struct _Edgel
   guint     next, previous;
 } Edgel;
 
+typedef struct
+{
+  GeglBuffer *buffer;
+  GimpAsync  *async;
+  GMutex      mutex;
+  gboolean    select_transparent;
+  guchar      threshold;
+  guchar      max_value;
+} LineArtBinarizeData;
+
+typedef struct
+{
+  gfloat    *curvatures;
+  gfloat    *smoothed_curvatures;
+  gfloat    *radii;
+  gint       width;
+  gfloat     threshold;
+  gfloat     clamped_threshold;
+  GimpAsync *async;
+} CurvatureThresholdData;
+
+typedef struct
+{
+  GeglBuffer *mask;
+  gfloat     *dist;
+  gfloat     *thickness;
+  gint        width;
+  gint        height;
+  GimpAsync  *async;
+} StrokesRadiiData;
+
+typedef struct
+{
+  GArray    *max_positions;
+  gfloat    *normals;
+  gint       width;
+  gint       distance_threshold;
+  gfloat     cos_min;
+  GArray    *candidates;
+  GMutex     mutex;
+  GimpAsync *async;
+} SplineCandidatesData;
+
+typedef struct
+{
+  SplineCandidate candidate;
+  gint            i;
+  gint            j;
+} SplineCandidateEntry;
+
+typedef struct
+{
+  gfloat    *normals;
+  gint       width;
+  GimpAsync *async;
+} NormalsData;
+
+typedef struct
+{
+  GArray      *set;
+  gint         mask_size;
+  gfloat      *weights;
+  gfloat      *smoothed_curvatures;
+  GeglBuffer  *buffer;
+  GArray     **bands;
+  gint         n_bands;
+  GHashTable  *edgel2index;
+  GimpAsync   *async;
+} EdgelSetData;
+
 
 static void            gimp_line_art_finalize                  (GObject               *object);
 static void            gimp_line_art_set_property              (GObject                *object,
@@ -161,10 +264,13 @@ static void            gimp_line_art_get_property              (GObject
 /* Functions for asynchronous computation. */
 
 static void            gimp_line_art_compute                   (GimpLineArt            *line_art);
+static void            gimp_line_art_update                    (GimpLineArt            *line_art);
 static void            gimp_line_art_compute_cb                (GimpAsync              *async,
                                                                 GimpLineArt            *line_art);
 
 static GimpAsync     * gimp_line_art_prepare_async             (GimpLineArt            *line_art,
+                                                                GeglBuffer             *closed,
+                                                                GPtrArray              *closures,
                                                                 gint                    priority);
 static void            gimp_line_art_prepare_async_func        (GimpAsync              *async,
                                                                 LineArtData            *data);
@@ -172,18 +278,40 @@ static LineArtData   * line_art_data_new                       (GeglBuffer
                                                                 GimpLineArt            *line_art);
 static void            line_art_data_free                      (LineArtData            *data);
 static LineArtResult * line_art_result_new                     (GeglBuffer             *line_art,
-                                                                gfloat                 *distmap);
+                                                                GPtrArray              *closures,
+                                                                gfloat                 *distmap,
+                                                                gboolean                select_transparent,
+                                                                guchar                  max_value);
 static void            line_art_result_free                    (LineArtResult          *result);
 
+static LineArtClosure * line_art_closure_new                   (Pixel                   p1,
+                                                                Pixel                   p2,
+                                                                GArray                 *pixels,
+                                                                GList                  *seeds);
+static void            line_art_closure_free                   (LineArtClosure         *closure);
+static void            line_art_closure_unref                  (LineArtClosure         *closure);
+static gboolean        line_art_closure_ends_in                (LineArtClosure         *closure,
+                                                                const GeglRectangle    *rect);
+static void            line_art_closures_translate             (GPtrArray              *closures,
+                                                                gint                    dx,
+                                                                gint                    dy);
+
 static gboolean        gimp_line_art_idle                      (GimpLineArt            *line_art);
 static void            gimp_line_art_input_invalidate_preview  (GimpViewable           *viewable,
                                                                 GimpLineArt            *line_art);
+static void            gimp_line_art_input_update              (GimpDrawable           *drawable,
+                                                                gint                    x,
+                                                                gint                    y,
+                                                                gint                    width,
+                                                                gint                    height,
+                                                                GimpLineArt            *line_art);
 
 
 /* All actual computation functions. */
 
 static GeglBuffer    * gimp_line_art_close                     (GeglBuffer             *buffer,
                                                                 gboolean                select_transparent,
+                                                                guchar                  max_value,
                                                                 gdouble                 stroke_threshold,
                                                                 gboolean                automatic_closure,
                                                                 gint                    spline_max_length,
@@ -198,8 +326,33 @@ static GeglBuffer    * gimp_line_art_close                     (GeglBuffer
                                                                 gint                    created_regions_significant_area,
                                                                 gint                    created_regions_minimum_area,
                                                                 gboolean                small_segments_from_spline_sources,
+                                                                const GeglRectangle    *keypoint_area,
+                                                                GeglBuffer            **lineart_strokes,
+                                                                GPtrArray             **lineart_closures,
                                                                 gfloat                **lineart_distmap,
                                                                 GimpAsync              *async);
+static GeglBuffer    * gimp_line_art_merge                     (GeglBuffer             *prev_closed,
+                                                                GPtrArray              *prev_closures,
+                                                                GeglBuffer             *strokes,
+                                                                GPtrArray              *closures,
+                                                                const GeglRectangle    *update_rect,
+                                                                const GeglRectangle    *context_rect,
+                                                                GPtrArray             **merged_closures);
+static void            gimp_line_art_merge_erase               (GeglBuffer             *closed,
+                                                                GArray                 *pixels,
+                                                                GeglBuffer             *strokes,
+                                                                const GeglRectangle    *context_rect);
+
+static guchar          gimp_line_art_get_max_value             (GeglBuffer             *buffer,
+                                                                GimpAsync              *async);
+static gfloat        * gimp_line_art_get_distmap               (GeglBuffer             *closed);
+static void            gimp_line_art_max_value_area            (const GeglRectangle    *area,
+                                                                LineArtBinarizeData    *data);
+static void            gimp_line_art_binarize_area             (const GeglRectangle    *area,
+                                                                LineArtBinarizeData    *data);
+static void            gimp_line_art_threshold_range           (gint                    offset,
+                                                                gint                    size,
+                                                                CurvatureThresholdData *data);
 
 static void            gimp_lineart_denoise                    (GeglBuffer             *buffer,
                                                                 int                     size,
@@ -210,22 +363,30 @@ static void            gimp_lineart_compute_normals_curvatures (GeglBuffer
                                                                 gfloat                 *smoothed_curvatures,
                                                                 int                     normal_estimate_mask_size,
                                                                 GimpAsync              *async);
+static void            gimp_lineart_normalize_normals_range    (gint                    offset,
+                                                                gint                    size,
+                                                                NormalsData            *data);
 static gfloat        * gimp_lineart_get_smooth_curvatures      (GArray                 *edgelset,
                                                                 GimpAsync              *async);
+static void            gimp_lineart_smooth_curvatures_range    (gint                    offset,
+                                                                gint                    size,
+                                                                EdgelSetData           *data);
 static GArray        * gimp_lineart_curvature_extremums        (gfloat                 *curvatures,
                                                                 gfloat                 *smoothed_curvatures,
                                                                 gint                    curvatures_width,
                                                                 gint                    curvatures_height,
                                                                 GimpAsync              *async);
-static gint            gimp_spline_candidate_cmp               (const SplineCandidate  *a,
-                                                                const SplineCandidate  *b,
-                                                                gpointer                user_data);
+static gint            gimp_spline_candidate_entry_cmp         (const SplineCandidateEntry *a,
+                                                                const SplineCandidateEntry *b);
 static GList         * gimp_lineart_find_spline_candidates     (GArray                 *max_positions,
                                                                 gfloat                 *normals,
                                                                 gint                    width,
                                                                 gint                    distance_threshold,
                                                                 gfloat                  max_angle_deg,
                                                                 GimpAsync              *async);
+static void            gimp_lineart_spline_candidates_func     (gint                    i,
+                                                                gint                    n,
+                                                                SplineCandidatesData   *data);
 
 static GArray        * gimp_lineart_discrete_spline            (Pixel                   p0,
                                                                 GimpVector2             n0,
@@ -245,10 +406,13 @@ static GArray        * gimp_lineart_line_segment_until_hit      (const GeglBuffe
                                                                  int                     size);
 static gfloat        * gimp_lineart_estimate_strokes_radii      (GeglBuffer             *mask,
                                                                  GimpAsync              *async);
+static void            gimp_lineart_strokes_radii_area          (const GeglRectangle    *area,
+                                                                 StrokesRadiiData       *data);
 static void            gimp_line_art_simple_fill                (GeglBuffer             *buffer,
                                                                  gint                    x,
                                                                  gint                    y,
-                                                                 gint                   *counter);
+                                                                 gint                   *counter,
+                                                                 GArray                 *filled);
 
 /* Some callback-type functions. */
 
@@ -286,22 +450,31 @@ static glong      gimp_edgel_region_area          (const GeglBuffer   *mask,
 
 static GArray   * gimp_edgelset_new               (GeglBuffer         *buffer,
                                                    GimpAsync          *async);
-static void       gimp_edgelset_add               (GArray             *set,
-                                                   int                 x,
-                                                   int                 y,
-                                                   Direction           direction,
-                                                   GHashTable         *edgel2index);
+static void       gimp_edgelset_new_band          (gint                band_index,
+                                                   gint                n_bands,
+                                                   EdgelSetData       *data);
 static void       gimp_edgelset_init_normals      (GArray             *set);
 static void       gimp_edgelset_smooth_normals    (GArray             *set,
                                                    int                 mask_size,
                                                    GimpAsync          *async);
+static void       gimp_edgelset_smooth_normals_range
+                                                  (gint                offset,
+                                                   gint                size,
+                                                   EdgelSetData       *data);
 static void       gimp_edgelset_compute_curvature (GArray             *set,
                                                    GimpAsync          *async);
+static void       gimp_edgelset_compute_curvature_range
+                                                  (gint                offset,
+                                                   gint                size,
+                                                   EdgelSetData       *data);
 
 static void       gimp_edgelset_build_graph       (GArray            *set,
                                                    GeglBuffer        *buffer,
                                                    GHashTable        *edgel2index,
                                                    GimpAsync         *async);
+static void       gimp_edgelset_build_graph_range (gint               offset,
+                                                   gint               size,
+                                                   EdgelSetData      *data);
 static void       gimp_edgelset_next8             (const GeglBuffer  *buffer,
                                                    Edgel             *it,
                                                    Edgel             *n);
@@ -528,6 +701,12 @@ gimp_line_art_set_input (GimpLineArt  *line_art,
           g_signal_connect (pickable, "invalidate-preview",
                             G_CALLBACK (gimp_line_art_input_invalidate_preview),
                             line_art);
+
+          /* Only drawables tell which part of them changed. */
+          if (GIMP_IS_DRAWABLE (pickable))
+            g_signal_connect (pickable, "update",
+                              G_CALLBACK (gimp_line_art_input_update),
+                              line_art);
         }
     }
 }
@@ -555,7 +734,7 @@ gimp_line_art_thaw (GimpLineArt *line_art)
   line_art->priv->frozen = FALSE;
   if (line_art->priv->compute_after_thaw)
     {
-      gimp_line_art_compute (line_art);
+      gimp_line_art_update (line_art);
       line_art->priv->compute_after_thaw = FALSE;
     }
 }
@@ -596,6 +775,17 @@ gimp_line_art_get (GimpLineArt  *line_art,
 static void
 gimp_line_art_compute (GimpLineArt *line_art)
 {
+  line_art->priv->update_all = TRUE;
+
+  gimp_line_art_update (line_art);
+}
+
+static void
+gimp_line_art_update (GimpLineArt *line_art)
+{
+  GeglBuffer *closed   = NULL;
+  GPtrArray  *closures = NULL;
+
   if (line_art->priv->frozen)
     {
       line_art->priv->compute_after_thaw = TRUE;
@@ -619,7 +809,18 @@ gimp_line_art_compute (GimpLineArt *line_art)
       line_art->priv->idle_id = 0;
     }
 
+  /* Keep the previous result around if only part of the input changed
+   * since it was computed.
+   */
+  if (! line_art->priv->update_all &&
+      ! gegl_rectangle_is_empty (&line_art->priv->update_area))
+    {
+      closed   = g_steal_pointer (&line_art->priv->closed);
+      closures = g_steal_pointer (&line_art->priv->closures);
+    }
+
   g_clear_object (&line_art->priv->closed);
+  g_clear_pointer (&line_art->priv->closures, g_ptr_array_unref);
   g_clear_pointer (&line_art->priv->distmap, g_free);
 
   if (line_art->priv->input)
@@ -632,7 +833,9 @@ gimp_line_art_compute (GimpLineArt *line_art)
         line_art->priv->input,
         G_CALLBACK (gimp_line_art_input_invalidate_preview),
         line_art);
-      line_art->priv->async = gimp_line_art_prepare_async (line_art, +1);
+      line_art->priv->async = gimp_line_art_prepare_async (line_art,
+                                                           closed, closures,
+                                                           +1);
       g_signal_emit (line_art, gimp_line_art_signals[COMPUTING_START], 0);
       g_signal_handlers_unblock_by_func (
         line_art->priv->input,
@@ -643,6 +846,12 @@ gimp_line_art_compute (GimpLineArt *line_art)
                                           (GimpAsyncCallback) gimp_line_art_compute_cb,
                                           line_art, line_art);
     }
+
+  g_clear_object (&closed);
+  g_clear_pointer (&closures, g_ptr_array_unref);
+
+  line_art->priv->update_area = *GEGL_RECTANGLE (0, 0, 0, 0);
+  line_art->priv->update_all  = FALSE;
 }
 
 static void
@@ -658,9 +867,13 @@ gimp_line_art_compute_cb (GimpAsync   *async,
 
       result = gimp_async_get_result (async);
 
-      line_art->priv->closed  = g_object_ref (result->closed);
-      line_art->priv->distmap = result->distmap;
+      line_art->priv->closed   = g_object_ref (result->closed);
+      line_art->priv->closures = g_ptr_array_ref (result->closures);
+      line_art->priv->distmap  = result->distmap;
       result->distmap  = NULL;
+
+      line_art->priv->closed_select_transparent = result->select_transparent;
+      line_art->priv->closed_max_value          = result->max_value;
       g_signal_emit (line_art, gimp_line_art_signals[COMPUTING_END], 0);
     }
 
@@ -669,6 +882,8 @@ gimp_line_art_compute_cb (GimpAsync   *async,
 
 static GimpAsync *
 gimp_line_art_prepare_async (GimpLineArt *line_art,
+                             GeglBuffer  *closed,
+                             GPtrArray   *closures,
                              gint         priority)
 {
   GeglBuffer  *buffer;
@@ -686,6 +901,15 @@ gimp_line_art_prepare_async (GimpLineArt *line_art,
 
   g_object_unref (buffer);
 
+  if (closed && closures)
+    {
+      data->closed                    = gimp_gegl_buffer_dup (closed);
+      data->closures                  = g_ptr_array_ref (closures);
+      data->area                      = line_art->priv->update_area;
+      data->closed_select_transparent = line_art->priv->closed_select_transparent;
+      data->closed_max_value          = line_art->priv->closed_max_value;
+    }
+
   async = gimp_parallel_run_async_full (
     priority,
     (GimpRunAsyncFunc) gimp_line_art_prepare_async_func,
@@ -698,13 +922,21 @@ static void
 gimp_line_art_prepare_async_func (GimpAsync   *async,
                                   LineArtData *data)
 {
-  GeglBuffer *buffer;
-  GeglBuffer *closed  = NULL;
-  gfloat     *distmap = NULL;
-  gint        buffer_x;
-  gint        buffer_y;
-  gboolean    has_alpha;
-  gboolean    select_transparent = FALSE;
+  GeglBuffer          *buffer;
+  GeglBuffer          *closed   = NULL;
+  GeglBuffer          *strokes  = NULL;
+  GPtrArray           *closures = NULL;
+  gfloat              *distmap  = NULL;
+  const GeglRectangle *extent;
+  GeglRectangle        update_rect;
+  GeglRectangle        context_rect;
+  GeglRectangle        keypoint_rect;
+  gint                 buffer_x;
+  gint                 buffer_y;
+  gboolean             has_alpha;
+  gboolean             select_transparent = FALSE;
+  gboolean             incremental        = FALSE;
+  guchar               max_value          = 0;
 
   has_alpha = babl_format_has_alpha (gegl_buffer_get_format (data->buffer));
 
@@ -753,11 +985,110 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
         }
     }
 
+  extent = gegl_buffer_get_extent (data->buffer);
+
+  if (! select_transparent)
+    {
+      max_value = gimp_line_art_get_max_value (data->buffer, async);
+
+      if (gimp_async_is_stopped (async))
+        {
+          line_art_data_free (data);
+
+          return;
+        }
+    }
+
+  /* If only part of the input changed, and the binarization didn't,
+   * only close the line art around the updated area.  The area is
+   * grown by the maximum gap length, so that closures reaching into it
+   * are redone.  End points are only looked for up to one more gap
+   * length around it, so that closures ending in it can be found
+   * again, and the line art is closed with one gap length of context
+   * around those end points.  See gimp_line_art_merge() for how the
+   * closures are then combined with the previous ones.
+   */
+  if (data->closed                                                      &&
+      gegl_rectangle_equal (gegl_buffer_get_extent (data->closed), extent) &&
+      data->closed_select_transparent == select_transparent             &&
+      data->closed_max_value          == max_value)
+    {
+      gint margin = 0;
+
+      if (data->automatic_closure)
+        margin = MAX (data->spline_max_len, data->segment_max_len);
+
+      /* Leave room for the denoising step too. */
+      margin += 8;
+
+      update_rect = data->area;
+
+      update_rect.x      -= margin;
+      update_rect.y      -= margin;
+      update_rect.width  += 2 * margin;
+      update_rect.height += 2 * margin;
+
+      gegl_rectangle_align_to_buffer (&update_rect, &update_rect, data->closed,
+                                      GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+      gegl_rectangle_intersect (&update_rect, &update_rect, extent);
+
+      keypoint_rect = update_rect;
+
+      keypoint_rect.x      -= margin;
+      keypoint_rect.y      -= margin;
+      keypoint_rect.width  += 2 * margin;
+      keypoint_rect.height += 2 * margin;
+
+      gegl_rectangle_intersect (&keypoint_rect, &keypoint_rect, extent);
+
+      context_rect = keypoint_rect;
+
+      context_rect.x      -= margin;
+      context_rect.y      -= margin;
+      context_rect.width  += 2 * margin;
+      context_rect.height += 2 * margin;
+
+      gegl_rectangle_intersect (&context_rect, &context_rect, extent);
+
+      /* End points within one margin of a context border which is not
+       * the image border lack context; ignore them.
+       */
+      keypoint_rect.x -= context_rect.x;
+      keypoint_rect.y -= context_rect.y;
+
+      incremental = ! gegl_rectangle_contains (&update_rect, extent);
+    }
+
+  if (incremental && gegl_rectangle_is_empty (&update_rect))
+    {
+      gimp_async_finish_full (async,
+                              line_art_result_new (
+                                g_object_ref (data->closed),
+                                g_ptr_array_ref (data->closures),
+                                gimp_line_art_get_distmap (data->closed),
+                                select_transparent, max_value),
+                              (GDestroyNotify) line_art_result_free);
+
+      line_art_data_free (data);
+
+      return;
+    }
+
   buffer   = data->buffer;
   buffer_x = gegl_buffer_get_x (data->buffer);
   buffer_y = gegl_buffer_get_y (data->buffer);
 
-  if (buffer_x != 0 || buffer_y != 0)
+  if (incremental)
+    {
+      buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                context_rect.width,
+                                                context_rect.height),
+                                gegl_buffer_get_format (data->buffer));
+
+      gimp_gegl_buffer_copy (data->buffer, &context_rect, GEGL_ABYSS_NONE,
+                             buffer, gegl_buffer_get_extent (buffer));
+    }
+  else if (buffer_x != 0 || buffer_y != 0)
     {
       buffer = g_object_new (GEGL_TYPE_BUFFER,
                              "source",  buffer,
@@ -774,6 +1105,7 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
 
   closed = gimp_line_art_close (buffer,
                                 select_transparent,
+                                max_value,
                                 data->threshold,
                                 data->automatic_closure,
                                 data->spline_max_len,
@@ -798,7 +1130,10 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
                                 100,
                                 /*small_segments_from_spline_sources,*/
                                 TRUE,
-                                &distmap,
+                                incremental ? &keypoint_rect : NULL,
+                                incremental ? &strokes : NULL,
+                                &closures,
+                                incremental ? NULL : &distmap,
                                 async);
 
   GIMP_TIMER_END("close line-art");
@@ -808,7 +1143,27 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
 
   if (! gimp_async_is_stopped (async))
     {
-      if (buffer_x != 0 || buffer_y != 0)
+      if (incremental)
+        {
+          GPtrArray *merged_closures;
+
+          line_art_closures_translate (closures,
+                                       context_rect.x, context_rect.y);
+
+          g_object_unref (closed);
+
+          closed = gimp_line_art_merge (data->closed, data->closures,
+                                        strokes, closures,
+                                        &update_rect, &context_rect,
+                                        &merged_closures);
+
+          g_ptr_array_unref (closures);
+          closures = merged_closures;
+
+          /* Distances can span the whole stroke, recompute them all. */
+          distmap = gimp_line_art_get_distmap (closed);
+        }
+      else if (buffer_x != 0 || buffer_y != 0)
         {
           buffer = g_object_new (GEGL_TYPE_BUFFER,
                                  "source",  closed,
@@ -819,13 +1174,19 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
           g_object_unref (closed);
 
           closed = buffer;
+
+          line_art_closures_translate (closures, buffer_x, buffer_y);
         }
 
       gimp_async_finish_full (async,
-                              line_art_result_new (closed, distmap),
+                              line_art_result_new (closed, closures, distmap,
+                                                   select_transparent,
+                                                   max_value),
                               (GDestroyNotify) line_art_result_free);
     }
 
+  g_clear_object (&strokes);
+
   line_art_data_free (data);
 }
 
@@ -841,6 +1202,8 @@ line_art_data_new (GeglBuffer  *buffer,
   data->automatic_closure  = line_art->priv->automatic_closure;
   data->spline_max_len     = line_art->priv->spline_max_len;
   data->segment_max_len    = line_art->priv->segment_max_len;
+  data->closed             = NULL;
+  data->closures           = NULL;
 
   return data;
 }
@@ -849,19 +1212,27 @@ static void
 line_art_data_free (LineArtData *data)
 {
   g_object_unref (data->buffer);
+  g_clear_object (&data->closed);
+  g_clear_pointer (&data->closures, g_ptr_array_unref);
 
   g_slice_free (LineArtData, data);
 }
 
 static LineArtResult *
 line_art_result_new (GeglBuffer *closed,
-                     gfloat     *distmap)
+                     GPtrArray  *closures,
+                     gfloat     *distmap,
+                     gboolean    select_transparent,
+                     guchar      max_value)
 {
   LineArtResult *data;
 
   data = g_slice_new (LineArtResult);
-  data->closed  = closed;
-  data->distmap = distmap;
+  data->closed             = closed;
+  data->closures           = closures;
+  data->distmap            = distmap;
+  data->select_transparent = select_transparent;
+  data->max_value          = max_value;
 
   return data;
 }
@@ -870,17 +1241,94 @@ static void
 line_art_result_free (LineArtResult *data)
 {
   g_object_unref (data->closed);
+  g_clear_pointer (&data->closures, g_ptr_array_unref);
   g_clear_pointer (&data->distmap, g_free);
 
   g_slice_free (LineArtResult, data);
 }
 
+static LineArtClosure *
+line_art_closure_new (Pixel   p1,
+                      Pixel   p2,
+                      GArray *pixels,
+                      GList  *seeds)
+{
+  LineArtClosure *closure = g_atomic_rc_box_new0 (LineArtClosure);
+
+  closure->p1     = p1;
+  closure->p2     = p2;
+  closure->pixels = pixels;
+  closure->seeds  = seeds;
+  closure->fills  = g_array_new (FALSE, FALSE, sizeof (Pixel));
+
+  return closure;
+}
+
+static void
+line_art_closure_free (LineArtClosure *closure)
+{
+  g_array_free (closure->pixels, TRUE);
+  g_list_free_full (closure->seeds, g_free);
+  g_array_free (closure->fills, TRUE);
+}
+
+static void
+line_art_closure_unref (LineArtClosure *closure)
+{
+  g_atomic_rc_box_release_full (closure,
+                                (GDestroyNotify) line_art_closure_free);
+}
+
+static gboolean
+line_art_closure_ends_in (LineArtClosure      *closure,
+                          const GeglRectangle *rect)
+{
+  return (closure->p1.x >= rect->x && closure->p1.x < rect->x + rect->width &&
+          closure->p1.y >= rect->y && closure->p1.y < rect->y + rect->height) ||
+         (closure->p2.x >= rect->x && closure->p2.x < rect->x + rect->width &&
+          closure->p2.y >= rect->y && closure->p2.y < rect->y + rect->height);
+}
+
+static void
+line_art_closures_translate (GPtrArray *closures,
+                             gint       dx,
+                             gint       dy)
+{
+  gint i;
+  gint j;
+
+  if (dx == 0 && dy == 0)
+    return;
+
+  for (i = 0; i < closures->len; i++)
+    {
+      LineArtClosure *closure = g_ptr_array_index (closures, i);
+
+      closure->p1.x += dx;
+      closure->p1.y += dy;
+      closure->p2.x += dx;
+      closure->p2.y += dy;
+
+      for (j = 0; j < closure->pixels->len; j++)
+        {
+          g_array_index (closure->pixels, Pixel, j).x += dx;
+          g_array_index (closure->pixels, Pixel, j).y += dy;
+        }
+
+      for (j = 0; j < closure->fills->len; j++)
+        {
+          g_array_index (closure->fills, Pixel, j).x += dx;
+          g_array_index (closure->fills, Pixel, j).y += dy;
+        }
+    }
+}
+
 static gboolean
 gimp_line_art_idle (GimpLineArt *line_art)
 {
   line_art->priv->idle_id = 0;
 
-  gimp_line_art_compute (line_art);
+  gimp_line_art_update (line_art);
 
   return G_SOURCE_REMOVE;
 }
@@ -889,6 +1337,10 @@ static void
 gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
                                         GimpLineArt  *line_art)
 {
+  /* We don't know what changed, unless an "update" told us. */
+  if (gegl_rectangle_is_empty (&line_art->priv->update_area))
+    line_art->priv->update_all = TRUE;
+
   if (! line_art->priv->idle_id)
     {
       line_art->priv->idle_id = g_idle_add_full (
@@ -898,6 +1350,23 @@ gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
     }
 }
 
+static void
+gimp_line_art_input_update (GimpDrawable *drawable,
+                            gint          x,
+                            gint          y,
+                            gint          width,
+                            gint          height,
+                            GimpLineArt  *line_art)
+{
+  GeglRectangle area = { x, y, width, height };
+
+  if (gegl_rectangle_is_empty (&line_art->priv->update_area))
+    line_art->priv->update_area = area;
+  else
+    gegl_rectangle_bounding_box (&line_art->priv->update_area,
+                                 &line_art->priv->update_area, &area);
+}
+
 /* All actual computation functions. */
 
 /**
@@ -905,6 +1374,8 @@ gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
  * @buffer: the input #GeglBuffer.
  * @select_transparent: whether we binarize the alpha channel or the
  *                      luminosity.
+ * @max_value: the biggest gray level of @buffer, used to invert it when
+ *             @select_transparent is %FALSE.
  * @stroke_threshold: [0-1] threshold value for detecting stroke pixels
  *                    (higher values will detect more stroke pixels).
  * @automatic_closure: whether the closing step should be performed or
@@ -929,6 +1400,12 @@ gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
  * @created_regions_significant_area:
  * @created_regions_minimum_area:
  * @small_segments_from_spline_sources:
+ * @keypoint_area: if not %NULL, only end points inside this area are
+ *                 closed.
+ * @closed_strokes: if not %NULL, returns the denoised strokes, before
+ *                  closing.
+ * @closed_closures: if not %NULL, returns a #GPtrArray of the splines
+ *                   and segments which were drawn.
  * @closed_distmap: a distance map of the closed line art pixels.
  * @async: the #GimpAsync associated with the computation
  *
@@ -951,33 +1428,37 @@ gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
  *          for overflowing created masks later.
  */
 static GeglBuffer *
-gimp_line_art_close (GeglBuffer  *buffer,
-                     gboolean     select_transparent,
-                     gdouble      stroke_threshold,
-                     gboolean     automatic_closure,
-                     gint         spline_max_length,
-                     gint         segment_max_length,
-                     gint         minimal_lineart_area,
-                     gint         normal_estimate_mask_size,
-                     gfloat       end_point_rate,
-                     gfloat       spline_max_angle,
-                     gint         end_point_connectivity,
-                     gfloat       spline_roundness,
-                     gboolean     allow_self_intersections,
-                     gint         created_regions_significant_area,
-                     gint         created_regions_minimum_area,
-                     gboolean     small_segments_from_spline_sources,
-                     gfloat     **closed_distmap,
-                     GimpAsync   *async)
-{
-  const Babl         *gray_format;
-  GeglBufferIterator *gi;
-  GeglBuffer         *closed  = NULL;
-  GeglBuffer         *strokes = NULL;
-  guchar              max_value = 0;
-  gint                width  = gegl_buffer_get_width (buffer);
-  gint                height = gegl_buffer_get_height (buffer);
-  gint                i;
+gimp_line_art_close (GeglBuffer          *buffer,
+                     gboolean             select_transparent,
+                     guchar               max_value,
+                     gdouble              stroke_threshold,
+                     gboolean             automatic_closure,
+                     gint                 spline_max_length,
+                     gint                 segment_max_length,
+                     gint                 minimal_lineart_area,
+                     gint                 normal_estimate_mask_size,
+                     gfloat               end_point_rate,
+                     gfloat               spline_max_angle,
+                     gint                 end_point_connectivity,
+                     gfloat               spline_roundness,
+                     gboolean             allow_self_intersections,
+                     gint                 created_regions_significant_area,
+                     gint                 created_regions_minimum_area,
+                     gboolean             small_segments_from_spline_sources,
+                     const GeglRectangle *keypoint_area,
+                     GeglBuffer         **closed_strokes,
+                     GPtrArray          **closed_closures,
+                     gfloat             **closed_distmap,
+                     GimpAsync           *async)
+{
+  const Babl          *gray_format;
+  LineArtBinarizeData  binarize_data;
+  GeglBuffer          *closed   = NULL;
+  GeglBuffer          *strokes  = NULL;
+  GPtrArray           *closures = NULL;
+  gint                 width  = gegl_buffer_get_width (buffer);
+  gint                 height = gegl_buffer_get_height (buffer);
+  gint                 i;
 
   if (select_transparent)
     /* Keep alpha channel as gray levels */
@@ -992,63 +1473,24 @@ gimp_line_art_close (GeglBuffer  *buffer,
   gimp_gegl_buffer_copy (buffer, NULL, GEGL_ABYSS_NONE, strokes, NULL);
   gegl_buffer_set_format (strokes, babl_format ("Y' u8"));
 
-  if (! select_transparent)
-    {
-      /* Compute the biggest value */
-      gi = gegl_buffer_iterator_new (strokes, NULL, 0, NULL,
-                                     GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
-      while (gegl_buffer_iterator_next (gi))
-        {
-          guchar *data = (guchar*) gi->items[0].data;
-          gint    k;
-
-          if (gimp_async_is_canceled (async))
-            {
-              gegl_buffer_iterator_stop (gi);
-
-              gimp_async_abort (async);
-
-              goto end1;
-            }
-
-          for (k = 0; k < gi->length; k++)
-            {
-              if (*data > max_value)
-                max_value = *data;
-              data++;
-            }
-        }
-    }
+  binarize_data.buffer             = strokes;
+  binarize_data.async              = async;
+  binarize_data.select_transparent = select_transparent;
+  binarize_data.threshold          = (guchar) (255.0f * (1.0f - stroke_threshold));
+  binarize_data.max_value          = max_value;
 
   /* Make the image binary: 1 is stroke, 0 background */
-  gi = gegl_buffer_iterator_new (strokes, NULL, 0, NULL,
-                                 GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE, 1);
-  while (gegl_buffer_iterator_next (gi))
-    {
-      guchar *data = (guchar*) gi->items[0].data;
-      gint    k;
-
-      if (gimp_async_is_canceled (async))
-        {
-          gegl_buffer_iterator_stop (gi);
-
-          gimp_async_abort (async);
+  gegl_parallel_distribute_area (
+    gegl_buffer_get_extent (strokes), PIXELS_PER_THREAD,
+    GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_line_art_binarize_area,
+    &binarize_data);
 
-          goto end1;
-        }
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
 
-      for (k = 0; k < gi->length; k++)
-        {
-          if (! select_transparent)
-            /* Negate the value. */
-            *data = max_value - *data;
-          /* Apply a threshold. */
-          if (*data > (guchar) (255.0f * (1.0f - stroke_threshold)))
-            *data = 1;
-          else
-            *data = 0;
-          data++;
-        }
+      goto end1;
     }
 
   /* Denoise (remove small connected components) */
@@ -1056,7 +1498,11 @@ gimp_line_art_close (GeglBuffer  *buffer,
   if (gimp_async_is_stopped (async))
     goto end1;
 
-  closed = g_object_ref (strokes);
+  if (closed_strokes)
+    *closed_strokes = gimp_gegl_buffer_dup (strokes);
+
+  closed   = g_object_ref (strokes);
+  closures = g_ptr_array_new_with_free_func ((GDestroyNotify) line_art_closure_unref);
 
   if (automatic_closure &&
       (spline_max_length > 0 || segment_max_length > 0))
@@ -1067,11 +1513,10 @@ gimp_line_art_close (GeglBuffer  *buffer,
       gfloat     *normals             = NULL;
       gfloat     *curvatures          = NULL;
       gfloat     *smoothed_curvatures = NULL;
-      gfloat      threshold;
-      gfloat      clamped_threshold;
-      GList      *fill_pixels         = NULL;
       GList      *iter;
 
+      CurvatureThresholdData  threshold_data;
+
       normals             = g_new0 (gfloat, width * height * 2);
       curvatures          = g_new0 (gfloat, width * height);
       smoothed_curvatures = g_new0 (gfloat, width * height);
@@ -1087,28 +1532,27 @@ gimp_line_art_close (GeglBuffer  *buffer,
       radii = gimp_lineart_estimate_strokes_radii (strokes, async);
       if (gimp_async_is_stopped (async))
         goto end2;
-      threshold = 1.0f - end_point_rate;
-      clamped_threshold = MAX (0.25f, threshold);
-      for (i = 0; i < width; i++)
-        {
-          gint j;
 
-          if (gimp_async_is_canceled (async))
-            {
-              gimp_async_abort (async);
+      threshold_data.curvatures          = curvatures;
+      threshold_data.smoothed_curvatures = smoothed_curvatures;
+      threshold_data.radii               = radii;
+      threshold_data.width               = width;
+      threshold_data.threshold           = 1.0f - end_point_rate;
+      threshold_data.clamped_threshold   = MAX (0.25f, threshold_data.threshold);
+      threshold_data.async               = async;
 
-              goto end2;
-            }
+      gegl_parallel_distribute_range (
+        height, MAX (1, PIXELS_PER_THREAD / width),
+        (GeglParallelDistributeRangeFunc) gimp_line_art_threshold_range,
+        &threshold_data);
 
-          for (j = 0; j < height; j++)
-            {
-              if (smoothed_curvatures[i + j * width] >= (threshold / MAX (1.0f, radii[i + j * width])) ||
-                  curvatures[i + j * width] >= clamped_threshold)
-                curvatures[i + j * width] = 1.0;
-              else
-                curvatures[i + j * width] = 0.0;
-            }
+      if (gimp_async_is_canceled (async))
+        {
+          gimp_async_abort (async);
+
+          goto end2;
         }
+
       g_clear_pointer (&radii, g_free);
 
       keypoints = gimp_lineart_curvature_extremums (curvatures, smoothed_curvatures,
@@ -1116,6 +1560,29 @@ gimp_line_art_close (GeglBuffer  *buffer,
       if (gimp_async_is_stopped (async))
         goto end2;
 
+      if (keypoint_area)
+        {
+          gint j = 0;
+
+          /* Drop end points whose curvature or closures may depend on
+           * pixels outside of @buffer.
+           */
+          for (i = 0; i < keypoints->len; i++)
+            {
+              Pixel p = g_array_index (keypoints, Pixel, i);
+
+              if (p.x >= keypoint_area->x                         &&
+                  p.x <  keypoint_area->x + keypoint_area->width  &&
+                  p.y >= keypoint_area->y                         &&
+                  p.y <  keypoint_area->y + keypoint_area->height)
+                {
+                  g_array_index (keypoints, Pixel, j++) = p;
+                }
+            }
+
+          g_array_set_size (keypoints, j);
+        }
+
       visited = g_hash_table_new_full ((GHashFunc) visited_hash_fun,
                                        (GEqualFunc) visited_equal_fun,
                                        (GDestroyNotify) g_free, NULL);
@@ -1167,6 +1634,7 @@ gimp_line_art_close (GeglBuffer  *buffer,
                    GPOINTER_TO_INT (g_hash_table_lookup (visited, p2)) < end_point_connectivity))
                 {
                   GArray      *discrete_curve;
+                  GList       *seeds = NULL;
                   GimpVector2  vect1 = pair2normal (*p1, normals, width);
                   GimpVector2  vect2 = pair2normal (*p2, normals, width);
                   gfloat       distance = gimp_vector2_length_val (gimp_vector2_sub_val (*p1, *p2));
@@ -1185,7 +1653,7 @@ gimp_line_art_close (GeglBuffer  *buffer,
 
                   if (transitions == 2 &&
                       gimp_line_art_allow_closure (closed, discrete_curve,
-                                                   &fill_pixels,
+                                                   &seeds,
                                                    created_regions_significant_area,
                                                    created_regions_minimum_area))
                     {
@@ -1202,13 +1670,20 @@ gimp_line_art_close (GeglBuffer  *buffer,
                                                NULL, &val, GEGL_AUTO_ROWSTRIDE);
                             }
                         }
+                      g_ptr_array_add (closures,
+                                       line_art_closure_new (*p1, *p2,
+                                                             discrete_curve,
+                                                             seeds));
                       g_hash_table_replace (visited, p1,
                                             GINT_TO_POINTER (GPOINTER_TO_INT (g_hash_table_lookup (visited, p1)) + 1));
                       g_hash_table_replace (visited, p2,
                                             GINT_TO_POINTER (GPOINTER_TO_INT (g_hash_table_lookup (visited, p2)) + 1));
                       inserted = TRUE;
                     }
-                  g_array_free (discrete_curve, TRUE);
+                  else
+                    {
+                      g_array_free (discrete_curve, TRUE);
+                    }
                 }
               if (! inserted)
                 {
@@ -1254,9 +1729,10 @@ gimp_line_art_close (GeglBuffer  *buffer,
                   GArray *segment = gimp_lineart_line_segment_until_hit (closed, *point,
                                                                          pair2normal (*point, normals, width),
                                                                          segment_max_length);
+                  GList  *seeds   = NULL;
 
                   if (segment->len &&
-                      gimp_line_art_allow_closure (closed, segment, &fill_pixels,
+                      gimp_line_art_allow_closure (closed, segment, &seeds,
                                                    created_regions_significant_area,
                                                    created_regions_minimum_area))
                     {
@@ -1270,11 +1746,19 @@ gimp_line_art_close (GeglBuffer  *buffer,
                           gegl_buffer_set (closed, GEGL_RECTANGLE ((gint) p2.x, (gint) p2.y, 1, 1), 0,
                                            NULL, &val, GEGL_AUTO_ROWSTRIDE);
                         }
+                      g_ptr_array_add (closures,
+                                       line_art_closure_new (*point,
+                                                             g_array_index (segment, Pixel,
+                                                                            segment->len - 1),
+                                                             segment, seeds));
                       g_hash_table_replace (visited, p,
                                             GINT_TO_POINTER (GPOINTER_TO_INT (g_hash_table_lookup (visited, p)) + 1));
                       inserted = TRUE;
                     }
-                  g_array_free (segment, TRUE);
+                  else
+                    {
+                      g_array_free (segment, TRUE);
+                    }
                 }
               if (! inserted)
                 g_free (p);
@@ -1282,30 +1766,38 @@ gimp_line_art_close (GeglBuffer  *buffer,
             }
         }
 
-      for (iter = fill_pixels; iter; iter = iter->next)
+      for (i = 0; i < closures->len; i++)
         {
-          Pixel *p        = iter->data;
-          gint   fill_max = created_regions_significant_area - 1;
+          LineArtClosure *closure = g_ptr_array_index (closures, i);
 
-          if (gimp_async_is_canceled (async))
+          for (iter = closure->seeds; iter; iter = iter->next)
             {
-              gimp_async_abort (async);
+              Pixel *p        = iter->data;
+              gint   fill_max = created_regions_significant_area - 1;
+
+              if (gimp_async_is_canceled (async))
+                {
+                  gimp_async_abort (async);
+
+                  goto end2;
+                }
 
-              goto end2;
+              /* XXX A best approach would be to generalize
+               * gimp_drawable_bucket_fill() to work on any buffer (the code
+               * is already mostly there) rather than reimplementing a naive
+               * bucket fill.
+               * This is mostly a quick'n dirty first implementation which I
+               * will improve later.
+               */
+              gimp_line_art_simple_fill (closed, (gint) p->x, (gint) p->y,
+                                         &fill_max, closure->fills);
             }
 
-          /* XXX A best approach would be to generalize
-           * gimp_drawable_bucket_fill() to work on any buffer (the code
-           * is already mostly there) rather than reimplementing a naive
-           * bucket fill.
-           * This is mostly a quick'n dirty first implementation which I
-           * will improve later.
-           */
-          gimp_line_art_simple_fill (closed, (gint) p->x, (gint) p->y, &fill_max);
+          g_list_free_full (closure->seeds, g_free);
+          closure->seeds = NULL;
         }
 
  end2:
-      g_list_free_full (fill_pixels, g_free);
       g_free (normals);
       g_free (curvatures);
       g_free (smoothed_curvatures);
@@ -1324,249 +1816,417 @@ gimp_line_art_close (GeglBuffer  *buffer,
 
   if (closed_distmap)
     {
-      GeglNode   *graph;
-      GeglNode   *input;
-      GeglNode   *op;
-
       /* Flooding needs a distance map for closed line art. */
-      *closed_distmap = g_new (gfloat, width * height);
-
-      graph = gegl_node_new ();
-      input = gegl_node_new_child (graph,
-                                   "operation", "gegl:buffer-source",
-                                   "buffer", closed,
-                                   NULL);
-      op  = gegl_node_new_child (graph,
-                                 "operation", "gegl:distance-transform",
-                                 "metric",    GEGL_DISTANCE_METRIC_EUCLIDEAN,
-                                 "normalize", FALSE,
-                                 NULL);
-      gegl_node_link (input, op);
-      gegl_node_blit (op, 1.0, gegl_buffer_get_extent (closed),
-                      NULL, *closed_distmap,
-                      GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
-      g_object_unref (graph);
+      *closed_distmap = gimp_line_art_get_distmap (closed);
     }
 
  end1:
   g_clear_object (&strokes);
 
   if (gimp_async_is_stopped (async))
-    g_clear_object (&closed);
+    {
+      g_clear_object (&closed);
+      g_clear_pointer (&closures, g_ptr_array_unref);
+
+      if (closed_strokes)
+        g_clear_object (closed_strokes);
+    }
+
+  if (closed_closures)
+    *closed_closures = closures;
+  else
+    g_clear_pointer (&closures, g_ptr_array_unref);
+
+  return closed;
+}
+
+/**
+ * gimp_line_art_merge:
+ * @prev_closed: the previous result of gimp_line_art_close().
+ * @prev_closures: the splines and segments drawn in @prev_closed.
+ * @strokes: the denoised strokes of @context_rect.
+ * @closures: the splines and segments found in @context_rect, in
+ *            image coordinates.
+ * @update_rect: the area to recompute.
+ * @context_rect: the area @strokes and @closures were computed on.
+ * @merged_closures: returns the splines and segments drawn in the
+ *                   merged result.
+ *
+ * Merges a closing of @context_rect into @prev_closed.  Closures are
+ * kept or dropped whole, depending on where their end points are: the
+ * previous closures with an end point in @update_rect are replaced by
+ * the new ones with an end point there, while the other previous
+ * closures are kept, even where they cross @update_rect.  The new
+ * closures with no end point in @update_rect are dropped, since their
+ * context was cut.
+ *
+ * Returns: a new #GeglBuffer with the merged closed line art.
+ */
+static GeglBuffer *
+gimp_line_art_merge (GeglBuffer           *prev_closed,
+                     GPtrArray            *prev_closures,
+                     GeglBuffer           *strokes,
+                     GPtrArray            *closures,
+                     const GeglRectangle  *update_rect,
+                     const GeglRectangle  *context_rect,
+                     GPtrArray           **merged_closures)
+{
+  GeglBuffer *closed;
+  GPtrArray  *merged;
+  gint        width  = gegl_buffer_get_width (prev_closed);
+  gint        height = gegl_buffer_get_height (prev_closed);
+  gint        i;
+  gint        j;
+
+  closed = gimp_gegl_buffer_dup (prev_closed);
+  merged = g_ptr_array_new_with_free_func ((GDestroyNotify) line_art_closure_unref);
+
+  gimp_gegl_buffer_copy (strokes,
+                         GEGL_RECTANGLE (update_rect->x - context_rect->x,
+                                         update_rect->y - context_rect->y,
+                                         update_rect->width,
+                                         update_rect->height),
+                         GEGL_ABYSS_NONE,
+                         closed, update_rect);
+
+  for (i = 0; i < prev_closures->len; i++)
+    {
+      LineArtClosure *closure = g_ptr_array_index (prev_closures, i);
+
+      if (line_art_closure_ends_in (closure, update_rect))
+        {
+          gimp_line_art_merge_erase (closed, closure->pixels,
+                                     strokes, context_rect);
+          gimp_line_art_merge_erase (closed, closure->fills,
+                                     strokes, context_rect);
+        }
+      else
+        {
+          g_ptr_array_add (merged, g_atomic_rc_box_acquire (closure));
+        }
+    }
+
+  for (i = 0; i < closures->len; i++)
+    {
+      LineArtClosure *closure = g_ptr_array_index (closures, i);
+
+      if (line_art_closure_ends_in (closure, update_rect))
+        g_ptr_array_add (merged, g_atomic_rc_box_acquire (closure));
+    }
+
+  /* Draw the closures first, then fill around them, as
+   * gimp_line_art_close() does.
+   */
+  for (i = 0; i < merged->len; i++)
+    {
+      LineArtClosure *closure = g_ptr_array_index (merged, i);
+
+      for (j = 0; j < closure->pixels->len; j++)
+        {
+          Pixel  p   = g_array_index (closure->pixels, Pixel, j);
+          guchar val = 2;
+
+          if (p.x >= 0 && p.x < width &&
+              p.y >= 0 && p.y < height)
+            {
+              gegl_buffer_set (closed, GEGL_RECTANGLE ((gint) p.x, (gint) p.y, 1, 1), 0,
+                               NULL, &val, GEGL_AUTO_ROWSTRIDE);
+            }
+        }
+    }
+
+  for (i = 0; i < merged->len; i++)
+    {
+      LineArtClosure *closure = g_ptr_array_index (merged, i);
+
+      for (j = 0; j < closure->fills->len; j++)
+        {
+          Pixel  p = g_array_index (closure->fills, Pixel, j);
+          guchar val;
+
+          gegl_buffer_sample (closed, (gint) p.x, (gint) p.y, NULL, &val,
+                              NULL, GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
+
+          if (! val)
+            {
+              val = 1;
+              gegl_buffer_set (closed, GEGL_RECTANGLE ((gint) p.x, (gint) p.y, 1, 1), 0,
+                               NULL, &val, GEGL_AUTO_ROWSTRIDE);
+            }
+        }
+    }
+
+  *merged_closures = merged;
 
   return closed;
 }
 
 static void
-gimp_lineart_denoise (GeglBuffer *buffer,
-                      int         minimum_area,
-                      GimpAsync  *async)
+gimp_line_art_merge_erase (GeglBuffer          *closed,
+                           GArray              *pixels,
+                           GeglBuffer          *strokes,
+                           const GeglRectangle *context_rect)
 {
-  /* Keep connected regions with significant area. */
-  GArray   *region;
-  GQueue   *q       = g_queue_new ();
-  gint      width   = gegl_buffer_get_width (buffer);
-  gint      height  = gegl_buffer_get_height (buffer);
-  gboolean *visited = g_new0 (gboolean, width * height);
-  gint      x, y;
+  gint i;
 
-  region = g_array_sized_new (TRUE, TRUE, sizeof (Pixel *), minimum_area);
+  for (i = 0; i < pixels->len; i++)
+    {
+      Pixel  p = g_array_index (pixels, Pixel, i);
+      guchar val;
 
-  for (y = 0; y < height; ++y)
-    for (x = 0; x < width; ++x)
-      {
-        guchar has_stroke;
+      /* Closures ending in the updated area stay well inside the
+       * context, whose strokes are what was under them.
+       */
+      if (p.x < context_rect->x || p.x >= context_rect->x + context_rect->width ||
+          p.y < context_rect->y || p.y >= context_rect->y + context_rect->height)
+        continue;
+
+      gegl_buffer_sample (strokes,
+                          (gint) p.x - context_rect->x,
+                          (gint) p.y - context_rect->y,
+                          NULL, &val,
+                          NULL, GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
+      gegl_buffer_set (closed, GEGL_RECTANGLE ((gint) p.x, (gint) p.y, 1, 1), 0,
+                       NULL, &val, GEGL_AUTO_ROWSTRIDE);
+    }
+}
 
-        if (gimp_async_is_canceled (async))
-          {
-            gimp_async_abort (async);
+static guchar
+gimp_line_art_get_max_value (GeglBuffer *buffer,
+                             GimpAsync  *async)
+{
+  LineArtBinarizeData data;
 
-            goto end;
-          }
+  data.buffer    = buffer;
+  data.async     = async;
+  data.max_value = 0;
+  g_mutex_init (&data.mutex);
 
-        gegl_buffer_sample (buffer, x, y, NULL, &has_stroke, NULL,
-                            GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-        if (has_stroke && ! visited[x + y * width])
-          {
-            Pixel *p = g_new (Pixel, 1);
-            gint   regionSize = 0;
+  gegl_parallel_distribute_area (
+    gegl_buffer_get_extent (buffer), PIXELS_PER_THREAD,
+    GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_line_art_max_value_area,
+    &data);
 
-            p->x = x;
-            p->y = y;
+  g_mutex_clear (&data.mutex);
 
-            g_queue_push_tail (q, p);
-            visited[x + y * width] = TRUE;
+  if (gimp_async_is_canceled (async))
+    gimp_async_abort (async);
 
-            while (! g_queue_is_empty (q))
-              {
-                Pixel *p;
-                gint   p2x;
-                gint   p2y;
+  return data.max_value;
+}
 
-                if (gimp_async_is_canceled (async))
-                  {
-                    gimp_async_abort (async);
+static gfloat *
+gimp_line_art_get_distmap (GeglBuffer *closed)
+{
+  GeglNode *graph;
+  GeglNode *input;
+  GeglNode *op;
+  gfloat   *distmap;
 
-                    goto end;
-                  }
+  distmap = g_new (gfloat, gegl_buffer_get_width (closed) *
+                           gegl_buffer_get_height (closed));
+
+  graph = gegl_node_new ();
+  input = gegl_node_new_child (graph,
+                               "operation", "gegl:buffer-source",
+                               "buffer", closed,
+                               NULL);
+  op  = gegl_node_new_child (graph,
+                             "operation", "gegl:distance-transform",
+                             "metric",    GEGL_DISTANCE_METRIC_EUCLIDEAN,
+                             "normalize", FALSE,
+                             NULL);
+  gegl_node_link (input, op);
+  gegl_node_blit (op, 1.0, gegl_buffer_get_extent (closed),
+                  NULL, distmap,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  g_object_unref (graph);
 
-                p = (Pixel *) g_queue_pop_head (q);
+  return distmap;
+}
 
-                p2x = p->x + 1;
-                p2y = p->y;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+static void
+gimp_line_art_max_value_area (const GeglRectangle *area,
+                              LineArtBinarizeData *data)
+{
+  GeglBufferIterator *gi;
+  guchar              max_value = 0;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x +p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x - 1;
-                p2y = p->y;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+  gi = gegl_buffer_iterator_new (data->buffer, area, 0, babl_format ("Y' u8"),
+                                 GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+  while (gegl_buffer_iterator_next (gi))
+    {
+      guchar *p = (guchar*) gi->items[0].data;
+      gint    k;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x;
-                p2y = p->y - 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+      if (gimp_async_is_canceled (data->async))
+        {
+          gegl_buffer_iterator_stop (gi);
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x;
-                p2y = p->y + 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+          return;
+        }
+
+      for (k = 0; k < gi->length; k++)
+        {
+          if (*p > max_value)
+            max_value = *p;
+          p++;
+        }
+    }
+
+  g_mutex_lock (&data->mutex);
+
+  data->max_value = MAX (data->max_value, max_value);
+
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+gimp_line_art_binarize_area (const GeglRectangle *area,
+                             LineArtBinarizeData *data)
+{
+  GeglBufferIterator *gi;
+
+  gi = gegl_buffer_iterator_new (data->buffer, area, 0, NULL,
+                                 GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE, 1);
+  while (gegl_buffer_iterator_next (gi))
+    {
+      guchar *p = (guchar*) gi->items[0].data;
+      gint    k;
+
+      if (gimp_async_is_canceled (data->async))
+        {
+          gegl_buffer_iterator_stop (gi);
+
+          return;
+        }
+
+      for (k = 0; k < gi->length; k++)
+        {
+          if (! data->select_transparent)
+            /* Negate the value. */
+            *p = data->max_value - *p;
+          /* Apply a threshold. */
+          if (*p > data->threshold)
+            *p = 1;
+          else
+            *p = 0;
+          p++;
+        }
+    }
+}
+
+static void
+gimp_line_art_threshold_range (gint                    offset,
+                               gint                    size,
+                               CurvatureThresholdData *data)
+{
+  gint y;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      gfloat *curvatures          = data->curvatures          + y * data->width;
+      gfloat *smoothed_curvatures = data->smoothed_curvatures + y * data->width;
+      gfloat *radii               = data->radii               + y * data->width;
+      gint    x;
+
+      if (gimp_async_is_canceled (data->async))
+        return;
+
+      for (x = 0; x < data->width; x++)
+        {
+          if (smoothed_curvatures[x] >= (data->threshold / MAX (1.0f, radii[x])) ||
+              curvatures[x] >= data->clamped_threshold)
+            curvatures[x] = 1.0;
+          else
+            curvatures[x] = 0.0;
+        }
+    }
+}
+
+static void
+gimp_lineart_denoise (GeglBuffer *buffer,
+                      int         minimum_area,
+                      GimpAsync  *async)
+{
+  /* Keep connected regions with significant area.  The mask is read
+   * once into memory, visited pixels are marked as 2 and the region
+   * being grown is the head of the queue itself, so no per-pixel
+   * buffer access or allocation is needed.
+   */
+  gint    width  = gegl_buffer_get_width (buffer);
+  gint    height = gegl_buffer_get_height (buffer);
+  guchar *mask   = g_new (guchar, (gsize) width * height);
+  gint   *queue  = g_new (gint, (gsize) width * height);
+  gint    x, y;
+  gint    i;
+
+  gegl_buffer_get (buffer, NULL, 1.0, NULL, mask,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (y = 0; y < height; ++y)
+    {
+      if (gimp_async_is_canceled (async))
+        {
+          gimp_async_abort (async);
+
+          goto end;
+        }
+
+      for (x = 0; x < width; ++x)
+        {
+          gint head = 0;
+          gint tail = 0;
+
+          if (mask[x + y * width] != 1)
+            continue;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x + 1;
-                p2y = p->y + 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+          queue[tail++] = x + y * width;
+          mask[x + y * width] = 2;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x - 1;
-                p2y = p->y - 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+          while (head < tail)
+            {
+              gint px = queue[head] % width;
+              gint py = queue[head] / width;
+              gint dx, dy;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x - 1;
-                p2y = p->y + 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
-                  {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+              head++;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
-                      }
-                  }
-                p2x = p->x + 1;
-                p2y = p->y - 1;
-                if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height)
+              for (dy = -1; dy <= 1; dy++)
+                for (dx = -1; dx <= 1; dx++)
                   {
-                    gegl_buffer_sample (buffer, p2x, p2y, NULL, &has_stroke, NULL,
-                                        GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-                    if (has_stroke && ! visited[p2x + p2y * width])
-                      {
-                        Pixel *p2 = g_new (Pixel, 1);
+                    gint p2x = px + dx;
+                    gint p2y = py + dy;
 
-                        p2->x = p2x;
-                        p2->y = p2y;
-                        g_queue_push_tail (q, p2);
-                        visited[p2x + p2y * width] = TRUE;
+                    if (p2x >= 0 && p2x < width && p2y >= 0 && p2y < height &&
+                        mask[p2x + p2y * width] == 1)
+                      {
+                        queue[tail++] = p2x + p2y * width;
+                        mask[p2x + p2y * width] = 2;
                       }
                   }
+            }
 
-                ++regionSize;
-                if (regionSize < minimum_area)
-                  g_array_append_val (region, *p);
-                g_free (p);
-              }
-            if (regionSize < minimum_area)
-              {
-                Pixel *pixel = (Pixel *) region->data;
-                gint   i = 0;
+          if (tail < minimum_area)
+            {
+              for (i = 0; i < tail; i++)
+                mask[queue[i]] = 0;
+            }
+        }
+    }
 
-                for (; i < region->len; i++)
-                  {
-                    guchar val = 0;
-                    gegl_buffer_set (buffer, GEGL_RECTANGLE (pixel->x, pixel->y, 1, 1), 0,
-                                     NULL, &val, GEGL_AUTO_ROWSTRIDE);
-                    pixel++;
-                  }
-              }
-            g_array_remove_range (region, 0, region->len);
-          }
-      }
+  for (i = 0; i < width * height; i++)
+    {
+      if (mask[i])
+        mask[i] = 1;
+    }
+
+  gegl_buffer_set (buffer, NULL, 0, NULL, mask, GEGL_AUTO_ROWSTRIDE);
 
  end:
-  g_array_free (region, TRUE);
-  g_queue_free_full (q, g_free);
-  g_free (visited);
+  g_free (queue);
+  g_free (mask);
 }
 
 static void
@@ -1577,11 +2237,16 @@ gimp_lineart_compute_normals_curvatures (GeglBuffer *mask,
                                          int         normal_estimate_mask_size,
                                          GimpAsync  *async)
 {
-  gfloat  *edgels_curvatures  = NULL;
-  gfloat  *smoothed_curvature;
-  GArray  *es                 = NULL;
-  Edgel  **e;
-  gint     width              = gegl_buffer_get_width (mask);
+  NormalsData   normals_data;
+  gfloat       *edgels_curvatures  = NULL;
+  gfloat       *smoothed_curvature;
+  GArray       *es                 = NULL;
+  Edgel       **e;
+  gint          width              = gegl_buffer_get_width (mask);
+
+  normals_data.normals = normals;
+  normals_data.width   = width;
+  normals_data.async   = async;
 
   es = gimp_edgelset_new (mask, async);
   if (gimp_async_is_stopped (async))
@@ -1615,22 +2280,17 @@ gimp_lineart_compute_normals_curvatures (GeglBuffer *mask,
                                                    curvatures[(*e)->x + (*e)->y * width]);
       e++;
     }
-  for (int y = 0; y < gegl_buffer_get_height (mask); ++y)
-    {
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
 
-          goto end;
-        }
+  gegl_parallel_distribute_range (
+    gegl_buffer_get_height (mask), MAX (1, PIXELS_PER_THREAD / width),
+    (GeglParallelDistributeRangeFunc) gimp_lineart_normalize_normals_range,
+    &normals_data);
 
-      for (int x = 0; x < gegl_buffer_get_width (mask); ++x)
-        {
-          const float _angle = atan2f (normals[(x + y * width) * 2 + 1],
-                                       normals[(x + y * width) * 2]);
-          normals[(x + y * width) * 2] = cosf (_angle);
-          normals[(x + y * width) * 2 + 1] = sinf (_angle);
-        }
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
+
+      goto end;
     }
 
   /* Smooth curvatures on edgels, then take maximum on each pixel. */
@@ -1659,56 +2319,104 @@ gimp_lineart_compute_normals_curvatures (GeglBuffer *mask,
     g_array_free (es, TRUE);
 }
 
+static void
+gimp_lineart_normalize_normals_range (gint         offset,
+                                      gint         size,
+                                      NormalsData *data)
+{
+  gint y;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      gfloat *normal = data->normals + (gsize) y * data->width * 2;
+      gint    x;
+
+      if (gimp_async_is_canceled (data->async))
+        return;
+
+      for (x = 0; x < data->width; x++)
+        {
+          const float _angle = atan2f (normal[1], normal[0]);
+
+          normal[0] = cosf (_angle);
+          normal[1] = sinf (_angle);
+          normal += 2;
+        }
+    }
+}
+
 static gfloat *
 gimp_lineart_get_smooth_curvatures (GArray    *edgelset,
                                     GimpAsync *async)
 {
-  Edgel  **e;
-  gfloat  *smoothed_curvatures = g_new0 (gfloat, edgelset->len);
-  gfloat   weights[9];
-  gfloat   smoothed_curvature;
-  gfloat   weights_sum;
-  gint     idx = 0;
+  EdgelSetData  data;
+  gfloat       *smoothed_curvatures = g_new0 (gfloat, edgelset->len);
+  gfloat        weights[9];
 
   weights[0] = 1.0f;
   for (int i = 1; i <= 8; ++i)
     weights[i] = expf (-(i * i) / 30.0f);
 
-  e = (Edgel **) edgelset->data;
-  while (*e)
+  data.set                 = edgelset;
+  data.weights             = weights;
+  data.smoothed_curvatures = smoothed_curvatures;
+  data.async               = async;
+
+  /* Each edgel only reads its neighbors' curvature and writes its own
+   * slot, so the result doesn't depend on how the set is split.
+   */
+  gegl_parallel_distribute_range (
+    edgelset->len, EDGELS_PER_THREAD,
+    (GeglParallelDistributeRangeFunc) gimp_lineart_smooth_curvatures_range,
+    &data);
+
+  if (gimp_async_is_canceled (async))
     {
-      Edgel *edgel_before = g_array_index (edgelset, Edgel*, (*e)->previous);
-      Edgel *edgel_after  = g_array_index (edgelset, Edgel*, (*e)->next);
-      int    n = 5;
-      int    i = 1;
+      gimp_async_abort (async);
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+      g_free (smoothed_curvatures);
 
-          g_free (smoothed_curvatures);
+      return NULL;
+    }
 
-          return NULL;
-        }
+  return smoothed_curvatures;
+}
+
+static void
+gimp_lineart_smooth_curvatures_range (gint          offset,
+                                      gint          size,
+                                      EdgelSetData *data)
+{
+  GArray *edgelset = data->set;
+  gint    idx;
 
-      smoothed_curvature = (*e)->curvature;
-      weights_sum = weights[0];
+  for (idx = offset; idx < offset + size; idx++)
+    {
+      Edgel  *e            = g_array_index (edgelset, Edgel*, idx);
+      Edgel  *edgel_before = g_array_index (edgelset, Edgel*, e->previous);
+      Edgel  *edgel_after  = g_array_index (edgelset, Edgel*, e->next);
+      gfloat  smoothed_curvature;
+      gfloat  weights_sum;
+      int     n = 5;
+      int     i = 1;
+
+      if (gimp_async_is_canceled (data->async))
+        return;
+
+      smoothed_curvature = e->curvature;
+      weights_sum = data->weights[0];
       while (n-- && (edgel_after != edgel_before))
         {
-          smoothed_curvature += weights[i] * edgel_before->curvature;
-          smoothed_curvature += weights[i] * edgel_after->curvature;
+          smoothed_curvature += data->weights[i] * edgel_before->curvature;
+          smoothed_curvature += data->weights[i] * edgel_after->curvature;
           edgel_before = g_array_index (edgelset, Edgel*, edgel_before->previous);
           edgel_after  = g_array_index (edgelset, Edgel*, edgel_after->next);
-          weights_sum += 2 * weights[i];
+          weights_sum += 2 * data->weights[i];
           i++;
         }
       smoothed_curvature /= weights_sum;
-      smoothed_curvatures[idx++] = smoothed_curvature;
-
-      e++;
+      data->smoothed_curvatures[idx] = smoothed_curvature;
     }
-
-  return smoothed_curvatures;
 }
 
 /**
@@ -1937,20 +2645,23 @@ gimp_lineart_curvature_extremums (gfloat    *curvatures,
 }
 
 static gint
-gimp_spline_candidate_cmp (const SplineCandidate *a,
-                           const SplineCandidate *b,
-                           gpointer               user_data)
+gimp_spline_candidate_entry_cmp (const SplineCandidateEntry *a,
+                                 const SplineCandidateEntry *b)
 {
   /* This comparison actually returns the opposite of common comparison
    * functions on purpose, as we want the first element on the list to
-   * be the "bigger".
+   * be the "bigger".  Ties are broken by putting the pair found last
+   * first, so the order is the same as when candidates were inserted
+   * one by one in a sorted list.
    */
-  if (a->quality < b->quality)
+  if (a->candidate.quality < b->candidate.quality)
     return 1;
-  else if (a->quality > b->quality)
+  else if (a->candidate.quality > b->candidate.quality)
     return -1;
+  else if (a->i != b->i)
+    return b->i - a->i;
   else
-    return 0;
+    return b->j - a->j;
 }
 
 static GList *
@@ -1961,30 +2672,84 @@ gimp_lineart_find_spline_candidates (GArray    *max_positions,
                                      gfloat     max_angle_deg,
                                      GimpAsync *async)
 {
-  GList       *candidates = NULL;
-  const float  CosMin     = cosf (M_PI * (max_angle_deg / 180.0));
-  gint         i;
+  SplineCandidatesData  data;
+  GList                *candidates = NULL;
+  gint                  i;
+
+  data.max_positions      = max_positions;
+  data.normals            = normals;
+  data.width              = width;
+  data.distance_threshold = distance_threshold;
+  data.cos_min            = cosf (M_PI * (max_angle_deg / 180.0));
+  data.candidates         = g_array_new (FALSE, FALSE,
+                                         sizeof (SplineCandidateEntry));
+  data.async              = async;
+  g_mutex_init (&data.mutex);
 
-  for (i = 0; i < max_positions->len; i++)
+  gegl_parallel_distribute (
+    -1,
+    (GeglParallelDistributeFunc) gimp_lineart_spline_candidates_func,
+    &data);
+
+  g_mutex_clear (&data.mutex);
+
+  if (gimp_async_is_canceled (async))
     {
-      Pixel p1 = g_array_index (max_positions, Pixel, i);
-      gint  j;
+      gimp_async_abort (async);
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+      g_array_free (data.candidates, TRUE);
 
-          g_list_free_full (candidates, g_free);
+      return NULL;
+    }
 
-          return NULL;
-        }
+  g_array_sort (data.candidates,
+                (GCompareFunc) gimp_spline_candidate_entry_cmp);
+
+  for (i = data.candidates->len - 1; i >= 0; i--)
+    {
+      SplineCandidateEntry *entry;
+
+      entry = &g_array_index (data.candidates, SplineCandidateEntry, i);
+
+      candidates = g_list_prepend (candidates,
+                                   g_memdup2 (&entry->candidate,
+                                              sizeof (SplineCandidate)));
+    }
+
+  g_array_free (data.candidates, TRUE);
+
+  return candidates;
+}
+
+static void
+gimp_lineart_spline_candidates_func (gint                  i,
+                                     gint                  n,
+                                     SplineCandidatesData *data)
+{
+  GArray *max_positions = data->max_positions;
+  gfloat *normals       = data->normals;
+  gint    width         = data->width;
+  GArray *candidates;
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (SplineCandidateEntry));
+
+  /* The work for each point decreases with its index, so points are
+   * dealt out round-robin rather than in contiguous ranges.
+   */
+  for (; i < max_positions->len; i += n)
+    {
+      Pixel p1 = g_array_index (max_positions, Pixel, i);
+      gint  j;
+
+      if (gimp_async_is_canceled (data->async))
+        break;
 
       for (j = i + 1; j < max_positions->len; j++)
         {
           Pixel       p2 = g_array_index (max_positions, Pixel, j);
           const float distance = gimp_vector2_length_val (gimp_vector2_sub_val (p1, p2));
 
-          if (distance <= distance_threshold)
+          if (distance <= data->distance_threshold)
             {
               GimpVector2 normalP1;
               GimpVector2 normalP2;
@@ -2006,28 +2771,39 @@ gimp_lineart_find_spline_candidates (GArray    *max_positions,
               p1p2 = gimp_vector2_sub_val (p2f, p1f);
 
               cosN = gimp_vector2_inner_product_val (normalP1, (gimp_vector2_neg_val (normalP2)));
-              qualityA = MAX (0.0f, 1 - distance / distance_threshold);
+              qualityA = MAX (0.0f, 1 - distance / data->distance_threshold);
               qualityB = MAX (0.0f,
                               (float) (gimp_vector2_inner_product_val (normalP1, p1p2) - gimp_vector2_inner_product_val (normalP2, p1p2)) /
                               distance);
-              qualityC = MAX (0.0f, cosN - CosMin);
+              qualityC = MAX (0.0f, cosN - data->cos_min);
               quality = qualityA * qualityB * qualityC;
               if (quality > 0)
                 {
-                  SplineCandidate *candidate = g_new (SplineCandidate, 1);
+                  SplineCandidateEntry entry;
 
-                  candidate->p1      = p1;
-                  candidate->p2      = p2;
-                  candidate->quality = quality;
+                  entry.candidate.p1      = p1;
+                  entry.candidate.p2      = p2;
+                  entry.candidate.quality = quality;
+                  entry.i                 = i;
+                  entry.j                 = j;
 
-                  candidates = g_list_insert_sorted_with_data (candidates, candidate,
-                                                               (GCompareDataFunc) gimp_spline_candidate_cmp,
-                                                               NULL);
+                  g_array_append_val (candidates, entry);
                 }
             }
         }
     }
-  return candidates;
+
+  if (candidates->len > 0)
+    {
+      g_mutex_lock (&data->mutex);
+
+      g_array_append_vals (data->candidates,
+                           candidates->data, candidates->len);
+
+      g_mutex_unlock (&data->mutex);
+    }
+
+  g_array_free (candidates, TRUE);
 }
 
 static GArray *
@@ -2320,17 +3096,15 @@ static gfloat *
 gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                                      GimpAsync  *async)
 {
-  GeglBufferIterator *gi;
-  gfloat             *dist;
-  gfloat             *thickness;
-  GeglNode           *graph;
-  GeglNode           *input;
-  GeglNode           *op;
-  gint                width  = gegl_buffer_get_width (mask);
-  gint                height = gegl_buffer_get_height (mask);
+  StrokesRadiiData  data;
+  GeglNode         *graph;
+  GeglNode         *input;
+  GeglNode         *op;
+  gint              width  = gegl_buffer_get_width (mask);
+  gint              height = gegl_buffer_get_height (mask);
 
   /* Compute a distance map for the line art. */
-  dist = g_new (gfloat, width * height);
+  data.dist = g_new (gfloat, width * height);
 
   graph = gegl_node_new ();
   input = gegl_node_new_child (graph,
@@ -2344,11 +3118,41 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                              NULL);
   gegl_node_link (input, op);
   gegl_node_blit (op, 1.0, gegl_buffer_get_extent (mask),
-                  NULL, dist, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+                  NULL, data.dist, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
   g_object_unref (graph);
 
-  thickness = g_new0 (gfloat, width * height);
-  gi = gegl_buffer_iterator_new (mask, NULL, 0, NULL,
+  data.mask      = mask;
+  data.thickness = g_new0 (gfloat, width * height);
+  data.width     = width;
+  data.height    = height;
+  data.async     = async;
+
+  /* Each border pixel climbs the distance map independently. */
+  gegl_parallel_distribute_area (
+    gegl_buffer_get_extent (mask), PIXELS_PER_THREAD,
+    GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_lineart_strokes_radii_area,
+    &data);
+
+  g_free (data.dist);
+
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
+
+      g_clear_pointer (&data.thickness, g_free);
+    }
+
+  return data.thickness;
+}
+
+static void
+gimp_lineart_strokes_radii_area (const GeglRectangle *area,
+                                 StrokesRadiiData    *data)
+{
+  GeglBufferIterator *gi;
+
+  gi = gegl_buffer_iterator_new (data->mask, area, 0, NULL,
                                  GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
   while (gegl_buffer_iterator_next (gi))
     {
@@ -2360,19 +3164,17 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
       gint    x;
       gint    y;
 
-      if (gimp_async_is_canceled (async))
+      if (gimp_async_is_canceled (data->async))
         {
           gegl_buffer_iterator_stop (gi);
 
-          gimp_async_abort (async);
-
-          goto end;
+          return;
         }
 
       for (y = starty; y < endy; y++)
         for (x = startx; x < endx; x++)
           {
-            if (*m && dist[x + y * width] == 1.0)
+            if (*m && data->dist[x + y * data->width] == 1.0)
               {
                 gint     dx = x;
                 gint     dy = y;
@@ -2390,14 +3192,14 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                     neighbour_thicker = FALSE;
                     if (px >= 0)
                       {
-                        if ((nd = dist[px + dy * width]) > d)
+                        if ((nd = data->dist[px + dy * data->width]) > d)
                           {
                             d = nd;
                             dx = px;
                             neighbour_thicker = TRUE;
                             continue;
                           }
-                        if (py >= 0 && (nd = dist[px + py * width]) > d)
+                        if (py >= 0 && (nd = data->dist[px + py * data->width]) > d)
                           {
                             d = nd;
                             dx = px;
@@ -2405,7 +3207,7 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                             neighbour_thicker = TRUE;
                             continue;
                           }
-                        if (ny < height && (nd = dist[px + ny * width]) > d)
+                        if (ny < data->height && (nd = data->dist[px + ny * data->width]) > d)
                           {
                             d = nd;
                             dx = px;
@@ -2414,16 +3216,16 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                             continue;
                           }
                       }
-                    if (nx < width)
+                    if (nx < data->width)
                       {
-                        if ((nd = dist[nx + dy * width]) > d)
+                        if ((nd = data->dist[nx + dy * data->width]) > d)
                           {
                             d = nd;
                             dx = nx;
                             neighbour_thicker = TRUE;
                             continue;
                           }
-                        if (py >= 0 && (nd = dist[nx + py * width]) > d)
+                        if (py >= 0 && (nd = data->dist[nx + py * data->width]) > d)
                           {
                             d = nd;
                             dx = nx;
@@ -2431,7 +3233,7 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                             neighbour_thicker = TRUE;
                             continue;
                           }
-                        if (ny < height && (nd = dist[nx + ny * width]) > d)
+                        if (ny < data->height && (nd = data->dist[nx + ny * data->width]) > d)
                           {
                             d = nd;
                             dx = nx;
@@ -2440,14 +3242,14 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                             continue;
                           }
                       }
-                    if (py > 0 && (nd = dist[dx + py * width]) > d)
+                    if (py > 0 && (nd = data->dist[dx + py * data->width]) > d)
                       {
                         d = nd;
                         dy = py;
                         neighbour_thicker = TRUE;
                         continue;
                       }
-                    if (ny < height && (nd = dist[dx + ny * width]) > d)
+                    if (ny < data->height && (nd = data->dist[dx + ny * data->width]) > d)
                       {
                         d = nd;
                         dy = ny;
@@ -2455,26 +3257,19 @@ gimp_lineart_estimate_strokes_radii (GeglBuffer *mask,
                         continue;
                       }
                   }
-                thickness[(gint) x + (gint) y * width] = d;
+                data->thickness[(gint) x + (gint) y * data->width] = d;
               }
             m++;
           }
     }
-
- end:
-  g_free (dist);
-
-  if (gimp_async_is_stopped (async))
-    g_clear_pointer (&thickness, g_free);
-
-  return thickness;
 }
 
 static void
 gimp_line_art_simple_fill (GeglBuffer *buffer,
                            gint        x,
                            gint        y,
-                           gint       *counter)
+                           gint       *counter,
+                           GArray     *filled)
 {
   guchar val;
 
@@ -2488,14 +3283,17 @@ gimp_line_art_simple_fill (GeglBuffer *buffer,
 
   if (! val)
     {
+      Pixel p = { x, y };
+
       val = 1;
       gegl_buffer_set (buffer, GEGL_RECTANGLE (x, y, 1, 1), 0,
                        NULL, &val, GEGL_AUTO_ROWSTRIDE);
+      g_array_append_val (filled, p);
       (*counter)--;
-      gimp_line_art_simple_fill (buffer, x + 1, y, counter);
-      gimp_line_art_simple_fill (buffer, x - 1, y, counter);
-      gimp_line_art_simple_fill (buffer, x, y + 1, counter);
-      gimp_line_art_simple_fill (buffer, x, y - 1, counter);
+      gimp_line_art_simple_fill (buffer, x + 1, y, counter, filled);
+      gimp_line_art_simple_fill (buffer, x - 1, y, counter, filled);
+      gimp_line_art_simple_fill (buffer, x, y + 1, counter, filled);
+      gimp_line_art_simple_fill (buffer, x, y - 1, counter, filled);
     }
 }
 
@@ -2694,11 +3492,14 @@ static GArray *
 gimp_edgelset_new (GeglBuffer *buffer,
                    GimpAsync  *async)
 {
-  GeglBufferIterator *gi;
-  GArray             *set;
-  GHashTable         *edgel2index;
-  gint                width  = gegl_buffer_get_width (buffer);
-  gint                height = gegl_buffer_get_height (buffer);
+  EdgelSetData  data;
+  GArray       *set;
+  GHashTable   *edgel2index;
+  gint          width  = gegl_buffer_get_width (buffer);
+  gint          height = gegl_buffer_get_height (buffer);
+  gint          max_bands;
+  gint          i;
+  gint          j;
 
   set = g_array_new (TRUE, TRUE, sizeof (Edgel *));
   g_array_set_clear_func (set, (GDestroyNotify) gimp_edgel_clear);
@@ -2706,61 +3507,49 @@ gimp_edgelset_new (GeglBuffer *buffer,
   if (width <= 1 || height <= 1)
     return set;
 
-  edgel2index = g_hash_table_new ((GHashFunc) edgel2index_hash_fun,
-                                  (GEqualFunc) edgel2index_equal_fun);
+  /* Find the edgels of each band of rows in parallel, in row-major
+   * order, so that concatenating the bands gives the same set for any
+   * number of bands.
+   */
+  max_bands = CLAMP ((gdouble) width * height / PIXELS_PER_THREAD, 1, height);
 
-  gi = gegl_buffer_iterator_new (buffer, GEGL_RECTANGLE (0, 0, width, height),
-                                 0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 5);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (0, -1, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (0, 1, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (-1, 0, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (1, 0, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  while (gegl_buffer_iterator_next (gi))
-    {
-      guint8 *p      = (guint8*) gi->items[0].data;
-      guint8 *prevy  = (guint8*) gi->items[1].data;
-      guint8 *nexty  = (guint8*) gi->items[2].data;
-      guint8 *prevx  = (guint8*) gi->items[3].data;
-      guint8 *nextx  = (guint8*) gi->items[4].data;
-      gint    startx = gi->items[0].roi.x;
-      gint    starty = gi->items[0].roi.y;
-      gint    endy   = starty + gi->items[0].roi.height;
-      gint    endx   = startx + gi->items[0].roi.width;
-      gint    x;
-      gint    y;
+  data.buffer  = buffer;
+  data.bands   = g_new0 (GArray *, max_bands);
+  data.n_bands = 0;
+  data.async   = async;
 
-      if (gimp_async_is_canceled (async))
+  gegl_parallel_distribute (
+    max_bands,
+    (GeglParallelDistributeFunc) gimp_edgelset_new_band,
+    &data);
+
+  for (i = 0; i < data.n_bands; i++)
+    {
+      if (data.bands[i])
         {
-          gegl_buffer_iterator_stop (gi);
+          g_array_append_vals (set, data.bands[i]->data, data.bands[i]->len);
+          g_array_free (data.bands[i], TRUE);
+        }
+    }
 
-          gimp_async_abort (async);
+  g_free (data.bands);
 
-          goto end;
-        }
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
 
-      for (y = starty; y < endy; y++)
-        for (x = startx; x < endx; x++)
-          {
-            if (*(p++))
-              {
-                if (! *prevy)
-                  gimp_edgelset_add (set, x, y, YMinusDirection, edgel2index);
-                if (! *nexty)
-                  gimp_edgelset_add (set, x, y, YPlusDirection, edgel2index);
-                if (! *prevx)
-                  gimp_edgelset_add (set, x, y, XMinusDirection, edgel2index);
-                if (! *nextx)
-                  gimp_edgelset_add (set, x, y, XPlusDirection, edgel2index);
-              }
-            prevy++;
-            nexty++;
-            prevx++;
-            nextx++;
-          }
+      g_array_free (set, TRUE);
+
+      return NULL;
+    }
+
+  edgel2index = g_hash_table_new ((GHashFunc) edgel2index_hash_fun,
+                                  (GEqualFunc) edgel2index_equal_fun);
+
+  for (j = 0; j < set->len; j++)
+    {
+      g_hash_table_insert (edgel2index, g_array_index (set, Edgel *, j),
+                           GUINT_TO_POINTER (j));
     }
 
   gimp_edgelset_build_graph (set, buffer, edgel2index, async);
@@ -2782,17 +3571,74 @@ gimp_edgelset_new (GeglBuffer *buffer,
 }
 
 static void
-gimp_edgelset_add (GArray     *set,
-                   int         x,
-                   int         y,
-                   Direction   direction,
-                   GHashTable *edgel2index)
+gimp_edgelset_new_band (gint          band_index,
+                        gint          n_bands,
+                        EdgelSetData *data)
 {
-  Edgel         *edgel    = gimp_edgel_new (x, y, direction);
-  unsigned long  position = set->len;
+  GArray *band;
+  guint8 *rows;
+  gint    width  = gegl_buffer_get_width (data->buffer);
+  gint    height = gegl_buffer_get_height (data->buffer);
+  gint    y1     = (gint64) height * band_index       / n_bands;
+  gint    y2     = (gint64) height * (band_index + 1) / n_bands;
+  gint    x;
+  gint    y;
+
+  if (band_index == 0)
+    data->n_bands = n_bands;
+
+  /* The rows of the band, with one row of context on each side. */
+  rows = g_malloc ((gsize) width * (y2 - y1 + 2));
+
+  gegl_buffer_get (data->buffer,
+                   GEGL_RECTANGLE (0, y1 - 1, width, y2 - y1 + 2), 1.0,
+                   NULL, rows,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  band = g_array_new (FALSE, FALSE, sizeof (Edgel *));
+
+  for (y = y1; y < y2; y++)
+    {
+      const guint8 *prevy = rows + (gsize) (y - y1) * width;
+      const guint8 *p     = prevy + width;
+      const guint8 *nexty = p + width;
+
+      if (gimp_async_is_canceled (data->async))
+        break;
+
+      for (x = 0; x < width; x++)
+        {
+          if (p[x])
+            {
+              Edgel *edgel;
+
+              if (! prevy[x])
+                {
+                  edgel = gimp_edgel_new (x, y, YMinusDirection);
+                  g_array_append_val (band, edgel);
+                }
+              if (! nexty[x])
+                {
+                  edgel = gimp_edgel_new (x, y, YPlusDirection);
+                  g_array_append_val (band, edgel);
+                }
+              if (x == 0 || ! p[x - 1])
+                {
+                  edgel = gimp_edgel_new (x, y, XMinusDirection);
+                  g_array_append_val (band, edgel);
+                }
+              if (x == width - 1 || ! p[x + 1])
+                {
+                  edgel = gimp_edgel_new (x, y, XPlusDirection);
+                  g_array_append_val (band, edgel);
+                }
+            }
+        }
+    }
 
-  g_array_append_val (set, edgel);
-  g_hash_table_insert (edgel2index, edgel, GUINT_TO_POINTER (position));
+  g_free (rows);
+
+  data->bands[band_index] = band;
 }
 
 static void
@@ -2818,8 +3664,7 @@ gimp_edgelset_smooth_normals (GArray    *set,
   const gfloat sigma = mask_size * 0.775;
   const gfloat den   = 2 * sigma * sigma;
   gfloat       weights[65];
-  GimpVector2  smoothed_normal;
-  gint         i;
+  EdgelSetData data;
 
   gimp_assert (mask_size <= 65);
 
@@ -2827,28 +3672,50 @@ gimp_edgelset_smooth_normals (GArray    *set,
   for (int i = 1; i <= mask_size; ++i)
     weights[i] = expf (-(i * i) / den);
 
-  for (i = 0; i < set->len; i++)
+  data.set       = set;
+  data.mask_size = mask_size;
+  data.weights   = weights;
+  data.async     = async;
+
+  /* Smoothing only reads the neighbors' directions, which never change,
+   * so edgels can be processed in any order.
+   */
+  gegl_parallel_distribute_range (
+    set->len, EDGELS_PER_THREAD,
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_smooth_normals_range,
+    &data);
+
+  if (gimp_async_is_canceled (async))
+    gimp_async_abort (async);
+}
+
+static void
+gimp_edgelset_smooth_normals_range (gint          offset,
+                                    gint          size,
+                                    EdgelSetData *data)
+{
+  GArray      *set = data->set;
+  GimpVector2  smoothed_normal;
+  gint         i;
+
+  for (i = offset; i < offset + size; i++)
     {
       Edgel *it           = g_array_index (set, Edgel*, i);
       Edgel *edgel_before = g_array_index (set, Edgel*, it->previous);
       Edgel *edgel_after  = g_array_index (set, Edgel*, it->next);
-      int    n = mask_size;
+      int    n = data->mask_size;
       int    i = 1;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
-
-          return;
-        }
+      if (gimp_async_is_canceled (data->async))
+        return;
 
       smoothed_normal = Direction2Normal[it->direction];
       while (n-- && (edgel_after != edgel_before))
         {
           smoothed_normal = gimp_vector2_add_val (smoothed_normal,
-                                                  gimp_vector2_mul_val (Direction2Normal[edgel_before->direction], weights[i]));
+                                                  gimp_vector2_mul_val (Direction2Normal[edgel_before->direction], data->weights[i]));
           smoothed_normal = gimp_vector2_add_val (smoothed_normal,
-                                                  gimp_vector2_mul_val (Direction2Normal[edgel_after->direction], weights[i]));
+                                                  gimp_vector2_mul_val (Direction2Normal[edgel_after->direction], data->weights[i]));
           edgel_before = g_array_index (set, Edgel *, edgel_before->previous);
           edgel_after  = g_array_index (set, Edgel *, edgel_after->next);
           ++i;
@@ -2863,9 +3730,29 @@ static void
 gimp_edgelset_compute_curvature (GArray    *set,
                                  GimpAsync *async)
 {
-  gint i;
+  EdgelSetData data;
+
+  data.set   = set;
+  data.async = async;
+
+  gegl_parallel_distribute_range (
+    set->len, EDGELS_PER_THREAD,
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_compute_curvature_range,
+    &data);
+
+  if (gimp_async_is_canceled (async))
+    gimp_async_abort (async);
+}
 
-  for (i = 0; i < set->len; i++)
+static void
+gimp_edgelset_compute_curvature_range (gint          offset,
+                                       gint          size,
+                                       EdgelSetData *data)
+{
+  GArray *set = data->set;
+  gint    i;
+
+  for (i = offset; i < offset + size; i++)
     {
       Edgel       *it       = g_array_index (set, Edgel*, i);
       Edgel       *previous = g_array_index (set, Edgel *, it->previous);
@@ -2879,12 +3766,8 @@ gimp_edgelset_compute_curvature (GArray    *set,
 
       it->curvature = (crossp > 0.0f) ? c : -c;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
-
-          return;
-        }
+      if (gimp_async_is_canceled (data->async))
+        return;
     }
 }
 
@@ -2894,26 +3777,47 @@ gimp_edgelset_build_graph (GArray     *set,
                            GHashTable *edgel2index,
                            GimpAsync  *async)
 {
-  Edgel edgel;
-  gint  i;
+  EdgelSetData data;
+
+  data.set         = set;
+  data.buffer      = buffer;
+  data.edgel2index = edgel2index;
+  data.async       = async;
+
+  /* The hash table is only read, and since every edgel is the next one
+   * of exactly one edgel, each edgel is written by a single thread.
+   */
+  gegl_parallel_distribute_range (
+    set->len, EDGELS_PER_THREAD,
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_build_graph_range,
+    &data);
+
+  if (gimp_async_is_canceled (async))
+    gimp_async_abort (async);
+}
+
+static void
+gimp_edgelset_build_graph_range (gint          offset,
+                                 gint          size,
+                                 EdgelSetData *data)
+{
+  GArray *set = data->set;
+  Edgel   edgel;
+  gint    i;
 
-  for (i = 0; i < set->len; i++)
+  for (i = offset; i < offset + size; i++)
     {
       Edgel *neighbor;
       Edgel *it = g_array_index (set, Edgel *, i);
       guint  neighbor_pos;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
-
-          return;
-        }
+      if (gimp_async_is_canceled (data->async))
+        return;
 
-      gimp_edgelset_next8 (buffer, it, &edgel);
+      gimp_edgelset_next8 (data->buffer, it, &edgel);
 
-      gimp_assert (g_hash_table_contains (edgel2index, &edgel));
-      neighbor_pos = GPOINTER_TO_UINT (g_hash_table_lookup (edgel2index, &edgel));
+      gimp_assert (g_hash_table_contains (data->edgel2index, &edgel));
+      neighbor_pos = GPOINTER_TO_UINT (g_hash_table_lookup (data->edgel2index, &edgel));
       it->next = neighbor_pos;
       neighbor = g_array_index (set, Edgel *, neighbor_pos);
       neighbor->previous = i;
@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <archive.h>
 #include <archive_entry.h>
@@ -33,6 +34,7 @@
 #include "config/gimpxmlparser.h"
 
 #include "gimp-utils.h"
+#include "gimpdataloaderfactory.h"
 #include "gimppalette.h"
 #include "gimppalette-load.h"
 
@@ -76,6 +78,9 @@ static void swatchbooker_load_text          (GMarkupParseContext *context,
                                              gpointer             user_data,
                                              GError             **error);
 
+static gchar * gimp_palette_load_token          (gchar        **str,
+                                                 const gchar   *delimiters);
+
 static gchar * gimp_palette_load_acb_string     (GInputStream  *input,
                                                  goffset        file_size,
                                                  GError       **error);
@@ -163,10 +168,10 @@ gimp_palette_load (GimpContext   *context,
 
           if (columns < 0 || columns > 256)
             {
-              g_message (_("Reading palette file '%s': "
-                           "Invalid number of columns in line %d. "
-                           "Using default value."),
-                         gimp_file_get_utf8_name (file), linenum);
+              gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                  "Invalid number of columns in line %d. "
+                                                  "Using default value."),
+                                                gimp_file_get_utf8_name (file), linenum);
               columns = 0;
             }
 
@@ -195,60 +200,62 @@ gimp_palette_load (GimpContext   *context,
         {
           GeglColor *color  = gegl_color_new ("black");
           guint8     rgb[3] = { 0 };
+          gchar     *line;
 
-          tok = strtok (str, " \t");
+          line = str;
+          tok  = gimp_palette_load_token (&line, " \t");
           if (tok)
             {
               if (atoi (tok) < 0 || atoi (tok) > 255)
-                g_message (_("Reading palette file '%s': "
-                             "red component out of range in line %d."),
-                           gimp_file_get_utf8_name (file), linenum);
+                gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                    "red component out of range in line %d."),
+                                                  gimp_file_get_utf8_name (file), linenum);
 
               rgb[0] = CLAMP (atoi (tok), 0, 255);
             }
           else
             {
-              g_message (_("Reading palette file '%s': "
-                           "Missing RED component in line %d."),
-                         gimp_file_get_utf8_name (file), linenum);
+              gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                  "Missing RED component in line %d."),
+                                                gimp_file_get_utf8_name (file), linenum);
             }
 
-          tok = strtok (NULL, " \t");
+          tok = gimp_palette_load_token (&line, " \t");
           if (tok)
             {
               if (atoi (tok) < 0 || atoi (tok) > 255)
-                g_message (_("Reading palette file '%s': "
-                             "green component out of range in line %d."),
-                           gimp_file_get_utf8_name (file), linenum);
+                gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                    "green component out of range in line %d."),
+                                                  gimp_file_get_utf8_name (file), linenum);
 
               rgb[1] = CLAMP (atoi (tok), 0, 255);
             }
           else
             {
-              g_message (_("Reading palette file '%s': "
-                           "Missing GREEN component in line %d."),
-                         gimp_file_get_utf8_name (file), linenum);
+              gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                  "Missing GREEN component in line %d."),
+                                                gimp_file_get_utf8_name (file), linenum);
             }
 
-          tok = strtok (NULL, " \t");
+          tok = gimp_palette_load_token (&line, " \t");
           if (tok)
             {
               if (atoi (tok) < 0 || atoi (tok) > 255)
-                g_message (_("Reading palette file '%s': "
-                             "blue component out of range in line %d."),
-                           gimp_file_get_utf8_name (file), linenum);
+                gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                    "blue component out of range in line %d."),
+                                                  gimp_file_get_utf8_name (file), linenum);
 
               rgb[2] = CLAMP (atoi (tok), 0, 255);
             }
           else
             {
-              g_message (_("Reading palette file '%s': "
-                           "Missing BLUE component in line %d."),
-                         gimp_file_get_utf8_name (file), linenum);
+              gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                  "Missing BLUE component in line %d."),
+                                                gimp_file_get_utf8_name (file), linenum);
             }
 
           /* optional name */
-          tok = strtok (NULL, "\n");
+          tok = gimp_palette_load_token (&line, "\n");
 
           /* Historical .gpl format is sRGB. */
           gegl_color_set_pixel (color, babl_format ("R'G'B' u8"), rgb);
@@ -264,11 +271,11 @@ gimp_palette_load (GimpContext   *context,
                                            NULL, &my_error);
       if (! str && my_error)
         {
-          g_message (_("Reading palette file '%s': "
-                       "Read %d colors from truncated file: %s"),
-                     gimp_file_get_utf8_name (file),
-                     g_list_length (palette->colors),
-                     my_error->message);
+          gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                              "Read %d colors from truncated file: %s"),
+                                            gimp_file_get_utf8_name (file),
+                                            g_list_length (palette->colors),
+                                            my_error->message);
           g_clear_error (&my_error);
         }
     }
@@ -520,12 +527,12 @@ gimp_palette_load_aco (GimpContext   *context,
         {
           if (palette->colors)
             {
-              g_message (_("Reading palette file '%s': "
-                           "Read %d colors from truncated file: %s"),
-                         gimp_file_get_utf8_name (file),
-                         g_list_length (palette->colors),
-                         my_error ?
-                         my_error->message : _("Premature end of file."));
+              gimp_data_loader_factory_message (_("Reading palette file '%s': "
+                                                  "Read %d colors from truncated file: %s"),
+                                                gimp_file_get_utf8_name (file),
+                                                g_list_length (palette->colors),
+                                                my_error ?
+                                                my_error->message : _("Premature end of file."));
               g_clear_error (&my_error);
               break;
             }
@@ -960,6 +967,37 @@ gimp_palette_load_acb (GimpContext   *context,
   return g_list_prepend (NULL, palette);
 }
 
+/*  like strtok(), but keeps its position in *str instead of a static,
+ *  because palettes may be loaded on several threads at once
+ */
+static gchar *
+gimp_palette_load_token (gchar       **str,
+                         const gchar  *delimiters)
+{
+  gchar *token;
+
+  if (! *str)
+    return NULL;
+
+  token = *str + strspn (*str, delimiters);
+
+  if (! *token)
+    {
+      *str = NULL;
+
+      return NULL;
+    }
+
+  *str = token + strcspn (token, delimiters);
+
+  if (**str)
+    *(*str)++ = '\0';
+  else
+    *str = NULL;
+
+  return token;
+}
+
 static gchar *
 gimp_palette_load_acb_string (GInputStream  *input,
                               goffset        file_size,
@@ -43,6 +43,7 @@ gimp_pattern_load (GimpContext   *context,
   GimpPattern       *pattern = NULL;
   const Babl        *format  = NULL;
   GimpPatternHeader  header;
+  GFileInfo         *info;
   gsize              size;
   gsize              bytes_read;
   gsize              bn_size;
@@ -156,9 +157,39 @@ gimp_pattern_load (GimpContext   *context,
     case 4: format = babl_format ("R'G'B'A u8"); break;
     }
 
-  pattern->mask = gimp_temp_buf_new (header.width, header.height, format);
   size = (gsize) header.width * header.height * header.bytes;
 
+  /*  If we can tell that the pixel data is complete without reading
+   *  it, defer loading the pixels until the pattern is actually used,
+   *  see gimp_pattern_get_mask()
+   */
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info)
+    {
+      goffset file_size = g_file_info_get_size (info);
+
+      g_object_unref (info);
+
+      if (file_size < (goffset) header.header_size + (goffset) size)
+        {
+          g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                       _("File appears truncated."));
+          goto error;
+        }
+
+      pattern->deferred_file   = g_object_ref (file);
+      pattern->deferred_offset = header.header_size;
+      pattern->deferred_width  = header.width;
+      pattern->deferred_height = header.height;
+      pattern->deferred_format = format;
+
+      return g_list_prepend (NULL, pattern);
+    }
+
+  pattern->mask = gimp_temp_buf_new (header.width, header.height, format);
+
   if (! g_input_stream_read_all (input,
                                  gimp_temp_buf_get_data (pattern->mask), size,
                                  &bytes_read, NULL, error) ||
@@ -218,3 +249,56 @@ gimp_pattern_load_pixbuf (GimpContext   *context,
 
   return g_list_prepend (NULL, pattern);
 }
+
+GimpTempBuf *
+gimp_pattern_load_pixels (GimpPattern  *pattern,
+                          GError      **error)
+{
+  GFileInputStream *input;
+  GimpTempBuf      *mask;
+  gsize             size;
+  gsize             bytes_read;
+
+  g_return_val_if_fail (GIMP_IS_PATTERN (pattern), NULL);
+  g_return_val_if_fail (G_IS_FILE (pattern->deferred_file), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  input = g_file_read (pattern->deferred_file, NULL, error);
+
+  if (! input)
+    {
+      g_prefix_error (error,
+                      _("Could not open '%s' for reading: "),
+                      gimp_file_get_utf8_name (pattern->deferred_file));
+      return NULL;
+    }
+
+  mask = gimp_temp_buf_new (pattern->deferred_width,
+                            pattern->deferred_height,
+                            pattern->deferred_format);
+  size = gimp_temp_buf_get_data_size (mask);
+
+  if (! g_seekable_seek (G_SEEKABLE (input), pattern->deferred_offset,
+                         G_SEEK_SET, NULL, error) ||
+      ! g_input_stream_read_all (G_INPUT_STREAM (input),
+                                 gimp_temp_buf_get_data (mask), size,
+                                 &bytes_read, NULL, error))
+    {
+      g_clear_pointer (&mask, gimp_temp_buf_unref);
+    }
+  else if (bytes_read != size)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("File appears truncated."));
+      g_clear_pointer (&mask, gimp_temp_buf_unref);
+    }
+
+  g_object_unref (input);
+
+  if (! mask)
+    g_prefix_error (error,
+                    _("Error loading '%s': "),
+                    gimp_file_get_utf8_name (pattern->deferred_file));
+
+  return mask;
+}
@@ -22,14 +22,17 @@
 #define GIMP_PATTERN_FILE_EXTENSION ".pat"
 
 
-GList * gimp_pattern_load        (GimpContext   *context,
-                                  GFile         *file,
-                                  GInputStream  *input,
-                                  GError       **error);
-GList * gimp_pattern_load_pixbuf (GimpContext   *context,
-                                  GFile         *file,
-                                  GInputStream  *input,
-                                  GError       **error);
+GList       * gimp_pattern_load        (GimpContext   *context,
+                                        GFile         *file,
+                                        GInputStream  *input,
+                                        GError       **error);
+GList       * gimp_pattern_load_pixbuf (GimpContext   *context,
+                                        GFile         *file,
+                                        GInputStream  *input,
+                                        GError       **error);
+
+GimpTempBuf * gimp_pattern_load_pixels (GimpPattern   *pattern,
+                                        GError       **error);
 
 
 #endif /* __GIMP_PATTERN_LOAD_H__ */
@@ -31,6 +31,7 @@
 #include "gimppattern.h"
 #include "gimppattern-load.h"
 #include "gimppattern-save.h"
+#include "gimptagcache.h"
 #include "gimptagged.h"
 #include "gimptempbuf.h"
 
@@ -59,6 +60,12 @@ static void          gimp_pattern_copy              (GimpData             *data,
 
 static gchar       * gimp_pattern_get_checksum      (GimpTagged           *tagged);
 
+static gchar       * gimp_pattern_calc_checksum     (GimpTempBuf          *mask);
+
+static void          gimp_pattern_get_dimensions    (GimpPattern          *pattern,
+                                                     gint                 *width,
+                                                     gint                 *height);
+
 
 G_DEFINE_TYPE_WITH_CODE (GimpPattern, gimp_pattern, GIMP_TYPE_DATA,
                          G_IMPLEMENT_INTERFACE (GIMP_TYPE_TAGGED,
@@ -66,6 +73,9 @@ G_DEFINE_TYPE_WITH_CODE (GimpPattern, gimp_pattern, GIMP_TYPE_DATA,
 
 #define parent_class gimp_pattern_parent_class
 
+/*  serializes reading the pixels of deferred patterns  */
+static GMutex deferred_mutex;
+
 
 static void
 gimp_pattern_class_init (GimpPatternClass *klass)
@@ -98,7 +108,8 @@ gimp_pattern_tagged_iface_init (GimpTaggedInterface *iface)
 static void
 gimp_pattern_init (GimpPattern *pattern)
 {
-  pattern->mask = NULL;
+  pattern->mask          = NULL;
+  pattern->deferred_file = NULL;
 }
 
 static void
@@ -107,6 +118,8 @@ gimp_pattern_finalize (GObject *object)
   GimpPattern *pattern = GIMP_PATTERN (object);
 
   g_clear_pointer (&pattern->mask, gimp_temp_buf_unref);
+  g_clear_object (&pattern->deferred_file);
+  g_clear_pointer (&pattern->deferred_checksum, g_free);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -129,10 +142,7 @@ gimp_pattern_get_size (GimpViewable *viewable,
                        gint         *width,
                        gint         *height)
 {
-  GimpPattern *pattern = GIMP_PATTERN (viewable);
-
-  *width  = gimp_temp_buf_get_width  (pattern->mask);
-  *height = gimp_temp_buf_get_height (pattern->mask);
+  gimp_pattern_get_dimensions (GIMP_PATTERN (viewable), width, height);
 
   return TRUE;
 }
@@ -144,6 +154,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
                               gint          height)
 {
   GimpPattern *pattern     = GIMP_PATTERN (viewable);
+  GimpTempBuf *mask        = gimp_pattern_get_mask (pattern);
   GimpTempBuf *temp_buf;
   GeglBuffer  *src_buffer;
   gint         true_width;
@@ -152,12 +163,12 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
   gint         copy_height;
   gboolean     has_temp_buf = FALSE;
 
-  true_width  = gimp_temp_buf_get_width (pattern->mask);
-  true_height = gimp_temp_buf_get_height (pattern->mask);
+  true_width  = gimp_temp_buf_get_width  (mask);
+  true_height = gimp_temp_buf_get_height (mask);
   copy_width  = MIN (width, true_width);
   copy_height = MIN (height, true_height);
 
-  src_buffer = gimp_temp_buf_create_buffer (pattern->mask);
+  src_buffer = gimp_temp_buf_create_buffer (mask);
 
   if (true_width > width || true_height > height)
     {
@@ -176,7 +187,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
       copy_height = MAX (1, copy_height);
 
       temp_buf = gimp_temp_buf_new (copy_width, copy_height,
-                                    gimp_temp_buf_get_format (pattern->mask));
+                                    gimp_temp_buf_get_format (mask));
 
       if (temp_buf)
         {
@@ -197,7 +208,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
       GeglBuffer *dest_buffer;
 
       temp_buf = gimp_temp_buf_new (copy_width, copy_height,
-                                    gimp_temp_buf_get_format (pattern->mask));
+                                    gimp_temp_buf_get_format (mask));
 
       dest_buffer = gimp_temp_buf_create_buffer (temp_buf);
 
@@ -219,11 +230,14 @@ gimp_pattern_get_description (GimpViewable  *viewable,
                               gchar        **tooltip)
 {
   GimpPattern *pattern = GIMP_PATTERN (viewable);
+  gint         width;
+  gint         height;
+
+  gimp_pattern_get_dimensions (pattern, &width, &height);
 
   return g_strdup_printf ("%s (%d × %d)",
                           gimp_object_get_name (pattern),
-                          gimp_temp_buf_get_width  (pattern->mask),
-                          gimp_temp_buf_get_height (pattern->mask));
+                          width, height);
 }
 
 static const gchar *
@@ -240,7 +254,9 @@ gimp_pattern_copy (GimpData *data,
   GimpPattern *src_pattern = GIMP_PATTERN (src_data);
 
   g_clear_pointer (&pattern->mask, gimp_temp_buf_unref);
-  pattern->mask = gimp_temp_buf_copy (src_pattern->mask);
+  g_clear_object (&pattern->deferred_file);
+  g_clear_pointer (&pattern->deferred_checksum, g_free);
+  pattern->mask = gimp_temp_buf_copy (gimp_pattern_get_mask (src_pattern));
 
   gimp_data_dirty (data);
 }
@@ -251,21 +267,84 @@ gimp_pattern_get_checksum (GimpTagged *tagged)
   GimpPattern *pattern         = GIMP_PATTERN (tagged);
   gchar       *checksum_string = NULL;
 
-  if (pattern->mask)
+  g_mutex_lock (&deferred_mutex);
+
+  if (pattern->deferred_file)
     {
-      GChecksum *checksum = g_checksum_new (G_CHECKSUM_MD5);
+      /*  don't read the pixels of a deferred pattern just because the
+       *  tag cache asks for its checksum: use the one tags.xml has for
+       *  the pattern's file, and only read the pixels once for files
+       *  the tag cache doesn't know yet, or that were modified since
+       */
+      if (! pattern->deferred_checksum)
+        {
+          const gchar *cached;
+
+          cached = g_object_get_data (G_OBJECT (pattern),
+                                      GIMP_TAG_CACHE_CHECKSUM_KEY);
+
+          if (cached)
+            {
+              pattern->deferred_checksum = g_strdup (cached);
+            }
+          else
+            {
+              GimpTempBuf *mask = gimp_pattern_load_pixels (pattern, NULL);
+
+              if (mask)
+                {
+                  pattern->deferred_checksum = gimp_pattern_calc_checksum (mask);
+
+                  gimp_temp_buf_unref (mask);
+                }
+            }
+        }
+
+      checksum_string = g_strdup (pattern->deferred_checksum);
+    }
+  else if (pattern->mask)
+    {
+      checksum_string = gimp_pattern_calc_checksum (pattern->mask);
+    }
 
-      g_checksum_update (checksum, gimp_temp_buf_get_data (pattern->mask),
-                         gimp_temp_buf_get_data_size (pattern->mask));
+  g_mutex_unlock (&deferred_mutex);
 
-      checksum_string = g_strdup (g_checksum_get_string (checksum));
+  return checksum_string;
+}
 
-      g_checksum_free (checksum);
-    }
+static gchar *
+gimp_pattern_calc_checksum (GimpTempBuf *mask)
+{
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_MD5);
+  gchar     *checksum_string;
+
+  g_checksum_update (checksum, gimp_temp_buf_get_data (mask),
+                     gimp_temp_buf_get_data_size (mask));
+
+  checksum_string = g_strdup (g_checksum_get_string (checksum));
+
+  g_checksum_free (checksum);
 
   return checksum_string;
 }
 
+static void
+gimp_pattern_get_dimensions (GimpPattern *pattern,
+                             gint        *width,
+                             gint        *height)
+{
+  if (pattern->mask)
+    {
+      *width  = gimp_temp_buf_get_width  (pattern->mask);
+      *height = gimp_temp_buf_get_height (pattern->mask);
+    }
+  else
+    {
+      *width  = pattern->deferred_width;
+      *height = pattern->deferred_height;
+    }
+}
+
 GimpData *
 gimp_pattern_new (GimpContext *context,
                   const gchar *name)
@@ -317,7 +396,45 @@ gimp_pattern_get_mask (GimpPattern *pattern)
 {
   g_return_val_if_fail (GIMP_IS_PATTERN (pattern), NULL);
 
-  return pattern->mask;
+  if (G_UNLIKELY (g_atomic_pointer_get (&pattern->deferred_file)))
+    {
+      g_mutex_lock (&deferred_mutex);
+
+      if (pattern->deferred_file)
+        {
+          GFile       *file  = pattern->deferred_file;
+          GimpTempBuf *mask;
+          GError      *error = NULL;
+
+          mask = gimp_pattern_load_pixels (pattern, &error);
+
+          if (! mask)
+            {
+              /*  the file went away or changed since the header was
+               *  read, don't leave the pattern without pixels
+               */
+              g_warning ("%s: %s", G_STRFUNC, error->message);
+              g_clear_error (&error);
+
+              mask = gimp_temp_buf_new (pattern->deferred_width,
+                                        pattern->deferred_height,
+                                        pattern->deferred_format);
+              gimp_temp_buf_data_clear (mask);
+            }
+
+          /*  publish the mask before clearing deferred_file, which is
+           *  checked without the lock above
+           */
+          g_atomic_pointer_set (&pattern->mask, mask);
+          g_atomic_pointer_set (&pattern->deferred_file, NULL);
+
+          g_object_unref (file);
+        }
+
+      g_mutex_unlock (&deferred_mutex);
+    }
+
+  return g_atomic_pointer_get (&pattern->mask);
 }
 
 GeglBuffer *
@@ -325,5 +442,5 @@ gimp_pattern_create_buffer (GimpPattern *pattern)
 {
   g_return_val_if_fail (GIMP_IS_PATTERN (pattern), NULL);
 
-  return gimp_temp_buf_create_buffer (pattern->mask);
+  return gimp_temp_buf_create_buffer (gimp_pattern_get_mask (pattern));
 }
@@ -37,6 +37,14 @@ struct _GimpPattern
   GimpData     parent_instance;
 
   GimpTempBuf *mask;
+
+  /*  set while the pixels have not been read from disk yet  */
+  GFile       *deferred_file;
+  goffset      deferred_offset;
+  gint         deferred_width;
+  gint         deferred_height;
+  const Babl  *deferred_format;
+  gchar       *deferred_checksum;
 };
 
 struct _GimpPatternClass
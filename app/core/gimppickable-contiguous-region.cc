@@ -37,9 +37,11 @@ extern "C"
 #include "gimp-parallel.h"
 #include "gimp-utils.h" /* GIMP_TIMER */
 #include "gimpasync.h"
+#include "gimpcancelable.h"
 #include "gimplineart.h"
 #include "gimppickable.h"
 #include "gimppickable-contiguous-region.h"
+#include "gimpviewable.h"
 
 
 #define EPSILON 1e-6
@@ -47,6 +49,15 @@ extern "C"
 #define PIXELS_PER_THREAD \
   (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
 
+#define FILL_TILE_SIZE 128
+
+#define CONTIGUOUS_INDEX_KEY "gimp-pickable-contiguous-index"
+
+/*  images with more regions than this aren't worth indexing, and would
+ *  need wider labels
+ */
+#define CONTIGUOUS_INDEX_MAX_LABELS G_MAXUINT16
+
 
 typedef struct
 {
@@ -55,6 +66,53 @@ typedef struct
   gint   level;
 } BorderPixel;
 
+typedef struct
+{
+  gint   y;
+  gint   x0;
+  gint   x1;
+} FillSegment;
+
+typedef struct
+{
+  GeglRectangle  rect;
+  gfloat        *data;
+  GArray        *segments;
+  GArray        *out_segments;
+} FillTile;
+
+typedef struct
+{
+  GeglBuffer          *labels;
+  GArray              *bounds;
+} ContiguousIndexResult;
+
+typedef struct
+{
+  GimpPickable          *pickable;
+  gulong                 invalidate_id;
+
+  GimpSelectCriterion    select_criterion;
+  gboolean               select_transparent;
+  gboolean               diagonal_neighbors;
+
+  gint                   n_queries;
+
+  GimpAsync             *async;
+  ContiguousIndexResult *result;
+} ContiguousIndex;
+
+typedef struct
+{
+  GeglBuffer          *buffer;
+  const Babl          *format;
+  gint                 n_components;
+  gboolean             has_alpha;
+  GimpSelectCriterion  select_criterion;
+  gboolean             select_transparent;
+  gboolean             diagonal_neighbors;
+} ContiguousIndexData;
+
 
 /*  local function prototypes  */
 
@@ -70,37 +128,6 @@ static gfloat   pixel_difference          (const gfloat        *col1,
                                            gboolean             has_alpha,
                                            gboolean             select_transparent,
                                            GimpSelectCriterion  select_criterion);
-static void     push_segment              (GQueue              *segment_queue,
-                                           gint                 y,
-                                           gint                 old_y,
-                                           gint                 start,
-                                           gint                 end,
-                                           gint                 new_y,
-                                           gint                 new_start,
-                                           gint                 new_end);
-static void     pop_segment               (GQueue              *segment_queue,
-                                           gint                *y,
-                                           gint                *old_y,
-                                           gint                *start,
-                                           gint                *end);
-static gboolean find_contiguous_segment   (const gfloat        *col,
-                                           GeglBuffer          *src_buffer,
-                                           GeglSampler         *src_sampler,
-                                           const GeglRectangle *src_extent,
-                                           GeglBuffer          *mask_buffer,
-                                           const Babl          *src_format,
-                                           const Babl          *mask_format,
-                                           gint                 n_components,
-                                           gboolean             has_alpha,
-                                           gboolean             select_transparent,
-                                           GimpSelectCriterion  select_criterion,
-                                           gboolean             antialias,
-                                           gfloat               threshold,
-                                           gint                 initial_x,
-                                           gint                 initial_y,
-                                           gint                *start,
-                                           gint                *end,
-                                           gfloat              *row);
 static void     find_contiguous_region    (GeglBuffer          *src_buffer,
                                            GeglBuffer          *mask_buffer,
                                            const Babl          *format,
@@ -120,6 +147,25 @@ static void            line_art_queue_pixel (GQueue              *queue,
                                              gint                 y,
                                              gint                 level);
 
+static ContiguousIndex * contiguous_index_get          (GimpPickable          *pickable,
+                                                        const Babl            *format,
+                                                        gint                   n_components,
+                                                        gboolean               has_alpha,
+                                                        GimpSelectCriterion    select_criterion,
+                                                        gboolean               select_transparent,
+                                                        gboolean               diagonal_neighbors);
+static void              contiguous_index_free         (ContiguousIndex       *index);
+static void              contiguous_index_invalidate   (GimpViewable          *viewable,
+                                                        ContiguousIndex       *index);
+static void              contiguous_index_ready        (GimpAsync             *async,
+                                                        ContiguousIndex       *index);
+static void              contiguous_index_func         (GimpAsync             *async,
+                                                        ContiguousIndexData   *data);
+static void              contiguous_index_data_free    (ContiguousIndexData   *data);
+static void              contiguous_index_result_free  (ContiguousIndexResult *result);
+static GeglBuffer      * contiguous_index_extract      (ContiguousIndex       *index,
+                                                        gint                   x,
+                                                        gint                   y);
 
 /*  public functions  */
 
@@ -133,13 +179,14 @@ gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
                                          gint                 x,
                                          gint                 y)
 {
-  GeglBuffer    *src_buffer;
-  GeglBuffer    *mask_buffer;
-  const Babl    *format;
-  GeglRectangle  extent;
-  gint           n_components;
-  gboolean       has_alpha;
-  gfloat         start_col[MAX_CHANNELS];
+  GeglBuffer      *src_buffer;
+  GeglBuffer      *mask_buffer = NULL;
+  ContiguousIndex *index       = NULL;
+  const Babl      *format;
+  GeglRectangle    extent;
+  gint             n_components;
+  gboolean         has_alpha;
+  gfloat           start_col[MAX_CHANNELS];
 
   g_return_val_if_fail (GIMP_IS_PICKABLE (pickable), NULL);
 
@@ -151,6 +198,17 @@ gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
   gegl_buffer_sample (src_buffer, x, y, NULL, start_col, format,
                       GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
 
+  /*  at zero threshold, the regions partition the pickable independently
+   *  of the seed, so we can index them once, and look them up afterwards
+   */
+  if (threshold == 0.0f)
+    {
+      index = contiguous_index_get (pickable, format, n_components, has_alpha,
+                                    select_criterion,
+                                    select_transparent && has_alpha,
+                                    diagonal_neighbors);
+    }
+
   if (has_alpha)
     {
       if (select_transparent)
@@ -167,6 +225,12 @@ gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
       select_transparent = FALSE;
     }
 
+  if (index)
+    mask_buffer = contiguous_index_extract (index, x, y);
+
+  if (mask_buffer)
+    return mask_buffer;
+
   extent = *gegl_buffer_get_extent (src_buffer);
 
   mask_buffer = gegl_buffer_new (&extent, babl_format ("Y float"));
@@ -895,296 +959,803 @@ pixel_difference (const gfloat        *col1,
     }
 }
 
+/* The region is flood-filled in FILL_TILE_SIZE x FILL_TILE_SIZE tiles, in
+ * rounds.  In each round, all the tiles that have pending segments are
+ * filled in parallel, each by a serial scanline fill confined to the tile.
+ * Segments that spill over a tile's border are collected, and are handed
+ * to the neighboring tiles for the next round.
+ *
+ * An active tile keeps a single array of floats, initialized from the mask
+ * when the tile is reached: pixels that are already selected are
+ * positive, and all other pixels hold their negated difference from the
+ * seed color, so that a pixel can be selected by flipping its sign.  Once
+ * a round leaves a tile without pending segments, the tile is written
+ * back to the mask and its array is freed, so only the fill's front is
+ * kept in memory; a tile that is reached again is reinitialized from the
+ * mask.
+ */
+
 static void
-push_segment (GQueue *segment_queue,
-              gint    y,
-              gint    old_y,
-              gint    start,
-              gint    end,
-              gint    new_y,
-              gint    new_start,
-              gint    new_end)
+find_contiguous_region (GeglBuffer          *src_buffer,
+                        GeglBuffer          *mask_buffer,
+                        const Babl          *format,
+                        gint                 n_components,
+                        gboolean             has_alpha,
+                        gboolean             select_transparent,
+                        GimpSelectCriterion  select_criterion,
+                        gboolean             antialias,
+                        gfloat               threshold,
+                        gboolean             diagonal_neighbors,
+                        gint                 x,
+                        gint                 y,
+                        const gfloat        *col)
 {
-  /* To avoid excessive memory allocation (y, old_y, start, end) tuples are
-   * stored in interleaved format:
-   *
-   * [y1] [old_y1] [start1] [end1] [y2] [old_y2] [start2] [end2]
+  const Babl          *mask_format = babl_format ("Y float");
+  const GeglRectangle *extent;
+  FillTile            *tiles;
+  GArray              *touched;
+  GArray              *queue;
+  GArray              *next_queue;
+  GArray              *drained;
+  gint                 n_tiles_x;
+  gint                 n_tiles_y;
+  gint                 diagonal;
+  guint                i;
+
+  extent = gegl_buffer_get_extent (src_buffer);
+
+  n_tiles_x = (extent->width  + FILL_TILE_SIZE - 1) / FILL_TILE_SIZE;
+  n_tiles_y = (extent->height + FILL_TILE_SIZE - 1) / FILL_TILE_SIZE;
+
+  tiles = g_new0 (FillTile, n_tiles_x * n_tiles_y);
+
+  touched    = g_array_new (FALSE, FALSE, sizeof (FillTile *));
+  queue      = g_array_new (FALSE, FALSE, sizeof (FillTile *));
+  next_queue = g_array_new (FALSE, FALSE, sizeof (FillTile *));
+  drained    = g_array_new (FALSE, FALSE, sizeof (FillTile *));
+
+  diagonal = diagonal_neighbors ? 1 : 0;
+
+  /* add the segment [x0, x1) of row y, clipped to the extent, to the
+   * tiles it intersects, and add the tiles to the queue
    */
+  auto queue_segment = [=] (GArray *target,
+                            gint    y,
+                            gint    x0,
+                            gint    x1)
+  {
+    if (y < extent->y || y >= extent->y + extent->height)
+      return;
+
+    x0 = MAX (x0, extent->x);
+    x1 = MIN (x1, extent->x + extent->width);
+
+    while (x0 < x1)
+      {
+        FillSegment  segment;
+        FillTile    *tile;
+        gint         tx = (x0 - extent->x) / FILL_TILE_SIZE;
+        gint         ty = (y  - extent->y) / FILL_TILE_SIZE;
+
+        tile = &tiles[ty * n_tiles_x + tx];
+
+        if (! tile->segments)
+          {
+            tile->rect.x      = extent->x + tx * FILL_TILE_SIZE;
+            tile->rect.y      = extent->y + ty * FILL_TILE_SIZE;
+            tile->rect.width  = MIN (FILL_TILE_SIZE,
+                                     extent->x + extent->width -
+                                     tile->rect.x);
+            tile->rect.height = MIN (FILL_TILE_SIZE,
+                                     extent->y + extent->height -
+                                     tile->rect.y);
+
+            tile->segments     = g_array_new (FALSE, FALSE,
+                                              sizeof (FillSegment));
+            tile->out_segments = g_array_new (FALSE, FALSE,
+                                              sizeof (FillSegment));
+
+            g_array_append_val (touched, tile);
+          }
+
+        segment.y  = y;
+        segment.x0 = x0;
+        segment.x1 = MIN (x1, tile->rect.x + tile->rect.width);
+
+        if (tile->segments->len == 0)
+          g_array_append_val (target, tile);
 
-  if (new_y != old_y)
+        g_array_append_val (tile->segments, segment);
+
+        x0 = segment.x1;
+      }
+  };
+
+  auto fill_tile = [=] (FillTile *tile)
+  {
+    const GeglRectangle *rect = &tile->rect;
+    gint                 n    = rect->width * rect->height;
+
+    auto push_segment = [=] (GArray *segments,
+                             gint    y,
+                             gint    x0,
+                             gint    x1)
     {
-      /* If the new segment's y-coordinate is different than the old (source)
-       * segment's y-coordinate, push the entire segment.
-       */
-      g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_y));
-      g_queue_push_tail (segment_queue, GINT_TO_POINTER (y));
-      g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_start));
-      g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_end));
-    }
-  else
+      FillSegment segment = { y, x0, x1 };
+
+      if (x0 < x1)
+        g_array_append_val (segments, segment);
+    };
+
+    /* push the segment [x0, x1) of row y, splitting it into the part
+     * inside the tile, and the parts spilling over to its neighbors
+     */
+    auto propagate = [=] (gint y,
+                          gint x0,
+                          gint x1)
     {
-      /* Otherwise, only push the set-difference between the new segment and
-       * the source segment (since we've already scanned the source segment.)
-       * Note that the `+ 1` and `- 1` terms of the end/start coordinates below
-       * are only necessary when `diagonal_neighbors` is on (and otherwise make
-       * the segments slightly larger than necessary), but, meh...
-       */
-      if (new_start < start)
+      if (y >= rect->y && y < rect->y + rect->height)
+        {
+          gint x0_in = MAX (x0, rect->x);
+          gint x1_in = MIN (x1, rect->x + rect->width);
+
+          push_segment (tile->out_segments, y, x0,    x0_in);
+          push_segment (tile->segments,     y, x0_in, x1_in);
+          push_segment (tile->out_segments, y, x1_in, x1);
+        }
+      else
+        {
+          push_segment (tile->out_segments, y, x0, x1);
+        }
+    };
+
+    if (! tile->data)
+      {
+        gfloat *src;
+        gint    j;
+
+        tile->data = g_new (gfloat, n);
+        src        = gegl_scratch_new (gfloat, n * n_components);
+
+        gegl_buffer_get (mask_buffer, rect, 1.0, mask_format, tile->data,
+                         GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+        gegl_buffer_get (src_buffer, rect, 1.0, format, src,
+                         GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+        for (j = 0; j < n; j++)
+          {
+            if (tile->data[j] == 0.0f)
+              {
+                tile->data[j] = -pixel_difference (col, src + j * n_components,
+                                                   antialias, threshold,
+                                                   n_components, has_alpha,
+                                                   select_transparent,
+                                                   select_criterion);
+              }
+          }
+
+        gegl_scratch_free (src);
+      }
+
+    while (tile->segments->len > 0)
+      {
+        FillSegment  segment;
+        gfloat      *row;
+        gint         x;
+
+        segment = g_array_index (tile->segments, FillSegment,
+                                 tile->segments->len - 1);
+        g_array_set_size (tile->segments, tile->segments->len - 1);
+
+        row = tile->data + (segment.y - rect->y) * rect->width - rect->x;
+
+        for (x = segment.x0; x < segment.x1; x++)
+          {
+            gint start;
+            gint end;
+            gint k;
+
+            if (row[x] >= 0.0f)
+              continue;
+
+            start = x;
+
+            while (start > rect->x && row[start - 1] < 0.0f)
+              start--;
+
+            end = x + 1;
+
+            while (end < rect->x + rect->width && row[end] < 0.0f)
+              end++;
+
+            for (k = start; k < end; k++)
+              row[k] = -row[k];
+
+            /* the run may continue in the neighboring tiles */
+            if (start == rect->x)
+              push_segment (tile->out_segments, segment.y, start - 1, start);
+
+            if (end == rect->x + rect->width)
+              push_segment (tile->out_segments, segment.y, end, end + 1);
+
+            propagate (segment.y - 1, start - diagonal, end + diagonal);
+            propagate (segment.y + 1, start - diagonal, end + diagonal);
+
+            /* we've just selected all pixels in the range [x, end), and
+             * the pixel at end is not selectable
+             */
+            x = end;
+          }
+      }
+  };
+
+  /* write the tile back to the mask, and free its array  */
+  auto flush_tile = [=] (FillTile *tile)
+  {
+    gint n = tile->rect.width * tile->rect.height;
+    gint k;
+
+    for (k = 0; k < n; k++)
+      tile->data[k] = MAX (tile->data[k], 0.0f);
+
+    gegl_buffer_set (mask_buffer, &tile->rect, 0, mask_format,
+                     tile->data, GEGL_AUTO_ROWSTRIDE);
+
+    g_clear_pointer (&tile->data, g_free);
+  };
+
+  queue_segment (queue, y, x, x + 1);
+
+  while (queue->len > 0)
+    {
+      GArray *tmp;
+
+      gegl_parallel_distribute_range (
+        queue->len, 1,
+        [=] (gint offset, gint size)
+        {
+          gint j;
+
+          for (j = offset; j < offset + size; j++)
+            fill_tile (g_array_index (queue, FillTile *, j));
+        });
+
+      g_array_set_size (next_queue, 0);
+      g_array_set_size (drained,    0);
+
+      for (i = 0; i < queue->len; i++)
         {
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_y));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (y));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_start));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (start + 1));
+          FillTile *tile = g_array_index (queue, FillTile *, i);
+          guint     j;
+
+          for (j = 0; j < tile->out_segments->len; j++)
+            {
+              const FillSegment *segment = &g_array_index (tile->out_segments,
+                                                           FillSegment, j);
+
+              queue_segment (next_queue,
+                             segment->y, segment->x0, segment->x1);
+            }
+
+          g_array_set_size (tile->out_segments, 0);
         }
 
-      if (new_end > end)
+      /* tiles that didn't receive any segments for the next round */
+      for (i = 0; i < queue->len; i++)
         {
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_y));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (y));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (end - 1));
-          g_queue_push_tail (segment_queue, GINT_TO_POINTER (new_end));
+          FillTile *tile = g_array_index (queue, FillTile *, i);
+
+          if (tile->segments->len == 0)
+            g_array_append_val (drained, tile);
         }
+
+      gegl_parallel_distribute_range (
+        drained->len, 1,
+        [=] (gint offset, gint size)
+        {
+          gint j;
+
+          for (j = offset; j < offset + size; j++)
+            flush_tile (g_array_index (drained, FillTile *, j));
+        });
+
+      tmp        = queue;
+      queue      = next_queue;
+      next_queue = tmp;
     }
-}
 
-static void
-pop_segment (GQueue *segment_queue,
-             gint   *y,
-             gint   *old_y,
-             gint   *start,
-             gint   *end)
-{
-  *y     = GPOINTER_TO_INT (g_queue_pop_head (segment_queue));
-  *old_y = GPOINTER_TO_INT (g_queue_pop_head (segment_queue));
-  *start = GPOINTER_TO_INT (g_queue_pop_head (segment_queue));
-  *end   = GPOINTER_TO_INT (g_queue_pop_head (segment_queue));
+  /* the last round drained all the remaining tiles */
+  for (i = 0; i < touched->len; i++)
+    {
+      FillTile *tile = g_array_index (touched, FillTile *, i);
+
+      g_array_free (tile->segments,     TRUE);
+      g_array_free (tile->out_segments, TRUE);
+    }
+
+  g_array_free (drained,    TRUE);
+  g_array_free (next_queue, TRUE);
+  g_array_free (queue,      TRUE);
+  g_array_free (touched,    TRUE);
+
+  g_free (tiles);
 }
 
-/* #define FETCH_ROW 1 */
-
-static gboolean
-find_contiguous_segment (const gfloat        *col,
-                         GeglBuffer          *src_buffer,
-                         GeglSampler         *src_sampler,
-                         const GeglRectangle *src_extent,
-                         GeglBuffer          *mask_buffer,
-                         const Babl          *src_format,
-                         const Babl          *mask_format,
-                         gint                 n_components,
-                         gboolean             has_alpha,
-                         gboolean             select_transparent,
-                         GimpSelectCriterion  select_criterion,
-                         gboolean             antialias,
-                         gfloat               threshold,
-                         gint                 initial_x,
-                         gint                 initial_y,
-                         gint                *start,
-                         gint                *end,
-                         gfloat              *row)
+/* Component index: at zero threshold, two neighboring pixels belong to
+ * the same region iff they compare equal, so the regions partition the
+ * pickable regardless of the seed.  Once a second zero-threshold query
+ * for the same criterion arrives while the pickable is unchanged, all the
+ * regions of a copy of the pickable's buffer are labeled on a worker;
+ * once the labels are ready, subsequent queries only extract the seed's
+ * label from the label buffer.  Single queries, like a bucket fill
+ * followed by the update it causes, never pay for the labeling.
+ *
+ * The index is attached to the pickable, and is dropped whenever the
+ * pickable's preview is invalidated.  Images with more than
+ * CONTIGUOUS_INDEX_MAX_LABELS regions aren't indexed; queries keep using
+ * the flood fill until the pickable changes.
+ */
+
+static ContiguousIndex *
+contiguous_index_get (GimpPickable        *pickable,
+                      const Babl          *format,
+                      gint                 n_components,
+                      gboolean             has_alpha,
+                      GimpSelectCriterion  select_criterion,
+                      gboolean             select_transparent,
+                      gboolean             diagonal_neighbors)
 {
-  gfloat *s;
-  gfloat  mask_row_buf[src_extent->width];
-  gfloat *mask_row = mask_row_buf - src_extent->x;
-  gfloat  diff;
-
-#ifdef FETCH_ROW
-  gegl_buffer_get (src_buffer, GEGL_RECTANGLE (0, initial_y, width, 1), 1.0,
-                   src_format,
-                   row, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-  s = row + initial_x * n_components;
-#else
-  s = (gfloat *) g_alloca (n_components * sizeof (gfloat));
-
-  gegl_sampler_get (src_sampler,
-                    initial_x, initial_y, NULL, s, GEGL_ABYSS_NONE);
-#endif
-
-  diff = pixel_difference (col, s, antialias, threshold,
-                           n_components, has_alpha, select_transparent,
-                           select_criterion);
-
-  /* check the starting pixel */
-  if (! diff)
-    return FALSE;
-
-  mask_row[initial_x] = diff;
-
-  *start = initial_x - 1;
-#ifdef FETCH_ROW
-  s = row + *start * n_components;
-#endif
-
-  while (*start >= src_extent->x)
+  ContiguousIndex     *index;
+  ContiguousIndexData *data;
+
+  /*  we need to know when the pickable changes  */
+  if (! GIMP_IS_VIEWABLE (pickable))
+    return NULL;
+
+  index = (ContiguousIndex *) g_object_get_data (G_OBJECT (pickable),
+                                                 CONTIGUOUS_INDEX_KEY);
+
+  if (! index                                         ||
+      index->select_criterion   != select_criterion   ||
+      index->select_transparent != select_transparent ||
+      index->diagonal_neighbors != diagonal_neighbors)
     {
-#ifndef FETCH_ROW
-      gegl_sampler_get (src_sampler,
-                        *start, initial_y, NULL, s, GEGL_ABYSS_NONE);
-#endif
-
-      diff = pixel_difference (col, s, antialias, threshold,
-                               n_components, has_alpha, select_transparent,
-                               select_criterion);
-      if (diff == 0.0)
-        break;
+      index = g_new0 (ContiguousIndex, 1);
+
+      index->pickable           = pickable;
+      index->select_criterion   = select_criterion;
+      index->select_transparent = select_transparent;
+      index->diagonal_neighbors = diagonal_neighbors;
 
-      mask_row[*start] = diff;
+      index->invalidate_id =
+        g_signal_connect (pickable, "invalidate-preview",
+                          G_CALLBACK (contiguous_index_invalidate),
+                          index);
 
-      (*start)--;
-#ifdef FETCH_ROW
-      s -= n_components;
-#endif
+      /*  replaces, and frees, the previous index  */
+      g_object_set_data_full (G_OBJECT (pickable), CONTIGUOUS_INDEX_KEY,
+                              index, (GDestroyNotify) contiguous_index_free);
     }
 
-  *end = initial_x + 1;
-#ifdef FETCH_ROW
-  s = row + *end * n_components;
-#endif
+  /*  only label the pickable once it's queried repeatedly  */
+  if (++index->n_queries < 2 || index->async)
+    return index;
 
-  while (*end < src_extent->x + src_extent->width)
-    {
-#ifndef FETCH_ROW
-      gegl_sampler_get (src_sampler,
-                        *end, initial_y, NULL, s, GEGL_ABYSS_NONE);
-#endif
-
-      diff = pixel_difference (col, s, antialias, threshold,
-                               n_components, has_alpha, select_transparent,
-                               select_criterion);
-      if (diff == 0.0)
-        break;
+  data = g_new0 (ContiguousIndexData, 1);
+
+  data->buffer             = gimp_gegl_buffer_dup (
+                               gimp_pickable_get_buffer (pickable));
+  data->format             = format;
+  data->n_components       = n_components;
+  data->has_alpha          = has_alpha;
+  data->select_criterion   = select_criterion;
+  data->select_transparent = select_transparent;
+  data->diagonal_neighbors = diagonal_neighbors;
+
+  index->async = gimp_parallel_run_async_full (
+    +1,
+    (GimpRunAsyncFunc) contiguous_index_func,
+    data, (GDestroyNotify) contiguous_index_data_free);
+
+  gimp_async_add_callback (index->async,
+                           (GimpAsyncCallback) contiguous_index_ready,
+                           index);
+
+  return index;
+}
 
-      mask_row[*end] = diff;
+static void
+contiguous_index_free (ContiguousIndex *index)
+{
+  if (index->async)
+    {
+      gimp_async_remove_callback (index->async,
+                                  (GimpAsyncCallback) contiguous_index_ready,
+                                  index);
 
-      (*end)++;
-#ifdef FETCH_ROW
-      s += n_components;
-#endif
+      gimp_cancelable_cancel (GIMP_CANCELABLE (index->async));
+      g_object_unref (index->async);
     }
 
-  gegl_buffer_set (mask_buffer, GEGL_RECTANGLE (*start + 1, initial_y,
-                                                *end - *start - 1, 1),
-                   0, mask_format, &mask_row[*start + 1],
-                   GEGL_AUTO_ROWSTRIDE);
+  if (g_signal_handler_is_connected (index->pickable, index->invalidate_id))
+    g_signal_handler_disconnect (index->pickable, index->invalidate_id);
 
-  return TRUE;
+  g_free (index);
 }
 
 static void
-find_contiguous_region (GeglBuffer          *src_buffer,
-                        GeglBuffer          *mask_buffer,
-                        const Babl          *format,
-                        gint                 n_components,
-                        gboolean             has_alpha,
-                        gboolean             select_transparent,
-                        GimpSelectCriterion  select_criterion,
-                        gboolean             antialias,
-                        gfloat               threshold,
-                        gboolean             diagonal_neighbors,
-                        gint                 x,
-                        gint                 y,
-                        const gfloat        *col)
+contiguous_index_invalidate (GimpViewable    *viewable,
+                             ContiguousIndex *index)
 {
-  const Babl          *mask_format = babl_format ("Y float");
-  GeglSampler         *src_sampler;
-  const GeglRectangle *src_extent;
-  gint                 old_y;
-  gint                 start, end;
-  gint                 new_start, new_end;
-  GQueue              *segment_queue;
-  gfloat              *row = NULL;
+  g_object_set_data (G_OBJECT (viewable), CONTIGUOUS_INDEX_KEY, NULL);
+}
 
-  src_extent = gegl_buffer_get_extent (src_buffer);
+static void
+contiguous_index_ready (GimpAsync       *async,
+                        ContiguousIndex *index)
+{
+  /*  an aborted index, with too many regions, stays in place without a
+   *  result, so that queries fall back to the flood fill
+   */
+  if (gimp_async_is_finished (async))
+    index->result = (ContiguousIndexResult *) gimp_async_get_result (async);
+}
 
-#ifdef FETCH_ROW
-  row = g_new (gfloat, src_extent->width * n_components);
-#endif
+static void
+contiguous_index_func (GimpAsync           *async,
+                       ContiguousIndexData *data)
+{
+  const GeglRectangle   *extent  = gegl_buffer_get_extent (data->buffer);
+  const Babl            *format  = babl_format ("Y u16");
+  gint                   width   = extent->width;
+  gint                   height  = extent->height;
+  gint                   n       = data->n_components;
+  ContiguousIndexResult *result;
+  GeglBuffer            *provisional;
+  GeglBuffer            *labels;
+  GArray                *parents = g_array_new (FALSE, FALSE,
+                                                sizeof (guint32));
+  GArray                *bounds;
+  guint32               *map;
+  gfloat                *src[2];
+  guint32               *row[2];
+  guint16               *label_row;
+  guint32                n_labels = 0;
+  guint32                label;
+  gboolean               overflow = FALSE;
+  gint                   x, y;
+
+  auto transparent = [=] (const gfloat *p)
+  {
+    return data->select_transparent && p[n - 1] == 0.0f;
+  };
+
+  auto same = [=] (const gfloat *p,
+                   const gfloat *q)
+  {
+    return pixel_difference (p, q, FALSE, 0.0f,
+                             n, data->has_alpha, transparent (p),
+                             data->select_criterion) != 0.0f;
+  };
+
+  auto find = [=] (guint32 i)
+  {
+    guint32 *parent = &g_array_index (parents, guint32, 0);
+
+    while (parent[i] != i)
+      {
+        parent[i] = parent[parent[i]];
+        i         = parent[i];
+      }
+
+    return i;
+  };
+
+  auto merge = [=] (const gfloat *p,
+                   const gfloat *q,
+                   guint32       q_label,
+                   guint32      *label)
+  {
+    guint32 root;
+
+    if (! q_label || ! same (p, q))
+      return;
+
+    root = find (q_label);
+
+    if (! *label)
+      {
+        *label = root;
+      }
+    else
+      {
+        guint32 label_root = find (*label);
+
+        /*  always make the smaller label the root  */
+        if (root != label_root)
+          {
+            g_array_index (parents, guint32, MAX (root, label_root)) =
+              MIN (root, label_root);
+          }
 
-  src_sampler = gegl_buffer_sampler_new (src_buffer,
-                                         format, GEGL_SAMPLER_NEAREST);
+        *label = MIN (root, label_root);
+      }
+  };
 
-  segment_queue = g_queue_new ();
+  /*  there are many more provisional labels than regions, so they
+   *  need wider labels than the final ones
+   */
+  provisional = gegl_buffer_new (extent, babl_format ("Y u32"));
+
+  /*  label 0 stands for unselectable pixels  */
+  g_array_append_val (parents, n_labels);
 
-  push_segment (segment_queue,
-                y, /* dummy values: */ -1, 0, 0,
-                y, x - 1, x + 1);
+  src[0] = g_new  (gfloat,  width * n);
+  src[1] = g_new  (gfloat,  width * n);
+  row[0] = g_new0 (guint32, width);
+  row[1] = g_new0 (guint32, width);
 
-  do
+  /*  first pass: assign provisional labels, and record their equivalences  */
+  for (y = 0; y < height && ! overflow; y++)
     {
-      pop_segment (segment_queue,
-                   &y, &old_y, &start, &end);
+      const gfloat  *prev_src = src[(y + 1) % 2];
+      gfloat        *cur_src  = src[y % 2];
+      const guint32 *prev_row = row[(y + 1) % 2];
+      guint32       *cur_row  = row[y % 2];
+
+      if (gimp_async_is_canceled (async))
+        break;
+
+      gegl_buffer_get (data->buffer,
+                       GEGL_RECTANGLE (extent->x, extent->y + y, width, 1),
+                       1.0, data->format, cur_src,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
 
-      for (x = start + 1; x < end; x++)
+      for (x = 0; x < width; x++)
         {
-          gfloat val;
+          const gfloat *p = cur_src + x * n;
 
-          gegl_buffer_get (mask_buffer, GEGL_RECTANGLE (x, y, 1, 1), 1.0,
-                           mask_format, &val, GEGL_AUTO_ROWSTRIDE,
-                           GEGL_ABYSS_NONE);
+          label = 0;
 
-          if (val != 0.0)
+          if (same (p, p))
             {
-              /* If the current pixel is selected, then we've already visited
-               * the next pixel.  (Note that we assume that the maximal image
-               * width is sufficiently low that `x` won't overflow.)
-               */
-              x++;
-              continue;
-            }
+              if (x > 0)
+                merge (p, p - n, cur_row[x - 1], &label);
 
-          if (! find_contiguous_segment (col,
-                                         src_buffer, src_sampler, src_extent,
-                                         mask_buffer,
-                                         format, mask_format,
-                                         n_components,
-                                         has_alpha,
-                                         select_transparent, select_criterion,
-                                         antialias, threshold, x, y,
-                                         &new_start, &new_end,
-                                         row))
-            continue;
+              if (y > 0)
+                {
+                  merge (p, prev_src + x * n, prev_row[x], &label);
 
-          /* We can skip directly to `new_end + 1` on the next iteration, since
-           * we've just selected all pixels in the range `[x, new_end)`, and
-           * the pixel at `new_end` is above threshold.  (Note that we assume
-           * that the maximal image width is sufficiently low that `x` won't
-           * overflow.)
-           */
-          x = new_end;
+                  if (data->diagonal_neighbors)
+                    {
+                      if (x > 0)
+                        {
+                          merge (p, prev_src + (x - 1) * n, prev_row[x - 1],
+                                 &label);
+                        }
+
+                      if (x + 1 < width)
+                        {
+                          merge (p, prev_src + (x + 1) * n, prev_row[x + 1],
+                                 &label);
+                        }
+                    }
+                }
 
-          if (diagonal_neighbors)
-            {
-              if (new_start >= src_extent->x)
-                new_start--;
+              if (! label)
+                {
+                  if (parents->len == G_MAXUINT32)
+                    {
+                      overflow = TRUE;
 
-              if (new_end < src_extent->x + src_extent->width)
-                new_end++;
+                      break;
+                    }
+
+                  label = parents->len;
+
+                  g_array_append_val (parents, label);
+                }
             }
 
-          if (y + 1 < src_extent->y + src_extent->height)
+          cur_row[x] = label;
+        }
+
+      gegl_buffer_set (provisional,
+                       GEGL_RECTANGLE (extent->x, extent->y + y, width, 1),
+                       0, babl_format ("Y u32"), cur_row,
+                       GEGL_AUTO_ROWSTRIDE);
+    }
+
+  g_free (src[0]);
+  g_free (src[1]);
+
+  if (! overflow && ! gimp_async_is_canceled (async))
+    {
+      /*  map each provisional label to a compact final label.  roots are
+       *  always smaller than the rest of their set, so they're mapped
+       *  first.
+       */
+      map = g_new (guint32, parents->len);
+
+      map[0] = 0;
+
+      for (label = 1; label < parents->len; label++)
+        {
+          guint32 root = find (label);
+
+          if (root == label)
+            map[label] = ++n_labels;
+          else
+            map[label] = map[root];
+        }
+
+      /*  only the resolved regions have to fit in the final labels  */
+      if (n_labels > CONTIGUOUS_INDEX_MAX_LABELS)
+        {
+          overflow = TRUE;
+
+          g_free (map);
+        }
+    }
+
+  g_array_free (parents, TRUE);
+
+  if (overflow || gimp_async_is_canceled (async))
+    {
+      g_free (row[0]);
+      g_free (row[1]);
+
+      g_object_unref (provisional);
+
+      contiguous_index_data_free (data);
+
+      gimp_async_abort (async);
+
+      return;
+    }
+
+  labels    = gegl_buffer_new (extent, format);
+  label_row = g_new (guint16, width);
+
+  bounds = g_array_new (FALSE, TRUE, sizeof (GeglRectangle));
+  g_array_set_size (bounds, n_labels + 1);
+
+  /*  second pass: resolve the labels, and find the bounds of each region  */
+  for (y = 0; y < height; y++)
+    {
+      guint32 *cur_row = row[0];
+
+      gegl_buffer_get (provisional,
+                       GEGL_RECTANGLE (extent->x, extent->y + y, width, 1),
+                       1.0, babl_format ("Y u32"), cur_row,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (x = 0; x < width; x++)
+        {
+          GeglRectangle *rect;
+          gint           start = x;
+
+          label = map[cur_row[x]];
+
+          label_row[x] = label;
+
+          while (x + 1 < width && map[cur_row[x + 1]] == label)
+            label_row[++x] = label;
+
+          if (! label)
+            continue;
+
+          rect = &g_array_index (bounds, GeglRectangle, label);
+
+          if (gegl_rectangle_is_empty (rect))
             {
-              push_segment (segment_queue,
-                            y, old_y, start, end,
-                            y + 1, new_start, new_end);
+              *rect = *GEGL_RECTANGLE (extent->x + start, extent->y + y,
+                                       x - start + 1, 1);
             }
-
-          if (y - 1 >= src_extent->y)
+          else
             {
-              push_segment (segment_queue,
-                            y, old_y, start, end,
-                            y - 1, new_start, new_end);
+              gegl_rectangle_bounding_box (
+                rect, rect,
+                GEGL_RECTANGLE (extent->x + start, extent->y + y,
+                                x - start + 1, 1));
             }
-
         }
+
+      gegl_buffer_set (labels,
+                       GEGL_RECTANGLE (extent->x, extent->y + y, width, 1),
+                       0, format, label_row, GEGL_AUTO_ROWSTRIDE);
     }
-  while (! g_queue_is_empty (segment_queue));
 
-  g_queue_free (segment_queue);
+  g_free (map);
+  g_free (label_row);
+  g_free (row[0]);
+  g_free (row[1]);
+
+  g_object_unref (provisional);
+
+  result = g_new (ContiguousIndexResult, 1);
+
+  result->labels = labels;
+  result->bounds = bounds;
+
+  contiguous_index_data_free (data);
+
+  gimp_async_finish_full (async, result,
+                          (GDestroyNotify) contiguous_index_result_free);
+}
+
+static void
+contiguous_index_data_free (ContiguousIndexData *data)
+{
+  g_object_unref (data->buffer);
+
+  g_free (data);
+}
+
+static void
+contiguous_index_result_free (ContiguousIndexResult *result)
+{
+  g_object_unref (result->labels);
+  g_array_free (result->bounds, TRUE);
+
+  g_free (result);
+}
+
+static GeglBuffer *
+contiguous_index_extract (ContiguousIndex *index,
+                          gint             x,
+                          gint             y)
+{
+  const GeglRectangle *extent;
+  GeglBuffer          *labels;
+  GeglBuffer          *mask_buffer;
+  guint16              label;
+
+  if (! index->result)
+    return NULL;
+
+  labels = index->result->labels;
+  extent = gegl_buffer_get_extent (labels);
+
+  if (! gegl_rectangle_contains (extent, GEGL_RECTANGLE (x, y, 1, 1)))
+    return NULL;
+
+  gegl_buffer_get (labels, GEGL_RECTANGLE (x, y, 1, 1), 1.0,
+                   babl_format ("Y u16"), &label,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  mask_buffer = gegl_buffer_new (extent, babl_format ("Y float"));
 
-  g_object_unref (src_sampler);
+  if (! label)
+    return mask_buffer;
 
-#ifdef FETCH_ROW
-  g_free (row);
-#endif
+  gegl_parallel_distribute_area (
+    &g_array_index (index->result->bounds, GeglRectangle, label),
+    PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *area)
+    {
+      GeglBufferIterator *iter;
+
+      iter = gegl_buffer_iterator_new (labels, area, 0,
+                                       babl_format ("Y u16"),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+      gegl_buffer_iterator_add (iter, mask_buffer, area, 0,
+                                babl_format ("Y float"),
+                                GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const guint16 *src   = (const guint16 *) iter->items[0].data;
+          gfloat        *dest  = (gfloat        *) iter->items[1].data;
+          gint           count = iter->length;
+
+          while (count--)
+            *dest++ = *src++ == label ? 1.0f : 0.0f;
+        }
+    });
+
+  return mask_buffer;
 }
 
 static void
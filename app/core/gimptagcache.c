@@ -58,6 +58,7 @@ typedef struct
 {
   GQuark  identifier;
   GQuark  checksum;
+  gint64  mtime;
   GList  *tags;
   guint   referenced : 1;
 } GimpTagCacheRecord;
@@ -252,6 +253,18 @@ gimp_tag_cache_add_object (GimpTagCache *cache,
 
           if (rec->identifier == identifier_quark)
             {
+              /*  the checksum is only valid for the file's contents at
+               *  the time it was recorded
+               */
+              if (rec->checksum && rec->mtime &&
+                  GIMP_IS_DATA (tagged)        &&
+                  gimp_data_get_mtime (GIMP_DATA (tagged)) == rec->mtime)
+                {
+                  g_object_set_data (G_OBJECT (tagged),
+                                     GIMP_TAG_CACHE_CHECKSUM_KEY,
+                                     (gpointer) g_quark_to_string (rec->checksum));
+                }
+
               for (list = rec->tags; list; list = g_list_next (list))
                 {
                   gimp_tagged_add_tag (tagged, GIMP_TAG (list->data));
@@ -323,6 +336,8 @@ gimp_tag_cache_tagged_to_cache_record_foreach (GimpTagged  *tagged,
 
       cache_rec->identifier = g_quark_from_string (identifier);
       cache_rec->checksum   = g_quark_from_string (checksum);
+      cache_rec->mtime      = (GIMP_IS_DATA (tagged) ?
+                               gimp_data_get_mtime (GIMP_DATA (tagged)) : 0);
       cache_rec->tags       = g_list_copy (gimp_tagged_get_tags (tagged));
 
       g_free (checksum);
@@ -367,6 +382,7 @@ gimp_tag_cache_save (GimpTagCache *cache)
 
           record_copy->identifier = current_record->identifier;
           record_copy->checksum   = current_record->checksum;
+          record_copy->mtime      = current_record->mtime;
           record_copy->tags       = g_list_copy (current_record->tags);
 
           saved_records = g_list_prepend (saved_records, record_copy);
@@ -396,11 +412,17 @@ gimp_tag_cache_save (GimpTagCache *cache)
       gchar              *tag_string;
 
       identifier_string = g_markup_escape_text (g_quark_to_string (cache_rec->identifier), -1);
-      g_string_append_printf (buf, "\n  <resource identifier=\"%s\" checksum=\"%s\">\n",
+      g_string_append_printf (buf, "\n  <resource identifier=\"%s\" checksum=\"%s\"",
                               identifier_string,
                               g_quark_to_string (cache_rec->checksum));
       g_free (identifier_string);
 
+      if (cache_rec->mtime)
+        g_string_append_printf (buf, " mtime=\"%" G_GINT64_FORMAT "\"",
+                                cache_rec->mtime);
+
+      g_string_append (buf, ">\n");
+
       for (tag_iterator = cache_rec->tags;
            tag_iterator;
            tag_iterator = g_list_next (tag_iterator))
@@ -533,6 +555,7 @@ gimp_tag_cache_load_start_element (GMarkupParseContext *context,
     {
       const gchar *identifier;
       const gchar *checksum;
+      const gchar *mtime;
 
       identifier = gimp_tag_cache_attribute_name_to_value (attribute_names,
                                                            attribute_values,
@@ -540,6 +563,9 @@ gimp_tag_cache_load_start_element (GMarkupParseContext *context,
       checksum   = gimp_tag_cache_attribute_name_to_value (attribute_names,
                                                            attribute_values,
                                                            "checksum");
+      mtime      = gimp_tag_cache_attribute_name_to_value (attribute_names,
+                                                           attribute_values,
+                                                           "mtime");
 
       if (! identifier)
         {
@@ -554,6 +580,9 @@ gimp_tag_cache_load_start_element (GMarkupParseContext *context,
 
       parse_data->current_record.identifier = g_quark_from_string (identifier);
       parse_data->current_record.checksum   = g_quark_from_string (checksum);
+
+      if (mtime)
+        parse_data->current_record.mtime = g_ascii_strtoll (mtime, NULL, 10);
     }
 }
 
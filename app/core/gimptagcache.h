@@ -25,6 +25,12 @@
 #include "gimpobject.h"
 
 
+/*  set on data objects matched by identifier whose file wasn't modified
+ *  since, to their cached checksum
+ */
+#define GIMP_TAG_CACHE_CHECKSUM_KEY "gimp-tag-cache-checksum"
+
+
 #define GIMP_TYPE_TAG_CACHE            (gimp_tag_cache_get_type ())
 #define GIMP_TAG_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIMP_TYPE_TAG_CACHE, GimpTagCache))
 #define GIMP_TAG_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GIMP_TYPE_TAG_CACHE, GimpTagCacheClass))
@@ -50,6 +50,7 @@ struct _IndexedDialog
   GimpConvertPaletteType      palette_type;
   gint                        max_colors;
   gboolean                    remove_duplicates;
+  gboolean                    refine_palette;
   GimpConvertDitherType       dither_type;
   gboolean                    dither_alpha;
   gboolean                    dither_text_layers;
@@ -61,6 +62,7 @@ struct _IndexedDialog
   GimpContext                *context;
   GimpContainer              *container;
   GtkWidget                  *duplicates_toggle;
+  GtkWidget                  *refine_toggle;
 };
 
 
@@ -88,6 +90,7 @@ convert_indexed_dialog_new (GimpImage                  *image,
                             GimpConvertPaletteType      palette_type,
                             gint                        max_colors,
                             gboolean                    remove_duplicates,
+                            gboolean                    refine_palette,
                             GimpConvertDitherType       dither_type,
                             gboolean                    dither_alpha,
                             gboolean                    dither_text_layers,
@@ -122,6 +125,7 @@ convert_indexed_dialog_new (GimpImage                  *image,
   private->palette_type       = palette_type;
   private->max_colors         = max_colors;
   private->remove_duplicates  = remove_duplicates;
+  private->refine_palette     = refine_palette;
   private->dither_type        = dither_type;
   private->dither_alpha       = dither_alpha;
   private->dither_text_layers = dither_text_layers;
@@ -235,6 +239,25 @@ convert_indexed_dialog_new (GimpImage                  *image,
                     G_CALLBACK (gimp_toggle_button_update),
                     &private->remove_duplicates);
 
+  private->refine_toggle = toggle =
+    gtk_check_button_new_with_mnemonic (_("Re_fine the generated colormap"));
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (toggle),
+                                private->refine_palette);
+  gtk_box_pack_start (GTK_BOX (vbox), toggle, FALSE, FALSE, 3);
+  gtk_widget_show (toggle);
+
+  if (private->palette_type != GIMP_CONVERT_PALETTE_GENERATE)
+    gtk_widget_set_sensitive (toggle, FALSE);
+
+  g_signal_connect (toggle, "toggled",
+                    G_CALLBACK (gimp_toggle_button_update),
+                    &private->refine_palette);
+
+  gimp_help_set_help_data (toggle,
+                           _("Improve the colors of the generated colormap, "
+                             "at the cost of a slower conversion"),
+                           NULL);
+
   /*  dithering  */
 
   frame = gimp_frame_new (_("Dithering"));
@@ -320,6 +343,7 @@ convert_dialog_response (GtkWidget     *dialog,
                          private->palette_type,
                          private->max_colors,
                          private->remove_duplicates,
+                         private->refine_palette,
                          private->dither_type,
                          private->dither_alpha,
                          private->dither_text_layers,
@@ -432,4 +456,9 @@ convert_dialog_type_update (GtkWidget     *widget,
                               GIMP_CONVERT_PALETTE_GENERATE &&
                               private->palette_type !=
                               GIMP_CONVERT_PALETTE_MONO);
+
+  if (private->refine_toggle)
+    gtk_widget_set_sensitive (private->refine_toggle,
+                              private->palette_type ==
+                              GIMP_CONVERT_PALETTE_GENERATE);
 }
@@ -24,6 +24,7 @@ typedef void (* GimpConvertIndexedCallback) (GtkWidget              *dialog,
                                              GimpConvertPaletteType  palette_type,
                                              gint                    max_colors,
                                              gboolean                remove_duplicates,
+                                             gboolean                refine_palette,
                                              GimpConvertDitherType   dither_type,
                                              gboolean                dither_alpha,
                                              gboolean                dither_text_layers,
@@ -37,6 +38,7 @@ GtkWidget * convert_indexed_dialog_new (GimpImage                  *image,
                                         GimpConvertPaletteType      palette_type,
                                         gint                        max_colors,
                                         gboolean                    remove_duplicates,
+                                        gboolean                    refine_palette,
                                         GimpConvertDitherType       dither_type,
                                         gboolean                    dither_alpha,
                                         gboolean                    dither_text_layers,
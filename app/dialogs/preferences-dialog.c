@@ -2396,6 +2396,9 @@ prefs_dialog_new (Gimp       *gimp,
                           _("Remove unused and duplicate colors "
                             "from colormap"),
                           GTK_BOX (vbox2));
+  prefs_check_button_add (object, "image-convert-indexed-refine-palette",
+                          _("Refine the generated colormap"),
+                          GTK_BOX (vbox2));
 
   grid = prefs_grid_new (GTK_CONTAINER (vbox2));
   prefs_enum_combo_box_add (object, "image-convert-indexed-dither-type", 0, 0,
@@ -40,6 +40,8 @@
 
 #include "widgets/gimprender.h"
 
+#include "gimp-log.h"
+
 
 /*  public functions  */
 
@@ -146,50 +148,31 @@ gimp_display_shell_draw_image (GimpDisplayShell *shell,
                                gint              w,
                                gint              h)
 {
-  gdouble chunk_width;
-  gdouble chunk_height;
-  gdouble scale = 1.0;
-  gint    n_rows;
-  gint    n_cols;
-  gint    r, c;
+  gdouble                chunk_width;
+  gdouble                chunk_height;
+  gdouble                scale;
+  gint                   n_rows;
+  gint                   n_cols;
+  gint                   r, c;
+  cairo_rectangle_int_t *chunks;
+  cairo_rectangle_int_t *invalid;
+  gint                   n_chunks;
+  gint                   i;
 
   g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
   g_return_if_fail (gimp_display_get_image (shell->display));
   g_return_if_fail (cr != NULL);
 
-  /*  display the image in RENDER_BUF_WIDTH x RENDER_BUF_HEIGHT
-   *  maximally-sized image-space chunks.  adjust the screen-space
-   *  chunk size as necessary, to accommodate for the display
-   *  transform and window scale factor.
-   */
-  chunk_width  = shell->render_buf_width;
-  chunk_height = shell->render_buf_height;
-
-  /* multiply the image scale-factor by the window scale-factor, and divide
-   * the cairo scale-factor by the same amount (further down), so that we make
-   * full use of the screen resolution, even on hidpi displays.
-   */
-  scale *= shell->render_scale;
-
-  scale *= MAX (shell->scale_x, shell->scale_y);
-
-  if (scale != shell->scale_x)
-    chunk_width  = (chunk_width  - 1.0) * (shell->scale_x / scale);
-  if (scale != shell->scale_y)
-    chunk_height = (chunk_height - 1.0) * (shell->scale_y / scale);
-
-  if (shell->rotate_untransform)
-    {
-      gdouble a = shell->rotate_angle * G_PI / 180.0;
-
-      chunk_width = chunk_height = (MIN (chunk_width, chunk_height) - 1.0) /
-                                   (fabs (sin (a)) + fabs (cos (a)));
-    }
+  gimp_display_shell_render_get_chunk_size (shell, &scale,
+                                            &chunk_width, &chunk_height);
 
   /* divide the painted area to evenly-sized chunks */
   n_rows = ceil (h / floor (chunk_height));
   n_cols = ceil (w / floor (chunk_width));
 
+  chunks   = g_new (cairo_rectangle_int_t, n_rows * n_cols);
+  n_chunks = 0;
+
   for (r = 0; r < n_rows; r++)
     {
       gint y1 = y + (2 *  r      * h + n_rows) / (2 * n_rows);
@@ -200,53 +183,101 @@ gimp_display_shell_draw_image (GimpDisplayShell *shell,
           gint x1 = x + (2 *  c      * w + n_cols) / (2 * n_cols);
           gint x2 = x + (2 * (c + 1) * w + n_cols) / (2 * n_cols);
 
-          cairo_save (cr);
+          chunks[r * n_cols + c].x      = x1;
+          chunks[r * n_cols + c].y      = y1;
+          chunks[r * n_cols + c].width  = x2 - x1;
+          chunks[r * n_cols + c].height = y2 - y1;
+        }
+    }
+
+  /* collect the chunks which are not in the render cache yet, and
+   * render them all at once, so they can be rendered in parallel
+   */
+  invalid = g_new (cairo_rectangle_int_t, n_rows * n_cols);
+
+  for (i = 0; i < n_rows * n_cols; i++)
+    {
+      if (! gimp_display_shell_render_is_valid (shell,
+                                                chunks[i].x,
+                                                chunks[i].y,
+                                                chunks[i].width,
+                                                chunks[i].height))
+        {
+          invalid[n_chunks++] = chunks[i];
+        }
+    }
+
+  if (n_chunks > 0)
+    {
+      gint64 start = g_get_monotonic_time ();
 
-          /* clip to chunk bounds, in screen space */
-          cairo_rectangle (cr, x1, y1, x2 - x1, y2 - y1);
-          cairo_clip (cr);
+      /* render image to the render cache */
+      gimp_display_shell_render_chunks (shell, cr, invalid, n_chunks, scale);
 
-          if (! gimp_display_shell_render_is_valid (shell,
-                                                    x1, y1, x2 - x1, y2 - y1))
-            {
-              /* render image to the render cache */
-              gimp_display_shell_render (shell, cr,
-                                         x1, y1, x2 - x1, y2 - y1,
-                                         scale);
+      GIMP_LOG (RENDER, "rendered %d chunks in %.3f ms",
+                n_chunks, (g_get_monotonic_time () - start) / 1000.0);
 
-              gimp_display_shell_render_validate_area (shell,
-                                                       x1, y1, x2 - x1, y2 - y1);
-            }
+      for (i = 0; i < n_chunks; i++)
+        {
+          gimp_display_shell_render_validate_area (shell,
+                                                   invalid[i].x,
+                                                   invalid[i].y,
+                                                   invalid[i].width,
+                                                   invalid[i].height);
+        }
+    }
 
-          /* divide the cairo scale-factor by the window scale-factor, since
-           * the render cache uses device pixels.  see comment further up.
-           */
-          cairo_scale (cr,
-                       1.0 / shell->render_scale,
-                       1.0 / shell->render_scale);
+  g_free (invalid);
 
-          /* render from the render cache to screen */
-          cairo_set_source_surface (cr, shell->render_cache, 0, 0);
-          cairo_paint (cr);
+  for (i = 0; i < n_rows * n_cols; i++)
+    {
+      gint x1 = chunks[i].x;
+      gint y1 = chunks[i].y;
+      gint x2 = chunks[i].x + chunks[i].width;
+      gint y2 = chunks[i].y + chunks[i].height;
 
-          cairo_restore (cr);
+      cairo_save (cr);
 
-          /* if the GIMP_BRICK_WALL environment variable is defined,
-           * show chunk bounds
-           */
-          {
-            static gint brick_wall = -1;
+      /* clip to chunk bounds, in screen space */
+      cairo_rectangle (cr, x1, y1, x2 - x1, y2 - y1);
+      cairo_clip (cr);
 
-            if (brick_wall < 0)
-              brick_wall = (g_getenv ("GIMP_BRICK_WALL") != NULL);
+      /* divide the cairo scale-factor by the window scale-factor, since
+       * the render cache uses device pixels.  see
+       * gimp_display_shell_render_get_chunk_size().
+       */
+      cairo_scale (cr,
+                   1.0 / shell->render_scale,
+                   1.0 / shell->render_scale);
 
-            if (brick_wall)
-              {
-                cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
-                cairo_rectangle (cr, x1, y1, x2 - x1, y2 - y1);
-                cairo_stroke (cr);
-              }
+      /* render from the render cache to screen, the cache's origin is
+       * the top-left corner of its margin
+       */
+      cairo_set_source_surface (
+        cr, shell->render_cache,
+        -GIMP_DISPLAY_RENDER_CACHE_MARGIN * shell->render_scale,
+        -GIMP_DISPLAY_RENDER_CACHE_MARGIN * shell->render_scale);
+      cairo_paint (cr);
+
+      cairo_restore (cr);
+
+      /* if the GIMP_BRICK_WALL environment variable is defined,
+       * show chunk bounds
+       */
+      {
+        static gint brick_wall = -1;
+
+        if (brick_wall < 0)
+          brick_wall = (g_getenv ("GIMP_BRICK_WALL") != NULL);
+
+        if (brick_wall)
+          {
+            cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
+            cairo_rectangle (cr, x1, y1, x2 - x1, y2 - y1);
+            cairo_stroke (cr);
           }
-        }
+      }
     }
+
+  g_free (chunks);
 }
@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gegl.h>
 #include <gtk/gtk.h>
 
@@ -38,11 +40,94 @@
 #include "gimpdisplayshell-filter.h"
 #include "gimpdisplayshell-profile.h"
 #include "gimpdisplayshell-render.h"
+#include "gimpdisplayshell-scale.h"
 
 
 #define GIMP_DISPLAY_RENDER_ENABLE_SCALING 1
 #define GIMP_DISPLAY_RENDER_MAX_SCALE      4
 
+/*  how far ahead of the scroll direction to prefetch, in seconds of
+ *  scrolling, and how much to prefetch on the other sides, in pixels
+ */
+#define GIMP_DISPLAY_RENDER_PREFETCH_TIME  0.25
+#define GIMP_DISPLAY_RENDER_PREFETCH_MIN   64
+
+/*  the number of chunks to prefetch per idle iteration  */
+#define GIMP_DISPLAY_RENDER_PREFETCH_BATCH 8
+
+
+/*  scratch buffers for rendering a single chunk  */
+typedef struct
+{
+  cairo_surface_t *render_surface;
+  GeglBuffer      *profile_buffer;
+  guchar          *profile_data;
+  gint             profile_stride;
+  GeglBuffer      *filter_buffer;
+  guchar          *filter_data;
+  gint             filter_stride;
+  cairo_surface_t *mask_surface;
+} RenderBuffers;
+
+typedef struct
+{
+  /*  screen-space bounds, in render cache pixels  */
+  gint             tx;
+  gint             ty;
+  gint             twidth;
+  gint             theight;
+
+  /*  scaled image-space bounds  */
+  gint             x;
+  gint             y;
+  gint             width;
+  gint             height;
+
+  /*  the rendered chunk, when rendered on a worker thread  */
+  cairo_surface_t *surface;
+} RenderChunk;
+
+typedef struct
+{
+  GimpDisplayShell *shell;
+  GeglBuffer       *buffer;
+#ifdef USE_NODE_BLIT
+  GeglNode         *node;
+#endif
+  const Babl       *format;
+  gdouble           scale;
+  GeglAbyssPolicy   abyss_policy;
+  gint              filter;
+  gboolean          can_convert_to_u8;
+  cairo_pattern_t  *mask_pattern;
+
+  RenderChunk      *chunks;
+  gint              n_chunks;
+  gint              next_chunk;
+} RenderContext;
+
+
+static gboolean   gimp_display_shell_render_can_parallel      (GimpDisplayShell  *shell);
+static void       gimp_display_shell_render_get_shell_buffers (GimpDisplayShell  *shell,
+                                                               cairo_t           *cr,
+                                                               RenderContext     *ctx,
+                                                               RenderBuffers     *buffers);
+static void       gimp_display_shell_render_buffers_init      (RenderContext     *ctx,
+                                                               RenderBuffers     *buffers);
+static void       gimp_display_shell_render_buffers_clear     (RenderBuffers     *buffers);
+static void       gimp_display_shell_render_chunks_func       (gint               i,
+                                                               gint               n,
+                                                               RenderContext     *ctx);
+static void       gimp_display_shell_render_setup_cr          (GimpDisplayShell  *shell,
+                                                               cairo_t           *my_cr,
+                                                               const RenderChunk *chunk,
+                                                               gdouble            scale);
+static void       gimp_display_shell_render_chunk             (RenderContext     *ctx,
+                                                               RenderBuffers     *buffers,
+                                                               cairo_t           *my_cr,
+                                                               const RenderChunk *chunk);
+static gboolean   gimp_display_shell_render_prefetch_idle     (GimpDisplayShell  *shell);
+
 
 void
 gimp_display_shell_render_set_scale (GimpDisplayShell *shell,
@@ -62,6 +147,49 @@ gimp_display_shell_render_set_scale (GimpDisplayShell *shell,
 #endif
 }
 
+/*  display the image in RENDER_BUF_WIDTH x RENDER_BUF_HEIGHT
+ *  maximally-sized image-space chunks.  adjust the screen-space
+ *  chunk size as necessary, to accommodate for the display
+ *  transform and window scale factor.
+ */
+void
+gimp_display_shell_render_get_chunk_size (GimpDisplayShell *shell,
+                                          gdouble          *scale,
+                                          gdouble          *chunk_width,
+                                          gdouble          *chunk_height)
+{
+  gdouble s  = 1.0;
+  gdouble cw = shell->render_buf_width;
+  gdouble ch = shell->render_buf_height;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  /* multiply the image scale-factor by the window scale-factor, and divide
+   * the cairo scale-factor by the same amount when painting the render
+   * cache, so that we make full use of the screen resolution, even on
+   * hidpi displays.
+   */
+  s *= shell->render_scale;
+
+  s *= MAX (shell->scale_x, shell->scale_y);
+
+  if (s != shell->scale_x)
+    cw = (cw - 1.0) * (shell->scale_x / s);
+  if (s != shell->scale_y)
+    ch = (ch - 1.0) * (shell->scale_y / s);
+
+  if (shell->rotate_untransform)
+    {
+      gdouble a = shell->rotate_angle * G_PI / 180.0;
+
+      cw = ch = (MIN (cw, ch) - 1.0) / (fabs (sin (a)) + fabs (cos (a)));
+    }
+
+  if (scale)        *scale        = s;
+  if (chunk_width)  *chunk_width  = cw;
+  if (chunk_height) *chunk_height = ch;
+}
+
 void
 gimp_display_shell_render_invalidate_full (GimpDisplayShell *shell)
 {
@@ -149,62 +277,45 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                            gint              theight,
                            gdouble           scale)
 {
-  GimpDisplayConfig *display_config;
-  GimpImage         *image;
-  GeglBuffer        *buffer;
-#ifdef USE_NODE_BLIT
-  GeglNode          *node;
-#endif
-
-  cairo_t           *my_cr;
-  gint               cairo_stride;
-  guchar            *cairo_data;
-  gdouble            x1, y1;
-  gdouble            x2, y2;
-  gint               x;
-  gint               y;
-  gint               width;
-  gint               height;
-  GeglAbyssPolicy    abyss_policy;
-  gint               filter = GEGL_BUFFER_FILTER_AUTO;
+  cairo_rectangle_int_t chunk;
 
   g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
   g_return_if_fail (cr != NULL);
   g_return_if_fail (scale > 0.0);
 
-  /* map chunk from screen space to scaled image space */
-  gimp_display_shell_untransform_bounds_with_scale (shell, scale,
-                                                    tx, ty,
-                                                    tx + twidth, ty + theight,
-                                                    &x1, &y1,
-                                                    &x2, &y2);
-
-  x      = floor (x1);
-  y      = floor (y1);
-  width  = ceil  (x2) - x;
-  height = ceil  (y2) - y;
+  chunk.x      = tx;
+  chunk.y      = ty;
+  chunk.width  = twidth;
+  chunk.height = theight;
 
-  g_return_if_fail (width  > 0 && width  <= shell->render_buf_width);
-  g_return_if_fail (height > 0 && height <= shell->render_buf_height);
+  gimp_display_shell_render_chunks (shell, cr, &chunk, 1, scale);
+}
 
-  tx      *= shell->render_scale;
-  ty      *= shell->render_scale;
-  twidth  *= shell->render_scale;
-  theight *= shell->render_scale;
+void
+gimp_display_shell_render_chunks (GimpDisplayShell            *shell,
+                                  cairo_t                     *cr,
+                                  const cairo_rectangle_int_t *chunks,
+                                  gint                         n_chunks,
+                                  gdouble                      scale)
+{
+  GimpDisplayConfig *display_config;
+  GimpImage         *image;
+  RenderChunk       *render_chunks;
+  RenderContext      ctx = { 0, };
+  cairo_t           *my_cr;
+  gint               i;
 
-  display_config = shell->display->config;
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+  g_return_if_fail (cr != NULL);
+  g_return_if_fail (chunks != NULL || n_chunks == 0);
+  g_return_if_fail (scale > 0.0);
 
-  if (shell->show_all)
-    abyss_policy = GEGL_ABYSS_NONE;
-  else
-    abyss_policy = GEGL_ABYSS_CLAMP;
+  if (n_chunks == 0)
+    return;
 
-  if (display_config->zoom_quality != GIMP_ZOOM_QUALITY_HIGH)
-    {
-      filter = GEGL_BUFFER_FILTER_NEAREST;
-    }
+  display_config = shell->display->config;
 
-  image  = gimp_display_get_image (shell->display);
+  image = gimp_display_get_image (shell->display);
 
   /* While converting, the render can be wrong; but worse, we rely on allocated
    * data which might be the wrong size and this was a crash we had which was
@@ -214,14 +325,391 @@ gimp_display_shell_render (GimpDisplayShell *shell,
    */
   g_return_if_fail (! gimp_image_get_converting (image));
 
-  buffer = gimp_pickable_get_buffer (
+  render_chunks = g_new0 (RenderChunk, n_chunks);
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      RenderChunk *chunk = &render_chunks[i];
+      gdouble      x1, y1;
+      gdouble      x2, y2;
+
+      /* map chunk from screen space to scaled image space */
+      gimp_display_shell_untransform_bounds_with_scale (
+        shell, scale,
+        chunks[i].x,                   chunks[i].y,
+        chunks[i].x + chunks[i].width, chunks[i].y + chunks[i].height,
+        &x1, &y1,
+        &x2, &y2);
+
+      chunk->x      = floor (x1);
+      chunk->y      = floor (y1);
+      chunk->width  = ceil  (x2) - chunk->x;
+      chunk->height = ceil  (y2) - chunk->y;
+
+      if (chunk->width  <= 0 || chunk->width  > shell->render_buf_width ||
+          chunk->height <= 0 || chunk->height > shell->render_buf_height)
+        {
+          g_critical ("%s: chunk size %d x %d out of range",
+                      G_STRFUNC, chunk->width, chunk->height);
+
+          g_free (render_chunks);
+
+          return;
+        }
+
+      chunk->tx      = (chunks[i].x + GIMP_DISPLAY_RENDER_CACHE_MARGIN) *
+                       shell->render_scale;
+      chunk->ty      = (chunks[i].y + GIMP_DISPLAY_RENDER_CACHE_MARGIN) *
+                       shell->render_scale;
+      chunk->twidth  = chunks[i].width  * shell->render_scale;
+      chunk->theight = chunks[i].height * shell->render_scale;
+    }
+
+  ctx.shell  = shell;
+  ctx.scale  = scale;
+  ctx.filter = GEGL_BUFFER_FILTER_AUTO;
+
+  if (shell->show_all)
+    ctx.abyss_policy = GEGL_ABYSS_NONE;
+  else
+    ctx.abyss_policy = GEGL_ABYSS_CLAMP;
+
+  if (display_config->zoom_quality != GIMP_ZOOM_QUALITY_HIGH)
+    ctx.filter = GEGL_BUFFER_FILTER_NEAREST;
+
+  ctx.buffer = gimp_pickable_get_buffer (
     gimp_display_shell_get_pickable (shell));
 #ifdef USE_NODE_BLIT
-  node   = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
+  ctx.node   = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
+#endif
+  ctx.format = gimp_projectable_get_format (GIMP_PROJECTABLE (image));
+
+  if (! shell->render_cache)
+    {
+      shell->render_cache = cairo_surface_create_similar_image (
+        cairo_get_target (cr),
+        CAIRO_FORMAT_ARGB32,
+        (shell->disp_width  + 2 * GIMP_DISPLAY_RENDER_CACHE_MARGIN) *
+        shell->render_scale,
+        (shell->disp_height + 2 * GIMP_DISPLAY_RENDER_CACHE_MARGIN) *
+        shell->render_scale);
+    }
+
+  if (! shell->render_cache_valid)
+    {
+      shell->render_cache_valid = cairo_region_create ();
+    }
+
+  my_cr = cairo_create (shell->render_cache);
+
+  if (shell->mask)
+    {
+      /*  resolve the mask color on the main thread, it depends on the
+       *  widget's color management
+       */
+      gimp_cairo_set_source_color (my_cr, shell->mask_color,
+                                   GIMP_CORE_CONFIG (display_config)->color_management,
+                                   FALSE, GTK_WIDGET (shell));
 
+      ctx.mask_pattern = cairo_pattern_reference (cairo_get_source (my_cr));
+    }
+
+  if (shell->profile_transform ||
+      gimp_display_shell_has_filter (shell))
+    {
+      ctx.can_convert_to_u8 = gimp_display_shell_profile_can_convert_to_u8 (shell);
+    }
+
+#ifdef USE_NODE_BLIT
   gimp_projectable_begin_render (GIMP_PROJECTABLE (image));
 #endif
 
+  if (n_chunks > 1 && gimp_display_shell_render_can_parallel (shell))
+    {
+      /*  render the chunks concurrently into private surfaces, and
+       *  copy them to the render cache on this thread, so that cairo
+       *  objects are never shared between threads
+       */
+      ctx.chunks     = render_chunks;
+      ctx.n_chunks   = n_chunks;
+      ctx.next_chunk = 0;
+
+      gegl_parallel_distribute (
+        n_chunks,
+        (GeglParallelDistributeFunc) gimp_display_shell_render_chunks_func,
+        &ctx);
+
+      cairo_set_operator (my_cr, CAIRO_OPERATOR_SOURCE);
+
+      for (i = 0; i < n_chunks; i++)
+        {
+          RenderChunk *chunk = &render_chunks[i];
+
+          if (! chunk->surface)
+            continue;
+
+          cairo_set_source_surface (my_cr, chunk->surface,
+                                    chunk->tx, chunk->ty);
+          cairo_rectangle (my_cr,
+                           chunk->tx, chunk->ty,
+                           chunk->twidth, chunk->theight);
+          cairo_fill (my_cr);
+
+          cairo_surface_destroy (chunk->surface);
+        }
+    }
+  else
+    {
+      RenderBuffers buffers;
+
+      gimp_display_shell_render_get_shell_buffers (shell, cr, &ctx, &buffers);
+
+      for (i = 0; i < n_chunks; i++)
+        {
+          RenderChunk *chunk = &render_chunks[i];
+
+          cairo_save (my_cr);
+
+          gimp_display_shell_render_setup_cr (shell, my_cr, chunk, scale);
+          gimp_display_shell_render_chunk (&ctx, &buffers, my_cr, chunk);
+
+          cairo_restore (my_cr);
+        }
+    }
+
+#ifdef USE_NODE_BLIT
+  gimp_projectable_end_render (GIMP_PROJECTABLE (image));
+#endif
+
+  g_clear_pointer (&ctx.mask_pattern, cairo_pattern_destroy);
+
+  cairo_destroy (my_cr);
+
+  g_free (render_chunks);
+}
+
+/**
+ * gimp_display_shell_render_scrolled:
+ * @shell:    a #GimpDisplayShell
+ * @x_offset: the horizontal change of the scroll offset
+ * @y_offset: the vertical change of the scroll offset
+ *
+ * Updates the scroll velocity estimate, and schedules rendering of
+ * the render cache's margin around the viewport at idle priority,
+ * mostly in the direction of scrolling.
+ **/
+void
+gimp_display_shell_render_scrolled (GimpDisplayShell *shell,
+                                    gint              x_offset,
+                                    gint              y_offset)
+{
+  gint64 now;
+  gint64 dt;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  now = g_get_monotonic_time ();
+  dt  = now - shell->render_scroll_time;
+
+  if (shell->render_scroll_time && dt > 0 && dt < G_TIME_SPAN_SECOND / 4)
+    {
+      gdouble vx = x_offset * (gdouble) G_TIME_SPAN_SECOND / dt;
+      gdouble vy = y_offset * (gdouble) G_TIME_SPAN_SECOND / dt;
+
+      /*  smooth out irregular event timing  */
+      shell->render_scroll_vx = (shell->render_scroll_vx + vx) / 2.0;
+      shell->render_scroll_vy = (shell->render_scroll_vy + vy) / 2.0;
+    }
+  else
+    {
+      shell->render_scroll_vx = 0.0;
+      shell->render_scroll_vy = 0.0;
+    }
+
+  shell->render_scroll_time = now;
+
+  if (! shell->render_prefetch_idle_id)
+    {
+      shell->render_prefetch_idle_id =
+        g_idle_add_full (G_PRIORITY_LOW,
+                         (GSourceFunc) gimp_display_shell_render_prefetch_idle,
+                         shell, NULL);
+    }
+}
+
+
+/*  private functions  */
+
+static gboolean
+gimp_display_shell_render_prefetch_idle (GimpDisplayShell *shell)
+{
+  GimpImage             *image;
+  cairo_rectangle_int_t  ring;
+  cairo_rectangle_int_t  chunks[GIMP_DISPLAY_RENDER_PREFETCH_BATCH];
+  GeglRectangle          image_rect;
+  GeglRectangle          area;
+  gdouble                x1, y1;
+  gdouble                x2, y2;
+  gdouble                scale;
+  gdouble                chunk_width;
+  gdouble                chunk_height;
+  gint                   ahead_x;
+  gint                   ahead_y;
+  gint                   cw, ch;
+  gint                   n_chunks = 0;
+  gint                   x, y;
+  cairo_t               *cr;
+
+  image = gimp_display_get_image (shell->display);
+
+  if (! image                            ||
+      gimp_image_get_converting (image)  ||
+      ! shell->show_image                ||
+      ! shell->render_cache              ||
+      ! shell->render_cache_valid        ||
+      ! gtk_widget_is_drawable (shell->canvas))
+    {
+      shell->render_prefetch_idle_id = 0;
+
+      return G_SOURCE_REMOVE;
+    }
+
+  /*  prefetch further ahead the faster we scroll  */
+  ahead_x = CLAMP (fabs (shell->render_scroll_vx) *
+                   GIMP_DISPLAY_RENDER_PREFETCH_TIME,
+                   GIMP_DISPLAY_RENDER_PREFETCH_MIN,
+                   GIMP_DISPLAY_RENDER_CACHE_MARGIN);
+  ahead_y = CLAMP (fabs (shell->render_scroll_vy) *
+                   GIMP_DISPLAY_RENDER_PREFETCH_TIME,
+                   GIMP_DISPLAY_RENDER_PREFETCH_MIN,
+                   GIMP_DISPLAY_RENDER_CACHE_MARGIN);
+
+  ring.x      = shell->render_scroll_vx < 0.0 ? -ahead_x :
+                                                -GIMP_DISPLAY_RENDER_PREFETCH_MIN;
+  ring.y      = shell->render_scroll_vy < 0.0 ? -ahead_y :
+                                                -GIMP_DISPLAY_RENDER_PREFETCH_MIN;
+  ring.width  = shell->disp_width  - ring.x +
+                (shell->render_scroll_vx > 0.0 ? ahead_x :
+                                                 GIMP_DISPLAY_RENDER_PREFETCH_MIN);
+  ring.height = shell->disp_height - ring.y +
+                (shell->render_scroll_vy > 0.0 ? ahead_y :
+                                                 GIMP_DISPLAY_RENDER_PREFETCH_MIN);
+
+  /*  only the part of the ring which shows the image  */
+  gimp_display_shell_scale_get_image_unrotated_bounding_box (shell,
+                                                             &image_rect.x,
+                                                             &image_rect.y,
+                                                             &image_rect.width,
+                                                             &image_rect.height);
+
+  gimp_display_shell_rotate_bounds (shell,
+                                    image_rect.x,
+                                    image_rect.y,
+                                    image_rect.x + image_rect.width,
+                                    image_rect.y + image_rect.height,
+                                    &x1, &y1, &x2, &y2);
+
+  image_rect.x      = floor (x1);
+  image_rect.y      = floor (y1);
+  image_rect.width  = ceil  (x2) - image_rect.x;
+  image_rect.height = ceil  (y2) - image_rect.y;
+
+  if (! gegl_rectangle_intersect (&area,
+                                  &image_rect,
+                                  GEGL_RECTANGLE (ring.x,     ring.y,
+                                                  ring.width, ring.height)))
+    {
+      shell->render_prefetch_idle_id = 0;
+
+      return G_SOURCE_REMOVE;
+    }
+
+  gimp_display_shell_render_get_chunk_size (shell, &scale,
+                                            &chunk_width, &chunk_height);
+
+  cw = floor (chunk_width);
+  ch = floor (chunk_height);
+
+  /*  collect a batch of invalid chunks on a fixed grid  */
+  for (y = floor ((gdouble) area.y / ch) * ch;
+       y < area.y + area.height &&
+       n_chunks < GIMP_DISPLAY_RENDER_PREFETCH_BATCH;
+       y += ch)
+    {
+      for (x = floor ((gdouble) area.x / cw) * cw;
+           x < area.x + area.width &&
+           n_chunks < GIMP_DISPLAY_RENDER_PREFETCH_BATCH;
+           x += cw)
+        {
+          GeglRectangle chunk;
+
+          gegl_rectangle_intersect (&chunk, &area,
+                                    GEGL_RECTANGLE (x, y, cw, ch));
+
+          if (chunk.width > 0 && chunk.height > 0 &&
+              ! gimp_display_shell_render_is_valid (shell,
+                                                    chunk.x,     chunk.y,
+                                                    chunk.width, chunk.height))
+            {
+              chunks[n_chunks].x      = chunk.x;
+              chunks[n_chunks].y      = chunk.y;
+              chunks[n_chunks].width  = chunk.width;
+              chunks[n_chunks].height = chunk.height;
+
+              n_chunks++;
+            }
+        }
+    }
+
+  if (n_chunks > 0)
+    {
+      gint i;
+
+      cr = cairo_create (shell->render_cache);
+
+      gimp_display_shell_render_chunks (shell, cr, chunks, n_chunks, scale);
+
+      cairo_destroy (cr);
+
+      for (i = 0; i < n_chunks; i++)
+        {
+          gimp_display_shell_render_validate_area (shell,
+                                                   chunks[i].x,
+                                                   chunks[i].y,
+                                                   chunks[i].width,
+                                                   chunks[i].height);
+        }
+    }
+
+  if (n_chunks < GIMP_DISPLAY_RENDER_PREFETCH_BATCH)
+    {
+      shell->render_prefetch_idle_id = 0;
+
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+gimp_display_shell_render_can_parallel (GimpDisplayShell *shell)
+{
+#ifdef USE_NODE_BLIT
+  /*  the projectable's graph is not meant to be processed concurrently  */
+  return FALSE;
+#else
+  /*  color display modules are not required to be thread-safe  */
+  return ! gimp_display_shell_has_filter (shell);
+#endif
+}
+
+/*  use the shell's scratch buffers, creating them on demand  */
+static void
+gimp_display_shell_render_get_shell_buffers (GimpDisplayShell *shell,
+                                             cairo_t          *cr,
+                                             RenderContext    *ctx,
+                                             RenderBuffers    *buffers)
+{
   if (! shell->render_surface)
     {
       shell->render_surface =
@@ -231,74 +719,200 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                                             shell->render_buf_height);
     }
 
-  cairo_surface_flush (shell->render_surface);
+  /*  create the filter buffer if we have filters, or can't convert
+   *  to u8 directly
+   */
+  if ((shell->profile_transform || gimp_display_shell_has_filter (shell)) &&
+      (gimp_display_shell_has_filter (shell) || ! ctx->can_convert_to_u8) &&
+      ! shell->filter_buffer)
+    {
+      gint fw = shell->render_buf_width;
+      gint fh = shell->render_buf_height;
+
+      shell->filter_data =
+        gegl_malloc (fw * fh *
+                     babl_format_get_bytes_per_pixel (shell->filter_format));
+
+      shell->filter_stride =
+        fw * babl_format_get_bytes_per_pixel (shell->filter_format);
+
+      shell->filter_buffer =
+        gegl_buffer_linear_new_from_data (shell->filter_data,
+                                          shell->filter_format,
+                                          GEGL_RECTANGLE (0, 0, fw, fh),
+                                          GEGL_AUTO_ROWSTRIDE,
+                                          (GDestroyNotify) gegl_free,
+                                          shell->filter_data);
+    }
 
-  if (! shell->render_cache)
+  if (shell->mask && ! shell->mask_surface)
     {
-      shell->render_cache = cairo_surface_create_similar_image (
-        cairo_get_target (cr),
-        CAIRO_FORMAT_ARGB32,
-        shell->disp_width  * shell->render_scale,
-        shell->disp_height * shell->render_scale);
+      shell->mask_surface =
+        cairo_image_surface_create (CAIRO_FORMAT_A8,
+                                    shell->render_buf_width,
+                                    shell->render_buf_height);
     }
 
-  if (! shell->render_cache_valid)
+  buffers->render_surface = shell->render_surface;
+  buffers->profile_buffer = shell->profile_buffer;
+  buffers->profile_data   = shell->profile_data;
+  buffers->profile_stride = shell->profile_stride;
+  buffers->filter_buffer  = shell->filter_buffer;
+  buffers->filter_data    = shell->filter_data;
+  buffers->filter_stride  = shell->filter_stride;
+  buffers->mask_surface   = shell->mask_surface;
+}
+
+/*  allocate private scratch buffers for a render thread  */
+static void
+gimp_display_shell_render_buffers_init (RenderContext *ctx,
+                                        RenderBuffers *buffers)
+{
+  GimpDisplayShell *shell = ctx->shell;
+  gint              w     = shell->render_buf_width;
+  gint              h     = shell->render_buf_height;
+
+  memset (buffers, 0, sizeof (RenderBuffers));
+
+  buffers->render_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                        w, h);
+
+  if (shell->profile_buffer)
     {
-      shell->render_cache_valid = cairo_region_create ();
+      const Babl *format = gegl_buffer_get_format (shell->profile_buffer);
+
+      buffers->profile_stride = w * babl_format_get_bytes_per_pixel (format);
+      buffers->profile_data   = gegl_malloc (buffers->profile_stride * h);
+      buffers->profile_buffer =
+        gegl_buffer_linear_new_from_data (buffers->profile_data,
+                                          format,
+                                          GEGL_RECTANGLE (0, 0, w, h),
+                                          GEGL_AUTO_ROWSTRIDE,
+                                          (GDestroyNotify) gegl_free,
+                                          buffers->profile_data);
     }
 
-  my_cr = cairo_create (shell->render_cache);
+  if (shell->profile_transform && ! ctx->can_convert_to_u8)
+    {
+      const Babl *format = shell->filter_format;
+
+      buffers->filter_stride = w * babl_format_get_bytes_per_pixel (format);
+      buffers->filter_data   = gegl_malloc (buffers->filter_stride * h);
+      buffers->filter_buffer =
+        gegl_buffer_linear_new_from_data (buffers->filter_data,
+                                          format,
+                                          GEGL_RECTANGLE (0, 0, w, h),
+                                          GEGL_AUTO_ROWSTRIDE,
+                                          (GDestroyNotify) gegl_free,
+                                          buffers->filter_data);
+    }
+
+  if (shell->mask)
+    {
+      buffers->mask_surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+                                                          w, h);
+    }
+}
+
+static void
+gimp_display_shell_render_buffers_clear (RenderBuffers *buffers)
+{
+  g_clear_pointer (&buffers->render_surface, cairo_surface_destroy);
+  g_clear_object  (&buffers->profile_buffer);
+  g_clear_object  (&buffers->filter_buffer);
+  g_clear_pointer (&buffers->mask_surface, cairo_surface_destroy);
+}
 
+static void
+gimp_display_shell_render_chunks_func (gint           i,
+                                       gint           n,
+                                       RenderContext *ctx)
+{
+  RenderBuffers buffers;
+  gint          c;
+
+  gimp_display_shell_render_buffers_init (ctx, &buffers);
+
+  while ((c = g_atomic_int_add (&ctx->next_chunk, 1)) < ctx->n_chunks)
+    {
+      RenderChunk *chunk = &ctx->chunks[c];
+      cairo_t     *my_cr;
+
+      chunk->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                   chunk->twidth,
+                                                   chunk->theight);
+
+      my_cr = cairo_create (chunk->surface);
+
+      /*  the chunk surface's origin is the chunk's corner  */
+      cairo_translate (my_cr, -chunk->tx, -chunk->ty);
+
+      gimp_display_shell_render_setup_cr (ctx->shell, my_cr, chunk, ctx->scale);
+      gimp_display_shell_render_chunk (ctx, &buffers, my_cr, chunk);
+
+      cairo_destroy (my_cr);
+
+      cairo_surface_flush (chunk->surface);
+    }
+
+  gimp_display_shell_render_buffers_clear (&buffers);
+}
+
+static void
+gimp_display_shell_render_setup_cr (GimpDisplayShell  *shell,
+                                    cairo_t           *my_cr,
+                                    const RenderChunk *chunk,
+                                    gdouble            scale)
+{
   /* clip to chunk bounds, in screen space */
-  cairo_rectangle (my_cr, tx, ty, twidth, theight);
+  cairo_rectangle (my_cr, chunk->tx, chunk->ty, chunk->twidth, chunk->theight);
   cairo_clip (my_cr);
 
+  /* the render cache extends beyond the viewport by a margin */
+  cairo_translate (my_cr,
+                   GIMP_DISPLAY_RENDER_CACHE_MARGIN * shell->render_scale,
+                   GIMP_DISPLAY_RENDER_CACHE_MARGIN * shell->render_scale);
+
   /* transform to scaled image space, and apply uneven scaling */
   cairo_scale (my_cr, shell->render_scale, shell->render_scale);
   if (shell->rotate_transform)
     cairo_transform (my_cr, shell->rotate_transform);
   cairo_translate (my_cr, -shell->offset_x, -shell->offset_y);
   cairo_scale (my_cr, shell->scale_x / scale, shell->scale_y / scale);
+}
 
-  cairo_stride = cairo_image_surface_get_stride (shell->render_surface);
-  cairo_data   = cairo_image_surface_get_data (shell->render_surface);
+static void
+gimp_display_shell_render_chunk (RenderContext     *ctx,
+                                 RenderBuffers     *buffers,
+                                 cairo_t           *my_cr,
+                                 const RenderChunk *chunk)
+{
+  GimpDisplayShell *shell        = ctx->shell;
+  GeglBuffer       *buffer       = ctx->buffer;
+  gdouble           scale        = ctx->scale;
+  GeglAbyssPolicy   abyss_policy = ctx->abyss_policy;
+  gint              filter       = ctx->filter;
+  gint              x            = chunk->x;
+  gint              y            = chunk->y;
+  gint              width        = chunk->width;
+  gint              height       = chunk->height;
+  gint              cairo_stride;
+  guchar           *cairo_data;
+
+  cairo_surface_flush (buffers->render_surface);
+
+  cairo_stride = cairo_image_surface_get_stride (buffers->render_surface);
+  cairo_data   = cairo_image_surface_get_data (buffers->render_surface);
 
   if (shell->profile_transform ||
       gimp_display_shell_has_filter (shell))
     {
-      gboolean can_convert_to_u8;
+      gboolean can_convert_to_u8 = ctx->can_convert_to_u8;
 
       /*  if there is a profile transform or a display filter, we need
        *  to use temp buffers
        */
 
-      can_convert_to_u8 = gimp_display_shell_profile_can_convert_to_u8 (shell);
-
-      /*  create the filter buffer if we have filters, or can't convert
-       *  to u8 directly
-       */
-      if ((gimp_display_shell_has_filter (shell) || ! can_convert_to_u8) &&
-          ! shell->filter_buffer)
-        {
-          gint fw = shell->render_buf_width;
-          gint fh = shell->render_buf_height;
-
-          shell->filter_data =
-            gegl_malloc (fw * fh *
-                         babl_format_get_bytes_per_pixel (shell->filter_format));
-
-          shell->filter_stride =
-            fw * babl_format_get_bytes_per_pixel (shell->filter_format);
-
-          shell->filter_buffer =
-            gegl_buffer_linear_new_from_data (shell->filter_data,
-                                              shell->filter_format,
-                                              GEGL_RECTANGLE (0, 0, fw, fh),
-                                              GEGL_AUTO_ROWSTRIDE,
-                                              (GDestroyNotify) gegl_free,
-                                              shell->filter_data);
-        }
-
       if (! gimp_display_shell_has_filter (shell) || shell->filter_transform)
         {
           /*  if there are no filters, or there is a filter transform,
@@ -307,14 +921,14 @@ gimp_display_shell_render (GimpDisplayShell *shell,
 #ifndef USE_NODE_BLIT
           gegl_buffer_get (buffer,
                            GEGL_RECTANGLE (x, y, width, height), scale,
-                           gimp_projectable_get_format (GIMP_PROJECTABLE (image)),
-                           shell->profile_data, shell->profile_stride,
+                           ctx->format,
+                           buffers->profile_data, buffers->profile_stride,
                            abyss_policy | filter);
 #else
-          gegl_node_blit (node,
+          gegl_node_blit (ctx->node,
                           scale, GEGL_RECTANGLE (x, y, width, height),
-                          gimp_projectable_get_format (GIMP_PROJECTABLE (image)),
-                          shell->profile_data, shell->profile_stride,
+                          ctx->format,
+                          buffers->profile_data, buffers->profile_stride,
                           GEGL_BLIT_CACHE | filter);
 #endif
         }
@@ -326,13 +940,13 @@ gimp_display_shell_render (GimpDisplayShell *shell,
           gegl_buffer_get (buffer,
                            GEGL_RECTANGLE (x, y, width, height), scale,
                            shell->filter_format,
-                           shell->filter_data, shell->filter_stride,
+                           buffers->filter_data, buffers->filter_stride,
                            abyss_policy | filter);
 #else
-          gegl_node_blit (node,
+          gegl_node_blit (ctx->node,
                           scale, GEGL_RECTANGLE (x, y, width, height),
                           shell->filter_format,
-                          shell->filter_data, shell->filter_stride,
+                          buffers->filter_data, buffers->filter_stride,
                           GEGL_BLIT_CACHE | filter);
 #endif
         }
@@ -343,10 +957,10 @@ gimp_display_shell_render (GimpDisplayShell *shell,
       if (shell->filter_transform)
         {
           gimp_color_transform_process_buffer (shell->filter_transform,
-                                               shell->profile_buffer,
+                                               buffers->profile_buffer,
                                                GEGL_RECTANGLE (0, 0,
                                                                width, height),
-                                               shell->filter_buffer,
+                                               buffers->filter_buffer,
                                                GEGL_RECTANGLE (0, 0,
                                                                width, height));
         }
@@ -362,7 +976,7 @@ gimp_display_shell_render (GimpDisplayShell *shell,
            *  position-dependent filters
            */
           filter_buffer = g_object_new (GEGL_TYPE_BUFFER,
-                                        "source", shell->filter_buffer,
+                                        "source", buffers->filter_buffer,
                                         "shift-x", -x,
                                         "shift-y", -y,
                                         NULL);
@@ -387,10 +1001,10 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                *  in-place
                */
               gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->filter_buffer,
+                                                   buffers->filter_buffer,
                                                    GEGL_RECTANGLE (0, 0,
                                                                    width, height),
-                                                   shell->filter_buffer,
+                                                   buffers->filter_buffer,
                                                    GEGL_RECTANGLE (0, 0,
                                                                    width, height));
             }
@@ -400,10 +1014,10 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                *  the pixels from the profile_buffer to the filter_buffer
                */
               gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->profile_buffer,
+                                                   buffers->profile_buffer,
                                                    GEGL_RECTANGLE (0, 0,
                                                                    width, height),
-                                                   shell->filter_buffer,
+                                                   buffers->filter_buffer,
                                                    GEGL_RECTANGLE (0, 0,
                                                                    width, height));
             }
@@ -421,7 +1035,7 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                *  the cairo_buffer
                */
               gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->profile_buffer,
+                                                   buffers->profile_buffer,
                                                    GEGL_RECTANGLE (0, 0,
                                                                    width, height),
                                                    buffer,
@@ -436,7 +1050,7 @@ gimp_display_shell_render (GimpDisplayShell *shell,
        */
       if (gimp_display_shell_has_filter (shell) || ! can_convert_to_u8)
         {
-          gegl_buffer_get (shell->filter_buffer,
+          gegl_buffer_get (buffers->filter_buffer,
                            GEGL_RECTANGLE (0, 0, width, height), 1.0,
                            babl_format ("cairo-ARGB32"),
                            cairo_data, cairo_stride,
@@ -455,7 +1069,7 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                        cairo_data, cairo_stride,
                        abyss_policy | filter);
 #else
-      gegl_node_blit (node,
+      gegl_node_blit (ctx->node,
                       scale, GEGL_RECTANGLE (x, y, width, height),
                       babl_format ("cairo-ARGB32"),
                       cairo_data, cairo_stride,
@@ -463,34 +1077,22 @@ gimp_display_shell_render (GimpDisplayShell *shell,
 #endif
     }
 
-#ifdef USE_NODE_BLIT
-  gimp_projectable_end_render (GIMP_PROJECTABLE (image));
-#endif
-
-  cairo_surface_mark_dirty (shell->render_surface);
+  cairo_surface_mark_dirty (buffers->render_surface);
 
   /*  SOURCE so the destination's alpha is replaced  */
   cairo_set_operator (my_cr, CAIRO_OPERATOR_SOURCE);
 
-  cairo_set_source_surface (my_cr, shell->render_surface, x, y);
+  cairo_set_source_surface (my_cr, buffers->render_surface, x, y);
   cairo_paint (my_cr);
 
   cairo_set_operator (my_cr, CAIRO_OPERATOR_OVER);
 
   if (shell->mask)
     {
-      if (! shell->mask_surface)
-        {
-          shell->mask_surface =
-            cairo_image_surface_create (CAIRO_FORMAT_A8,
-                                        shell->render_buf_width,
-                                        shell->render_buf_height);
-        }
-
-      cairo_surface_flush (shell->mask_surface);
+      cairo_surface_flush (buffers->mask_surface);
 
-      cairo_stride = cairo_image_surface_get_stride (shell->mask_surface);
-      cairo_data   = cairo_image_surface_get_data (shell->mask_surface);
+      cairo_stride = cairo_image_surface_get_stride (buffers->mask_surface);
+      cairo_data   = cairo_image_surface_get_data (buffers->mask_surface);
 
       gegl_buffer_get (shell->mask,
                        GEGL_RECTANGLE (x - floor (shell->mask_offset_x * scale),
@@ -521,13 +1123,9 @@ gimp_display_shell_render (GimpDisplayShell *shell,
             }
         }
 
-      cairo_surface_mark_dirty (shell->mask_surface);
+      cairo_surface_mark_dirty (buffers->mask_surface);
 
-      gimp_cairo_set_source_color (my_cr, shell->mask_color,
-                                   GIMP_CORE_CONFIG (display_config)->color_management,
-                                   FALSE, GTK_WIDGET (shell));
-      cairo_mask_surface (my_cr, shell->mask_surface, x, y);
+      cairo_set_source (my_cr, ctx->mask_pattern);
+      cairo_mask_surface (my_cr, buffers->mask_surface, x, y);
     }
-
-  cairo_destroy (my_cr);
 }
@@ -19,9 +19,20 @@
 #define __GIMP_DISPLAY_SHELL_RENDER_H__
 
 
+/*  the render cache extends this many screen pixels beyond each side
+ *  of the viewport, so that scrolling can use prefetched pixels
+ */
+#define GIMP_DISPLAY_RENDER_CACHE_MARGIN 256
+
+
 void     gimp_display_shell_render_set_scale       (GimpDisplayShell *shell,
                                                     gint              scale);
 
+void     gimp_display_shell_render_get_chunk_size  (GimpDisplayShell *shell,
+                                                    gdouble          *scale,
+                                                    gdouble          *chunk_width,
+                                                    gdouble          *chunk_height);
+
 void     gimp_display_shell_render_invalidate_full (GimpDisplayShell *shell);
 void     gimp_display_shell_render_invalidate_area (GimpDisplayShell *shell,
                                                     gint              x,
@@ -48,6 +59,15 @@ void     gimp_display_shell_render                 (GimpDisplayShell *shell,
                                                     gint              width,
                                                     gint              height,
                                                     gdouble           scale);
+void     gimp_display_shell_render_chunks          (GimpDisplayShell            *shell,
+                                                    cairo_t                     *cr,
+                                                    const cairo_rectangle_int_t *chunks,
+                                                    gint                         n_chunks,
+                                                    gdouble                      scale);
+
+void     gimp_display_shell_render_scrolled        (GimpDisplayShell *shell,
+                                                    gint              x_offset,
+                                                    gint              y_offset);
 
 
 #endif  /*  __GIMP_DISPLAY_SHELL_RENDER_H__  */
@@ -103,8 +103,8 @@ gimp_display_shell_scroll (GimpDisplayShell *shell,
           surface = cairo_surface_create_similar_image (
             shell->render_cache,
             CAIRO_FORMAT_ARGB32,
-            shell->disp_width  * shell->render_scale,
-            shell->disp_height * shell->render_scale);
+            cairo_image_surface_get_width  (shell->render_cache),
+            cairo_image_surface_get_height (shell->render_cache));
 
           cr = cairo_create (surface);
           cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
@@ -130,13 +130,15 @@ gimp_display_shell_scroll (GimpDisplayShell *shell,
           cairo_region_translate (shell->render_cache_valid,
                                   -x_offset, -y_offset);
 
-          rect.x      = 0;
-          rect.y      = 0;
-          rect.width  = shell->disp_width;
-          rect.height = shell->disp_height;
+          rect.x      = -GIMP_DISPLAY_RENDER_CACHE_MARGIN;
+          rect.y      = -GIMP_DISPLAY_RENDER_CACHE_MARGIN;
+          rect.width  = shell->disp_width  + 2 * GIMP_DISPLAY_RENDER_CACHE_MARGIN;
+          rect.height = shell->disp_height + 2 * GIMP_DISPLAY_RENDER_CACHE_MARGIN;
 
           cairo_region_intersect_rectangle (shell->render_cache_valid, &rect);
         }
+
+      gimp_display_shell_render_scrolled (shell, x_offset, y_offset);
     }
 
   /* re-enable the active tool */
@@ -840,6 +840,12 @@ gimp_display_shell_dispose (GObject *object)
       shell->filter_idle_id = 0;
     }
 
+  if (shell->render_prefetch_idle_id)
+    {
+      g_source_remove (shell->render_prefetch_idle_id);
+      shell->render_prefetch_idle_id = 0;
+    }
+
   g_clear_object (&shell->zoom_gesture);
   g_clear_object (&shell->rotate_gesture);
 
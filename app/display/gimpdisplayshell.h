@@ -173,6 +173,10 @@ struct _GimpDisplayShell
 
   cairo_surface_t   *render_cache;
   cairo_region_t    *render_cache_valid;
+  guint              render_prefetch_idle_id;
+  gint64             render_scroll_time;  /*  time of the last scroll        */
+  gdouble            render_scroll_vx;    /*  scroll velocity, in px/s       */
+  gdouble            render_scroll_vy;
 
   gint               render_buf_width;
   gint               render_buf_height;
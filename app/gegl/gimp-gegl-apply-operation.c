@@ -26,6 +26,8 @@
 #include <gio/gio.h>
 #include <gegl.h>
 
+#include "libgimpcolor/gimpcolor.h"
+
 #include "gimp-gegl-types.h"
 
 #include "core/gimp-transform-utils.h"
@@ -400,6 +402,78 @@ gimp_gegl_apply_dither (GeglBuffer   *src_buffer,
   g_object_unref (node);
 }
 
+/*  converts @src_buffer to the format of @dest_buffer, dithering
+ *  with @dither_type.  If @dest_profile is set, the pixels are also
+ *  converted from @src_profile to it, so @src_profile is then required;
+ *  without @dest_profile, both profiles are ignored.
+ */
+void
+gimp_gegl_apply_convert (GeglBuffer       *src_buffer,
+                         GimpColorProfile *src_profile,
+                         GimpProgress     *progress,
+                         GeglBuffer       *dest_buffer,
+                         GimpColorProfile *dest_profile,
+                         gint              dither_type)
+{
+  const Babl *dest_format;
+  gint        bits;
+
+  g_return_if_fail (GEGL_IS_BUFFER (src_buffer));
+  g_return_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress));
+  g_return_if_fail (GEGL_IS_BUFFER (dest_buffer));
+  g_return_if_fail (src_profile == NULL || GIMP_IS_COLOR_PROFILE (src_profile));
+  g_return_if_fail (dest_profile == NULL || GIMP_IS_COLOR_PROFILE (dest_profile));
+  g_return_if_fail (dest_profile == NULL || src_profile != NULL);
+
+  dest_format = gegl_buffer_get_format (dest_buffer);
+
+  bits = (babl_format_get_bytes_per_pixel (dest_format) * 8 /
+          babl_format_get_n_components (dest_format));
+
+  if (dither_type == GEGL_DITHER_NONE)
+    {
+      if (dest_profile)
+        {
+          gimp_gegl_convert_color_profile (src_buffer,  NULL, src_profile,
+                                           dest_buffer, NULL, dest_profile,
+                                           GIMP_COLOR_RENDERING_INTENT_PERCEPTUAL,
+                                           TRUE, progress);
+        }
+      else
+        {
+          gimp_gegl_buffer_copy (src_buffer, NULL, GEGL_ABYSS_NONE,
+                                 dest_buffer, NULL);
+        }
+    }
+  else if (! dest_profile ||
+           gimp_color_profile_is_equal (src_profile, dest_profile))
+    {
+      /*  the profile conversion is a plain format conversion, dither
+       *  straight into dest_buffer instead of going through a full
+       *  copy of the source in its own format
+       */
+      gimp_gegl_apply_dither (src_buffer, progress, NULL,
+                              dest_buffer, 1 << bits, dither_type);
+    }
+  else
+    {
+      GeglBuffer *buffer;
+
+      buffer = gegl_buffer_new (gegl_buffer_get_extent (src_buffer),
+                                gegl_buffer_get_format (src_buffer));
+
+      gimp_gegl_apply_dither (src_buffer, NULL, NULL,
+                              buffer, 1 << bits, dither_type);
+
+      gimp_gegl_convert_color_profile (buffer,      NULL, src_profile,
+                                       dest_buffer, NULL, dest_profile,
+                                       GIMP_COLOR_RENDERING_INTENT_PERCEPTUAL,
+                                       TRUE, progress);
+
+      g_object_unref (buffer);
+    }
+}
+
 void
 gimp_gegl_apply_flatten (GeglBuffer          *src_buffer,
                          GimpProgress        *progress,
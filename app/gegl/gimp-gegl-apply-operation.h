@@ -57,6 +57,13 @@ void   gimp_gegl_apply_dither          (GeglBuffer             *src_buffer,
                                         gint                    levels,
                                         gint                    dither_type);
 
+void   gimp_gegl_apply_convert         (GeglBuffer             *src_buffer,
+                                        GimpColorProfile       *src_profile,
+                                        GimpProgress           *progress,
+                                        GeglBuffer             *dest_buffer,
+                                        GimpColorProfile       *dest_profile,
+                                        gint                    dither_type);
+
 void   gimp_gegl_apply_flatten         (GeglBuffer             *src_buffer,
                                         GimpProgress           *progress,
                                         const gchar            *undo_desc,
@@ -124,4 +124,41 @@ gimp_gegl_smudge_with_paint_process_sse2 (gfloat       *accum,
     }
 }
 
+/* helper function of gimp_histogram_calculate_area(), maps each value
+ * to the bin SIGNED_ROUND (SAFE_CLAMP (value * max_bin, 0, max_bin)),
+ * four values at a time.  NaNs end up in bin 0, like with SAFE_CLAMP().
+ */
+void
+gimp_gegl_histogram_bins_sse2 (const gfloat *src,
+                               gint         *dest,
+                               gint          count,
+                               gfloat        max_bin)
+{
+  const __m128 v_max_bin = _mm_set1_ps (max_bin);
+  const __m128 v_zero    = _mm_setzero_ps ();
+
+  for (; count >= 4; count -= 4)
+    {
+      __m128 v = _mm_mul_ps (_mm_loadu_ps (src), v_max_bin);
+
+      /*  _mm_max_ps() returns its second operand for NaNs  */
+      v = _mm_min_ps (_mm_max_ps (v, v_zero), v_max_bin);
+
+      /*  rounds to nearest, like rint()  */
+      _mm_storeu_si128 ((__m128i *) dest, _mm_cvtps_epi32 (v));
+
+      src  += 4;
+      dest += 4;
+    }
+
+  while (count--)
+    {
+      gfloat v = *src++ * max_bin;
+
+      v = v > 0.0f ? v < max_bin ? v : max_bin : 0.0f;
+
+      *dest++ = _mm_cvtss_si32 (_mm_set_ss (v));
+    }
+}
+
 #endif /* COMPILE_SSE2_INTRINISICS */
@@ -34,6 +34,11 @@ void   gimp_gegl_smudge_with_paint_process_sse2 (gfloat       *accum,
                                                  gfloat        flow,
                                                  gfloat        rate);
 
+void   gimp_gegl_histogram_bins_sse2            (const gfloat *src,
+                                                 gint         *dest,
+                                                 gint          count,
+                                                 gfloat        max_bin);
+
 #endif /* COMPILE_SSE2_INTRINISICS */
 
 
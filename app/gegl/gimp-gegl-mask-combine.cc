@@ -107,6 +107,7 @@ gimp_gegl_mask_combine_ellipse_rect (GeglBuffer     *mask,
                                      gboolean        antialias)
 {
   GeglRectangle  rect;
+  GeglRectangle  grid;
   const Babl    *format;
   gint           bpp;
   gfloat         one_f = 1.0f;
@@ -117,6 +118,10 @@ gimp_gegl_mask_combine_ellipse_rect (GeglBuffer     *mask,
   gint           right;
   gint           top;
   gint           bottom;
+  gint           tile_width;
+  gint           tile_height;
+  gint           ty;
+  GArray        *edges;
 
   g_return_val_if_fail (GEGL_IS_BUFFER (mask), FALSE);
 
@@ -374,128 +379,224 @@ gimp_gegl_mask_combine_ellipse_rect (GeglBuffer     *mask,
     return (gpointer) (p + 1);
   };
 
-  gegl_parallel_distribute_area (
-    &rect, PIXELS_PER_THREAD,
-    [=] (const GeglRectangle *area)
-    {
-      GeglBufferIterator *iter;
+  /* classify an area as lying fully outside (0) or fully inside (1) the
+   * ellipse, or as crossing its circumference (-1).
+   */
+  auto classify = [=] (const GeglRectangle *area)
+  {
+    gdouble tx0, ty0;
+    gdouble tx1, ty1;
+    gdouble x0;
+    gdouble x1;
+
+    tx0 = area->x;
+    ty0 = area->y;
+
+    tx1 = area->x + area->width;
+    ty1 = area->y + area->height;
+
+    if (! antialias)
+      {
+        tx0 += 0.5;
+        ty0 += 0.5;
+
+        tx1 -= 0.5;
+        ty1 -= 0.5;
+      }
+
+    ellipse_range (ty0, &x0, &x1);
+
+    if (tx0 >= x0 && tx1 <= x1)
+      {
+        ellipse_range (ty1, &x0, &x1);
+
+        if (tx0 >= x0 && tx1 <= x1)
+          return 1;
+      }
+    else if (tx1 < x0 || tx0 > x1)
+      {
+        ellipse_range (ty1, &x0, &x1);
+
+        if (tx1 < x0 || tx0 > x1)
+          {
+            if ((ty0 - cy) * (ty1 - cy) >= 0.0)
+              return 0;
+          }
+      }
+
+    return -1;
+  };
+
+  /* fill an area lying fully outside/inside the ellipse as a whole, so that
+   * its tiles are shared instead of being written pixel by pixel.
+   */
+  auto fill_area = [=] (const GeglRectangle *area,
+                        gint                 inside)
+  {
+    switch (op)
+      {
+      case GIMP_CHANNEL_OP_REPLACE:
+        break;
+
+      case GIMP_CHANNEL_OP_ADD:
+      case GIMP_CHANNEL_OP_SUBTRACT:
+        if (! inside)
+          return;
+        break;
+
+      case GIMP_CHANNEL_OP_INTERSECT:
+        if (inside)
+          return;
+        break;
+      }
 
-      iter = gegl_buffer_iterator_new (
-        mask, area, 0, format,
-        op == GIMP_CHANNEL_OP_REPLACE ? GEGL_ACCESS_WRITE :
-                                        GEGL_ACCESS_READWRITE,
-        GEGL_ABYSS_NONE, 1);
+    if (inside && op != GIMP_CHANNEL_OP_SUBTRACT)
+      {
+        gegl_buffer_set_color_from_pixel (mask, area, &one_f,
+                                          babl_format ("Y float"));
+      }
+    else
+      {
+        gegl_buffer_clear (mask, area);
+      }
+  };
+
+  g_object_get (mask,
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                NULL);
+
+  gegl_rectangle_align_to_buffer (&grid, &rect, mask,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
 
-      while (gegl_buffer_iterator_next (iter))
+  edges = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+
+  /* walk the tile grid row by row, and fill each run of tiles lying fully
+   * inside or outside the ellipse with a single call.  only the tiles
+   * crossing the circumference are left to be rendered below, so the
+   * amount of per-pixel work is proportional to the ellipse's perimeter,
+   * rather than to its area.
+   */
+  for (ty = grid.y; ty < grid.y + grid.height; ty += tile_height)
+    {
+      GeglRectangle run       = {};
+      gint          run_value = -1;
+      gint          tx;
+
+      for (tx = grid.x; tx < grid.x + grid.width; tx += tile_width)
         {
-          const GeglRectangle *roi = &iter->items[0].roi;
-          gpointer             d   = iter->items[0].data;
-          gdouble              tx0, ty0;
-          gdouble              tx1, ty1;
-          gdouble              x0;
-          gdouble              x1;
-          gint                 y;
-
-          /* tile bounds */
-          tx0 = roi->x;
-          ty0 = roi->y;
-
-          tx1 = roi->x + roi->width;
-          ty1 = roi->y + roi->height;
-
-          if (! antialias)
+          GeglRectangle tile;
+          gint          value;
+
+          gegl_rectangle_intersect (&tile,
+                                    GEGL_RECTANGLE (tx, ty,
+                                                    tile_width, tile_height),
+                                    &rect);
+
+          value = classify (&tile);
+
+          if (value >= 0 && value == run_value)
             {
-              tx0 += 0.5;
-              ty0 += 0.5;
+              run.width = tile.x + tile.width - run.x;
 
-              tx1 -= 0.5;
-              ty1 -= 0.5;
+              continue;
             }
 
-          /* if the tile is fully inside/outside the ellipse, fill it with 1/0,
-           * respectively, and skip the rest.
-           */
-          ellipse_range (ty0, &x0, &x1);
+          if (run_value >= 0)
+            fill_area (&run, run_value);
 
-          if (tx0 >= x0 && tx1 <= x1)
-            {
-              ellipse_range (ty1, &x0, &x1);
+          run       = tile;
+          run_value = value;
 
-              if (tx0 >= x0 && tx1 <= x1)
-                {
-                  fill1 (d, iter->length);
+          if (value < 0)
+            g_array_append_val (edges, tile);
+        }
 
-                  continue;
-                }
-            }
-          else if (tx1 < x0 || tx0 > x1)
-            {
-              ellipse_range (ty1, &x0, &x1);
+      if (run_value >= 0)
+        fill_area (&run, run_value);
+    }
 
-              if (tx1 < x0 || tx0 > x1)
-                {
-                  if ((ty0 - cy) * (ty1 - cy) >= 0.0)
-                    {
-                      fill0 (d, iter->length);
+  gegl_parallel_distribute_range (
+    edges->len, 1,
+    [=] (gint offset, gint size)
+    {
+      gint i;
 
-                      continue;
-                    }
-                }
-            }
+      for (i = offset; i < offset + size; i++)
+        {
+          const GeglRectangle *area = &g_array_index (edges, GeglRectangle, i);
+          GeglBufferIterator  *iter;
 
-          for (y = roi->y; y < roi->y + roi->height; y++)
+          iter = gegl_buffer_iterator_new (
+            mask, area, 0, format,
+            op == GIMP_CHANNEL_OP_REPLACE ? GEGL_ACCESS_WRITE :
+                                            GEGL_ACCESS_READWRITE,
+            GEGL_ABYSS_NONE, 1);
+
+          while (gegl_buffer_iterator_next (iter))
             {
-              gint a, b;
+              const GeglRectangle *roi = &iter->items[0].roi;
+              gpointer             d   = iter->items[0].data;
+              gdouble              x0;
+              gdouble              x1;
+              gint                 y;
 
-              if (antialias)
+              for (y = roi->y; y < roi->y + roi->height; y++)
                 {
-                  gdouble v  = y_to_v (y + 0.5);
-                  gdouble u0 = v_to_u (v - 0.5);
-                  gdouble u1 = v_to_u (v + 0.5);
-                  gint    x;
+                  gint a, b;
 
-                  a = floor (u_to_x_left (u0)) - roi->x;
-                  a = CLAMP (a, 0, roi->width);
+                  if (antialias)
+                    {
+                      gdouble v  = y_to_v (y + 0.5);
+                      gdouble u0 = v_to_u (v - 0.5);
+                      gdouble u1 = v_to_u (v + 0.5);
+                      gint    x;
 
-                  b = ceil  (u_to_x_left (u1)) - roi->x;
-                  b = CLAMP (b, a, roi->width);
+                      a = floor (u_to_x_left (u0)) - roi->x;
+                      a = CLAMP (a, 0, roi->width);
 
-                  d = fill0 (d, a);
+                      b = ceil  (u_to_x_left (u1)) - roi->x;
+                      b = CLAMP (b, a, roi->width);
 
-                  for (x = roi->x + a; x < roi->x + b; x++)
-                    d = set (d, pixel_value (x, y));
+                      d = fill0 (d, a);
 
-                  a = floor (u_to_x_right (u1)) - roi->x;
-                  a = CLAMP (a, b, roi->width);
+                      for (x = roi->x + a; x < roi->x + b; x++)
+                        d = set (d, pixel_value (x, y));
 
-                  d = fill1 (d, a - b);
+                      a = floor (u_to_x_right (u1)) - roi->x;
+                      a = CLAMP (a, b, roi->width);
 
-                  b = ceil  (u_to_x_right (u0)) - roi->x;
-                  b = CLAMP (b, a, roi->width);
+                      d = fill1 (d, a - b);
 
-                  for (x = roi->x + a; x < roi->x + b; x++)
-                    d = set (d, pixel_value (x, y));
+                      b = ceil  (u_to_x_right (u0)) - roi->x;
+                      b = CLAMP (b, a, roi->width);
 
-                  d = fill0 (d, roi->width - b);
-                }
-              else
-                {
-                  ellipse_range (y + 0.5, &x0, &x1);
+                      for (x = roi->x + a; x < roi->x + b; x++)
+                        d = set (d, pixel_value (x, y));
 
-                  a = ceil  (x0 - 0.5) - roi->x;
-                  a = CLAMP (a, 0, roi->width);
+                      d = fill0 (d, roi->width - b);
+                    }
+                  else
+                    {
+                      ellipse_range (y + 0.5, &x0, &x1);
+
+                      a = ceil  (x0 - 0.5) - roi->x;
+                      a = CLAMP (a, 0, roi->width);
 
-                  b = floor (x1 + 0.5) - roi->x;
-                  b = CLAMP (b, 0, roi->width);
+                      b = floor (x1 + 0.5) - roi->x;
+                      b = CLAMP (b, 0, roi->width);
 
-                  d = fill0 (d, a);
-                  d = fill1 (d, b - a);
-                  d = fill0 (d, roi->width - b);
+                      d = fill0 (d, a);
+                      d = fill1 (d, b - a);
+                      d = fill0 (d, roi->width - b);
+                    }
                 }
             }
         }
     });
 
+  g_array_free (edges, TRUE);
+
   return TRUE;
 }
 
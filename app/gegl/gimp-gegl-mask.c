@@ -17,6 +17,9 @@
 
 #include "config.h"
 
+#include <string.h>
+
+#include <cairo.h>
 #include <gegl.h>
 
 #include "gimp-gegl-types.h"
@@ -24,6 +27,168 @@
 #include "gegl/gimp-gegl-mask.h"
 
 
+/*  extends the inclusive bounds @bounds_x1..@bounds_y2 to the nonzero
+ *  pixels of the iterator tile @roi, whose pixels are @data_u8
+ */
+static void
+gimp_gegl_mask_bounds_tile (const GeglRectangle *roi,
+                            const guint8        *data_u8,
+                            gint                 length,
+                            gint                 bpp,
+                            gint                *bounds_x1,
+                            gint                *bounds_y1,
+                            gint                *bounds_x2,
+                            gint                *bounds_y2)
+{
+  gint ex  = roi->x + roi->width;
+  gint ey  = roi->y + roi->height;
+  gint tx1 = *bounds_x1;
+  gint ty1 = *bounds_y1;
+  gint tx2 = *bounds_x2;
+  gint ty2 = *bounds_y2;
+
+  /*  only check the pixels if this tile is not fully within the
+   *  currently computed bounds
+   */
+  if (roi->x < tx1 || ex > tx2 ||
+      roi->y < ty1 || ey > ty2)
+    {
+      /* Check upper left and lower right corners to see if we can
+       * avoid checking the rest of the pixels in this tile
+       */
+      if (! gegl_memeq_zero (data_u8,                      bpp) &&
+          ! gegl_memeq_zero (data_u8 + (length - 1) * bpp, bpp))
+        {
+          /*  "ex/ey - 1" because the internal variables are the
+           *  right/bottom pixel of the mask's contents, not one
+           *  right/below it like the return values.
+           */
+
+          if (roi->x < tx1) tx1 = roi->x;
+          if (ex > tx2)     tx2 = ex - 1;
+
+          if (roi->y < ty1) ty1 = roi->y;
+          if (ey > ty2)     ty2 = ey - 1;
+        }
+      else
+        {
+          #define FIND_BOUNDS(bpp, type)                                 \
+            G_STMT_START                                                 \
+              {                                                          \
+                const type *data;                                        \
+                gint        y;                                           \
+                                                                         \
+                if ((guintptr) data_u8 % bpp)                            \
+                  goto generic;                                          \
+                                                                         \
+                data = (const type *) data_u8;                           \
+                                                                         \
+                for (y = roi->y; y < ey; y++)                            \
+                  {                                                      \
+                    gint x1;                                             \
+                                                                         \
+                    for (x1 = 0; x1 < roi->width; x1++)                  \
+                      {                                                  \
+                        if (data[x1])                                    \
+                          {                                              \
+                            gint x2;                                     \
+                            gint x2_end = MAX (x1, tx2 - roi->x);        \
+                                                                         \
+                            for (x2 = roi->width - 1; x2 > x2_end; x2--) \
+                              {                                          \
+                                if (data[x2])                            \
+                                  break;                                 \
+                              }                                          \
+                                                                         \
+                            x1 += roi->x;                                \
+                            x2 += roi->x;                                \
+                                                                         \
+                            if (x1 < tx1) tx1 = x1;                      \
+                            if (x2 > tx2) tx2 = x2;                      \
+                                                                         \
+                            if (y < ty1) ty1 = y;                        \
+                            if (y > ty2) ty2 = y;                        \
+                                                                         \
+                            break;                                       \
+                          }                                              \
+                      }                                                  \
+                                                                         \
+                    data += roi->width;                                  \
+                  }                                                      \
+              }                                                          \
+            G_STMT_END
+
+          switch (bpp)
+            {
+            case 1:
+              FIND_BOUNDS (1, guint8);
+              break;
+
+            case 2:
+              FIND_BOUNDS (2, guint16);
+              break;
+
+            case 4:
+              FIND_BOUNDS (4, guint32);
+              break;
+
+            case 8:
+              FIND_BOUNDS (8, guint64);
+              break;
+
+            default:
+            generic:
+              {
+                const guint8 *data = data_u8;
+                gint          y;
+
+                for (y = roi->y; y < ey; y++)
+                  {
+                    gint x1;
+
+                    for (x1 = 0; x1 < roi->width; x1++)
+                      {
+                        if (! gegl_memeq_zero (data + x1 * bpp, bpp))
+                          {
+                            gint x2;
+                            gint x2_end = MAX (x1, tx2 - roi->x);
+
+                            for (x2 = roi->width - 1; x2 > x2_end; x2--)
+                              {
+                                if (! gegl_memeq_zero (data + x2 * bpp,
+                                                       bpp))
+                                  {
+                                    break;
+                                  }
+                              }
+
+                            x1 += roi->x;
+                            x2 += roi->x;
+
+                            if (x1 < tx1) tx1 = x1;
+                            if (x2 > tx2) tx2 = x2;
+
+                            if (y < ty1) ty1 = y;
+                            if (y > ty2) ty2 = y;
+                          }
+                      }
+
+                    data += roi->width * bpp;
+                  }
+              }
+              break;
+            }
+
+          #undef FIND_BOUNDS
+        }
+    }
+
+  *bounds_x1 = tx1;
+  *bounds_y1 = ty1;
+  *bounds_x2 = tx2;
+  *bounds_y2 = ty2;
+}
+
 gboolean
 gimp_gegl_mask_bounds (GeglBuffer *buffer,
                        gint        *x1,
@@ -33,7 +198,6 @@ gimp_gegl_mask_bounds (GeglBuffer *buffer,
 {
   GeglBufferIterator  *iter;
   const GeglRectangle *extent;
-  const GeglRectangle *roi;
   const Babl          *format;
   gint                 bpp;
   gint                 tx1, tx2, ty1, ty2;
@@ -57,149 +221,12 @@ gimp_gegl_mask_bounds (GeglBuffer *buffer,
 
   iter = gegl_buffer_iterator_new (buffer, NULL, 0, format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
-  roi = &iter->items[0].roi;
 
   while (gegl_buffer_iterator_next (iter))
     {
-      const guint8 *data_u8 = iter->items[0].data;
-      gint          ex      = roi->x + roi->width;
-      gint          ey      = roi->y + roi->height;
-
-      /*  only check the pixels if this tile is not fully within the
-       *  currently computed bounds
-       */
-      if (roi->x < tx1 || ex > tx2 ||
-          roi->y < ty1 || ey > ty2)
-        {
-          /* Check upper left and lower right corners to see if we can
-           * avoid checking the rest of the pixels in this tile
-           */
-          if (! gegl_memeq_zero (data_u8,                            bpp) &&
-              ! gegl_memeq_zero (data_u8 + (iter->length - 1) * bpp, bpp))
-            {
-              /*  "ex/ey - 1" because the internal variables are the
-               *  right/bottom pixel of the mask's contents, not one
-               *  right/below it like the return values.
-               */
-
-              if (roi->x < tx1) tx1 = roi->x;
-              if (ex > tx2)     tx2 = ex - 1;
-
-              if (roi->y < ty1) ty1 = roi->y;
-              if (ey > ty2)     ty2 = ey - 1;
-            }
-          else
-            {
-              #define FIND_BOUNDS(bpp, type)                                 \
-                G_STMT_START                                                 \
-                  {                                                          \
-                    const type *data;                                        \
-                    gint        y;                                           \
-                                                                             \
-                    if ((guintptr) data_u8 % bpp)                            \
-                      goto generic;                                          \
-                                                                             \
-                    data = (const type *) data_u8;                           \
-                                                                             \
-                    for (y = roi->y; y < ey; y++)                            \
-                      {                                                      \
-                        gint x1;                                             \
-                                                                             \
-                        for (x1 = 0; x1 < roi->width; x1++)                  \
-                          {                                                  \
-                            if (data[x1])                                    \
-                              {                                              \
-                                gint x2;                                     \
-                                gint x2_end = MAX (x1, tx2 - roi->x);        \
-                                                                             \
-                                for (x2 = roi->width - 1; x2 > x2_end; x2--) \
-                                  {                                          \
-                                    if (data[x2])                            \
-                                      break;                                 \
-                                  }                                          \
-                                                                             \
-                                x1 += roi->x;                                \
-                                x2 += roi->x;                                \
-                                                                             \
-                                if (x1 < tx1) tx1 = x1;                      \
-                                if (x2 > tx2) tx2 = x2;                      \
-                                                                             \
-                                if (y < ty1) ty1 = y;                        \
-                                if (y > ty2) ty2 = y;                        \
-                                                                             \
-                                break;                                       \
-                              }                                              \
-                          }                                                  \
-                                                                             \
-                        data += roi->width;                                  \
-                      }                                                      \
-                  }                                                          \
-                G_STMT_END
-
-              switch (bpp)
-                {
-                case 1:
-                  FIND_BOUNDS (1, guint8);
-                  break;
-
-                case 2:
-                  FIND_BOUNDS (2, guint16);
-                  break;
-
-                case 4:
-                  FIND_BOUNDS (4, guint32);
-                  break;
-
-                case 8:
-                  FIND_BOUNDS (8, guint64);
-                  break;
-
-                default:
-                generic:
-                  {
-                    const guint8 *data = data_u8;
-                    gint          y;
-
-                    for (y = roi->y; y < ey; y++)
-                      {
-                        gint x1;
-
-                        for (x1 = 0; x1 < roi->width; x1++)
-                          {
-                            if (! gegl_memeq_zero (data + x1 * bpp, bpp))
-                              {
-                                gint x2;
-                                gint x2_end = MAX (x1, tx2 - roi->x);
-
-                                for (x2 = roi->width - 1; x2 > x2_end; x2--)
-                                  {
-                                    if (! gegl_memeq_zero (data + x2 * bpp,
-                                                           bpp))
-                                      {
-                                        break;
-                                      }
-                                  }
-
-                                x1 += roi->x;
-                                x2 += roi->x;
-
-                                if (x1 < tx1) tx1 = x1;
-                                if (x2 > tx2) tx2 = x2;
-
-                                if (y < ty1) ty1 = y;
-                                if (y > ty2) ty2 = y;
-                              }
-                          }
-
-                        data += roi->width * bpp;
-                      }
-                  }
-                  break;
-                }
-
-              #undef FIND_BOUNDS
-            }
-        }
+      gimp_gegl_mask_bounds_tile (&iter->items[0].roi, iter->items[0].data,
+                                  iter->length, bpp,
+                                  &tx1, &ty1, &tx2, &ty2);
     }
 
   tx2 = CLAMP (tx2 + 1, 0, gegl_buffer_get_width  (buffer));
@@ -251,3 +278,169 @@ gimp_gegl_mask_is_empty (GeglBuffer *buffer)
 
   return TRUE;
 }
+
+/*  Selection masks are mostly binary: except for antialiased or
+ *  feathered edges, their tiles are either entirely unselected or
+ *  entirely selected.  This replaces such tiles within @rect by
+ *  shared ones: empty tiles are dropped in favor of GEGL's zero tile,
+ *  and filled tiles become copy-on-write duplicates of a single tile,
+ *  so they cost next to no memory, whatever the mask's precision.
+ *  Tiles with any other content are kept as they are.
+ *
+ *  If @bounds is not NULL, it is set to the bounding box of the nonzero
+ *  pixels within @rect, found while scanning the tiles, so callers that
+ *  know the mask is empty outside @rect don't need another pass over
+ *  the buffer.  It is empty if there are no such pixels.
+ */
+void
+gimp_gegl_mask_compact (GeglBuffer          *buffer,
+                        const GeglRectangle *rect,
+                        GeglRectangle       *bounds)
+{
+  GeglBufferIterator *iter;
+  const Babl         *format;
+  GeglRectangle       scan;
+  GeglRectangle       area;
+  cairo_region_t     *empty_region;
+  cairo_region_t     *full_region;
+  gfloat              one = 1.0f;
+  guint8              full_pixel[16];
+  gint                tile_width;
+  gint                tile_height;
+  gint                bpp;
+  gint                n_rects;
+  gint                tx1, ty1, tx2, ty2;
+  gint                i;
+
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  if (bounds)
+    *bounds = *GEGL_RECTANGLE (0, 0, 0, 0);
+
+  format = gegl_buffer_get_format (buffer);
+  bpp    = babl_format_get_bytes_per_pixel (format);
+
+  g_return_if_fail (babl_format_get_n_components (format) == 1);
+  g_return_if_fail (bpp <= (gint) sizeof (full_pixel));
+
+  if (! rect)
+    rect = gegl_buffer_get_extent (buffer);
+
+  if (! gegl_rectangle_intersect (&scan, rect, gegl_buffer_get_extent (buffer)))
+    return;
+
+  /*  only whole tiles can be shared  */
+  gegl_rectangle_align_to_buffer (&area, &scan, buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUBSET);
+
+  /*  the bounds need the partial tiles too  */
+  if (! bounds)
+    scan = area;
+
+  if (gegl_rectangle_is_empty (&scan))
+    return;
+
+  g_object_get (buffer,
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                NULL);
+
+  babl_process (babl_fish (babl_format_with_space ("Y float", format),
+                           format),
+                &one, full_pixel, 1);
+
+  /*  inclusive, like in gimp_gegl_mask_bounds()  */
+  tx1 = scan.x + scan.width;
+  ty1 = scan.y + scan.height;
+  tx2 = scan.x - 1;
+  ty2 = scan.y - 1;
+
+  empty_region = cairo_region_create ();
+  full_region  = cairo_region_create ();
+
+  iter = gegl_buffer_iterator_new (buffer, &scan, 0, format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      const guint8        *data  = iter->items[0].data;
+      gboolean             whole = (roi->width  == tile_width &&
+                                    roi->height == tile_height);
+      gint                 j;
+
+      if (gegl_memeq_zero (data, bpp * iter->length))
+        {
+          if (whole)
+            {
+              cairo_region_union_rectangle (empty_region,
+                                            (const cairo_rectangle_int_t *) roi);
+            }
+
+          continue;
+        }
+
+      if (whole)
+        {
+          for (j = 0; j < iter->length; j++)
+            {
+              if (memcmp (data + j * bpp, full_pixel, bpp))
+                break;
+            }
+
+          if (j == iter->length)
+            {
+              cairo_region_union_rectangle (full_region,
+                                            (const cairo_rectangle_int_t *) roi);
+
+              tx1 = MIN (tx1, roi->x);
+              ty1 = MIN (ty1, roi->y);
+              tx2 = MAX (tx2, roi->x + roi->width  - 1);
+              ty2 = MAX (ty2, roi->y + roi->height - 1);
+
+              continue;
+            }
+        }
+
+      if (bounds)
+        {
+          gimp_gegl_mask_bounds_tile (roi, data, iter->length, bpp,
+                                      &tx1, &ty1, &tx2, &ty2);
+        }
+    }
+
+  if (bounds && tx1 <= tx2)
+    {
+      *bounds = *GEGL_RECTANGLE (tx1, ty1, tx2 - tx1 + 1, ty2 - ty1 + 1);
+    }
+
+  gegl_buffer_freeze_changed (buffer);
+
+  n_rects = cairo_region_num_rectangles (empty_region);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t r;
+
+      cairo_region_get_rectangle (empty_region, i, &r);
+
+      gegl_buffer_clear (buffer, (GeglRectangle *) &r);
+    }
+
+  n_rects = cairo_region_num_rectangles (full_region);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t r;
+
+      cairo_region_get_rectangle (full_region, i, &r);
+
+      gegl_buffer_set_color_from_pixel (buffer, (GeglRectangle *) &r,
+                                        full_pixel, format);
+    }
+
+  gegl_buffer_thaw_changed (buffer);
+
+  cairo_region_destroy (empty_region);
+  cairo_region_destroy (full_region);
+}
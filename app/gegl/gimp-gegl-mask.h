@@ -26,5 +26,9 @@ gboolean   gimp_gegl_mask_bounds   (GeglBuffer *buffer,
                                     gint        *y2);
 gboolean   gimp_gegl_mask_is_empty (GeglBuffer *buffer);
 
+void       gimp_gegl_mask_compact  (GeglBuffer          *buffer,
+                                    const GeglRectangle *rect,
+                                    GeglRectangle       *bounds);
+
 
 #endif /* __GIMP_GEGL_MASK_H__ */
@@ -24,10 +24,27 @@
 
 #include "gimp-gegl-types.h"
 
+#include "operations/layer-modes/gimp-layer-modes.h"
+#include "operations/layer-modes/gimpoperationlayermode.h"
+
 #include "gimp-gegl-nodes.h"
 #include "gimpapplicator.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
+typedef struct
+{
+  GimpApplicator         *applicator;
+  GimpOperationLayerMode *layer_mode;
+  const Babl             *format;
+  const Babl             *mask_format;
+  gboolean                use_mask;
+} BlitDirectData;
+
+
 static void   gimp_applicator_finalize     (GObject      *object);
 static void   gimp_applicator_set_property (GObject      *object,
                                             guint         property_id,
@@ -38,6 +55,11 @@ static void   gimp_applicator_get_property (GObject      *object,
                                             GValue       *value,
                                             GParamSpec   *pspec);
 
+static gboolean gimp_applicator_blit_direct      (GimpApplicator      *applicator,
+                                                  const GeglRectangle *rect);
+static void     gimp_applicator_blit_direct_area (const GeglRectangle *area,
+                                                  BlitDirectData      *data);
+
 
 G_DEFINE_TYPE (GimpApplicator, gimp_applicator, G_TYPE_OBJECT)
 
@@ -72,6 +94,7 @@ gimp_applicator_finalize (GObject *object)
   GimpApplicator *applicator = GIMP_APPLICATOR (object);
 
   g_clear_object (&applicator->node);
+  g_clear_object (&applicator->direct_mode_node);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -139,6 +162,21 @@ gimp_applicator_new (GeglNode *parent)
   gimp_gegl_mode_node_set_opacity (applicator->mode_node,
                                    applicator->opacity);
 
+  /*  a copy of the mode node outside of the graph, whose operation is
+   *  run directly by gimp_applicator_blit(), see below
+   */
+  applicator->direct_mode_node = gegl_node_new_child (NULL,
+                                                      "operation", "gimp:normal",
+                                                      NULL);
+
+  gimp_gegl_mode_node_set_mode (applicator->direct_mode_node,
+                                applicator->paint_mode,
+                                applicator->blend_space,
+                                applicator->composite_space,
+                                applicator->composite_mode);
+  gimp_gegl_mode_node_set_opacity (applicator->direct_mode_node,
+                                   applicator->opacity);
+
   gegl_node_link (applicator->input_node, applicator->mode_node);
 
   applicator->apply_offset_node =
@@ -422,6 +460,8 @@ gimp_applicator_set_opacity (GimpApplicator *applicator,
 
       gimp_gegl_mode_node_set_opacity (applicator->mode_node,
                                        opacity);
+      gimp_gegl_mode_node_set_opacity (applicator->direct_mode_node,
+                                       opacity);
     }
 }
 
@@ -447,6 +487,9 @@ gimp_applicator_set_mode (GimpApplicator         *applicator,
       gimp_gegl_mode_node_set_mode (applicator->mode_node,
                                     paint_mode, blend_space,
                                     composite_space, composite_mode);
+      gimp_gegl_mode_node_set_mode (applicator->direct_mode_node,
+                                    paint_mode, blend_space,
+                                    composite_space, composite_mode);
     }
 }
 
@@ -644,6 +687,176 @@ gimp_applicator_blit (GimpApplicator      *applicator,
 {
   g_return_if_fail (GIMP_IS_APPLICATOR (applicator));
 
-  gegl_node_blit (applicator->dest_node, 1.0, rect,
-                  NULL, NULL, 0, GEGL_BLIT_DEFAULT);
+  if (! gimp_applicator_blit_direct (applicator, rect))
+    {
+      gegl_node_blit (applicator->dest_node, 1.0, rect,
+                      NULL, NULL, 0, GEGL_BLIT_DEFAULT);
+    }
+}
+
+
+/*  private functions  */
+
+/*  The common case of compositing an apply buffer onto a source buffer,
+ *  optionally through a mask, and writing the result to a destination
+ *  buffer doesn't need the graph: we run the layer mode's process
+ *  function over the area ourselves, in parallel, which saves the
+ *  graph's per-blit setup and pays off for small paint dabs.
+ */
+static gboolean
+gimp_applicator_blit_direct (GimpApplicator      *applicator,
+                             const GeglRectangle *rect)
+{
+  GeglOperation          *operation;
+  GimpOperationLayerMode *layer_mode;
+  BlitDirectData          data;
+
+  if (! applicator->src_buffer   ||
+      ! applicator->apply_buffer ||
+      ! applicator->dest_buffer  ||
+      applicator->affect != GIMP_COMPONENT_MASK_ALL)
+    {
+      return FALSE;
+    }
+
+  /*  the graph crops the result, or converts it to a different format
+   *  than the dest buffer's
+   */
+  if (applicator->crop_enabled ||
+      (applicator->output_format &&
+       applicator->output_format !=
+       gegl_buffer_get_format (applicator->dest_buffer)))
+    {
+      return FALSE;
+    }
+
+  /*  without input, the mode node renders the layer as the bottom
+   *  layer, let the graph deal with that
+   */
+  if (gegl_rectangle_is_empty (gegl_buffer_get_extent (applicator->src_buffer)))
+    return FALSE;
+
+  operation = gegl_node_get_gegl_operation (applicator->direct_mode_node);
+
+  if (! GIMP_IS_OPERATION_LAYER_MODE (operation))
+    return FALSE;
+
+  layer_mode = GIMP_OPERATION_LAYER_MODE (operation);
+
+  /*  do what gimp_operation_layer_mode_prepare() and
+   *  gimp_operation_layer_mode_parent_process() would do
+   */
+  layer_mode->composite_mode = layer_mode->prop_composite_mode;
+
+  if (layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_AUTO)
+    {
+      layer_mode->composite_mode =
+        gimp_layer_mode_get_composite_mode (layer_mode->layer_mode);
+    }
+
+  layer_mode->function       = gimp_layer_mode_get_function (layer_mode->layer_mode);
+  layer_mode->blend_function = gimp_layer_mode_get_blend_function (layer_mode->layer_mode);
+  layer_mode->is_last_node   = FALSE;
+  layer_mode->opacity        = layer_mode->prop_opacity;
+
+  data.applicator = applicator;
+  data.layer_mode = layer_mode;
+  data.use_mask   = FALSE;
+  data.format     =
+    gimp_layer_mode_get_format (layer_mode->layer_mode,
+                                layer_mode->blend_space,
+                                layer_mode->composite_space,
+                                layer_mode->composite_mode,
+                                gegl_buffer_get_format (applicator->src_buffer));
+  data.mask_format = babl_format_with_space ("Y float", data.format);
+
+  if (applicator->mask_buffer)
+    {
+      GeglRectangle mask_rect = *gegl_buffer_get_extent (applicator->mask_buffer);
+
+      mask_rect.x += applicator->mask_offset_x;
+      mask_rect.y += applicator->mask_offset_y;
+
+      /*  a mask outside of the area masks everything  */
+      if (gegl_rectangle_intersect (NULL, &mask_rect, rect))
+        data.use_mask = TRUE;
+      else
+        layer_mode->opacity = 0.0;
+    }
+
+  layer_mode->has_mask = data.use_mask;
+
+  /*  the workers only read the blend space fishes  */
+  gimp_operation_layer_mode_cache_fishes (
+    layer_mode, gegl_buffer_get_format (applicator->src_buffer));
+
+  gegl_parallel_distribute_area (
+    rect, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_applicator_blit_direct_area,
+    &data);
+
+  return TRUE;
+}
+
+static void
+gimp_applicator_blit_direct_area (const GeglRectangle *area,
+                                  BlitDirectData      *data)
+{
+  GimpApplicator     *applicator = data->applicator;
+  GeglBufferIterator *iter;
+  gboolean            in_place;
+  gint                in_index;
+  gint                layer_index;
+  gint                mask_index = 0;
+
+  in_place = (applicator->src_buffer == applicator->dest_buffer);
+
+  iter = gegl_buffer_iterator_new (applicator->dest_buffer, area, 0,
+                                   data->format,
+                                   in_place ? GEGL_ACCESS_READWRITE :
+                                              GEGL_ACCESS_WRITE,
+                                   GEGL_ABYSS_NONE, 4);
+
+  if (in_place)
+    {
+      in_index = 0;
+    }
+  else
+    {
+      in_index = gegl_buffer_iterator_add (iter, applicator->src_buffer,
+                                           area, 0, data->format,
+                                           GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+    }
+
+  layer_index =
+    gegl_buffer_iterator_add (iter, applicator->apply_buffer,
+                              GEGL_RECTANGLE (area->x - applicator->apply_offset_x,
+                                              area->y - applicator->apply_offset_y,
+                                              area->width, area->height),
+                              0, data->format,
+                              GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  if (data->use_mask)
+    {
+      mask_index =
+        gegl_buffer_iterator_add (iter, applicator->mask_buffer,
+                                  GEGL_RECTANGLE (area->x - applicator->mask_offset_x,
+                                                  area->y - applicator->mask_offset_y,
+                                                  area->width, area->height),
+                                  0, data->mask_format,
+                                  GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+    }
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      data->layer_mode->function (GEGL_OPERATION (data->layer_mode),
+                                  iter->items[in_index].data,
+                                  iter->items[layer_index].data,
+                                  data->use_mask ?
+                                    iter->items[mask_index].data : NULL,
+                                  iter->items[0].data,
+                                  iter->length,
+                                  &iter->items[0].roi,
+                                  0);
+    }
 }
@@ -56,6 +56,7 @@ struct _GimpApplicator
   GimpLayerColorSpace     composite_space;
   GimpLayerCompositeMode  composite_mode;
   GeglNode               *mode_node;
+  GeglNode               *direct_mode_node;
 
   GimpComponentMask       affect;
   GeglNode               *affect_node;
@@ -45,7 +45,9 @@ static const GDebugKey log_keys[] =
   { "rectangle-tool",     GIMP_LOG_RECTANGLE_TOOL     },
   { "brush-cache",        GIMP_LOG_BRUSH_CACHE        },
   { "projection",         GIMP_LOG_PROJECTION         },
-  { "xcf",                GIMP_LOG_XCF                }
+  { "xcf",                GIMP_LOG_XCF                },
+  { "data-factory",       GIMP_LOG_DATA_FACTORY       },
+  { "render",             GIMP_LOG_RENDER             }
 };
 
 static const gchar * const log_domains[] =
@@ -45,7 +45,9 @@ typedef enum
   GIMP_LOG_BRUSH_CACHE        = 1 << 18,
   GIMP_LOG_PROJECTION         = 1 << 19,
   GIMP_LOG_XCF                = 1 << 20,
-  GIMP_LOG_MAGIC_MATCH        = 1 << 21
+  GIMP_LOG_MAGIC_MATCH        = 1 << 21,
+  GIMP_LOG_DATA_FACTORY       = 1 << 22,
+  GIMP_LOG_RENDER             = 1 << 23
 } GimpLogFlags;
 
 
@@ -113,6 +115,7 @@ void             gimp_log_remove_handler (GimpLogHandler  handler);
 #define BRUSH_CACHE        GIMP_LOG_BRUSH_CACHE
 #define PROJECTION         GIMP_LOG_PROJECTION
 #define XCF                GIMP_LOG_XCF
+#define DATA_FACTORY       GIMP_LOG_DATA_FACTORY
 
 #if 0 /* last resort */
 #  define GIMP_LOG /* nothing => no varargs, no log */
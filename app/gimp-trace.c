@@ -0,0 +1,366 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <time.h>
+
+#include "glib-object.h"
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#endif
+
+#include "gimp-trace.h"
+
+
+/*  Startup tracing: records nested, named spans of wall-clock and
+ *  process CPU time, and dumps them as a Chrome trace-event JSON file
+ *  (loadable in chrome://tracing or Perfetto) plus a summary tree on
+ *  stdout.  It is enabled with --startup-trace=<file> or by setting
+ *  GIMP_STARTUP_TRACE=<file>, and is finished once GIMP is initialized,
+ *  or after the batch commands when those load the data files.
+ */
+
+
+typedef struct
+{
+  const gchar *name;
+  gint         depth;
+  guint        thread;
+  gint64       start_wall;
+  gint64       end_wall;
+  gint64       start_cpu;
+  gint64       end_cpu;
+} GimpTraceSpan;
+
+
+static gint64   gimp_trace_get_cpu_time (void);
+static guint    gimp_trace_get_thread   (void);
+static GArray * gimp_trace_get_stack    (void);
+static void     gimp_trace_write_json   (GString     *str,
+                                         const gchar *text);
+
+
+gboolean        gimp_trace_enabled = FALSE;
+
+static GMutex   trace_mutex;
+static GArray  *trace_spans        = NULL;
+static gchar   *trace_filename     = NULL;
+static gint64   trace_start_wall   = 0;
+static gint     trace_n_threads    = 0;
+
+static GPrivate trace_stack_private  = G_PRIVATE_INIT ((GDestroyNotify) g_array_unref);
+static GPrivate trace_thread_private = G_PRIVATE_INIT (NULL);
+
+
+/*  public functions  */
+
+void
+gimp_trace_init (void)
+{
+  const gchar *filename = g_getenv ("GIMP_STARTUP_TRACE");
+
+  if (filename && *filename)
+    gimp_trace_enable (filename);
+}
+
+void
+gimp_trace_enable (const gchar *filename)
+{
+  g_return_if_fail (filename != NULL);
+
+  g_mutex_lock (&trace_mutex);
+
+  g_free (trace_filename);
+  trace_filename = g_strdup (filename);
+
+  if (! trace_spans)
+    {
+      trace_spans      = g_array_new (FALSE, FALSE, sizeof (GimpTraceSpan));
+      trace_start_wall = g_get_monotonic_time ();
+    }
+
+  g_mutex_unlock (&trace_mutex);
+
+  if (! gimp_trace_enabled)
+    {
+      gimp_trace_enabled = TRUE;
+
+      gimp_trace_begin ("startup");
+    }
+}
+
+void
+gimp_trace_begin (const gchar *name)
+{
+  GimpTraceSpan span = { 0, };
+  GArray       *stack;
+  guint         index;
+
+  g_return_if_fail (name != NULL);
+
+  if (! gimp_trace_enabled)
+    return;
+
+  stack = gimp_trace_get_stack ();
+
+  span.name       = g_intern_string (name);
+  span.depth      = stack->len;
+  span.thread     = gimp_trace_get_thread ();
+  span.start_wall = g_get_monotonic_time ();
+  span.start_cpu  = gimp_trace_get_cpu_time ();
+  span.end_wall   = -1;
+  span.end_cpu    = -1;
+
+  g_mutex_lock (&trace_mutex);
+
+  /*  the trace might have been finished by another thread meanwhile  */
+  if (! trace_spans)
+    {
+      g_mutex_unlock (&trace_mutex);
+      return;
+    }
+
+  index = trace_spans->len;
+  g_array_append_val (trace_spans, span);
+
+  g_mutex_unlock (&trace_mutex);
+
+  g_array_append_val (stack, index);
+}
+
+void
+gimp_trace_end (void)
+{
+  GArray *stack;
+  gint64  end_wall;
+  gint64  end_cpu;
+  guint   index;
+
+  if (! gimp_trace_enabled)
+    return;
+
+  stack = gimp_trace_get_stack ();
+
+  g_return_if_fail (stack->len > 0);
+
+  end_wall = g_get_monotonic_time ();
+  end_cpu  = gimp_trace_get_cpu_time ();
+
+  index = g_array_index (stack, guint, stack->len - 1);
+  g_array_set_size (stack, stack->len - 1);
+
+  g_mutex_lock (&trace_mutex);
+
+  if (trace_spans && index < trace_spans->len)
+    {
+      g_array_index (trace_spans, GimpTraceSpan, index).end_wall = end_wall;
+      g_array_index (trace_spans, GimpTraceSpan, index).end_cpu  = end_cpu;
+    }
+
+  g_mutex_unlock (&trace_mutex);
+}
+
+void
+gimp_trace_finish (void)
+{
+  GString *json;
+  GArray  *stack;
+  GError  *error = NULL;
+  gint64   now_wall;
+  gint64   now_cpu;
+  guint    i;
+
+  if (! gimp_trace_enabled)
+    return;
+
+  /*  close whatever is still open on this thread, including the
+   *  toplevel "startup" span
+   */
+  stack = gimp_trace_get_stack ();
+
+  while (stack->len > 0)
+    gimp_trace_end ();
+
+  gimp_trace_enabled = FALSE;
+
+  now_wall = g_get_monotonic_time ();
+  now_cpu  = gimp_trace_get_cpu_time ();
+
+  g_mutex_lock (&trace_mutex);
+
+  json = g_string_new ("{\n  \"displayTimeUnit\": \"ms\",\n"
+                       "  \"traceEvents\": [\n");
+
+  g_print ("Startup trace (wall / cpu, in seconds):\n");
+
+  for (i = 0; i < trace_spans->len; i++)
+    {
+      GimpTraceSpan *span = &g_array_index (trace_spans, GimpTraceSpan, i);
+      gint64         wall;
+      gint64         cpu;
+
+      /*  spans left open on other threads end with the trace  */
+      if (span->end_wall < 0)
+        {
+          span->end_wall = now_wall;
+          span->end_cpu  = now_cpu;
+        }
+
+      wall = span->end_wall - span->start_wall;
+      cpu  = span->end_cpu  - span->start_cpu;
+
+      g_string_append (json, "    { \"name\": ");
+      gimp_trace_write_json (json, span->name);
+      g_string_append_printf (json,
+                              ", \"cat\": \"startup\", \"ph\": \"X\", "
+                              "\"pid\": 1, \"tid\": %u, "
+                              "\"ts\": %" G_GINT64_FORMAT ", "
+                              "\"dur\": %" G_GINT64_FORMAT ", "
+                              "\"args\": { \"cpu_us\": %" G_GINT64_FORMAT " } }%s\n",
+                              span->thread,
+                              span->start_wall - trace_start_wall,
+                              wall, cpu,
+                              i + 1 < trace_spans->len ? "," : "");
+
+      g_print ("%*s%-*s %9.3f %9.3f%s\n",
+               2 + 2 * span->depth, "",
+               MAX (1, 48 - 2 * span->depth), span->name,
+               wall / (gdouble) G_TIME_SPAN_SECOND,
+               cpu  / (gdouble) G_TIME_SPAN_SECOND,
+               span->thread > 1 ? "  (worker)" : "");
+    }
+
+  g_string_append (json, "  ]\n}\n");
+
+  if (! g_file_set_contents (trace_filename, json->str, json->len, &error))
+    {
+      g_printerr ("Failed to write startup trace: %s\n", error->message);
+      g_clear_error (&error);
+    }
+  else
+    {
+      g_print ("Startup trace written to '%s'\n", trace_filename);
+    }
+
+  g_string_free (json, TRUE);
+
+  g_clear_pointer (&trace_spans, g_array_unref);
+  g_clear_pointer (&trace_filename, g_free);
+
+  g_mutex_unlock (&trace_mutex);
+}
+
+
+/*  private functions  */
+
+static gint64
+gimp_trace_get_cpu_time (void)
+{
+#if defined (G_OS_WIN32)
+  FILETIME       creation_time;
+  FILETIME       exit_time;
+  FILETIME       kernel_time;
+  FILETIME       user_time;
+  ULARGE_INTEGER kernel;
+  ULARGE_INTEGER user;
+
+  if (! GetProcessTimes (GetCurrentProcess (),
+                         &creation_time, &exit_time,
+                         &kernel_time, &user_time))
+    return 0;
+
+  kernel.LowPart  = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart    = user_time.dwLowDateTime;
+  user.HighPart   = user_time.dwHighDateTime;
+
+  /*  100ns units  */
+  return (kernel.QuadPart + user.QuadPart) / 10;
+#elif defined (CLOCK_PROCESS_CPUTIME_ID)
+  struct timespec ts;
+
+  if (clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &ts))
+    return 0;
+
+  return (gint64) ts.tv_sec * G_TIME_SPAN_SECOND + ts.tv_nsec / 1000;
+#else
+  return (gint64) clock () * G_TIME_SPAN_SECOND / CLOCKS_PER_SEC;
+#endif
+}
+
+static guint
+gimp_trace_get_thread (void)
+{
+  guint thread = GPOINTER_TO_UINT (g_private_get (&trace_thread_private));
+
+  if (! thread)
+    {
+      /*  the first thread to trace, the main thread, gets id 1  */
+      thread = g_atomic_int_add (&trace_n_threads, 1) + 1;
+
+      g_private_set (&trace_thread_private, GUINT_TO_POINTER (thread));
+    }
+
+  return thread;
+}
+
+static GArray *
+gimp_trace_get_stack (void)
+{
+  GArray *stack = g_private_get (&trace_stack_private);
+
+  if (! stack)
+    {
+      stack = g_array_new (FALSE, FALSE, sizeof (guint));
+
+      g_private_set (&trace_stack_private, stack);
+    }
+
+  return stack;
+}
+
+static void
+gimp_trace_write_json (GString     *str,
+                       const gchar *text)
+{
+  const gchar *p;
+
+  g_string_append_c (str, '"');
+
+  for (p = text; *p; p++)
+    {
+      switch (*p)
+        {
+        case '"':
+        case '\\':
+          g_string_append_c (str, '\\');
+          g_string_append_c (str, *p);
+          break;
+
+        default:
+          if ((guchar) *p < 0x20)
+            g_string_append_printf (str, "\\u%04x", (guchar) *p);
+          else
+            g_string_append_c (str, *p);
+          break;
+        }
+    }
+
+  g_string_append_c (str, '"');
+}
@@ -80,5 +80,12 @@ gimp_console_app_new (Gimp        *gimp,
                       "batch-commands",    batch_commands,
                       NULL);
 
+  /*  batch jobs typically open, process and export a file without
+   *  touching brushes, patterns or fonts, so read those only if a
+   *  procedure asks for them
+   */
+  if (batch_commands && batch_commands[0])
+    gimp->defer_data = TRUE;
+
   return G_APPLICATION (app);
 }
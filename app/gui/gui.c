@@ -109,6 +109,7 @@
 #endif /* GDK_WINDOWING_QUARTZ */
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 
 
 /*  local function prototypes  */
@@ -516,11 +517,13 @@ gui_restore_callback (Gimp               *gimp,
                     NULL);
     }
 
+  GIMP_TRACE_BEGIN ("gui actions and dialogs");
   actions_init (gimp);
   menus_init (gimp);
   gimp_render_init (gimp);
 
   dialogs_init (gimp);
+  GIMP_TRACE_END ();
 
   gimp_clipboard_init (gimp);
   if (gimp_get_clipboard_image (gimp))
@@ -540,7 +543,9 @@ gui_restore_callback (Gimp               *gimp,
   g_type_class_unref (g_type_class_ref (GIMP_TYPE_COLOR_SELECTOR_PALETTE));
 
   status_callback (NULL, _("Tool Options"), 1.0);
+  GIMP_TRACE_BEGIN ("tool options");
   gimp_tools_restore (gimp);
+  GIMP_TRACE_END ();
 }
 
 static void
@@ -582,11 +587,13 @@ gui_restore_after_callback (Gimp               *gimp,
                                 "gimp", gimp,
                                 NULL);
 
+  GIMP_TRACE_BEGIN ("gui menus");
   image_ui_manager = menus_get_image_manager_singleton (gimp);
   gimp_ui_manager_update (image_ui_manager, gimp);
 
   if (gui_config->restore_accels)
     menus_restore (gimp);
+  GIMP_TRACE_END ();
 
   /* Check that every accelerator is unique. */
   gui_check_unique_accelerators (gimp);
@@ -615,6 +622,8 @@ gui_restore_after_callback (Gimp               *gimp,
       GimpDisplayShell *shell;
       GtkWidget        *toplevel;
 
+      GIMP_TRACE_BEGIN ("gui session");
+
       /*  create the empty display  */
       display = GIMP_DISPLAY (gimp_create_display (gimp, NULL,
                                                    gimp_unit_pixel (), 1.0,
@@ -629,6 +638,8 @@ gui_restore_after_callback (Gimp               *gimp,
       if (gui_config->restore_session)
         session_restore (gimp, initial_monitor);
 
+      GIMP_TRACE_END ();
+
       toplevel = gtk_widget_get_toplevel (GTK_WIDGET (shell));
 
 #ifdef G_OS_WIN32
@@ -80,6 +80,7 @@
 #endif
 
 #include "gimp-log.h"
+#include "gimp-trace.h"
 #include "gimp-intl.h"
 #include "gimp-version.h"
 
@@ -92,6 +93,10 @@ static gboolean  gimp_option_stack_trace_mode (const gchar  *option_name,
                                                const gchar  *value,
                                                gpointer      data,
                                                GError      **error);
+static gboolean  gimp_option_startup_trace    (const gchar  *option_name,
+                                               const gchar  *value,
+                                               gpointer      data,
+                                               GError      **error);
 static gboolean  gimp_option_pdb_compat_mode  (const gchar  *option_name,
                                                const gchar  *value,
                                                gpointer      data,
@@ -262,6 +267,11 @@ static const GOptionEntry main_entries[] =
     G_OPTION_ARG_NONE, &use_debug_handler,
     N_("Enable non-fatal debugging signal handlers"), NULL
   },
+  {
+    "startup-trace", 0, G_OPTION_FLAG_FILENAME,
+    G_OPTION_ARG_CALLBACK, gimp_option_startup_trace,
+    N_("Write startup phase timings to <file>"), "<file>"
+  },
   {
     "g-fatal-warnings", 0, G_OPTION_FLAG_NO_ARG,
     G_OPTION_ARG_CALLBACK, gimp_option_fatal_warnings,
@@ -655,6 +665,8 @@ main (int    argc,
 
   gimp_log_init ();
 
+  gimp_trace_init ();
+
   gimp_init_i18n ();
 
   g_set_application_name (GIMP_NAME);
@@ -913,6 +925,17 @@ gimp_option_stack_trace_mode (const gchar  *option_name,
   return TRUE;
 }
 
+static gboolean
+gimp_option_startup_trace (const gchar  *option_name,
+                           const gchar  *value,
+                           gpointer      data,
+                           GError      **error)
+{
+  gimp_trace_enable (value);
+
+  return TRUE;
+}
+
 static gboolean
 gimp_option_pdb_compat_mode (const gchar  *option_name,
                              const gchar  *value,
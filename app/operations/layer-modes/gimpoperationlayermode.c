@@ -117,9 +117,6 @@ static gboolean        process_last_node                             (GeglOperat
                                                                       const GeglRectangle *roi,
                                                                       gint                 level);
 
-static void            gimp_operation_layer_mode_cache_fishes        (GimpOperationLayerMode *op,
-                                                                      const Babl             *preferred_format);
-
 
 G_DEFINE_TYPE (GimpOperationLayerMode, gimp_operation_layer_mode,
                GEGL_TYPE_OPERATION_POINT_COMPOSER3)
@@ -662,8 +659,12 @@ gimp_operation_layer_mode_real_process (GeglOperation       *operation,
 
       /* Make sure the cache is set up from the start as the
        * operation's prepare() method may have not been run yet.
+       * Once it is, the cache is only read here, since this may run
+       * on several threads at once.
        */
-      gimp_operation_layer_mode_cache_fishes (layer_mode, NULL);
+      if (! layer_mode->cached_fish_format)
+        gimp_operation_layer_mode_cache_fishes (layer_mode, NULL);
+
       composite_to_blend_fish = layer_mode->space_fish [composite_space - 1]
                                                        [blend_space     - 1];
 
@@ -873,12 +874,45 @@ process_last_node (GeglOperation       *operation,
   return TRUE;
 }
 
-static void
+
+/*  public functions  */
+
+
+GimpLayerCompositeRegion
+gimp_operation_layer_mode_get_affected_region (GimpOperationLayerMode *layer_mode)
+{
+  GimpOperationLayerModeClass *klass;
+
+  g_return_val_if_fail (GIMP_IS_OPERATION_LAYER_MODE (layer_mode),
+                        GIMP_LAYER_COMPOSITE_REGION_INTERSECTION);
+
+  klass = GIMP_OPERATION_LAYER_MODE_GET_CLASS (layer_mode);
+
+  if (klass->get_affected_region)
+    return klass->get_affected_region (layer_mode);
+
+  return GIMP_LAYER_COMPOSITE_REGION_INTERSECTION;
+}
+
+/**
+ * gimp_operation_layer_mode_cache_fishes:
+ * @op:               a #GimpOperationLayerMode
+ * @preferred_format: (nullable): the format of the input
+ *
+ * Sets up the fishes converting between the composite and blend
+ * spaces of @op, for @preferred_format, or for the format of the
+ * node's input if %NULL.  prepare() does this; code running the
+ * process function without the graph has to call it first, on a
+ * single thread.
+ **/
+void
 gimp_operation_layer_mode_cache_fishes (GimpOperationLayerMode *op,
                                         const Babl             *preferred_format)
 {
   const Babl *format;
 
+  g_return_if_fail (GIMP_IS_OPERATION_LAYER_MODE (op));
+
   if (! preferred_format)
     {
       const GeglRectangle *input_extent;
@@ -898,8 +932,6 @@ gimp_operation_layer_mode_cache_fishes (GimpOperationLayerMode *op,
                                        preferred_format);
   if (op->cached_fish_format != format)
     {
-      op->cached_fish_format = format;
-
       op->space_fish
         /* from */ [GIMP_LAYER_COLOR_SPACE_RGB_LINEAR     - 1]
         /* to   */ [GIMP_LAYER_COLOR_SPACE_RGB_PERCEPTUAL - 1] =
@@ -971,25 +1003,8 @@ gimp_operation_layer_mode_cache_fishes (GimpOperationLayerMode *op,
         /* to   */ [GIMP_LAYER_COLOR_SPACE_RGB_PERCEPTUAL - 1] =
           babl_fish (babl_format_with_space("R'G'B'A float", format),
                      babl_format_with_space ( "R~G~B~A float", format));
+
+      op->cached_fish_format = format;
     }
 }
 
-
-/*  public functions  */
-
-
-GimpLayerCompositeRegion
-gimp_operation_layer_mode_get_affected_region (GimpOperationLayerMode *layer_mode)
-{
-  GimpOperationLayerModeClass *klass;
-
-  g_return_val_if_fail (GIMP_IS_OPERATION_LAYER_MODE (layer_mode),
-                        GIMP_LAYER_COMPOSITE_REGION_INTERSECTION);
-
-  klass = GIMP_OPERATION_LAYER_MODE_GET_CLASS (layer_mode);
-
-  if (klass->get_affected_region)
-    return klass->get_affected_region (layer_mode);
-
-  return GIMP_LAYER_COMPOSITE_REGION_INTERSECTION;
-}
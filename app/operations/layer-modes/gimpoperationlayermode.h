@@ -86,6 +86,8 @@ struct _GimpOperationLayerModeClass
 GType                    gimp_operation_layer_mode_get_type            (void) G_GNUC_CONST;
 
 GimpLayerCompositeRegion gimp_operation_layer_mode_get_affected_region (GimpOperationLayerMode *layer_mode);
+void                     gimp_operation_layer_mode_cache_fishes        (GimpOperationLayerMode *op,
+                                                                        const Babl             *preferred_format);
 
 
 #endif /* __GIMP_OPERATION_LAYER_MODE_H__ */
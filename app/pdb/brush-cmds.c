@@ -781,6 +781,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -813,6 +814,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -845,6 +847,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -876,6 +879,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -925,6 +929,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -986,6 +991,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1017,6 +1023,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1048,6 +1055,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1080,6 +1088,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1119,6 +1128,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1150,6 +1160,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1187,6 +1198,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1218,6 +1230,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1255,6 +1268,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1286,6 +1300,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1323,6 +1338,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1354,6 +1370,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1391,6 +1408,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -1422,6 +1440,7 @@ register_brush_procs (GimpPDB *pdb)
                                          "Bill Skaggs <weskaggs@primate.ucdavis.edu>",
                                          "Bill Skaggs",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
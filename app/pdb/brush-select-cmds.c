@@ -155,6 +155,7 @@ register_brush_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("brush-callback",
                                                        "brush callback",
@@ -200,6 +201,7 @@ register_brush_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("brush-callback",
                                                        "brush callback",
@@ -224,6 +226,7 @@ register_brush_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("brush-callback",
                                                        "brush callback",
@@ -107,6 +107,7 @@ register_brushes_procs (GimpPDB *pdb)
                                          "Seth Burgess",
                                          "Seth Burgess",
                                          "1997");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -125,6 +126,7 @@ register_brushes_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-1996");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("filter",
                                                        "filter",
@@ -3874,6 +3874,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_brush ("brush",
                                                           "brush",
@@ -3899,6 +3900,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_brush ("brush",
                                                       "brush",
@@ -3970,6 +3972,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Ed Swartz",
                                          "Ed Swartz",
                                          "2012");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4125,6 +4128,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Alexia Death",
                                          "Alexia Death",
                                          "2014");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4188,6 +4192,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Alexia Death",
                                          "Alexia Death",
                                          "2014");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4252,6 +4257,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2011");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_string ("name",
                                                            "name",
@@ -4276,6 +4282,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2011");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -4392,6 +4399,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2016");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_string ("name",
                                                            "name",
@@ -4416,6 +4424,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2016");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -4440,6 +4449,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_pattern ("pattern",
                                                             "pattern",
@@ -4465,6 +4475,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_pattern ("pattern",
                                                         "pattern",
@@ -4490,6 +4501,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_gradient ("gradient",
                                                              "gradient",
@@ -4515,6 +4527,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -4540,6 +4553,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4557,6 +4571,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4574,6 +4589,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4591,6 +4607,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -4750,6 +4767,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_palette ("palette",
                                                             "palette",
@@ -4775,6 +4793,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -4800,6 +4819,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_font ("font",
                                                          "font",
@@ -4825,6 +4845,7 @@ register_context_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org> & Sven Neumann <sven@gimp.org>",
                                          "Michael Natterer & Sven Neumann",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_font ("font",
                                                      "font",
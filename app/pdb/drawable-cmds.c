@@ -1940,6 +1940,7 @@ register_drawable_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-1996");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -396,6 +396,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-1996");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -421,6 +422,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis & Raphael Quinet",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-2000");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -454,6 +456,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -498,6 +501,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -584,6 +588,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-1996");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -609,6 +614,7 @@ register_drawable_edit_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2018");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_drawable ("drawable",
                                                          "drawable",
@@ -102,6 +102,7 @@ register_dynamics_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2011");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -119,6 +120,7 @@ register_dynamics_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2011");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("filter",
                                                        "filter",
@@ -118,6 +118,7 @@ register_font_procs (GimpPDB *pdb)
                                          "Idriss Fekir",
                                          "Idriss Fekir",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_font ("font",
                                                      "font",
@@ -152,6 +153,7 @@ register_font_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -163,6 +163,7 @@ register_fonts_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -180,6 +181,7 @@ register_fonts_procs (GimpPDB *pdb)
                                          "Idriss Fekir",
                                          "Idriss Fekir",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_return_value (procedure,
                                    gimp_param_spec_string ("config",
                                                            "config",
@@ -225,6 +227,7 @@ register_fonts_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("filter",
                                                        "filter",
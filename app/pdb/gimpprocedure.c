@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -28,6 +29,7 @@
 #include "pdb-types.h"
 
 #include "core/gimp.h"
+#include "core/gimp-data-factories.h"
 #include "core/gimp-memsize.h"
 #include "core/gimpchannel.h"
 #include "core/gimpdisplay.h"
@@ -78,6 +80,7 @@ static gboolean      gimp_procedure_validate_args       (GimpProcedure   *proced
                                                          GimpValueArray  *args,
                                                          gboolean         return_vals,
                                                          GError         **error);
+static gboolean      gimp_procedure_uses_data           (GimpProcedure   *procedure);
 
 
 G_DEFINE_TYPE (GimpProcedure, gimp_procedure, GIMP_TYPE_VIEWABLE)
@@ -413,6 +416,15 @@ gimp_procedure_set_deprecated (GimpProcedure *procedure,
   procedure->deprecated = g_strdup (deprecated);
 }
 
+void
+gimp_procedure_set_uses_data (GimpProcedure *procedure,
+                              gboolean       uses_data)
+{
+  g_return_if_fail (GIMP_IS_PROCEDURE (procedure));
+
+  procedure->uses_data = uses_data ? TRUE : FALSE;
+}
+
 const gchar *
 gimp_procedure_get_label (GimpProcedure *procedure)
 {
@@ -509,6 +521,10 @@ gimp_procedure_execute (GimpProcedure   *procedure,
       return return_vals;
     }
 
+  /*  in a deferred-data startup, read the data files on first use  */
+  if (G_UNLIKELY (gimp->defer_data) && gimp_procedure_uses_data (procedure))
+    gimp_data_factories_load_deferred (gimp);
+
   if (GIMP_IS_PDB_CONTEXT (context))
     context = g_object_ref (context);
   else
@@ -828,6 +844,28 @@ gimp_procedure_free_attribution (GimpProcedure *procedure)
   procedure->static_attribution = FALSE;
 }
 
+static gboolean
+gimp_procedure_uses_data (GimpProcedure *procedure)
+{
+  gint i;
+
+  /*  set by pdbgen for procedures which use data objects without
+   *  taking or returning them, mostly through the context
+   */
+  if (procedure->uses_data)
+    return TRUE;
+
+  for (i = 0; i < procedure->num_args; i++)
+    if (GIMP_IS_PARAM_SPEC_RESOURCE (procedure->args[i]))
+      return TRUE;
+
+  for (i = 0; i < procedure->num_values; i++)
+    if (GIMP_IS_PARAM_SPEC_RESOURCE (procedure->values[i]))
+      return TRUE;
+
+  return FALSE;
+}
+
 static gboolean
 gimp_procedure_validate_args (GimpProcedure  *procedure,
                               GParamSpec    **param_specs,
@@ -70,6 +70,7 @@ struct _GimpProcedure
 
   gboolean          is_core;        /* Created by core for libgimp    */
   gboolean          is_private;     /* Invisible procedure            */
+  gboolean          uses_data;      /* Uses brushes, fonts, ...       */
 };
 
 struct _GimpProcedureClass
@@ -134,6 +135,8 @@ void             gimp_procedure_take_attribution   (GimpProcedure    *procedure,
 
 void             gimp_procedure_set_deprecated     (GimpProcedure    *procedure,
                                                     const gchar      *deprecated);
+void             gimp_procedure_set_uses_data      (GimpProcedure    *procedure,
+                                                    gboolean          uses_data);
 
 const gchar    * gimp_procedure_get_label          (GimpProcedure    *procedure);
 const gchar    * gimp_procedure_get_menu_label     (GimpProcedure    *procedure);
@@ -1242,6 +1242,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -1274,6 +1275,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -1306,6 +1308,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Lars-Peter Clausen <lars@metafoo.de>",
                                          "Lars-Peter Clausen",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1337,6 +1340,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Federico Mena Quintero",
                                          "Federico Mena Quintero",
                                          "1997");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1380,6 +1384,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Federico Mena Quintero",
                                          "Federico Mena Quintero",
                                          "1997");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1423,6 +1428,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1462,6 +1468,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1501,6 +1508,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1540,6 +1548,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1579,6 +1588,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1617,6 +1627,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1661,6 +1672,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1699,6 +1711,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1743,6 +1756,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1781,6 +1795,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1825,6 +1840,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1864,6 +1880,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1903,6 +1920,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1948,6 +1966,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -1993,6 +2012,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2031,6 +2051,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2075,6 +2096,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2113,6 +2135,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2157,6 +2180,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2195,6 +2219,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2233,6 +2258,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2271,6 +2297,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
@@ -2309,6 +2336,7 @@ register_gradient_procs (GimpPDB *pdb)
                                          "Shlomi Fish <shlomif@iglu.org.il>",
                                          "Shlomi Fish",
                                          "2003");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_gradient ("gradient",
                                                          "gradient",
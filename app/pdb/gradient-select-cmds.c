@@ -161,6 +161,7 @@ register_gradient_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("gradient-callback",
                                                        "gradient callback",
@@ -206,6 +207,7 @@ register_gradient_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("gradient-callback",
                                                        "gradient callback",
@@ -230,6 +232,7 @@ register_gradient_select_procs (GimpPDB *pdb)
                                          "Andy Thomas",
                                          "Andy Thomas",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("gradient-callback",
                                                        "gradient callback",
@@ -106,6 +106,7 @@ register_gradients_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2002");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -124,6 +125,7 @@ register_gradients_procs (GimpPDB *pdb)
                                          "Federico Mena Quintero",
                                          "Federico Mena Quintero",
                                          "1997");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("filter",
                                                        "filter",
@@ -178,7 +178,7 @@ image_convert_indexed_invoker (GimpProcedure         *procedure,
 
       if (success)
         success = gimp_image_convert_indexed (image,
-                                              palette_type, num_cols, remove_unused,
+                                              palette_type, num_cols, remove_unused, FALSE,
                                               dither_type, alpha_dither, FALSE,
                                               pal,
                                               NULL, error);
@@ -327,6 +327,7 @@ register_image_convert_procs (GimpPDB *pdb)
                                          "Spencer Kimball & Peter Mattis",
                                          "Spencer Kimball & Peter Mattis",
                                          "1995-1996");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_image ("image",
                                                       "image",
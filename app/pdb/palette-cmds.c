@@ -554,6 +554,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -586,6 +587,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -618,6 +620,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -649,6 +652,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2006");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -680,6 +684,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2005");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -711,6 +716,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2005");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -742,6 +748,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -788,6 +795,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -819,6 +827,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -857,6 +866,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -895,6 +905,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -933,6 +944,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -976,6 +988,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Jehan",
                                          "Jehan",
                                          "2024");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -1020,6 +1033,7 @@ register_palette_procs (GimpPDB *pdb)
                                          "Jehan",
                                          "Jehan",
                                          "2024");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_palette ("palette",
                                                         "palette",
@@ -106,6 +106,7 @@ register_palettes_procs (GimpPDB *pdb)
                                          "Adrian Likins <adrian@gimp.org>",
                                          "Adrian Likins",
                                          "1998");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
@@ -124,6 +125,7 @@ register_palettes_procs (GimpPDB *pdb)
                                          "Nathan Summers <rock@gimp.org>",
                                          "Nathan Summers",
                                          "2001");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("filter",
                                                        "filter",
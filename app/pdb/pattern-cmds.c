@@ -95,13 +95,14 @@ pattern_get_info_invoker (GimpProcedure         *procedure,
 
   if (success)
     {
-      const Babl *format;
+      GimpTempBuf *mask = gimp_pattern_get_mask (pattern);
+      const Babl  *format;
 
       format = gimp_babl_compat_u8_format (
-        gimp_temp_buf_get_format (pattern->mask));
+        gimp_temp_buf_get_format (mask));
 
-      width  = gimp_temp_buf_get_width  (pattern->mask);
-      height = gimp_temp_buf_get_height (pattern->mask);
+      width  = gimp_temp_buf_get_width  (mask);
+      height = gimp_temp_buf_get_height (mask);
       bpp    = babl_format_get_bytes_per_pixel (format);
     }
 
@@ -138,20 +139,20 @@ pattern_get_pixels_invoker (GimpProcedure         *procedure,
 
   if (success)
     {
-
-      const Babl *format;
-      gpointer    data;
+      GimpTempBuf *mask = gimp_pattern_get_mask (pattern);
+      const Babl  *format;
+      gpointer     data;
 
       format = gimp_babl_compat_u8_format (
-        gimp_temp_buf_get_format (pattern->mask));
-      data   = gimp_temp_buf_lock (pattern->mask, format, GEGL_ACCESS_READ);
+        gimp_temp_buf_get_format (mask));
+      data   = gimp_temp_buf_lock (mask, format, GEGL_ACCESS_READ);
 
-      width           = gimp_temp_buf_get_width  (pattern->mask);
-      height          = gimp_temp_buf_get_height (pattern->mask);
+      width           = gimp_temp_buf_get_width  (mask);
+      height          = gimp_temp_buf_get_height (mask);
       bpp             = babl_format_get_bytes_per_pixel (format);
-      color_bytes     = g_bytes_new (data, gimp_temp_buf_get_data_size (pattern->mask));
+      color_bytes     = g_bytes_new (data, gimp_temp_buf_get_data_size (mask));
 
-      gimp_temp_buf_unlock (pattern->mask, data);
+      gimp_temp_buf_unlock (mask, data);
     }
 
   return_vals = gimp_procedure_get_return_values (procedure, success,
@@ -187,6 +188,7 @@ register_pattern_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2023");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("name",
                                                        "name",
@@ -219,6 +221,7 @@ register_pattern_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_pattern ("pattern",
                                                         "pattern",
@@ -262,6 +265,7 @@ register_pattern_procs (GimpPDB *pdb)
                                          "Michael Natterer <mitch@gimp.org>",
                                          "Michael Natterer",
                                          "2004");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_pattern ("pattern",
                                                         "pattern",
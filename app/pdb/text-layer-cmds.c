@@ -1014,6 +1014,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_image ("image",
                                                       "image",
@@ -1072,6 +1073,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1102,6 +1104,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1132,6 +1135,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Barak Itkin <lightningismyname@gmail.com>",
                                          "Barak Itkin",
                                          "2010");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1163,6 +1167,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Ian Munsie <darkstarsword@gmail.com>",
                                          "Ian Munsie",
                                          "2014");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1193,6 +1198,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1224,6 +1230,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1255,6 +1262,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1292,6 +1300,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1329,6 +1338,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1358,6 +1368,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1387,6 +1398,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1417,6 +1429,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Sven Neumann <sven@gimp.org>",
                                          "Sven Neumann",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1447,6 +1460,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1476,6 +1490,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1505,6 +1520,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1535,6 +1551,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1565,6 +1582,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1595,6 +1613,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1625,6 +1644,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1655,6 +1675,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1685,6 +1706,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1715,6 +1737,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1745,6 +1768,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1774,6 +1798,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1803,6 +1828,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1832,6 +1858,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1861,6 +1888,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1890,6 +1918,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Marcus Heese <heese@cip.ifi.lmu.de>",
                                          "Marcus Heese",
                                          "2008");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -1919,6 +1948,7 @@ register_text_layer_procs (GimpPDB *pdb)
                                          "Barak Itkin <lightningismyname@gmail.com>",
                                          "Barak Itkin",
                                          "2009");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_text_layer ("layer",
                                                            "layer",
@@ -162,6 +162,7 @@ register_text_tool_procs (GimpPDB *pdb)
                                          "Martin Edlman & Sven Neumann",
                                          "Spencer Kimball & Peter Mattis",
                                          "1998- 2001");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_image ("image",
                                                       "image",
@@ -244,6 +245,7 @@ register_text_tool_procs (GimpPDB *pdb)
                                          "Martin Edlman & Sven Neumann",
                                          "Spencer Kimball & Peter Mattis",
                                          "1998- 2001");
+  gimp_procedure_set_uses_data (procedure, TRUE);
   gimp_procedure_add_argument (procedure,
                                gimp_param_spec_string ("text",
                                                        "text",
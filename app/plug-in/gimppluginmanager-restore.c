@@ -49,6 +49,7 @@
 #include "plug-in-rc.h"
 
 #include "gimp-intl.h"
+#include "gimp-trace.h"
 
 
 static void    gimp_plug_in_manager_search            (GimpPlugInManager    *manager,
@@ -103,18 +104,26 @@ gimp_plug_in_manager_restore (GimpPlugInManager  *manager,
   context = gimp_pdb_context_new (gimp, context, TRUE);
 
   /* search for binaries in the plug-in directory path */
+  GIMP_TRACE_BEGIN ("search");
   gimp_plug_in_manager_search (manager, status_callback);
+  GIMP_TRACE_END ();
 
   /* read the pluginrc file for cached data */
   pluginrc = gimp_plug_in_manager_get_pluginrc (manager);
 
+  GIMP_TRACE_BEGIN ("read pluginrc");
   gimp_plug_in_manager_read_pluginrc (manager, pluginrc, status_callback);
+  GIMP_TRACE_END ();
 
   /* query any plug-ins that changed since we last wrote out pluginrc */
+  GIMP_TRACE_BEGIN ("query new plug-ins");
   gimp_plug_in_manager_query_new (manager, context, status_callback);
+  GIMP_TRACE_END ();
 
   /* initialize the plug-ins */
+  GIMP_TRACE_BEGIN ("init plug-ins");
   gimp_plug_in_manager_init_plug_ins (manager, context, status_callback);
+  GIMP_TRACE_END ();
 
   /* add the procedures to manager->plug_in_procedures */
   for (list = manager->plug_in_defs; list; list = list->next)
@@ -163,6 +172,7 @@ gimp_plug_in_manager_restore (GimpPlugInManager  *manager,
   manager->plug_in_defs = NULL;
 
   /* add the plug-in procs to the procedure database */
+  GIMP_TRACE_BEGIN ("add procedures");
   for (list = manager->plug_in_procedures; list; list = list->next)
     {
       gimp_plug_in_manager_add_to_db (manager, context, list->data);
@@ -170,8 +180,11 @@ gimp_plug_in_manager_restore (GimpPlugInManager  *manager,
 
   /* sort the load, save and export procedures, make the raw handler list */
   gimp_plug_in_manager_sort_file_procs (manager);
+  GIMP_TRACE_END ();
 
+  GIMP_TRACE_BEGIN ("run extensions");
   gimp_plug_in_manager_run_extensions (manager, context, status_callback);
+  GIMP_TRACE_END ();
 
   g_object_unref (context);
 }
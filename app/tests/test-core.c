@@ -15,18 +15,38 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
+#include <stdlib.h>
+
 #include <gegl.h>
 #include <gtk/gtk.h>
 
+#include "libgimpbase/gimpbase.h"
+#include "libgimpmath/gimpmath.h"
+
 #include "widgets/widgets-types.h"
 
 #include "widgets/gimpuimanager.h"
 
 #include "core/gimp.h"
+#include "core/gimpasync.h"
+#include "core/gimpboundary.h"
 #include "core/gimpcontext.h"
+#include "core/gimpdrawable-foreground-extract.h"
+#include "core/gimphistogram.h"
 #include "core/gimpimage.h"
+#include "core/gimpimage-colormap.h"
+#include "core/gimpimage-convert-indexed.h"
+#include "core/gimpimage-convert-precision.h"
 #include "core/gimplayer.h"
 #include "core/gimplayer-new.h"
+#include "core/gimplineart.h"
+#include "core/gimppalette.h"
+#include "core/gimppickable-contiguous-region.h"
+#include "core/gimpsubprogress.h"
+
+#include "gegl/gimp-gegl-loops-sse2.h"
 
 #include "operations/gimplevelsconfig.h"
 
@@ -37,6 +57,33 @@
 
 #define GIMP_TEST_IMAGE_SIZE 100
 
+/*  large enough for the matte to be solved in several tiles, and for
+ *  a coarse matte to be solved first
+ */
+#define FOREGROUND_EXTRACT_SIZE 1040
+
+/*  large enough for an edit in a corner to be closed incrementally  */
+#define LINE_ART_SIZE           1280
+
+/*  large enough for the boundary to be searched in many bands  */
+#define BOUNDARY_SIZE           2048
+
+/*  large enough for a fill to wind through many tiles  */
+#define CONTIGUOUS_REGION_SIZE  2048
+
+/*  large enough for the conversion passes to be split in several areas  */
+#define CONVERT_INDEXED_SIZE    768
+
+/*  the size and number of the layers converted to another precision  */
+#define CONVERT_PRECISION_SIZE  1024
+#define CONVERT_PRECISION_N     8
+
+/*  large enough for an approximate histogram to be shown first  */
+#define HISTOGRAM_SIZE          4608
+
+/*  the number of evenly spaced values mapped to histogram bins  */
+#define HISTOGRAM_BINS_N_VALUES 4096
+
 #define ADD_IMAGE_TEST(function) \
   g_test_add ("/gimp-core/" #function, \
               GimpTestFixture, \
@@ -263,6 +310,1506 @@ white_graypoint_in_red_levels (GimpTestFixture *fixture,
   g_clear_object (&white);
 }
 
+/**
+ * foreground_extract_tiles:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that solving the matte of a trimap in tiles gives about
+ * the same matte as solving the whole trimap at once, also across the
+ * tile borders, and reports the time both take, and the time of the
+ * coarse matte.
+ **/
+static void
+foreground_extract_tiles (GimpTestFixture *fixture,
+                          gconstpointer    data)
+{
+  Gimp               *gimp      = GIMP (data);
+  GimpMattingEngine   engines[] = { GIMP_MATTING_ENGINE_GLOBAL,
+                                    GIMP_MATTING_ENGINE_LEVIN };
+  GimpImage          *image;
+  GimpLayer          *layer;
+  GeglBuffer         *buffer;
+  GeglBuffer         *trimap;
+  GeglBufferIterator *iter;
+  gint                i;
+
+  image = gimp_image_new (gimp,
+                          FOREGROUND_EXTRACT_SIZE,
+                          FOREGROUND_EXTRACT_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_FLOAT_NON_LINEAR);
+
+  layer = gimp_layer_new (image,
+                          FOREGROUND_EXTRACT_SIZE,
+                          FOREGROUND_EXTRACT_SIZE,
+                          babl_format ("R'G'B'A float"),
+                          "Test Layer",
+                          GIMP_OPACITY_OPAQUE,
+                          GIMP_LAYER_MODE_NORMAL);
+
+  gimp_image_add_layer (image,
+                        layer,
+                        GIMP_IMAGE_ACTIVE_PARENT,
+                        0,
+                        FALSE);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+  trimap = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                            FOREGROUND_EXTRACT_SIZE,
+                                            FOREGROUND_EXTRACT_SIZE),
+                            babl_format ("Y float"));
+
+  /*  a wavy, soft vertical edge with a little texture, and an unknown
+   *  band along it which crosses the borders of all tile rows
+   */
+  iter = gegl_buffer_iterator_new (buffer, NULL, 0,
+                                   babl_format ("R'G'B'A float"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter, trimap, NULL, 0,
+                            babl_format ("Y float"),
+                            GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      gfloat              *pixel = iter->items[0].data;
+      gfloat              *tri   = iter->items[1].data;
+      gint                 x, y;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        {
+          gdouble edge = 448.0 + 32.0 * sin (y / 60.0);
+
+          for (x = roi->x; x < roi->x + roi->width; x++)
+            {
+              gdouble alpha   = CLAMP ((x - edge) / 8.0 + 0.5, 0.0, 1.0);
+              gdouble texture = 0.05 * sin (x * 0.3) * sin (y * 0.2);
+
+              pixel[0] = 0.1 + 0.8 * alpha + texture;
+              pixel[1] = 0.2 + 0.4 * alpha + texture;
+              pixel[2] = 0.7 - 0.5 * alpha + texture;
+              pixel[3] = 1.0;
+
+              if (x < edge - 16.0)
+                *tri = 0.0;
+              else if (x > edge + 16.0)
+                *tri = 1.0;
+              else
+                *tri = 0.5;
+
+              pixel += 4;
+              tri++;
+            }
+        }
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (engines); i++)
+    {
+      GeglNode   *gegl;
+      GeglNode   *input;
+      GeglNode   *aux;
+      GeglNode   *matting;
+      GeglNode   *sink;
+      GeglBuffer *reference;
+      GeglBuffer *matte;
+      GeglBuffer *coarse;
+      gint64      reference_time;
+      gint64      tiled_time;
+      gint64      coarse_time;
+      gdouble     max_diff = 0.0;
+      gdouble     sum_diff = 0.0;
+      gint        n_unknown = 0;
+
+      /*  the matte solved in one go, as it was before tiling  */
+      gegl = gegl_node_new ();
+
+      input = gegl_node_new_child (gegl,
+                                   "operation", "gegl:buffer-source",
+                                   "buffer",    buffer,
+                                   NULL);
+      aux = gegl_node_new_child (gegl,
+                                 "operation", "gegl:buffer-source",
+                                 "buffer",    trimap,
+                                 NULL);
+
+      if (engines[i] == GIMP_MATTING_ENGINE_GLOBAL)
+        matting = gegl_node_new_child (gegl,
+                                       "operation",  "gegl:matting-global",
+                                       "iterations", 2,
+                                       NULL);
+      else
+        matting = gegl_node_new_child (gegl,
+                                       "operation",     "gegl:matting-levin",
+                                       "levels",        2,
+                                       "active_levels", 2,
+                                       NULL);
+
+      sink = gegl_node_new_child (gegl,
+                                  "operation", "gegl:buffer-sink",
+                                  "buffer",    &reference,
+                                  "format",    babl_format ("Y float"),
+                                  NULL);
+
+      gegl_node_link_many (input, matting, sink, NULL);
+      gegl_node_connect (aux, "output", matting, "aux");
+
+      reference_time = g_get_monotonic_time ();
+      gegl_node_process (sink);
+      reference_time = g_get_monotonic_time () - reference_time;
+
+      g_object_unref (gegl);
+
+      tiled_time = g_get_monotonic_time ();
+      matte = gimp_drawable_foreground_extract (GIMP_DRAWABLE (layer),
+                                                engines[i], 2, 2, 2,
+                                                trimap, NULL);
+      tiled_time = g_get_monotonic_time () - tiled_time;
+
+      coarse_time = g_get_monotonic_time ();
+      coarse = gimp_drawable_foreground_extract_coarse (GIMP_DRAWABLE (layer),
+                                                        engines[i], 2, 2, 2,
+                                                        trimap);
+      coarse_time = g_get_monotonic_time () - coarse_time;
+
+      g_test_message ("%s: one go %.1f ms, tiled %.1f ms, coarse %.1f ms",
+                      engines[i] == GIMP_MATTING_ENGINE_GLOBAL ?
+                      "global" : "levin",
+                      reference_time / 1000.0, tiled_time / 1000.0,
+                      coarse_time / 1000.0);
+
+      g_assert_nonnull (coarse);
+      g_object_unref (coarse);
+
+      iter = gegl_buffer_iterator_new (trimap, NULL, 0,
+                                       babl_format ("Y float"),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 3);
+
+      gegl_buffer_iterator_add (iter, reference, NULL, 0,
+                                babl_format ("Y float"),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+      gegl_buffer_iterator_add (iter, matte, NULL, 0,
+                                babl_format ("Y float"),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const gfloat *tri = iter->items[0].data;
+          const gfloat *ref = iter->items[1].data;
+          const gfloat *out = iter->items[2].data;
+          gint          j;
+
+          for (j = 0; j < iter->length; j++)
+            {
+              if (tri[j] > 0.0 && tri[j] < 1.0)
+                {
+                  gdouble diff = fabs (out[j] - ref[j]);
+
+                  max_diff  = MAX (max_diff, diff);
+                  sum_diff += diff;
+                  n_unknown++;
+                }
+            }
+        }
+
+      g_assert_cmpint (n_unknown, >, 0);
+      g_assert_cmpfloat (sum_diff / n_unknown, <=, 0.01);
+      g_assert_cmpfloat (max_diff, <=, 0.15);
+
+      g_object_unref (reference);
+      g_object_unref (matte);
+    }
+
+  g_object_unref (trimap);
+  g_object_unref (image);
+}
+
+static void
+draw_open_square (GeglBuffer *buffer,
+                  gint        x,
+                  gint        y,
+                  gboolean    gap_on_left)
+{
+  GeglColor *black = gegl_color_new ("black");
+
+  /*  an 80x80 outline, 3 pixels wide, with a 12 pixels gap in the
+   *  middle of its left or top side
+   */
+  gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y + 77, 80, 3), black);
+  gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x + 77, y, 3, 80), black);
+
+  if (gap_on_left)
+    {
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y, 80, 3), black);
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y, 3, 34), black);
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y + 46, 3, 34), black);
+    }
+  else
+    {
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y, 3, 80), black);
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x, y, 34, 3), black);
+      gegl_buffer_set_color (buffer, GEGL_RECTANGLE (x + 46, y, 34, 3), black);
+    }
+
+  g_object_unref (black);
+}
+
+/**
+ * line_art_incremental:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that closing the line art again after a local edit gives
+ * the same result as closing it all from scratch, for shapes inside
+ * the recomputed area, on its border, and around it.
+ **/
+static void
+line_art_incremental (GimpTestFixture *fixture,
+                      gconstpointer    data)
+{
+  Gimp               *gimp = GIMP (data);
+  GimpImage          *image;
+  GimpLayer          *layer;
+  GimpLineArt        *line_art;
+  GimpLineArt        *reference;
+  GeglBuffer         *buffer;
+  GeglBuffer         *closed;
+  GeglBuffer         *expected;
+  GeglColor          *white;
+  GeglBufferIterator *iter;
+  guchar              gap;
+  gint                n_different = 0;
+  gint                x, y;
+
+  image = gimp_image_new (gimp,
+                          LINE_ART_SIZE,
+                          LINE_ART_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_U8_NON_LINEAR);
+
+  layer = gimp_layer_new (image,
+                          LINE_ART_SIZE,
+                          LINE_ART_SIZE,
+                          babl_format ("R'G'B'A u8"),
+                          "Test Layer",
+                          GIMP_OPACITY_OPAQUE,
+                          GIMP_LAYER_MODE_NORMAL);
+
+  gimp_image_add_layer (image,
+                        layer,
+                        GIMP_IMAGE_ACTIVE_PARENT,
+                        0,
+                        FALSE);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  white = gegl_color_new ("white");
+  gegl_buffer_set_color (buffer, NULL, white);
+  g_object_unref (white);
+
+  for (y = 40; y < 1000; y += 320)
+    for (x = 40; x < 1000; x += 320)
+      draw_open_square (buffer, x, y, (x / 320 + y / 320) % 2);
+
+  /*  straddling the border of the area recomputed after the edit
+   *  below, with the gap outside of it, and across it
+   */
+  draw_open_square (buffer, 720, 1000, TRUE);
+  draw_open_square (buffer, 1000, 730, TRUE);
+
+  gimp_drawable_update (GIMP_DRAWABLE (layer), 0, 0, -1, -1);
+
+  line_art = gimp_line_art_new ();
+  gimp_line_art_set_input (line_art, GIMP_PICKABLE (layer));
+  gimp_line_art_get (line_art, NULL);
+
+  /*  edit one corner only  */
+  draw_open_square (buffer, 1000, 1000, FALSE);
+
+  gimp_drawable_update (GIMP_DRAWABLE (layer), 1000, 1000, 80, 80);
+  gimp_viewable_invalidate_preview (GIMP_VIEWABLE (layer));
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  closed = gimp_line_art_get (line_art, NULL);
+
+  reference = gimp_line_art_new ();
+  gimp_line_art_set_input (reference, GIMP_PICKABLE (layer));
+  expected = gimp_line_art_get (reference, NULL);
+
+  /*  the new gap was closed  */
+  gegl_buffer_sample (closed, 1040, 1001, NULL, &gap, babl_format ("Y u8"),
+                      GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
+  g_assert_cmpint (gap, !=, 0);
+
+  iter = gegl_buffer_iterator_new (closed, NULL, 0,
+                                   babl_format ("Y u8"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter, expected, NULL, 0,
+                            babl_format ("Y u8"),
+                            GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guchar *out = iter->items[0].data;
+      const guchar *ref = iter->items[1].data;
+      gint          i;
+
+      for (i = 0; i < iter->length; i++)
+        {
+          if (out[i] != ref[i])
+            n_different++;
+        }
+    }
+
+  g_assert_cmpint (n_different, ==, 0);
+
+  g_object_unref (reference);
+  g_object_unref (line_art);
+  g_object_unref (image);
+}
+
+/**
+ * line_art_threads:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that closing line art gives the same result whether its
+ * passes run on one thread or are split over several.
+ **/
+static void
+line_art_threads (GimpTestFixture *fixture,
+                  gconstpointer    data)
+{
+  Gimp               *gimp = GIMP (data);
+  GimpImage          *image;
+  GimpLayer          *layer;
+  GimpLineArt        *serial;
+  GimpLineArt        *parallel;
+  GeglBuffer         *buffer;
+  GeglBuffer         *serial_closed;
+  GeglBuffer         *parallel_closed;
+  GeglColor          *white;
+  GeglBufferIterator *iter;
+  gint                threads;
+  gint                n_different = 0;
+  gint                x, y;
+
+  image = gimp_image_new (gimp,
+                          LINE_ART_SIZE,
+                          LINE_ART_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_U8_NON_LINEAR);
+
+  layer = gimp_layer_new (image,
+                          LINE_ART_SIZE,
+                          LINE_ART_SIZE,
+                          babl_format ("R'G'B'A u8"),
+                          "Test Layer",
+                          GIMP_OPACITY_OPAQUE,
+                          GIMP_LAYER_MODE_NORMAL);
+
+  gimp_image_add_layer (image,
+                        layer,
+                        GIMP_IMAGE_ACTIVE_PARENT,
+                        0,
+                        FALSE);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  white = gegl_color_new ("white");
+  gegl_buffer_set_color (buffer, NULL, white);
+  g_object_unref (white);
+
+  /*  shapes at every offset from the band and tile borders  */
+  for (y = 20; y < LINE_ART_SIZE - 100; y += 137)
+    for (x = 20; x < LINE_ART_SIZE - 100; x += 151)
+      draw_open_square (buffer, x, y, (x + y) % 2);
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  g_object_set (gegl_config (), "threads", 1, NULL);
+
+  serial = gimp_line_art_new ();
+  gimp_line_art_set_input (serial, GIMP_PICKABLE (layer));
+  serial_closed = gimp_line_art_get (serial, NULL);
+
+  g_object_set (gegl_config (), "threads", 4, NULL);
+
+  parallel = gimp_line_art_new ();
+  gimp_line_art_set_input (parallel, GIMP_PICKABLE (layer));
+  parallel_closed = gimp_line_art_get (parallel, NULL);
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  iter = gegl_buffer_iterator_new (serial_closed, NULL, 0,
+                                   babl_format ("Y u8"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter, parallel_closed, NULL, 0,
+                            babl_format ("Y u8"),
+                            GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guchar *out = iter->items[0].data;
+      const guchar *ref = iter->items[1].data;
+      gint          i;
+
+      for (i = 0; i < iter->length; i++)
+        {
+          if (out[i] != ref[i])
+            n_different++;
+        }
+    }
+
+  g_assert_cmpint (n_different, ==, 0);
+
+  g_object_unref (serial);
+  g_object_unref (parallel);
+  g_object_unref (image);
+}
+
+static gint
+boundary_seg_cmp (const GimpBoundSeg *seg1,
+                  const GimpBoundSeg *seg2)
+{
+  if (seg1->y1 != seg2->y1)
+    return seg1->y1 - seg2->y1;
+  if (seg1->x1 != seg2->x1)
+    return seg1->x1 - seg2->x1;
+  if (seg1->y2 != seg2->y2)
+    return seg1->y2 - seg2->y2;
+  if (seg1->x2 != seg2->x2)
+    return seg1->x2 - seg2->x2;
+
+  return (gint) seg1->open - (gint) seg2->open;
+}
+
+static GimpBoundSeg *
+boundary_find_sorted (GeglBuffer       *mask,
+                      GimpBoundaryType  type,
+                      gint              n_threads,
+                      gint             *num_segs,
+                      gint64           *time)
+{
+  GimpBoundSeg *segs;
+  gint64        start;
+
+  g_object_set (gegl_config (), "threads", n_threads, NULL);
+
+  start = g_get_monotonic_time ();
+
+  segs = gimp_boundary_find (mask, NULL, babl_format ("Y float"), type,
+                             BOUNDARY_SIZE / 4, BOUNDARY_SIZE / 4,
+                             3 * BOUNDARY_SIZE / 4, 3 * BOUNDARY_SIZE / 4,
+                             GIMP_BOUNDARY_HALF_WAY, num_segs);
+
+  *time = g_get_monotonic_time () - start;
+
+  qsort (segs, *num_segs, sizeof (GimpBoundSeg),
+         (GCompareFunc) boundary_seg_cmp);
+
+  return segs;
+}
+
+static GeglBuffer *
+boundary_mask_new (void)
+{
+  GeglBuffer         *mask;
+  GeglBufferIterator *iter;
+
+  mask = gegl_buffer_new (GEGL_RECTANGLE (0, 0, BOUNDARY_SIZE, BOUNDARY_SIZE),
+                          babl_format ("Y float"));
+
+  /*  rings of every size, and a bar spanning all rows  */
+  iter = gegl_buffer_iterator_new (mask, NULL, 0, babl_format ("Y float"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      gfloat              *pixel = iter->items[0].data;
+      gint                 x, y;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        for (x = roi->x; x < roi->x + roi->width; x++)
+          {
+            gint    cx = x % 200 - 100;
+            gint    cy = y % 170 - 85;
+            gdouble r  = sqrt (cx * cx + cy * cy);
+            gdouble r1 = 20 + (x / 200 * 7 + y / 170 * 3) % 50;
+
+            *pixel++ = ((r >= r1 && r < r1 + 15) ||
+                        (x >= 1013 && x < 1031)) ? 1.0 : 0.0;
+          }
+    }
+
+  return mask;
+}
+
+/**
+ * boundary_bands:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that searching a boundary in parallel bands finds the
+ * same segments as the serial search, on a mask whose outlines cross
+ * the band borders, and reports the time both take.
+ **/
+static void
+boundary_bands (GimpTestFixture *fixture,
+                gconstpointer    data)
+{
+  GimpBoundaryType  types[] = { GIMP_BOUNDARY_WITHIN_BOUNDS,
+                                GIMP_BOUNDARY_IGNORE_BOUNDS };
+  GeglBuffer       *mask    = boundary_mask_new ();
+  gint              threads;
+  gint              i;
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      GimpBoundSeg *serial;
+      GimpBoundSeg *parallel;
+      gint          n_serial;
+      gint          n_parallel;
+      gint64        serial_time;
+      gint64        parallel_time;
+      gint          j;
+
+      serial   = boundary_find_sorted (mask, types[i], 1,
+                                       &n_serial, &serial_time);
+      parallel = boundary_find_sorted (mask, types[i], MAX (threads, 4),
+                                       &n_parallel, &parallel_time);
+
+      g_test_message ("%d segments: serial %.1f ms, parallel %.1f ms",
+                      n_serial,
+                      serial_time / 1000.0, parallel_time / 1000.0);
+
+      g_assert_cmpint (n_serial, >, 0);
+      g_assert_cmpint (n_parallel, ==, n_serial);
+
+      for (j = 0; j < n_serial; j++)
+        g_assert_cmpint (boundary_seg_cmp (&serial[j], &parallel[j]), ==, 0);
+
+      g_free (serial);
+      g_free (parallel);
+    }
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  g_object_unref (mask);
+}
+
+/**
+ * contiguous_region_threads:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that filling a contiguous region gives the same mask
+ * whether its tiles are filled on one thread or on several, for a
+ * region which winds back and forth through every tile row, and
+ * reports the time both take.
+ **/
+static void
+contiguous_region_threads (GimpTestFixture *fixture,
+                           gconstpointer    data)
+{
+  Gimp               *gimp = GIMP (data);
+  GimpImage          *image;
+  GimpLayer          *layer;
+  GeglBuffer         *buffer;
+  GeglBuffer         *serial;
+  GeglBuffer         *parallel;
+  GeglColor          *black;
+  GeglBufferIterator *iter;
+  gint64              serial_time;
+  gint64              parallel_time;
+  gint                threads;
+  gint                n_selected  = 0;
+  gint                n_different = 0;
+  gint                y;
+
+  image = gimp_image_new (gimp,
+                          CONTIGUOUS_REGION_SIZE,
+                          CONTIGUOUS_REGION_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_U8_NON_LINEAR);
+
+  layer = gimp_layer_new (image,
+                          CONTIGUOUS_REGION_SIZE,
+                          CONTIGUOUS_REGION_SIZE,
+                          babl_format ("R'G'B'A u8"),
+                          "Test Layer",
+                          GIMP_OPACITY_OPAQUE,
+                          GIMP_LAYER_MODE_NORMAL);
+
+  gimp_image_add_layer (image,
+                        layer,
+                        GIMP_IMAGE_ACTIVE_PARENT,
+                        0,
+                        FALSE);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  /*  a slightly noisy light background, within the threshold below  */
+  iter = gegl_buffer_iterator_new (buffer, NULL, 0,
+                                   babl_format ("R'G'B'A u8"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      guchar              *pixel = iter->items[0].data;
+      gint                 x;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        for (x = roi->x; x < roi->x + roi->width; x++)
+          {
+            guchar value = 200 + (x * 7 + y * 13) % 8;
+
+            *pixel++ = value;
+            *pixel++ = value;
+            *pixel++ = value;
+            *pixel++ = 255;
+          }
+    }
+
+  /*  walls across the image, open at alternating ends  */
+  black = gegl_color_new ("black");
+
+  for (y = 61; y < CONTIGUOUS_REGION_SIZE; y += 64)
+    {
+      if ((y / 64) % 2)
+        gegl_buffer_set_color (buffer,
+                               GEGL_RECTANGLE (40, y,
+                                               CONTIGUOUS_REGION_SIZE - 40, 3),
+                               black);
+      else
+        gegl_buffer_set_color (buffer,
+                               GEGL_RECTANGLE (0, y,
+                                               CONTIGUOUS_REGION_SIZE - 40, 3),
+                               black);
+    }
+
+  g_object_unref (black);
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  g_object_set (gegl_config (), "threads", 1, NULL);
+
+  serial_time = g_get_monotonic_time ();
+  serial = gimp_pickable_contiguous_region_by_seed (GIMP_PICKABLE (layer),
+                                                    FALSE, 0.1, FALSE,
+                                                    GIMP_SELECT_CRITERION_COMPOSITE,
+                                                    FALSE, 10, 10);
+  serial_time = g_get_monotonic_time () - serial_time;
+
+  g_object_set (gegl_config (), "threads", MAX (threads, 4), NULL);
+
+  parallel_time = g_get_monotonic_time ();
+  parallel = gimp_pickable_contiguous_region_by_seed (GIMP_PICKABLE (layer),
+                                                      FALSE, 0.1, FALSE,
+                                                      GIMP_SELECT_CRITERION_COMPOSITE,
+                                                      FALSE, 10, 10);
+  parallel_time = g_get_monotonic_time () - parallel_time;
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  g_test_message ("%dx%d fill: serial %.1f ms, parallel %.1f ms",
+                  CONTIGUOUS_REGION_SIZE, CONTIGUOUS_REGION_SIZE,
+                  serial_time / 1000.0, parallel_time / 1000.0);
+
+  iter = gegl_buffer_iterator_new (serial, NULL, 0,
+                                   babl_format ("Y float"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter, parallel, NULL, 0,
+                            babl_format ("Y float"),
+                            GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const gfloat *out = iter->items[0].data;
+      const gfloat *ref = iter->items[1].data;
+      gint          i;
+
+      for (i = 0; i < iter->length; i++)
+        {
+          if (out[i] > 0.5f)
+            n_selected++;
+
+          if (out[i] != ref[i])
+            n_different++;
+        }
+    }
+
+  /*  everything but the walls was reached  */
+  g_assert_cmpint (n_selected, ==,
+                   CONTIGUOUS_REGION_SIZE * CONTIGUOUS_REGION_SIZE -
+                   (CONTIGUOUS_REGION_SIZE / 64) *
+                   (CONTIGUOUS_REGION_SIZE - 40) * 3);
+  g_assert_cmpint (n_different, ==, 0);
+
+  g_object_unref (serial);
+  g_object_unref (parallel);
+  g_object_unref (image);
+}
+
+static GimpImage *
+convert_indexed_image_new (Gimp *gimp,
+                           gint  shift)
+{
+  GimpImage          *image;
+  GimpLayer          *layer;
+  GeglBufferIterator *iter;
+
+  image = gimp_image_new (gimp,
+                          CONVERT_INDEXED_SIZE,
+                          CONVERT_INDEXED_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_U8_NON_LINEAR);
+
+  layer = gimp_layer_new (image,
+                          CONVERT_INDEXED_SIZE,
+                          CONVERT_INDEXED_SIZE,
+                          babl_format ("R'G'B' u8"),
+                          "Test Layer",
+                          GIMP_OPACITY_OPAQUE,
+                          GIMP_LAYER_MODE_NORMAL);
+
+  gimp_image_add_layer (image,
+                        layer,
+                        GIMP_IMAGE_ACTIVE_PARENT,
+                        0,
+                        FALSE);
+
+  /*  far more colors than fit in the colormap  */
+  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                                   NULL, 0, babl_format ("R'G'B' u8"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      guchar              *pixel = iter->items[0].data;
+      gint                 x, y;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        for (x = roi->x; x < roi->x + roi->width; x++)
+          {
+            *pixel++ = x * 255 / CONVERT_INDEXED_SIZE;
+            *pixel++ = y * 255 / CONVERT_INDEXED_SIZE;
+            *pixel++ = 128 + 127 * sin ((x + shift) / 40.0) * cos (y / 50.0);
+          }
+    }
+
+  return image;
+}
+
+/**
+ * convert_indexed_refine:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that converting to indexed with a refined generated
+ * colormap maps every pixel to an index within the colormap, with
+ * each dither type, while reporting progress.
+ **/
+static void
+convert_indexed_refine (GimpTestFixture *fixture,
+                        gconstpointer    data)
+{
+  Gimp                  *gimp           = GIMP (data);
+  GimpConvertDitherType  dither_types[] = { GIMP_CONVERT_DITHER_NONE,
+                                            GIMP_CONVERT_DITHER_FS,
+                                            GIMP_CONVERT_DITHER_FS_LOWBLEED,
+                                            GIMP_CONVERT_DITHER_FIXED };
+  gint                   i;
+
+  for (i = 0; i < G_N_ELEMENTS (dither_types); i++)
+    {
+      GimpImage          *image    = convert_indexed_image_new (gimp, 0);
+      GimpProgress       *progress = gimp_sub_progress_new (NULL);
+      GimpLayer          *layer;
+      GeglBufferIterator *iter;
+      gint                n_colors;
+      gint                max_index = -1;
+      gboolean            success;
+
+      success = gimp_image_convert_indexed (image,
+                                           GIMP_CONVERT_PALETTE_GENERATE,
+                                           16, FALSE, TRUE,
+                                           dither_types[i], FALSE, FALSE,
+                                           NULL, progress, NULL);
+      g_assert_true (success);
+
+      n_colors = gimp_palette_get_n_colors (gimp_image_get_colormap_palette (image));
+
+      g_assert_cmpint (n_colors, >, 0);
+      g_assert_cmpint (n_colors, <=, 16);
+
+      layer = GIMP_LAYER (gimp_image_get_layer_iter (image)->data);
+
+      iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                                       NULL, 0,
+                                       gimp_drawable_get_format (GIMP_DRAWABLE (layer)),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const guchar *index = iter->items[0].data;
+          gint          j;
+
+          for (j = 0; j < iter->length; j++)
+            max_index = MAX (max_index, index[j]);
+        }
+
+      g_assert_cmpint (max_index, >=, 0);
+      g_assert_cmpint (max_index, <, n_colors);
+
+      g_object_unref (progress);
+      g_object_unref (image);
+    }
+}
+
+/**
+ * convert_indexed_cache:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that converting to indexed with an inverse colormap kept
+ * from earlier conversions to the same palette, and filled from other
+ * pixels, gives the same indices as with a fresh one.
+ **/
+static void
+convert_indexed_cache (GimpTestFixture *fixture,
+                       gconstpointer    data)
+{
+  Gimp               *gimp     = GIMP (data);
+  gint                shifts[] = { 0, 100, 0 };
+  GimpImage          *images[G_N_ELEMENTS (shifts)];
+  GimpLayer          *miss_layer;
+  GimpLayer          *hit_layer;
+  GeglBufferIterator *iter;
+  gint                n_different = 0;
+  gint                i;
+
+  /*  the first conversion to the web palette starts a fresh inverse
+   *  colormap, the second one keeps its map, and the third one, of the
+   *  same pixels as the first, reuses it
+   */
+  for (i = 0; i < G_N_ELEMENTS (shifts); i++)
+    {
+      images[i] = convert_indexed_image_new (gimp, shifts[i]);
+
+      g_assert_true (gimp_image_convert_indexed (images[i],
+                                                 GIMP_CONVERT_PALETTE_WEB,
+                                                 256, FALSE, FALSE,
+                                                 GIMP_CONVERT_DITHER_NONE,
+                                                 FALSE, FALSE,
+                                                 NULL, NULL, NULL));
+    }
+
+  miss_layer = GIMP_LAYER (gimp_image_get_layer_iter (images[0])->data);
+  hit_layer  = GIMP_LAYER (gimp_image_get_layer_iter (images[2])->data);
+
+  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (miss_layer)),
+                                   NULL, 0,
+                                   gimp_drawable_get_format (GIMP_DRAWABLE (miss_layer)),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter,
+                            gimp_drawable_get_buffer (GIMP_DRAWABLE (hit_layer)),
+                            NULL, 0,
+                            gimp_drawable_get_format (GIMP_DRAWABLE (hit_layer)),
+                            GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guchar *out = iter->items[0].data;
+      const guchar *ref = iter->items[1].data;
+      gint          j;
+
+      for (j = 0; j < iter->length; j++)
+        {
+          if (out[j] != ref[j])
+            n_different++;
+        }
+    }
+
+  g_assert_cmpint (n_different, ==, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (shifts); i++)
+    g_object_unref (images[i]);
+}
+
+static gint64
+convert_indexed_timed (GimpImage             *image,
+                       GimpConvertDitherType  dither_type,
+                       gint                   n_threads)
+{
+  gint64 start;
+
+  g_object_set (gegl_config (), "threads", n_threads, NULL);
+
+  start = g_get_monotonic_time ();
+
+  g_assert_true (gimp_image_convert_indexed (image,
+                                             GIMP_CONVERT_PALETTE_GENERATE,
+                                             256, FALSE, FALSE,
+                                             dither_type, FALSE, FALSE,
+                                             NULL, NULL, NULL));
+
+  return g_get_monotonic_time () - start;
+}
+
+/**
+ * convert_indexed_threads:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that converting to indexed gives the same colormap and
+ * indices whether its passes run on one thread or on several, and
+ * reports the time both take.
+ **/
+static void
+convert_indexed_threads (GimpTestFixture *fixture,
+                         gconstpointer    data)
+{
+  Gimp                  *gimp           = GIMP (data);
+  GimpConvertDitherType  dither_types[] = { GIMP_CONVERT_DITHER_NONE,
+                                            GIMP_CONVERT_DITHER_FIXED };
+  gint                   threads;
+  gint                   i;
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (dither_types); i++)
+    {
+      GimpImage          *serial   = convert_indexed_image_new (gimp, 0);
+      GimpImage          *parallel = convert_indexed_image_new (gimp, 0);
+      GimpLayer          *serial_layer;
+      GimpLayer          *parallel_layer;
+      guchar             *serial_colormap;
+      guchar             *parallel_colormap;
+      GeglBufferIterator *iter;
+      gint64              serial_time;
+      gint64              parallel_time;
+      gint                n_serial;
+      gint                n_parallel;
+      gint                n_different = 0;
+
+      serial_time   = convert_indexed_timed (serial, dither_types[i], 1);
+      parallel_time = convert_indexed_timed (parallel, dither_types[i],
+                                             MAX (threads, 4));
+
+      g_test_message ("%dx%d to indexed: serial %.1f ms, parallel %.1f ms",
+                      CONVERT_INDEXED_SIZE, CONVERT_INDEXED_SIZE,
+                      serial_time / 1000.0, parallel_time / 1000.0);
+
+      serial_colormap   = _gimp_image_get_colormap (serial,   &n_serial);
+      parallel_colormap = _gimp_image_get_colormap (parallel, &n_parallel);
+
+      g_assert_cmpint (n_parallel, ==, n_serial);
+      g_assert_cmpmem (parallel_colormap, 3 * n_parallel,
+                       serial_colormap,   3 * n_serial);
+
+      serial_layer   = GIMP_LAYER (gimp_image_get_layer_iter (serial)->data);
+      parallel_layer = GIMP_LAYER (gimp_image_get_layer_iter (parallel)->data);
+
+      iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (serial_layer)),
+                                       NULL, 0,
+                                       gimp_drawable_get_format (GIMP_DRAWABLE (serial_layer)),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+      gegl_buffer_iterator_add (iter,
+                                gimp_drawable_get_buffer (GIMP_DRAWABLE (parallel_layer)),
+                                NULL, 0,
+                                gimp_drawable_get_format (GIMP_DRAWABLE (parallel_layer)),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const guchar *out = iter->items[0].data;
+          const guchar *ref = iter->items[1].data;
+          gint          j;
+
+          for (j = 0; j < iter->length; j++)
+            {
+              if (out[j] != ref[j])
+                n_different++;
+            }
+        }
+
+      g_assert_cmpint (n_different, ==, 0);
+
+      g_free (serial_colormap);
+      g_free (parallel_colormap);
+
+      g_object_unref (serial);
+      g_object_unref (parallel);
+    }
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+}
+
+static GimpImage *
+convert_precision_image_new (Gimp *gimp)
+{
+  GimpImage *image;
+  gint       i;
+
+  image = gimp_image_new (gimp,
+                          CONVERT_PRECISION_SIZE,
+                          CONVERT_PRECISION_SIZE,
+                          GIMP_RGB,
+                          GIMP_PRECISION_FLOAT_NON_LINEAR);
+
+  for (i = 0; i < CONVERT_PRECISION_N; i++)
+    {
+      GimpLayer          *layer;
+      GeglBufferIterator *iter;
+
+      layer = gimp_layer_new (image,
+                              CONVERT_PRECISION_SIZE,
+                              CONVERT_PRECISION_SIZE,
+                              babl_format ("R'G'B'A float"),
+                              "Test Layer",
+                              GIMP_OPACITY_OPAQUE,
+                              GIMP_LAYER_MODE_NORMAL);
+
+      gimp_image_add_layer (image,
+                            layer,
+                            GIMP_IMAGE_ACTIVE_PARENT,
+                            0,
+                            FALSE);
+
+      iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                                       NULL, 0, babl_format ("R'G'B'A float"),
+                                       GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const GeglRectangle *roi   = &iter->items[0].roi;
+          gfloat              *pixel = iter->items[0].data;
+          gint                 x, y;
+
+          for (y = roi->y; y < roi->y + roi->height; y++)
+            for (x = roi->x; x < roi->x + roi->width; x++)
+              {
+                *pixel++ = (gfloat) x / CONVERT_PRECISION_SIZE;
+                *pixel++ = (gfloat) y / CONVERT_PRECISION_SIZE;
+                *pixel++ = 0.5 + 0.5 * sin ((x + y) / 30.0 + i);
+                *pixel++ = 1.0;
+              }
+        }
+    }
+
+  return image;
+}
+
+static gint64
+convert_precision_timed (GimpImage *image,
+                         gint       n_threads)
+{
+  gint64 start;
+
+  g_object_set (gegl_config (), "threads", n_threads, NULL);
+
+  start = g_get_monotonic_time ();
+
+  gimp_image_convert_precision (image, GIMP_PRECISION_U16_NON_LINEAR,
+                                GEGL_DITHER_NONE, GEGL_DITHER_NONE,
+                                GEGL_DITHER_NONE, NULL);
+
+  return g_get_monotonic_time () - start;
+}
+
+/**
+ * convert_precision_threads:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that converting the precision of an image with several
+ * layers gives the same pixels whether its layers are converted on
+ * one thread or on several, and reports the time both take.
+ **/
+static void
+convert_precision_threads (GimpTestFixture *fixture,
+                           gconstpointer    data)
+{
+  Gimp      *gimp     = GIMP (data);
+  GimpImage *serial   = convert_precision_image_new (gimp);
+  GimpImage *parallel = convert_precision_image_new (gimp);
+  GList     *serial_list;
+  GList     *parallel_list;
+  gint64     serial_time;
+  gint64     parallel_time;
+  gint       threads;
+  gint       n_different = 0;
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  serial_time   = convert_precision_timed (serial, 1);
+  parallel_time = convert_precision_timed (parallel, MAX (threads, 4));
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  g_test_message ("%d %dx%d layers to 16 bit: serial %.1f ms, "
+                  "parallel %.1f ms",
+                  CONVERT_PRECISION_N,
+                  CONVERT_PRECISION_SIZE, CONVERT_PRECISION_SIZE,
+                  serial_time / 1000.0, parallel_time / 1000.0);
+
+  g_assert_cmpint (gimp_image_get_precision (serial),   ==,
+                   GIMP_PRECISION_U16_NON_LINEAR);
+  g_assert_cmpint (gimp_image_get_precision (parallel), ==,
+                   GIMP_PRECISION_U16_NON_LINEAR);
+
+  for (serial_list   = gimp_image_get_layer_iter (serial),
+       parallel_list = gimp_image_get_layer_iter (parallel);
+       serial_list && parallel_list;
+       serial_list   = g_list_next (serial_list),
+       parallel_list = g_list_next (parallel_list))
+    {
+      GeglBufferIterator *iter;
+
+      iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (serial_list->data),
+                                       NULL, 0, babl_format ("R'G'B'A u16"),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+      gegl_buffer_iterator_add (iter,
+                                gimp_drawable_get_buffer (parallel_list->data),
+                                NULL, 0, babl_format ("R'G'B'A u16"),
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const guint16 *out = iter->items[0].data;
+          const guint16 *ref = iter->items[1].data;
+          gint           i;
+
+          for (i = 0; i < 4 * iter->length; i++)
+            {
+              if (out[i] != ref[i])
+                n_different++;
+            }
+        }
+    }
+
+  g_assert_null (serial_list);
+  g_assert_null (parallel_list);
+  g_assert_cmpint (n_different, ==, 0);
+
+  g_object_unref (serial);
+  g_object_unref (parallel);
+}
+
+typedef struct
+{
+  gint64   start;
+  gint64   approximate_time;
+  gint64   exact_time;
+  gdouble  approximate_count;
+  gdouble  approximate_mean;
+} HistogramTimes;
+
+static void
+histogram_values_notify (GimpHistogram  *histogram,
+                         GParamSpec     *pspec,
+                         HistogramTimes *times)
+{
+  gint n_bins = gimp_histogram_n_bins (histogram);
+
+  if (n_bins == 0)
+    return;
+
+  if (gimp_histogram_is_approximate (histogram))
+    {
+      times->approximate_time  = g_get_monotonic_time () - times->start;
+      times->approximate_count =
+        gimp_histogram_get_count (histogram, GIMP_HISTOGRAM_VALUE,
+                                  0, n_bins - 1);
+      times->approximate_mean  =
+        gimp_histogram_get_mean (histogram, GIMP_HISTOGRAM_VALUE,
+                                 0, n_bins - 1);
+    }
+  else
+    {
+      times->exact_time = g_get_monotonic_time () - times->start;
+    }
+}
+
+/**
+ * histogram_approximate:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that the histogram of a large area is approximated first,
+ * close to the exact one which replaces it, and reports the time until
+ * each is set.
+ **/
+static void
+histogram_approximate (GimpTestFixture *fixture,
+                       gconstpointer    data)
+{
+  GimpHistogram      *histogram;
+  GimpAsync          *async;
+  GeglBuffer         *buffer;
+  GeglBufferIterator *iter;
+  HistogramTimes      times = { 0, };
+  gint                n_bins;
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                            HISTOGRAM_SIZE, HISTOGRAM_SIZE),
+                            babl_format ("Y' u8"));
+
+  iter = gegl_buffer_iterator_new (buffer, NULL, 0, babl_format ("Y' u8"),
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi   = &iter->items[0].roi;
+      guchar              *pixel = iter->items[0].data;
+      gint                 x, y;
+
+      for (y = roi->y; y < roi->y + roi->height; y++)
+        for (x = roi->x; x < roi->x + roi->width; x++)
+          *pixel++ = 128 + 100 * sin (x / 70.0) * sin (y / 90.0);
+    }
+
+  histogram = gimp_histogram_new (GIMP_TRC_NON_LINEAR);
+
+  g_signal_connect (histogram, "notify::values",
+                    G_CALLBACK (histogram_values_notify),
+                    &times);
+
+  times.start = g_get_monotonic_time ();
+
+  async = gimp_histogram_calculate_async (histogram, buffer,
+                                          GEGL_RECTANGLE (0, 0,
+                                                          HISTOGRAM_SIZE,
+                                                          HISTOGRAM_SIZE),
+                                          NULL, NULL);
+  g_object_ref (async);
+
+  while (! times.exact_time)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_test_message ("%dx%d histogram: approximate after %.1f ms, "
+                  "exact after %.1f ms",
+                  HISTOGRAM_SIZE, HISTOGRAM_SIZE,
+                  times.approximate_time / 1000.0,
+                  times.exact_time / 1000.0);
+
+  g_assert_true (gimp_async_is_finished (async));
+  g_assert_false (gimp_histogram_is_approximate (histogram));
+
+  n_bins = gimp_histogram_n_bins (histogram);
+
+  g_assert_cmpfloat (gimp_histogram_get_count (histogram,
+                                               GIMP_HISTOGRAM_VALUE,
+                                               0, n_bins - 1),
+                     ==, (gdouble) HISTOGRAM_SIZE * HISTOGRAM_SIZE);
+
+  /*  the approximate histogram may be skipped when the exact one is
+   *  done first, but if it was set, it is close to the exact one
+   */
+  if (times.approximate_time)
+    {
+      g_assert_cmpint (times.approximate_time, <=, times.exact_time);
+      g_assert_cmpfloat (fabs (times.approximate_count -
+                               (gdouble) HISTOGRAM_SIZE * HISTOGRAM_SIZE),
+                         <=, 0.01 * HISTOGRAM_SIZE * HISTOGRAM_SIZE);
+      g_assert_cmpfloat (fabs (times.approximate_mean -
+                               gimp_histogram_get_mean (histogram,
+                                                        GIMP_HISTOGRAM_VALUE,
+                                                        0, n_bins - 1)),
+                         <=, 0.01);
+    }
+
+  g_object_unref (async);
+  g_object_unref (histogram);
+  g_object_unref (buffer);
+}
+
+/**
+ * boundary_cache:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that the boundary found through a #GimpBoundaryCache has
+ * the same segments as the one found by gimp_boundary_find(), with the
+ * segments crossing cell borders merged again, also after a change of
+ * the mask across cell borders.
+ **/
+static void
+boundary_cache (GimpTestFixture *fixture,
+                gconstpointer    data)
+{
+  GimpBoundaryType  types[] = { GIMP_BOUNDARY_WITHIN_BOUNDS,
+                                GIMP_BOUNDARY_IGNORE_BOUNDS };
+  GeglBuffer       *mask    = boundary_mask_new ();
+  GeglColor        *white   = gegl_color_new ("white");
+  gint              threads;
+  gint              i;
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      GimpBoundaryCache *cache = gimp_boundary_cache_new ();
+      gint               pass;
+
+      for (pass = 0; pass < 2; pass++)
+        {
+          GimpBoundSeg *expected;
+          GimpBoundSeg *segs;
+          gint          n_expected;
+          gint          n_segs;
+          gint64        time;
+          gint          j;
+
+          if (pass == 1)
+            {
+              gegl_buffer_set_color (mask, GEGL_RECTANGLE (500, 700, 40, 90),
+                                     white);
+              gimp_boundary_cache_invalidate (cache,
+                                              GEGL_RECTANGLE (500, 700, 40, 90));
+            }
+
+          expected = boundary_find_sorted (mask, types[i], 1,
+                                           &n_expected, &time);
+
+          segs = gimp_boundary_cache_find (cache, mask, NULL,
+                                           babl_format ("Y float"), types[i],
+                                           BOUNDARY_SIZE / 4, BOUNDARY_SIZE / 4,
+                                           3 * BOUNDARY_SIZE / 4,
+                                           3 * BOUNDARY_SIZE / 4,
+                                           GIMP_BOUNDARY_HALF_WAY, &n_segs);
+
+          qsort (segs, n_segs, sizeof (GimpBoundSeg),
+                 (GCompareFunc) boundary_seg_cmp);
+
+          g_assert_cmpint (n_expected, >, 0);
+          g_assert_cmpint (n_segs, ==, n_expected);
+
+          for (j = 0; j < n_expected; j++)
+            g_assert_cmpint (boundary_seg_cmp (&segs[j], &expected[j]), ==, 0);
+
+          g_free (expected);
+          g_free (segs);
+        }
+
+      gimp_boundary_cache_free (cache);
+    }
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  g_object_unref (white);
+  g_object_unref (mask);
+}
+
+#if COMPILE_SSE2_INTRINISICS
+
+/**
+ * histogram_bins_sse2:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure that gimp_gegl_histogram_bins_sse2() maps values to the
+ * same bins as the scalar code of gimp_histogram_calculate_bins(),
+ * including out-of-range values, infinities and NaNs, for any count
+ * and alignment, so that the tail after the last group of four values
+ * is covered, and that it doesn't write past the last value.
+ **/
+static void
+histogram_bins_sse2 (GimpTestFixture *fixture,
+                     gconstpointer    data)
+{
+  const gfloat max_bins[] = { 255.0f, 1023.0f };
+  const gfloat specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, 2.0f,
+                              G_MINFLOAT, G_MAXFLOAT, -G_MAXFLOAT,
+                              INFINITY, -INFINITY, NAN };
+  gint         i;
+
+  if (! (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2))
+    {
+      g_test_skip ("no SSE2 support");
+
+      return;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (max_bins); i++)
+    {
+      gfloat  max_bin  = max_bins[i];
+      gint    n_values = HISTOGRAM_BINS_N_VALUES + (gint) max_bin +
+                         G_N_ELEMENTS (specials);
+      gfloat *src      = g_new (gfloat, n_values);
+      gint   *expected = g_new (gint,   n_values);
+      gint   *dest     = g_new (gint,   n_values + 1);
+      gint    n        = 0;
+      gint    offset;
+      gint    j;
+
+      /*  evenly spaced values, also outside of [0, 1]  */
+      for (j = 0; j < HISTOGRAM_BINS_N_VALUES; j++)
+        src[n++] = -0.25f + 1.5f * j / (HISTOGRAM_BINS_N_VALUES - 1);
+
+      /*  the borders between two bins, where the rounding matters  */
+      for (j = 0; j < (gint) max_bin; j++)
+        src[n++] = (j + 0.5f) / max_bin;
+
+      for (j = 0; j < G_N_ELEMENTS (specials); j++)
+        src[n++] = specials[j];
+
+      g_assert_cmpint (n, ==, n_values);
+
+      /*  the scalar code of gimp_histogram_calculate_bins()  */
+      for (j = 0; j < n_values; j++)
+        {
+          gfloat temp = src[j] * max_bin;
+
+          expected[j] = SIGNED_ROUND (SAFE_CLAMP (temp, 0.0f, max_bin));
+        }
+
+      /*  odd counts and unaligned starts leave a tail of 1 to 3 values
+       *  after the last group of four
+       */
+      for (offset = 0; offset < 4; offset++)
+        {
+          gint count;
+
+          for (count = 0; count <= n_values - offset; count++)
+            {
+              if (count > 16 && count < n_values - offset - 16)
+                continue;
+
+              dest[count] = -1;
+
+              gimp_gegl_histogram_bins_sse2 (src + offset, dest, count,
+                                             max_bin);
+
+              for (j = 0; j < count; j++)
+                g_assert_cmpint (dest[j], ==, expected[offset + j]);
+
+              g_assert_cmpint (dest[count], ==, -1);
+            }
+        }
+
+      g_free (src);
+      g_free (expected);
+      g_free (dest);
+    }
+}
+
+#endif /* COMPILE_SSE2_INTRINISICS */
+
 int
 main (int    argc,
       char **argv)
@@ -283,6 +1830,20 @@ main (int    argc,
   ADD_IMAGE_TEST (remove_layer);
   ADD_IMAGE_TEST (rotate_non_overlapping);
   ADD_TEST (white_graypoint_in_red_levels);
+  ADD_TEST (foreground_extract_tiles);
+  ADD_TEST (line_art_incremental);
+  ADD_TEST (line_art_threads);
+  ADD_TEST (boundary_bands);
+  ADD_TEST (boundary_cache);
+  ADD_TEST (contiguous_region_threads);
+  ADD_TEST (convert_indexed_refine);
+  ADD_TEST (convert_indexed_threads);
+  ADD_TEST (convert_indexed_cache);
+  ADD_TEST (convert_precision_threads);
+  ADD_TEST (histogram_approximate);
+#if COMPILE_SSE2_INTRINISICS
+  ADD_TEST (histogram_bins_sse2);
+#endif
 
   /* Run the tests */
   result = g_test_run ();
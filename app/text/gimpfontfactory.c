@@ -48,7 +48,25 @@
 
 #include <fontconfig/fontconfig.h>
 
-#define CONF_FNAME "fonts.conf"
+#define CONF_FNAME  "fonts.conf"
+#define INDEX_FNAME "fontdirs.index"
+
+
+typedef struct _GimpFontFactoryLoad GimpFontFactoryLoad;
+
+struct _GimpFontFactoryLoad
+{
+  FcConfig   *config;
+  GList      *path;
+  gchar      *index_filename;
+
+  GHashTable *old_index;
+  GString    *new_index;
+  GError     *error;
+
+  FcFontSet  *fontset;
+  gboolean   *supported;
+};
 
 
 struct _GimpFontFactoryPrivate
@@ -73,21 +91,21 @@ static gboolean   gimp_font_factory_data_delete     (GimpDataFactory *factory,
                                                      GError         **error);
 static void       gimp_font_factory_finalize        (GObject         *object);
 
-static void       gimp_font_factory_load            (GimpFontFactory *factory,
-                                                     GError         **error);
-static gboolean   gimp_font_factory_load_fonts_conf (FcConfig        *config,
-                                                     GFile           *fonts_conf);
-static void       gimp_font_factory_add_directories (GimpFontFactory *factory,
-                                                     FcConfig        *config,
-                                                     GList           *path,
-                                                     GError         **error);
+static void       gimp_font_factory_load            (GimpFontFactory     *factory);
+static void       gimp_font_factory_load_free       (GimpFontFactoryLoad *load);
+static gboolean   gimp_font_factory_load_fonts_conf (FcConfig            *config,
+                                                     GFile               *fonts_conf);
+static void       gimp_font_factory_index_read      (GimpFontFactoryLoad *load);
+static void       gimp_font_factory_index_write     (GimpFontFactoryLoad *load);
+static void       gimp_font_factory_add_directories (GimpFontFactoryLoad *load);
 static void       gimp_font_factory_recursive_add_fontdir
-                                                    (FcConfig        *config,
-                                                     GFile           *file,
-                                                     GError         **error);
-static void       gimp_font_factory_load_names      (GimpFontFactory *container,
-                                                     PangoFontMap    *fontmap,
-                                                     PangoContext    *context);
+                                                    (GimpFontFactoryLoad *load,
+                                                     GFile               *file,
+                                                     GError             **error);
+static void       gimp_font_factory_list_fonts      (GimpFontFactoryLoad *load);
+static void       gimp_font_factory_load_names      (GimpFontFactory     *factory,
+                                                     GimpFontFactoryLoad *load,
+                                                     PangoContext        *context);
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpFontFactory, gimp_font_factory,
@@ -122,34 +140,14 @@ static void
 gimp_font_factory_data_init (GimpDataFactory *factory,
                              GimpContext     *context)
 {
-  GError *error = NULL;
-
-  gimp_font_factory_load (GIMP_FONT_FACTORY (factory), &error);
-
-  if (error)
-    {
-      gimp_message_literal (gimp_data_factory_get_gimp (factory), NULL,
-                            GIMP_MESSAGE_INFO,
-                            error->message);
-      g_error_free (error);
-    }
+  gimp_font_factory_load (GIMP_FONT_FACTORY (factory));
 }
 
 static void
 gimp_font_factory_data_refresh (GimpDataFactory *factory,
                                 GimpContext     *context)
 {
-  GError *error = NULL;
-
-  gimp_font_factory_load (GIMP_FONT_FACTORY (factory), &error);
-
-  if (error)
-    {
-      gimp_message_literal (gimp_data_factory_get_gimp (factory), NULL,
-                            GIMP_MESSAGE_INFO,
-                            error->message);
-      g_error_free (error);
-    }
+  gimp_font_factory_load (GIMP_FONT_FACTORY (factory));
 }
 
 static void
@@ -255,16 +253,25 @@ gimp_font_factory_get_fonts_renaming_config (GimpFontFactory  *factory)
 /*  private functions  */
 
 static void
-gimp_font_factory_load_async (GimpAsync *async,
-                              FcConfig  *config)
+gimp_font_factory_load_async (GimpAsync           *async,
+                              GimpFontFactoryLoad *load)
 {
-  if (FcConfigBuildFonts (config))
+  gimp_font_factory_index_read (load);
+
+  gimp_font_factory_add_directories (load);
+
+  if (FcConfigBuildFonts (load->config))
     {
-      gimp_async_finish (async, config);
+      gimp_font_factory_index_write (load);
+
+      gimp_font_factory_list_fonts (load);
+
+      gimp_async_finish_full (async, load,
+                              (GDestroyNotify) gimp_font_factory_load_free);
     }
   else
     {
-      FcConfigDestroy (config);
+      gimp_font_factory_load_free (load);
 
       gimp_async_abort (async);
     }
@@ -286,11 +293,11 @@ gimp_font_factory_load_async_callback (GimpAsync       *async,
 
   if (gimp_async_is_finished (async))
     {
-      FcConfig     *config = gimp_async_get_result (async);
-      PangoFontMap *fontmap;
-      PangoContext *context;
+      GimpFontFactoryLoad *load = gimp_async_get_result (async);
+      PangoFontMap        *fontmap;
+      PangoContext        *context;
 
-      FcConfigSetCurrent (config);
+      FcConfigSetCurrent (load->config);
 
       fontmap = pango_cairo_font_map_new_for_font_type (CAIRO_FONT_TYPE_FT);
       if (! fontmap)
@@ -302,25 +309,32 @@ gimp_font_factory_load_async_callback (GimpAsync       *async,
       context = pango_font_map_create_context (fontmap);
       g_object_unref (fontmap);
 
-      gimp_font_factory_load_names (factory, PANGO_FONT_MAP (fontmap), context);
+      gimp_font_factory_load_names (factory, load, context);
       g_object_unref (context);
-      FcConfigDestroy (config);
+
+      if (load->error)
+        {
+          Gimp *gimp = gimp_data_factory_get_gimp (GIMP_DATA_FACTORY (factory));
+
+          gimp_message_literal (gimp, NULL, GIMP_MESSAGE_INFO,
+                                load->error->message);
+        }
     }
 
   gimp_container_thaw (container);
 }
 
 static void
-gimp_font_factory_load (GimpFontFactory  *factory,
-                        GError          **error)
+gimp_font_factory_load (GimpFontFactory *factory)
 {
-  GimpContainer *container;
-  Gimp          *gimp;
-  GimpAsyncSet  *async_set;
-  FcConfig      *config;
-  GFile         *fonts_conf;
-  GList         *path;
-  GimpAsync     *async;
+  GimpContainer       *container;
+  Gimp                *gimp;
+  GimpAsyncSet        *async_set;
+  GimpFontFactoryLoad *load;
+  FcConfig            *config;
+  GFile               *fonts_conf;
+  GList               *path;
+  GimpAsync           *async;
 
   async_set = gimp_data_factory_get_async_set (GIMP_DATA_FACTORY (factory));
 
@@ -372,22 +386,30 @@ gimp_font_factory_load (GimpFontFactory  *factory,
 
   path = gimp_data_factory_get_data_path (GIMP_DATA_FACTORY (factory));
   if (! path)
-    return;
+    {
+      FcConfigDestroy (config);
+      return;
+    }
 
   gimp_container_freeze (container);
   gimp_container_clear (container);
 
-  gimp_font_factory_add_directories (factory, config, path, error);
-  g_list_free_full (path, (GDestroyNotify) g_object_unref);
+  load = g_slice_new0 (GimpFontFactoryLoad);
+
+  load->config         = config;
+  load->path           = path;
+  load->index_filename = g_build_filename (gimp_cache_directory (),
+                                           INDEX_FNAME, NULL);
 
-  /* We perform font cache initialization in a separate thread, so
-   * in the case a cache rebuild is to be done it will not block
-   * the UI.
+  /* We perform scanning the font directories, font cache
+   * initialization and validating the fonts in a separate thread, so
+   * they will not block the UI. Only creating the font objects
+   * happens on the main thread once everything is ready.
    */
   async = gimp_parallel_run_async_independent_full (
     +10,
     (GimpRunAsyncFunc) gimp_font_factory_load_async,
-    config);
+    load);
 
   gimp_async_add_callback_for_object (
     async,
@@ -400,6 +422,26 @@ gimp_font_factory_load (GimpFontFactory  *factory,
   g_object_unref (async);
 }
 
+static void
+gimp_font_factory_load_free (GimpFontFactoryLoad *load)
+{
+  g_clear_pointer (&load->fontset, FcFontSetDestroy);
+  g_clear_pointer (&load->config,  FcConfigDestroy);
+
+  g_list_free_full (load->path, (GDestroyNotify) g_object_unref);
+
+  g_free (load->index_filename);
+  g_clear_pointer (&load->old_index, g_hash_table_unref);
+
+  if (load->new_index)
+    g_string_free (load->new_index, TRUE);
+
+  g_clear_error (&load->error);
+  g_free (load->supported);
+
+  g_slice_free (GimpFontFactoryLoad, load);
+}
+
 static gboolean
 gimp_font_factory_load_fonts_conf (FcConfig *config,
                                    GFile    *fonts_conf)
@@ -415,15 +457,68 @@ gimp_font_factory_load_fonts_conf (FcConfig *config,
   return ret;
 }
 
+/* The font directory index remembers the directories which contain
+ * no subdirectories and whose files could all be added the last time
+ * fonts were loaded, together with the directory's modification time.
+ * Those can safely be added with FcConfigAppFontAddDir(), which uses
+ * fontconfig's own cache instead of scanning every single file again.
+ */
+static void
+gimp_font_factory_index_read (GimpFontFactoryLoad *load)
+{
+  gchar  *contents;
+  gchar **lines;
+  gint    i;
+
+  load->old_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free, g_free);
+  load->new_index = g_string_new (NULL);
+
+  if (! g_file_get_contents (load->index_filename, &contents, NULL, NULL))
+    return;
+
+  lines = g_strsplit (contents, "\n", -1);
+
+  for (i = 0; lines[i]; i++)
+    {
+      gchar *separator = strchr (lines[i], ' ');
+
+      if (separator)
+        {
+          *separator = '\0';
+
+          g_hash_table_insert (load->old_index,
+                               g_strdup (separator + 1),
+                               g_strdup (lines[i]));
+        }
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+}
+
+static void
+gimp_font_factory_index_write (GimpFontFactoryLoad *load)
+{
+  gchar *dirname = g_path_get_dirname (load->index_filename);
+
+  if (g_mkdir_with_parents (dirname, 0700) == 0)
+    {
+      g_file_set_contents (load->index_filename,
+                           load->new_index->str, load->new_index->len,
+                           NULL);
+    }
+
+  g_free (dirname);
+}
+
 static void
-gimp_font_factory_add_directories (GimpFontFactory *factory,
-                                   FcConfig        *config,
-                                   GList           *path,
-                                   GError         **error)
+gimp_font_factory_add_directories (GimpFontFactoryLoad *load)
 {
-  GList *list;
+  GError **error = &load->error;
+  GList   *list;
 
-  for (list = path; list; list = list->next)
+  for (list = load->path; list; list = list->next)
     {
       /* The configured directories must exist or be created. */
       g_file_make_directory_with_parents (list->data, NULL, NULL);
@@ -433,12 +528,13 @@ gimp_font_factory_add_directories (GimpFontFactory *factory,
        * Otherwise, when some fonts fail to load (e.g. permission
        * issues), we end up in weird situations where the fonts are in
        * the list, but are unusable and output many errors.
-       * See bug 748553.
+       * See bug 748553. Directories known to be fine from the last
+       * run are the exception, see gimp_font_factory_index_read().
        */
-      gimp_font_factory_recursive_add_fontdir (config, list->data, error);
+      gimp_font_factory_recursive_add_fontdir (load, list->data, error);
     }
 
-  if (error && *error)
+  if (*error)
     {
       gchar *font_list = g_strdup ((*error)->message);
 
@@ -449,15 +545,72 @@ gimp_font_factory_add_directories (GimpFontFactory *factory,
     }
 }
 
+static gchar *
+gimp_font_factory_get_fc_path (GFile *file)
+{
+  gchar *path = g_file_get_path (file);
+#ifdef G_OS_WIN32
+  gchar *tmp = g_win32_locale_filename_from_utf8 (path);
+
+  g_free (path);
+  /* XXX: g_win32_locale_filename_from_utf8() may return
+   * NULL. So we need to check that path is not NULL before
+   * trying to load with fontconfig.
+   */
+  path = tmp;
+#endif
+
+  return path;
+}
+
+static gboolean
+gimp_font_factory_add_fontfile (FcConfig  *config,
+                                GFile     *file,
+                                GError   **error)
+{
+  gchar    *path    = gimp_font_factory_get_fc_path (file);
+  gboolean  success = TRUE;
+
+  if (! path ||
+      FcFalse == FcConfigAppFontAddFile (config, (const FcChar8 *) path))
+    {
+      g_printerr ("%s: adding font file '%s' failed.\n",
+                  G_STRFUNC, path);
+      if (error)
+        {
+          if (*error)
+            {
+              gchar *current_message = g_strdup ((*error)->message);
+
+              g_clear_error (error);
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "%s\n- %s", current_message, path);
+              g_free (current_message);
+            }
+          else
+            {
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "- %s", path);
+            }
+        }
+
+      success = FALSE;
+    }
+
+  g_free (path);
+
+  return success;
+}
+
 static void
-gimp_font_factory_recursive_add_fontdir (FcConfig  *config,
-                                         GFile     *file,
-                                         GError   **error)
+gimp_font_factory_recursive_add_fontdir (GimpFontFactoryLoad  *load,
+                                         GFile                *file,
+                                         GError              **error)
 {
   GFileEnumerator *enumerator;
   GError          *file_error = NULL;
 
-  g_return_if_fail (config != NULL);
+  g_return_if_fail (load->config != NULL);
 
   enumerator = g_file_enumerate_children (file,
                                           G_FILE_ATTRIBUTE_STANDARD_NAME ","
@@ -469,6 +622,24 @@ gimp_font_factory_recursive_add_fontdir (FcConfig  *config,
   if (enumerator)
     {
       GFileInfo *info;
+      GList     *subdirs  = NULL;
+      GList     *files    = NULL;
+      GList     *list;
+      gchar     *dir_path = g_file_get_path (file);
+      gchar     *mtime    = NULL;
+      gboolean   indexed  = FALSE;
+      gboolean   success  = TRUE;
+
+      info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+      if (info)
+        {
+          mtime = g_strdup_printf ("%" G_GUINT64_FORMAT,
+                                   g_file_info_get_attribute_uint64 (info,
+                                                                     G_FILE_ATTRIBUTE_TIME_MODIFIED));
+          g_object_unref (info);
+        }
 
       while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)))
         {
@@ -485,55 +656,53 @@ gimp_font_factory_recursive_add_fontdir (FcConfig  *config,
           child     = g_file_enumerator_get_child (enumerator, info);
 
           if (file_type == G_FILE_TYPE_DIRECTORY)
-            {
-              gimp_font_factory_recursive_add_fontdir (config, child, error);
-            }
+            subdirs = g_list_prepend (subdirs, g_object_ref (child));
           else if (file_type == G_FILE_TYPE_REGULAR)
-            {
-              gchar *path = g_file_get_path (child);
-#ifdef G_OS_WIN32
-              gchar *tmp = g_win32_locale_filename_from_utf8 (path);
-
-              g_free (path);
-              /* XXX: g_win32_locale_filename_from_utf8() may return
-               * NULL. So we need to check that path is not NULL before
-               * trying to load with fontconfig.
-               */
-              path = tmp;
-#endif
-
-              if (! path ||
-                  FcFalse == FcConfigAppFontAddFile (config, (const FcChar8 *) path))
-                {
-                  g_printerr ("%s: adding font file '%s' failed.\n",
-                              G_STRFUNC, path);
-                  if (error)
-                    {
-                      if (*error)
-                        {
-                          gchar *current_message = g_strdup ((*error)->message);
-
-                          g_clear_error (error);
-                          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
-                                       "%s\n- %s", current_message, path);
-                          g_free (current_message);
-                        }
-                      else
-                        {
-                          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
-                                       "- %s", path);
-                        }
-                    }
-                }
-
-              g_free (path);
-            }
+            files = g_list_prepend (files, g_object_ref (child));
 
           g_object_unref (child);
           g_object_unref (info);
         }
 
       g_object_unref (enumerator);
+
+      subdirs = g_list_reverse (subdirs);
+      files   = g_list_reverse (files);
+
+      if (! subdirs && dir_path && mtime &&
+          ! g_strcmp0 (g_hash_table_lookup (load->old_index, dir_path), mtime))
+        {
+          gchar *path = gimp_font_factory_get_fc_path (file);
+
+          if (path &&
+              FcConfigAppFontAddDir (load->config, (const FcChar8 *) path))
+            {
+              indexed = TRUE;
+            }
+
+          g_free (path);
+        }
+
+      if (! indexed)
+        {
+          for (list = files; list; list = g_list_next (list))
+            {
+              if (! gimp_font_factory_add_fontfile (load->config, list->data,
+                                                    error))
+                success = FALSE;
+            }
+        }
+
+      if (success && ! subdirs && dir_path && mtime)
+        g_string_append_printf (load->new_index, "%s %s\n", mtime, dir_path);
+
+      for (list = subdirs; list; list = g_list_next (list))
+        gimp_font_factory_recursive_add_fontdir (load, list->data, error);
+
+      g_list_free_full (subdirs, (GDestroyNotify) g_object_unref);
+      g_list_free_full (files,   (GDestroyNotify) g_object_unref);
+      g_free (dir_path);
+      g_free (mtime);
     }
   else
     {
@@ -742,20 +911,11 @@ gimp_font_factory_load_aliases (GimpContainer *container,
 }
 
 static void
-gimp_font_factory_load_names (GimpFontFactory *factory,
-                              PangoFontMap    *fontmap,
-                              PangoContext    *context)
+gimp_font_factory_list_fonts (GimpFontFactoryLoad *load)
 {
-  GimpContainer *container;
-  FcObjectSet   *os;
-  FcPattern     *pat;
-  FcFontSet     *fontset;
-  GString       *ignored_fonts;
-  GString       *global_xml = g_string_new ("<fontconfig>\n");
-  gint           n_ignored  = 0;
-  gint           i;
-
-  container = gimp_data_factory_get_container (GIMP_DATA_FACTORY (factory));
+  FcObjectSet *os;
+  FcPattern   *pat;
+  gint         i;
 
   os = FcObjectSetBuild (FC_FAMILY,
                          FC_STYLE,
@@ -779,14 +939,61 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
       return;
     }
 
-  fontset       = FcFontList (NULL, pat, os);
-  ignored_fonts = g_string_new (NULL);
+  load->fontset = FcFontList (load->config, pat, os);
 
   FcPatternDestroy (pat);
   FcObjectSetDestroy (os);
 
+  g_return_if_fail (load->fontset);
+
+  load->supported = g_new0 (gboolean, load->fontset->nfont);
+
+  /* Pango doesn't support non SFNT fonts because harfbuzz doesn't
+   * support them. Checking this means opening each font file, so do
+   * it here rather than on the main thread.
+   */
+  for (i = 0; i < load->fontset->nfont; i++)
+    {
+      gchar     *file = NULL;
+      hb_blob_t *blob;
+
+      FcPatternGetString (load->fontset->fonts[i], FC_FILE, 0,
+                          (FcChar8 **) &file);
+
+      if (file == NULL || ! g_utf8_validate (file, -1, NULL))
+        continue;
+
+      blob = hb_blob_create_from_file_or_fail (file);
+
+      if (blob)
+        {
+          load->supported[i] = (hb_face_count (blob) > 0);
+
+          hb_blob_destroy (blob);
+        }
+    }
+}
+
+static void
+gimp_font_factory_load_names (GimpFontFactory     *factory,
+                              GimpFontFactoryLoad *load,
+                              PangoContext        *context)
+{
+  GimpContainer *container;
+  FcFontSet     *fontset    = load->fontset;
+  GString       *ignored_fonts;
+  GString       *global_xml = g_string_new ("<fontconfig>\n");
+  GString       *rules_xml;
+  gint           n_ignored  = 0;
+  gint           i;
+
+  container = gimp_data_factory_get_container (GIMP_DATA_FACTORY (factory));
+
   g_return_if_fail (fontset);
 
+  ignored_fonts = g_string_new (NULL);
+  rules_xml     = g_string_new ("<?xml version=\"1.0\"?>\n<fontconfig>\n");
+
   for (i = 0; i < fontset->nfont; i++)
     {
       PangoFontDescription *pfd;
@@ -801,7 +1008,6 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
       gchar                *fullname2        = NULL;
       gchar                *escaped_file     = NULL;
       gchar                *file             = NULL;
-      hb_blob_t            *blob             = NULL;
       gint                  index            = -1;
       gint                  weight           = -1;
       gint                  width            = -1;
@@ -820,22 +1026,20 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
           continue;
         }
 
-      blob = hb_blob_create_from_file_or_fail (file);
       /*
        * Pango doesn't support non SFNT fonts because harfbuzz doesn't support them.
        * woff and woff2, not supported by pango (because they are not yet supported by harfbuzz).
        * pcf,pcf.gz are bitmap font formats, not supported by pango (because of harfbuzz).
        * afm, pfm, pfb are type1 font formats, not supported by pango (because of harfbuzz).
+       * This was checked by gimp_font_factory_list_fonts().
        */
-      if (blob == NULL || hb_face_count (blob) == 0)
+      if (! load->supported[i])
         {
           g_string_append_printf (ignored_fonts, "- %s (not supported by pango)\n", file);
           n_ignored++;
           continue;
         }
 
-      hb_blob_destroy (blob);
-
       /* Some variable fonts have only a family name and a font version.
        * But we also check in case there is no family name */
       if (FcPatternGetString (fontset->fonts[i], FC_FULLNAME, 0, (FcChar8 **) &fullname) != FcResultMatch ||
@@ -885,7 +1089,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
       xml = g_string_new ("<match>");
 
       /*We can't use faux bold (sometimes real bold) unless it is specified in fontconfig*/
-      xml_bold_variant = g_string_new ("<?xml version=\"1.0\"?>\n<match>");
+      xml_bold_variant = g_string_new ("<match>");
 
       g_string_append_printf (xml,
                               "<test name=\"family\"><string>%s</string></test>",
@@ -998,8 +1202,11 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
       g_string_append (xml, "</match>\n");
       g_string_append (xml_bold_variant, "</match>\n");
 
-      FcConfigParseAndLoadFromMemory (FcConfigGetCurrent (), (const FcChar8 *) xml_bold_variant->str, FcTrue);
-      FcConfigParseAndLoadFromMemory (FcConfigGetCurrent (), (const FcChar8 *) xml->str, FcTrue);
+      /* Collect the rules and parse them all at once below, parsing
+       * them one by one gets very slow with thousands of fonts.
+       */
+      g_string_append (rules_xml, xml_bold_variant->str);
+      g_string_append (rules_xml, xml->str);
 
       pfd = pango_font_description_from_string (newname);
 
@@ -1019,6 +1226,10 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
     }
 
   g_string_append (global_xml, "</fontconfig>");
+  g_string_append (rules_xml,  "</fontconfig>\n");
+
+  FcConfigParseAndLoadFromMemory (FcConfigGetCurrent (),
+                                  (const FcChar8 *) rules_xml->str, FcTrue);
 
   g_free (factory->fonts_renaming_config);
   factory->fonts_renaming_config = g_strdup (global_xml->str);
@@ -1035,10 +1246,9 @@ gimp_font_factory_load_names (GimpFontFactory *factory,
 
   g_string_free (ignored_fonts, TRUE);
   g_string_free (global_xml, TRUE);
+  g_string_free (rules_xml, TRUE);
 
   /*  only create aliases if there is at least one font available  */
   if (fontset->nfont > 0)
     gimp_font_factory_load_aliases (container, context);
-
-  FcFontSetDestroy (fontset);
 }
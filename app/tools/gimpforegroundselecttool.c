@@ -40,6 +40,8 @@
 #include "gegl/gimp-gegl-utils.h"
 
 #include "core/gimp.h"
+#include "core/gimpasync.h"
+#include "core/gimpcancelable.h"
 #include "core/gimpchannel-select.h"
 #include "core/gimpdrawable-foreground-extract.h"
 #include "core/gimperror.h"
@@ -48,6 +50,7 @@
 #include "core/gimplayermask.h"
 #include "core/gimpprogress.h"
 #include "core/gimpscanconvert.h"
+#include "core/gimpwaitable.h"
 
 #include "widgets/gimphelp-ids.h"
 #include "widgets/gimpwidgets-utils.h"
@@ -153,6 +156,9 @@ static void   gimp_foreground_select_tool_commit         (GimpForegroundSelectTo
 static void   gimp_foreground_select_tool_set_trimap     (GimpForegroundSelectTool *fg_select);
 static void   gimp_foreground_select_tool_set_preview    (GimpForegroundSelectTool *fg_select);
 static void   gimp_foreground_select_tool_preview        (GimpForegroundSelectTool *fg_select);
+static void   gimp_foreground_select_tool_refine_cancel  (GimpForegroundSelectTool *fg_select);
+static void   gimp_foreground_select_tool_refine_callback(GimpAsync                *async,
+                                                          GimpForegroundSelectTool *fg_select);
 
 static void   gimp_foreground_select_tool_stroke_paint   (GimpForegroundSelectTool *fg_select);
 static void   gimp_foreground_select_tool_cancel_paint   (GimpForegroundSelectTool *fg_select);
@@ -268,6 +274,9 @@ gimp_foreground_select_tool_finalize (GObject *object)
   if (fg_select->mask)
     g_warning ("%s: mask should be NULL at this point", G_STRLOC);
 
+  if (fg_select->refine_async)
+    g_warning ("%s: refine_async should be NULL at this point", G_STRLOC);
+
   if (fg_select->trimap)
     g_warning ("%s: mask should be NULL at this point", G_STRLOC);
 
@@ -972,6 +981,8 @@ gimp_foreground_select_tool_halt (GimpForegroundSelectTool *fg_select)
       gimp_draw_tool_remove_preview (draw_tool, fg_select->grayscale_preview);
     }
 
+  gimp_foreground_select_tool_refine_cancel (fg_select);
+
   g_clear_object (&fg_select->grayscale_preview);
   g_clear_object (&fg_select->trimap);
   g_clear_object (&fg_select->mask);
@@ -1035,6 +1046,10 @@ gimp_foreground_select_tool_commit (GimpForegroundSelectTool *fg_select)
       if (fg_select->state != MATTING_STATE_PREVIEW_MASK)
         gimp_foreground_select_tool_preview (fg_select);
 
+      /*  don't commit the coarse preview  */
+      if (fg_select->refine_async)
+        gimp_waitable_wait (GIMP_WAITABLE (fg_select->refine_async));
+
       gimp_channel_select_buffer (gimp_image_get_mask (image),
                                   C_("command", "Foreground Select"),
                                   fg_select->mask,
@@ -1061,6 +1076,8 @@ gimp_foreground_select_tool_set_trimap (GimpForegroundSelectTool *fg_select)
 
   gimp_polygon_select_tool_halt (GIMP_POLYGON_SELECT_TOOL (fg_select));
 
+  gimp_foreground_select_tool_refine_cancel (fg_select);
+
   if (options->preview_mode == GIMP_MATTING_PREVIEW_MODE_ON_COLOR)
     {
       if (fg_select->grayscale_preview)
@@ -1164,19 +1181,81 @@ gimp_foreground_select_tool_preview (GimpForegroundSelectTool *fg_select)
 
   options  = GIMP_FOREGROUND_SELECT_TOOL_GET_OPTIONS (tool);
 
+  gimp_foreground_select_tool_refine_cancel (fg_select);
+
   g_clear_object (&fg_select->mask);
 
-  fg_select->mask = gimp_drawable_foreground_extract (drawable,
-                                                      options->engine,
-                                                      options->iterations,
-                                                      options->levels,
-                                                      options->active_levels,
-                                                      fg_select->trimap,
-                                                      GIMP_PROGRESS (fg_select));
+  /*  on large drawables, show a coarse matte right away, and replace
+   *  it once the full-resolution one is calculated
+   */
+  fg_select->mask = gimp_drawable_foreground_extract_coarse (drawable,
+                                                             options->engine,
+                                                             options->iterations,
+                                                             options->levels,
+                                                             options->active_levels,
+                                                             fg_select->trimap);
+
+  if (fg_select->mask)
+    {
+      fg_select->refine_async =
+        gimp_drawable_foreground_extract_async (drawable,
+                                                options->engine,
+                                                options->iterations,
+                                                options->levels,
+                                                options->active_levels,
+                                                fg_select->trimap);
+
+      gimp_async_add_callback_for_object (
+        fg_select->refine_async,
+        (GimpAsyncCallback) gimp_foreground_select_tool_refine_callback,
+        fg_select,
+        fg_select);
+    }
+  else
+    {
+      fg_select->mask =
+        gimp_drawable_foreground_extract (drawable,
+                                          options->engine,
+                                          options->iterations,
+                                          options->levels,
+                                          options->active_levels,
+                                          fg_select->trimap,
+                                          GIMP_PROGRESS (fg_select));
+    }
 
   gimp_foreground_select_tool_set_preview (fg_select);
 }
 
+static void
+gimp_foreground_select_tool_refine_cancel (GimpForegroundSelectTool *fg_select)
+{
+  if (fg_select->refine_async)
+    {
+      gimp_cancelable_cancel (GIMP_CANCELABLE (fg_select->refine_async));
+      g_clear_object (&fg_select->refine_async);
+    }
+}
+
+static void
+gimp_foreground_select_tool_refine_callback (GimpAsync                *async,
+                                             GimpForegroundSelectTool *fg_select)
+{
+  /*  the trimap changed since  */
+  if (async != fg_select->refine_async || gimp_async_is_canceled (async))
+    return;
+
+  if (gimp_async_is_finished (async))
+    {
+      g_clear_object (&fg_select->mask);
+
+      fg_select->mask = g_object_ref (gimp_async_get_result (async));
+
+      gimp_foreground_select_tool_set_preview (fg_select);
+    }
+
+  g_clear_object (&fg_select->refine_async);
+}
+
 static void
 gimp_foreground_select_tool_stroke_paint (GimpForegroundSelectTool *fg_select)
 {
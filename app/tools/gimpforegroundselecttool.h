@@ -53,6 +53,7 @@ struct _GimpForegroundSelectTool
   GArray                *stroke;
   GeglBuffer            *trimap;
   GeglBuffer            *mask;
+  GimpAsync             *refine_async;
 
   GList                 *undo_stack;
   GList                 *redo_stack;
@@ -1891,6 +1891,11 @@ gimp_dnd_get_viewable_icon (GtkWidget      *widget,
                           "gimp-dnd-viewable", g_object_ref (viewable),
                           (GDestroyNotify) g_object_unref);
 
+  /*  the drag icon is shown right away, don't queue its thumbnail  */
+  if (GIMP_IS_IMAGEFILE (viewable))
+    gimp_imagefile_load_thumbnail (GIMP_IMAGEFILE (viewable),
+                                   DRAG_PREVIEW_SIZE);
+
   view = gimp_view_new (gimp_context, viewable,
                         DRAG_PREVIEW_SIZE, 0, TRUE);
 
@@ -2219,6 +2224,11 @@ gimp_dnd_get_viewable_list_icon (GtkWidget      *widget,
                           "gimp-dnd-viewable", g_object_ref (viewable),
                           (GDestroyNotify) g_object_unref);
 
+  /*  the drag icon is shown right away, don't queue its thumbnail  */
+  if (GIMP_IS_IMAGEFILE (viewable))
+    gimp_imagefile_load_thumbnail (GIMP_IMAGEFILE (viewable),
+                                   DRAG_PREVIEW_SIZE);
+
   view = gimp_view_new (gimp_context, viewable,
                         DRAG_PREVIEW_SIZE, 0, TRUE);
 
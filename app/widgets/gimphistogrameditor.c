@@ -75,6 +75,12 @@ static void     gimp_histogram_editor_frozen_update (GimpHistogramEditor *editor
                                                      const GParamSpec    *pspec);
 static void     gimp_histogram_editor_buffer_update (GimpHistogramEditor *editor,
                                                      const GParamSpec    *pspec);
+static void     gimp_histogram_editor_pixels_update (GimpDrawable        *drawable,
+                                                     gint                 x,
+                                                     gint                 y,
+                                                     gint                 width,
+                                                     gint                 height,
+                                                     GimpHistogramEditor *editor);
 static void     gimp_histogram_editor_update        (GimpHistogramEditor *editor);
 
 static gboolean gimp_histogram_editor_idle_update   (GimpHistogramEditor *editor);
@@ -238,8 +244,13 @@ gimp_histogram_editor_docked_iface_init (GimpDockedInterface *docked_iface)
 static void
 gimp_histogram_editor_finalize (GObject *object)
 {
-  if (GIMP_HISTOGRAM_EDITOR (object)->idle_id)
-    g_source_remove (GIMP_HISTOGRAM_EDITOR (object)->idle_id);
+  GimpHistogramEditor *editor = GIMP_HISTOGRAM_EDITOR (object);
+
+  if (editor->idle_id)
+    g_source_remove (editor->idle_id);
+
+  g_clear_pointer (&editor->update_region,    cairo_region_destroy);
+  g_clear_pointer (&editor->calculate_region, cairo_region_destroy);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -421,7 +432,7 @@ gimp_histogram_editor_layer_changed (GimpImage           *image,
                                             gimp_histogram_editor_menu_update,
                                             editor);
       g_signal_handlers_disconnect_by_func (editor->drawable,
-                                            gimp_histogram_editor_update,
+                                            gimp_histogram_editor_pixels_update,
                                             editor);
       g_signal_handlers_disconnect_by_func (editor->drawable,
                                             gimp_histogram_editor_buffer_update,
@@ -432,6 +443,8 @@ gimp_histogram_editor_layer_changed (GimpImage           *image,
       editor->drawable = NULL;
     }
 
+  g_clear_pointer (&editor->update_region, cairo_region_destroy);
+
   if (image)
     {
       GList *layers;
@@ -459,8 +472,8 @@ gimp_histogram_editor_layer_changed (GimpImage           *image,
                                G_CALLBACK (gimp_histogram_editor_buffer_update),
                                editor, G_CONNECT_SWAPPED);
       g_signal_connect_object (editor->drawable, "update",
-                               G_CALLBACK (gimp_histogram_editor_update),
-                               editor, G_CONNECT_SWAPPED);
+                               G_CALLBACK (gimp_histogram_editor_pixels_update),
+                               editor, 0);
       g_signal_connect_object (editor->drawable, "alpha-changed",
                                G_CALLBACK (gimp_histogram_editor_menu_update),
                                editor, G_CONNECT_SWAPPED);
@@ -486,6 +499,17 @@ gimp_histogram_editor_calculate_async_callback (GimpAsync           *async,
 {
   editor->calculate_async = NULL;
 
+  /*  if the calculation didn't finish, its area is still to be done  */
+  if (! gimp_async_is_finished (async))
+    {
+      if (! editor->calculate_region)
+        g_clear_pointer (&editor->update_region, cairo_region_destroy);
+      else if (editor->update_region)
+        cairo_region_union (editor->update_region, editor->calculate_region);
+    }
+
+  g_clear_pointer (&editor->calculate_region, cairo_region_destroy);
+
   if (gimp_async_is_finished (async) && editor->histogram)
     {
       if (editor->bg_pending)
@@ -539,11 +563,17 @@ gimp_histogram_editor_validate (GimpHistogramEditor *editor)
               gimp_histogram_view_set_histogram (view, editor->histogram);
             }
 
-          async = gimp_drawable_calculate_histogram_async (editor->drawable,
-                                                           editor->histogram,
-                                                           TRUE);
+          /*  only the area painted on since the last calculation
+           *  needs to be scanned again
+           */
+          async = gimp_drawable_update_histogram_async (editor->drawable,
+                                                        editor->histogram,
+                                                        TRUE,
+                                                        editor->update_region);
 
-          editor->calculate_async = async;
+          editor->calculate_async  = async;
+          editor->calculate_region = editor->update_region;
+          editor->update_region    = cairo_region_create ();
 
           gimp_async_add_callback (
             async,
@@ -636,6 +666,24 @@ gimp_histogram_editor_buffer_update (GimpHistogramEditor *editor,
                 NULL);
 }
 
+static void
+gimp_histogram_editor_pixels_update (GimpDrawable        *drawable,
+                                     gint                 x,
+                                     gint                 y,
+                                     gint                 width,
+                                     gint                 height,
+                                     GimpHistogramEditor *editor)
+{
+  if (editor->update_region)
+    {
+      cairo_region_union_rectangle (editor->update_region,
+                                    &(cairo_rectangle_int_t) { x, y,
+                                                               width, height });
+    }
+
+  gimp_histogram_editor_update (editor);
+}
+
 static void
 gimp_histogram_editor_update (GimpHistogramEditor *editor)
 {
@@ -49,6 +49,9 @@ struct _GimpHistogramEditor
   gboolean              bg_pending;
   gboolean              update_pending;
 
+  cairo_region_t       *update_region;
+  cairo_region_t       *calculate_region;
+
   GtkWidget            *menu;
   GtkWidget            *box;
   GtkWidget            *labels[6];
@@ -54,6 +54,15 @@
 
 #define RGB_EPSILON 1e-6
 
+/* the maximal number of queued renderers updated by a single iteration
+ * of the shared update idle, and the time after which an iteration
+ * yields to the main loop, so that a burst of invalidations (a stroke
+ * on an image with hundreds of layers) is spread over several frames
+ * instead of stalling a single one.
+ */
+#define UPDATE_MAX_PER_IDLE 16
+#define UPDATE_MAX_TIME     (G_TIME_SPAN_MILLISECOND * 8)
+
 enum
 {
   UPDATE,
@@ -71,14 +80,16 @@ struct _GimpViewRendererPrivate
   GimpColorTransform *profile_transform;
 
   gboolean            needs_render;
-  guint               idle_id;
+  GList              *update_link;
 };
 
 
 static void      gimp_view_renderer_dispose           (GObject            *object);
 static void      gimp_view_renderer_finalize          (GObject            *object);
 
-static gboolean  gimp_view_renderer_idle_update       (GimpViewRenderer   *renderer);
+static void      gimp_view_renderer_queue_update      (GimpViewRenderer   *renderer);
+static void      gimp_view_renderer_dequeue_update    (GimpViewRenderer   *renderer);
+static gboolean  gimp_view_renderer_idle_update       (gpointer            data);
 static void      gimp_view_renderer_real_set_context  (GimpViewRenderer   *renderer,
                                                        GimpContext        *context);
 static void      gimp_view_renderer_real_invalidate   (GimpViewRenderer   *renderer);
@@ -121,6 +132,13 @@ G_DEFINE_TYPE_WITH_PRIVATE (GimpViewRenderer, gimp_view_renderer, G_TYPE_OBJECT)
 
 static guint renderer_signals[LAST_SIGNAL] = { 0 };
 
+/*  all renderers share a single idle source, which works through a
+ *  queue of pending updates.  a renderer is queued at most once, no
+ *  matter how often it is invalidated before the idle runs.
+ */
+static GQueue renderer_update_queue   = G_QUEUE_INIT;
+static guint  renderer_update_idle_id = 0;
+
 
 static void
 gimp_view_renderer_class_init (GimpViewRendererClass *klass)
@@ -558,18 +576,9 @@ gimp_view_renderer_invalidate (GimpViewRenderer *renderer)
 {
   g_return_if_fail (GIMP_IS_VIEW_RENDERER (renderer));
 
-  if (renderer->priv->idle_id)
-    {
-      g_source_remove (renderer->priv->idle_id);
-      renderer->priv->idle_id = 0;
-    }
-
   GIMP_VIEW_RENDERER_GET_CLASS (renderer)->invalidate (renderer);
 
-  renderer->priv->idle_id =
-    g_idle_add_full (GIMP_PRIORITY_VIEWABLE_IDLE,
-                     (GSourceFunc) gimp_view_renderer_idle_update,
-                     renderer, NULL);
+  gimp_view_renderer_queue_update (renderer);
 }
 
 void
@@ -577,11 +586,7 @@ gimp_view_renderer_update (GimpViewRenderer *renderer)
 {
   g_return_if_fail (GIMP_IS_VIEW_RENDERER (renderer));
 
-  if (renderer->priv->idle_id)
-    {
-      g_source_remove (renderer->priv->idle_id);
-      renderer->priv->idle_id = 0;
-    }
+  gimp_view_renderer_dequeue_update (renderer);
 
   g_signal_emit (renderer, renderer_signals[UPDATE], 0);
 }
@@ -591,13 +596,7 @@ gimp_view_renderer_update_idle (GimpViewRenderer *renderer)
 {
   g_return_if_fail (GIMP_IS_VIEW_RENDERER (renderer));
 
-  if (renderer->priv->idle_id)
-    g_source_remove (renderer->priv->idle_id);
-
-  renderer->priv->idle_id =
-    g_idle_add_full (GIMP_PRIORITY_VIEWABLE_IDLE,
-                     (GSourceFunc) gimp_view_renderer_idle_update,
-                     renderer, NULL);
+  gimp_view_renderer_queue_update (renderer);
 }
 
 void
@@ -605,11 +604,7 @@ gimp_view_renderer_remove_idle (GimpViewRenderer *renderer)
 {
   g_return_if_fail (GIMP_IS_VIEW_RENDERER (renderer));
 
-  if (renderer->priv->idle_id)
-    {
-      g_source_remove (renderer->priv->idle_id);
-      renderer->priv->idle_id = 0;
-    }
+  gimp_view_renderer_dequeue_update (renderer);
 }
 
 void
@@ -679,14 +674,65 @@ gimp_view_renderer_draw (GimpViewRenderer *renderer,
 
 /*  private functions  */
 
+static void
+gimp_view_renderer_queue_update (GimpViewRenderer *renderer)
+{
+  if (! renderer->priv->update_link)
+    {
+      g_queue_push_tail (&renderer_update_queue, renderer);
+
+      renderer->priv->update_link = renderer_update_queue.tail;
+    }
+
+  if (! renderer_update_idle_id)
+    {
+      renderer_update_idle_id =
+        g_idle_add_full (GIMP_PRIORITY_VIEWABLE_IDLE,
+                         gimp_view_renderer_idle_update,
+                         NULL, NULL);
+    }
+}
+
+static void
+gimp_view_renderer_dequeue_update (GimpViewRenderer *renderer)
+{
+  if (renderer->priv->update_link)
+    {
+      g_queue_delete_link (&renderer_update_queue,
+                           renderer->priv->update_link);
+
+      renderer->priv->update_link = NULL;
+    }
+}
+
 static gboolean
-gimp_view_renderer_idle_update (GimpViewRenderer *renderer)
+gimp_view_renderer_idle_update (gpointer data)
 {
-  renderer->priv->idle_id = 0;
+  gint64 start_time = g_get_monotonic_time ();
+  gint   n;
 
-  gimp_view_renderer_update (renderer);
+  for (n = 0;
+       n < UPDATE_MAX_PER_IDLE && ! g_queue_is_empty (&renderer_update_queue);
+       n++)
+    {
+      GimpViewRenderer *renderer = g_queue_pop_head (&renderer_update_queue);
+
+      renderer->priv->update_link = NULL;
+
+      g_signal_emit (renderer, renderer_signals[UPDATE], 0);
+
+      if (g_get_monotonic_time () - start_time >= UPDATE_MAX_TIME)
+        break;
+    }
+
+  if (g_queue_is_empty (&renderer_update_queue))
+    {
+      renderer_update_idle_id = 0;
+
+      return G_SOURCE_REMOVE;
+    }
 
-  return FALSE;
+  return G_SOURCE_CONTINUE;
 }
 
 static void
@@ -58,6 +58,17 @@
  **/
 
 
+/*  the number of nodes per axis of the baked 3D lookup tables, and
+ *  the fixed-point precision of the interpolation weights
+ */
+#define LUT_SIZE      33
+#define LUT_FRAC_BITS 14
+
+#define LUT_STRIDE_R  (LUT_SIZE * LUT_SIZE * 3)
+#define LUT_STRIDE_G  (LUT_SIZE * 3)
+#define LUT_STRIDE_B  3
+
+
 enum
 {
   PROGRESS,
@@ -65,6 +76,22 @@ enum
 };
 
 
+typedef struct _GimpColorTransformLut GimpColorTransformLut;
+
+struct _GimpColorTransformLut
+{
+  gint     ref_count;
+  gchar   *key;
+  guint16 *data;
+};
+
+typedef struct
+{
+  guint16 index;
+  guint16 frac;
+} LutInput;
+
+
 struct _GimpColorTransform
 {
   GObject           parent_instance;
@@ -77,10 +104,34 @@ struct _GimpColorTransform
 
   cmsHTRANSFORM     transform;
   const Babl       *fish;
+
+  GimpColorTransformLut *lut;
+  gint                   lut_src_bpc;
+  gint                   lut_dest_bpc;
+  gboolean               lut_alpha;
 };
 
 
-static void   gimp_color_transform_finalize (GObject *object);
+static void   gimp_color_transform_finalize    (GObject                 *object);
+
+static void   gimp_color_transform_setup_lut   (GimpColorTransform      *transform,
+                                                GimpColorProfile        *src_profile,
+                                                cmsUInt32Number          lcms_src_format,
+                                                GimpColorProfile        *dest_profile,
+                                                cmsUInt32Number          lcms_dest_format,
+                                                GimpColorProfile        *proof_profile,
+                                                GimpColorRenderingIntent proof_intent,
+                                                GimpColorRenderingIntent intent,
+                                                GimpColorTransformFlags  flags);
+static void   gimp_color_transform_lut_unref   (GimpColorTransformLut   *lut);
+static void   gimp_color_transform_lut_process (GimpColorTransform      *transform,
+                                                gconstpointer            src,
+                                                gpointer                 dest,
+                                                gsize                    length);
+static void   gimp_color_transform_do          (GimpColorTransform      *transform,
+                                                gconstpointer            src,
+                                                gpointer                 dest,
+                                                gsize                    length);
 
 
 G_DEFINE_TYPE (GimpColorTransform, gimp_color_transform, G_TYPE_OBJECT)
@@ -91,6 +142,12 @@ static guint gimp_color_transform_signals[LAST_SIGNAL] = { 0 };
 
 static gchar *lcms_last_error = NULL;
 
+/*  baked lookup tables, shared by all transforms between the same
+ *  profiles with the same intents and flags
+ */
+static GMutex      lut_mutex;
+static GHashTable *lut_cache = NULL;
+
 
 static void
 lcms_error_clear (void)
@@ -145,6 +202,7 @@ gimp_color_transform_finalize (GObject *object)
   g_clear_object (&transform->dest_profile);
 
   g_clear_pointer (&transform->transform, cmsDeleteTransform);
+  g_clear_pointer (&transform->lut, gimp_color_transform_lut_unref);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -174,6 +232,12 @@ gimp_color_transform_finalize (GObject *object)
  * returns a non-%NULL transform and the code takes care of doing only
  * exactly the requested color transform.
  *
+ * Transforms between 8 and 16 bit RGB encodings are baked into a 3D
+ * lookup table, shared with all other transforms between the same
+ * profiles, unless @flags contains
+ * %GIMP_COLOR_TRANSFORM_FLAGS_NOOPTIMIZE or
+ * %GIMP_COLOR_TRANSFORM_FLAGS_GAMUT_CHECK.
+ *
  * Returns: (nullable): the #GimpColorTransform, or %NULL if there was an error.
  *
  * Since: 2.10
@@ -281,6 +345,14 @@ gimp_color_transform_new (GimpColorProfile         *src_profile,
       g_object_unref (transform);
       transform = NULL;
     }
+  else
+    {
+      gimp_color_transform_setup_lut (transform,
+                                      src_profile,  lcms_src_format,
+                                      dest_profile, lcms_dest_format,
+                                      NULL, 0,
+                                      rendering_intent, flags);
+    }
 
   return transform;
 }
@@ -372,6 +444,14 @@ gimp_color_transform_new_proofing (GimpColorProfile         *src_profile,
       g_object_unref (transform);
       transform = NULL;
     }
+  else
+    {
+      gimp_color_transform_setup_lut (transform,
+                                      src_profile,  lcms_src_format,
+                                      dest_profile, lcms_dest_format,
+                                      proof_profile, proof_intent,
+                                      display_intent, flags);
+    }
 
   return transform;
 }
@@ -445,14 +525,7 @@ gimp_color_transform_process_pixels (GimpColorTransform *transform,
       dest = dest_pixels;
     }
 
-  if (transform->transform)
-    {
-      cmsDoTransform (transform->transform, src, dest, length);
-    }
-  else
-    {
-      babl_process (transform->fish, src, dest, length);
-    }
+  gimp_color_transform_do (transform, src, dest, length);
 
   if (src_format != transform->src_format)
     {
@@ -542,16 +615,9 @@ gimp_color_transform_process_buffer (GimpColorTransform  *transform,
 
       while (gegl_buffer_iterator_next (iter))
         {
-          if (transform->transform)
-            {
-              cmsDoTransform (transform->transform,
-                              iter->items[0].data, iter->items[1].data, iter->length);
-            }
-          else
-            {
-              babl_process (transform->fish,
-                            iter->items[0].data, iter->items[1].data, iter->length);
-            }
+          gimp_color_transform_do (transform,
+                                   iter->items[0].data, iter->items[1].data,
+                                   iter->length);
 
           done_pixels += iter->items[0].roi.width * iter->items[0].roi.height;
 
@@ -569,16 +635,9 @@ gimp_color_transform_process_buffer (GimpColorTransform  *transform,
 
       while (gegl_buffer_iterator_next (iter))
         {
-          if (transform->transform)
-            {
-              cmsDoTransform (transform->transform,
-                              iter->items[0].data, iter->items[0].data, iter->length);
-            }
-          else
-            {
-              babl_process (transform->fish,
-                            iter->items[0].data, iter->items[0].data, iter->length);
-            }
+          gimp_color_transform_do (transform,
+                                   iter->items[0].data, iter->items[0].data,
+                                   iter->length);
 
           done_pixels += iter->items[0].roi.width * iter->items[0].roi.height;
 
@@ -627,3 +686,398 @@ gimp_color_transform_can_gegl_copy (GimpColorProfile *src_profile,
 
   return FALSE;
 }
+
+/**
+ * gimp_color_transform_uses_lut:
+ * @transform: a #GimpColorTransform
+ *
+ * This function checks if @transform processes pixels through a baked
+ * lookup table, instead of lcms.  Lookup tables are only used for 8 bit
+ * RGB sources with a non-linear TRC, and not when the transform's flags
+ * disable optimizations or request a gamut check.
+ *
+ * Returns: %TRUE if @transform uses a lookup table.
+ *
+ * Since: 3.0
+ **/
+gboolean
+gimp_color_transform_uses_lut (GimpColorTransform *transform)
+{
+  g_return_val_if_fail (GIMP_IS_COLOR_TRANSFORM (transform), FALSE);
+
+  return transform->lut != NULL;
+}
+
+
+/*  private functions  */
+
+static gboolean
+gimp_color_transform_lut_format (cmsUInt32Number  lcms_format,
+                                 gint            *bpc,
+                                 gboolean        *alpha)
+{
+  switch (lcms_format)
+    {
+    case TYPE_RGB_8:   *bpc = 1; *alpha = FALSE; return TRUE;
+    case TYPE_RGBA_8:  *bpc = 1; *alpha = TRUE;  return TRUE;
+    case TYPE_RGB_16:  *bpc = 2; *alpha = FALSE; return TRUE;
+    case TYPE_RGBA_16: *bpc = 2; *alpha = TRUE;  return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gchar *
+gimp_color_transform_profile_checksum (GimpColorProfile *profile)
+{
+  const guint8 *data;
+  gsize         length;
+
+  if (! profile)
+    return g_strdup ("-");
+
+  data = gimp_color_profile_get_icc_profile (profile, &length);
+
+  return g_compute_checksum_for_data (G_CHECKSUM_MD5, data, length);
+}
+
+static GimpColorTransformLut *
+gimp_color_transform_lut_bake (GimpColorProfile        *src_profile,
+                               GimpColorProfile        *dest_profile,
+                               GimpColorProfile        *proof_profile,
+                               GimpColorRenderingIntent proof_intent,
+                               GimpColorRenderingIntent intent,
+                               GimpColorTransformFlags  flags)
+{
+  GimpColorTransformLut *lut;
+  cmsHTRANSFORM          bake;
+  gfloat                *nodes;
+  gint                   r, g, b;
+  gint                   i = 0;
+
+  /*  sample the transform from float, so the nodes are exact  */
+  if (proof_profile)
+    {
+      bake = cmsCreateProofingTransform (gimp_color_profile_get_lcms_profile (src_profile),
+                                         TYPE_RGB_FLT,
+                                         gimp_color_profile_get_lcms_profile (dest_profile),
+                                         TYPE_RGB_16,
+                                         gimp_color_profile_get_lcms_profile (proof_profile),
+                                         proof_intent,
+                                         intent,
+                                         flags | cmsFLAGS_SOFTPROOFING);
+    }
+  else
+    {
+      bake = cmsCreateTransform (gimp_color_profile_get_lcms_profile (src_profile),
+                                 TYPE_RGB_FLT,
+                                 gimp_color_profile_get_lcms_profile (dest_profile),
+                                 TYPE_RGB_16,
+                                 intent,
+                                 flags);
+    }
+
+  if (! bake)
+    return NULL;
+
+  lut = g_slice_new0 (GimpColorTransformLut);
+
+  lut->ref_count = 1;
+  lut->data      = g_new (guint16, LUT_SIZE * LUT_SIZE * LUT_SIZE * 3);
+
+  nodes = g_new (gfloat, LUT_SIZE * LUT_SIZE * LUT_SIZE * 3);
+
+  for (r = 0; r < LUT_SIZE; r++)
+    for (g = 0; g < LUT_SIZE; g++)
+      for (b = 0; b < LUT_SIZE; b++)
+        {
+          nodes[i++] = (gfloat) r / (LUT_SIZE - 1);
+          nodes[i++] = (gfloat) g / (LUT_SIZE - 1);
+          nodes[i++] = (gfloat) b / (LUT_SIZE - 1);
+        }
+
+  cmsDoTransform (bake, nodes, lut->data, LUT_SIZE * LUT_SIZE * LUT_SIZE);
+
+  g_free (nodes);
+  cmsDeleteTransform (bake);
+
+  return lut;
+}
+
+static void
+gimp_color_transform_setup_lut (GimpColorTransform      *transform,
+                                GimpColorProfile        *src_profile,
+                                cmsUInt32Number          lcms_src_format,
+                                GimpColorProfile        *dest_profile,
+                                cmsUInt32Number          lcms_dest_format,
+                                GimpColorProfile        *proof_profile,
+                                GimpColorRenderingIntent proof_intent,
+                                GimpColorRenderingIntent intent,
+                                GimpColorTransformFlags  flags)
+{
+  GimpColorTransformLut *lut;
+  gboolean               src_alpha;
+  gboolean               dest_alpha;
+  gchar                 *src_checksum;
+  gchar                 *dest_checksum;
+  gchar                 *proof_checksum;
+  gchar                 *key;
+
+  /*  a baked lookup table trades accuracy for speed, and can't
+   *  reproduce the sharp edges of gamut check marks.  its nodes are
+   *  spaced evenly in the source encoding, which only matches the
+   *  precision of 8 bit sources with a perceptual TRC; linear sources
+   *  would lose their shadows, and 16 bit sources their precision.
+   *  test-color-transform checks the resulting error against lcms.
+   */
+  if (g_getenv ("GIMP_COLOR_TRANSFORM_DISABLE_LUT")        ||
+      (flags & GIMP_COLOR_TRANSFORM_FLAGS_NOOPTIMIZE)      ||
+      (flags & GIMP_COLOR_TRANSFORM_FLAGS_GAMUT_CHECK)     ||
+      ! gimp_color_profile_is_rgb (src_profile)            ||
+      ! gimp_color_profile_is_rgb (dest_profile)           ||
+      gimp_color_profile_is_linear (src_profile)           ||
+      ! gimp_color_transform_lut_format (lcms_src_format,
+                                         &transform->lut_src_bpc,
+                                         &src_alpha)       ||
+      ! gimp_color_transform_lut_format (lcms_dest_format,
+                                         &transform->lut_dest_bpc,
+                                         &dest_alpha)      ||
+      transform->lut_src_bpc != 1                          ||
+      src_alpha != dest_alpha)
+    {
+      return;
+    }
+
+  transform->lut_alpha = src_alpha;
+
+  src_checksum   = gimp_color_transform_profile_checksum (src_profile);
+  dest_checksum  = gimp_color_transform_profile_checksum (dest_profile);
+  proof_checksum = gimp_color_transform_profile_checksum (proof_profile);
+
+  key = g_strdup_printf ("%s %s %s %d %d %d",
+                         src_checksum, dest_checksum, proof_checksum,
+                         proof_profile ? proof_intent : 0, intent, flags);
+
+  g_free (src_checksum);
+  g_free (dest_checksum);
+  g_free (proof_checksum);
+
+  g_mutex_lock (&lut_mutex);
+
+  if (! lut_cache)
+    lut_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+  lut = g_hash_table_lookup (lut_cache, key);
+
+  if (lut)
+    {
+      lut->ref_count++;
+
+      g_free (key);
+    }
+  else
+    {
+      lut = gimp_color_transform_lut_bake (src_profile, dest_profile,
+                                           proof_profile, proof_intent,
+                                           intent, flags);
+
+      if (lut)
+        {
+          lut->key = key;
+
+          g_hash_table_insert (lut_cache, lut->key, lut);
+        }
+      else
+        {
+          g_free (key);
+        }
+    }
+
+  g_mutex_unlock (&lut_mutex);
+
+  transform->lut = lut;
+}
+
+static void
+gimp_color_transform_lut_unref (GimpColorTransformLut *lut)
+{
+  g_mutex_lock (&lut_mutex);
+
+  if (--lut->ref_count == 0)
+    {
+      g_hash_table_remove (lut_cache, lut->key);
+
+      g_free (lut->key);
+      g_free (lut->data);
+      g_slice_free (GimpColorTransformLut, lut);
+    }
+
+  g_mutex_unlock (&lut_mutex);
+}
+
+static const LutInput *
+gimp_color_transform_lut_get_inputs (void)
+{
+  static LutInput *inputs = NULL;
+
+  if (g_once_init_enter (&inputs))
+    {
+      LutInput *table = g_new (LutInput, 256);
+      gint      v;
+
+      /*  map each input value to its lower lookup table node and the
+       *  interpolation weight of the upper one
+       */
+      for (v = 0; v < 256; v++)
+        {
+          gdouble p     = (gdouble) v * (LUT_SIZE - 1) / 255;
+          gint    index = MIN ((gint) p, LUT_SIZE - 2);
+
+          table[v].index = index;
+          table[v].frac  = (p - index) * (1 << LUT_FRAC_BITS) + 0.5;
+        }
+
+      g_once_init_leave (&inputs, table);
+    }
+
+  return inputs;
+}
+
+static void
+gimp_color_transform_lut_process (GimpColorTransform *transform,
+                                  gconstpointer       src,
+                                  gpointer            dest,
+                                  gsize               length)
+{
+  const guint16  *lut       = transform->lut->data;
+  const LutInput *inputs    = gimp_color_transform_lut_get_inputs ();
+  const guint8   *src8      = src;
+  guint8         *dest8     = dest;
+  guint16        *dest16    = dest;
+  gint            n_comps   = transform->lut_alpha ? 4 : 3;
+  gboolean        dest_u8   = transform->lut_dest_bpc == 1;
+  gsize           i;
+
+  for (i = 0; i < length; i++)
+    {
+      const LutInput *r;
+      const LutInput *g;
+      const LutInput *b;
+      const guint16  *c000;
+      const guint16  *c1;
+      const guint16  *c2;
+      const guint16  *c111;
+      gint            f1, f2, f3;
+      gint            alpha;
+      gint            c;
+
+      r     = &inputs[src8[0]];
+      g     = &inputs[src8[1]];
+      b     = &inputs[src8[2]];
+      alpha = n_comps == 4 ? src8[3] * 257 : 0;
+
+      src8 += n_comps;
+
+      c000 = lut + (r->index * LUT_STRIDE_R +
+                    g->index * LUT_STRIDE_G +
+                    b->index * LUT_STRIDE_B);
+      c111 = c000 + LUT_STRIDE_R + LUT_STRIDE_G + LUT_STRIDE_B;
+
+      /*  tetrahedral interpolation: pick the tetrahedron of the cube
+       *  containing the point, by the order of the weights
+       */
+      if (r->frac >= g->frac)
+        {
+          if (g->frac >= b->frac)
+            {
+              c1 = c000 + LUT_STRIDE_R;
+              c2 = c000 + LUT_STRIDE_R + LUT_STRIDE_G;
+              f1 = r->frac; f2 = g->frac; f3 = b->frac;
+            }
+          else if (r->frac >= b->frac)
+            {
+              c1 = c000 + LUT_STRIDE_R;
+              c2 = c000 + LUT_STRIDE_R + LUT_STRIDE_B;
+              f1 = r->frac; f2 = b->frac; f3 = g->frac;
+            }
+          else
+            {
+              c1 = c000 + LUT_STRIDE_B;
+              c2 = c000 + LUT_STRIDE_R + LUT_STRIDE_B;
+              f1 = b->frac; f2 = r->frac; f3 = g->frac;
+            }
+        }
+      else
+        {
+          if (b->frac >= g->frac)
+            {
+              c1 = c000 + LUT_STRIDE_B;
+              c2 = c000 + LUT_STRIDE_G + LUT_STRIDE_B;
+              f1 = b->frac; f2 = g->frac; f3 = r->frac;
+            }
+          else if (b->frac >= r->frac)
+            {
+              c1 = c000 + LUT_STRIDE_G;
+              c2 = c000 + LUT_STRIDE_G + LUT_STRIDE_B;
+              f1 = g->frac; f2 = b->frac; f3 = r->frac;
+            }
+          else
+            {
+              c1 = c000 + LUT_STRIDE_G;
+              c2 = c000 + LUT_STRIDE_R + LUT_STRIDE_G;
+              f1 = g->frac; f2 = r->frac; f3 = b->frac;
+            }
+        }
+
+      for (c = 0; c < 3; c++)
+        {
+          gint v = c000[c] +
+                   (((c1[c]   - c000[c]) * f1 +
+                     (c2[c]   - c1[c])   * f2 +
+                     (c111[c] - c2[c])   * f3 +
+                     (1 << (LUT_FRAC_BITS - 1))) >> LUT_FRAC_BITS);
+
+          v = CLAMP (v, 0, 65535);
+
+          if (dest_u8)
+            dest8[c] = (v + 128) / 257;
+          else
+            dest16[c] = v;
+        }
+
+      if (dest_u8)
+        {
+          if (n_comps == 4)
+            dest8[3] = (alpha + 128) / 257;
+
+          dest8 += n_comps;
+        }
+      else
+        {
+          if (n_comps == 4)
+            dest16[3] = alpha;
+
+          dest16 += n_comps;
+        }
+    }
+}
+
+static void
+gimp_color_transform_do (GimpColorTransform *transform,
+                         gconstpointer       src,
+                         gpointer            dest,
+                         gsize               length)
+{
+  if (transform->lut)
+    {
+      gimp_color_transform_lut_process (transform, src, dest, length);
+    }
+  else if (transform->transform)
+    {
+      cmsDoTransform (transform->transform, src, dest, length);
+    }
+  else
+    {
+      babl_process (transform->fish, src, dest, length);
+    }
+}
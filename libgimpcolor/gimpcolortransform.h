@@ -89,6 +89,8 @@ void    gimp_color_transform_process_buffer   (GimpColorTransform       *transfo
 gboolean gimp_color_transform_can_gegl_copy   (GimpColorProfile         *src_profile,
                                                GimpColorProfile         *dest_profile);
 
+gboolean gimp_color_transform_uses_lut        (GimpColorTransform       *transform);
+
 
 G_END_DECLS
 
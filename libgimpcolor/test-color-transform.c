@@ -0,0 +1,255 @@
+/* LIBGIMP - The GIMP Library
+ * Copyright (C) 1995-1997 Peter Mattis and Spencer Kimball
+ *
+ * test-color-transform.c
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* A small regression test for the accuracy of the baked lookup tables
+ * of color transforms: transforms 8 bit sRGB to 16 bit Adobe RGB, and
+ * compares the result against an unoptimized lcms transform.  Also
+ * prints the time taken by the lookup table and by lcms' own
+ * optimized transform, and checks that 16 bit and linear sources are
+ * not transformed through a lookup table.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "gimpcolor.h"
+
+
+/*  the largest acceptable CIE76 difference, about a just noticeable
+ *  difference
+ */
+#define MAX_DELTA_E 1.0
+
+/*  the spacing of the sampled 8 bit input values  */
+#define STEP        3
+
+
+static GimpColorTransform *
+create_transform (GimpColorProfile        *src_profile,
+                  GimpColorProfile        *dest_profile,
+                  GimpColorTransformFlags  flags,
+                  gboolean                 use_lut)
+{
+  GimpColorTransform *transform;
+
+  if (! use_lut)
+    g_setenv ("GIMP_COLOR_TRANSFORM_DISABLE_LUT", "1", TRUE);
+
+  transform = gimp_color_transform_new (src_profile,
+                                        babl_format ("R'G'B' u8"),
+                                        dest_profile,
+                                        babl_format ("R'G'B' u16"),
+                                        GIMP_COLOR_RENDERING_INTENT_RELATIVE_COLORIMETRIC,
+                                        flags);
+
+  g_unsetenv ("GIMP_COLOR_TRANSFORM_DISABLE_LUT");
+
+  return transform;
+}
+
+static gboolean
+uses_lut (GimpColorProfile *src_profile,
+          const Babl       *src_format,
+          GimpColorProfile *dest_profile)
+{
+  GimpColorTransform *transform;
+  gboolean            lut;
+
+  transform = gimp_color_transform_new (src_profile,
+                                        src_format,
+                                        dest_profile,
+                                        babl_format ("R'G'B' u16"),
+                                        GIMP_COLOR_RENDERING_INTENT_RELATIVE_COLORIMETRIC,
+                                        0);
+
+  if (! transform)
+    return FALSE;
+
+  lut = gimp_color_transform_uses_lut (transform);
+
+  g_object_unref (transform);
+
+  return lut;
+}
+
+static gint64
+process (GimpColorTransform *transform,
+         const guint8       *src,
+         guint16            *dest,
+         gsize               length)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  gimp_color_transform_process_pixels (transform,
+                                       babl_format ("R'G'B' u8"),  src,
+                                       babl_format ("R'G'B' u16"), dest,
+                                       length);
+
+  return g_get_monotonic_time () - start;
+}
+
+int
+main (void)
+{
+  GimpColorProfile   *src_profile;
+  GimpColorProfile   *dest_profile;
+  GimpColorProfile   *linear_profile;
+  GimpColorTransform *lut_transform;
+  GimpColorTransform *lcms_transform;
+  GimpColorTransform *exact_transform;
+  const Babl         *to_lab;
+  guint8             *src;
+  guint16            *lut_dest;
+  guint16            *lcms_dest;
+  guint16            *exact_dest;
+  gfloat             *lut_lab;
+  gfloat             *exact_lab;
+  gsize               n_values = 255 / STEP + 1;
+  gsize               length   = n_values * n_values * n_values;
+  gsize               i;
+  gint64              lut_time;
+  gint64              lcms_time;
+  gdouble             max_delta_e = 0.0;
+  gint                r, g, b;
+
+  babl_init ();
+
+  /*  make sure lcms does the transforms  */
+  g_setenv ("GIMP_COLOR_TRANSFORM_DISABLE_BABL", "1", TRUE);
+
+  src_profile  = gimp_color_profile_new_rgb_srgb ();
+  dest_profile = gimp_color_profile_new_rgb_adobe ();
+
+  lut_transform   = create_transform (src_profile, dest_profile,
+                                      0, TRUE);
+  lcms_transform  = create_transform (src_profile, dest_profile,
+                                      0, FALSE);
+  exact_transform = create_transform (src_profile, dest_profile,
+                                      GIMP_COLOR_TRANSFORM_FLAGS_NOOPTIMIZE,
+                                      FALSE);
+
+  if (! lut_transform || ! lcms_transform || ! exact_transform)
+    {
+      g_printerr ("failed to create the transforms\n");
+
+      return EXIT_FAILURE;
+    }
+
+  if (! gimp_color_transform_uses_lut (lut_transform) ||
+      gimp_color_transform_uses_lut (lcms_transform)  ||
+      gimp_color_transform_uses_lut (exact_transform))
+    {
+      g_printerr ("only the optimized 8 bit transform should use "
+                  "a lookup table\n");
+
+      return EXIT_FAILURE;
+    }
+
+  linear_profile = gimp_color_profile_new_rgb_srgb_linear ();
+
+  if (uses_lut (src_profile, babl_format ("R'G'B' u16"), dest_profile) ||
+      uses_lut (linear_profile, babl_format ("RGB u8"), dest_profile))
+    {
+      g_printerr ("16 bit and linear sources should not use "
+                  "a lookup table\n");
+
+      return EXIT_FAILURE;
+    }
+
+  g_object_unref (linear_profile);
+
+  src        = g_new (guint8,  length * 3);
+  lut_dest   = g_new (guint16, length * 3);
+  lcms_dest  = g_new (guint16, length * 3);
+  exact_dest = g_new (guint16, length * 3);
+  lut_lab    = g_new (gfloat,  length * 3);
+  exact_lab  = g_new (gfloat,  length * 3);
+
+  i = 0;
+
+  for (r = 0; r <= 255; r += STEP)
+    for (g = 0; g <= 255; g += STEP)
+      for (b = 0; b <= 255; b += STEP)
+        {
+          src[i++] = r;
+          src[i++] = g;
+          src[i++] = b;
+        }
+
+  lut_time  = process (lut_transform,   src, lut_dest,   length);
+  lcms_time = process (lcms_transform,  src, lcms_dest,  length);
+  process (exact_transform, src, exact_dest, length);
+
+  to_lab = babl_fish (babl_format_with_space ("R'G'B' u16",
+                                              gimp_color_profile_get_space (
+                                                dest_profile,
+                                                GIMP_COLOR_RENDERING_INTENT_RELATIVE_COLORIMETRIC,
+                                                NULL)),
+                      babl_format ("CIE Lab float"));
+
+  babl_process (to_lab, lut_dest,   lut_lab,   length);
+  babl_process (to_lab, exact_dest, exact_lab, length);
+
+  for (i = 0; i < length; i++)
+    {
+      const gfloat *p = lut_lab   + 3 * i;
+      const gfloat *q = exact_lab + 3 * i;
+      gdouble       delta_e;
+
+      delta_e = sqrt (SQR (p[0] - q[0]) +
+                      SQR (p[1] - q[1]) +
+                      SQR (p[2] - q[2]));
+
+      max_delta_e = MAX (max_delta_e, delta_e);
+    }
+
+  g_print ("%" G_GSIZE_FORMAT " pixels: lookup table %.2f ms, "
+           "lcms %.2f ms, max delta E %.3f\n",
+           length, lut_time / 1000.0, lcms_time / 1000.0, max_delta_e);
+
+  g_free (src);
+  g_free (lut_dest);
+  g_free (lcms_dest);
+  g_free (exact_dest);
+  g_free (lut_lab);
+  g_free (exact_lab);
+
+  g_object_unref (lut_transform);
+  g_object_unref (lcms_transform);
+  g_object_unref (exact_transform);
+
+  g_object_unref (src_profile);
+  g_object_unref (dest_profile);
+
+  if (max_delta_e > MAX_DELTA_E)
+    {
+      g_printerr ("max delta E %.3f exceeds %.3f\n",
+                  max_delta_e, MAX_DELTA_E);
+
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
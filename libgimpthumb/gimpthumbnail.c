@@ -125,6 +125,13 @@ struct _GimpThumbnail
   gchar          *image_mimetype;
 };
 
+/*  the task data of gimp_thumbnail_load_thumb_async()  */
+typedef struct
+{
+  gchar         *filename;
+  GimpThumbSize  size;
+} ThumbLoadData;
+
 
 static void      gimp_thumbnail_finalize     (GObject        *object);
 static void      gimp_thumbnail_set_property (GObject        *object,
@@ -140,6 +147,16 @@ static void      gimp_thumbnail_reset_info   (GimpThumbnail  *thumbnail);
 static void      gimp_thumbnail_update_image (GimpThumbnail  *thumbnail);
 static void      gimp_thumbnail_update_thumb (GimpThumbnail  *thumbnail,
                                               GimpThumbSize   size);
+static GdkPixbuf * gimp_thumbnail_check_pixbuf (GimpThumbnail  *thumbnail,
+                                                GdkPixbuf      *pixbuf,
+                                                GimpThumbSize   size);
+static void      gimp_thumbnail_load_data_free
+                                             (ThumbLoadData  *data);
+static void      gimp_thumbnail_load_thumb_thread
+                                             (GTask          *task,
+                                              gpointer        source_object,
+                                              gpointer        task_data,
+                                              GCancellable   *cancellable);
 
 static gboolean  gimp_thumbnail_save         (GimpThumbnail  *thumbnail,
                                               GimpThumbSize   size,
@@ -709,6 +726,106 @@ gimp_thumbnail_update_image (GimpThumbnail *thumbnail)
     }
 }
 
+/*  @size is the size the thumbnail was found at, which is not
+ *  necessarily the current thumb_size when the thumbnail was loaded
+ *  asynchronously
+ */
+static GdkPixbuf *
+gimp_thumbnail_check_pixbuf (GimpThumbnail *thumbnail,
+                             GdkPixbuf     *pixbuf,
+                             GimpThumbSize  size)
+{
+  GimpThumbState  state = thumbnail->thumb_state;
+  const gchar    *option;
+  gint64          image_mtime;
+  gint64          image_size;
+
+  g_object_freeze_notify (G_OBJECT (thumbnail));
+
+  /* URI and mtime from the thumbnail need to match our file */
+  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_URI);
+  if (!option || !thumbnail->image_uri)
+    goto finish;
+
+  if (strcmp (option, thumbnail->image_uri))
+    {
+      /*  might be a local thumbnail, try if the local part matches  */
+      const gchar *baseuri = strrchr (thumbnail->image_uri, '/');
+
+      if (!baseuri || strcmp (option, baseuri))
+        goto finish;
+    }
+
+  state = GIMP_THUMB_STATE_OLD;
+
+  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_MTIME);
+  if (!option || sscanf (option, "%" G_GINT64_FORMAT, &image_mtime) != 1)
+    goto finish;
+
+  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_FILESIZE);
+  if (option && sscanf (option, "%" G_GINT64_FORMAT, &image_size) != 1)
+    goto finish;
+
+  /* TAG_THUMB_FILESIZE is optional but must match if present */
+  if (image_mtime == thumbnail->image_mtime &&
+      (option == NULL || image_size == thumbnail->image_filesize))
+    {
+      if (size == GIMP_THUMB_SIZE_FAIL)
+        state = GIMP_THUMB_STATE_FAILED;
+      else
+        state = GIMP_THUMB_STATE_OK;
+    }
+
+  if (state == GIMP_THUMB_STATE_FAILED)
+    gimp_thumbnail_reset_info (thumbnail);
+  else
+    gimp_thumbnail_set_info_from_pixbuf (thumbnail, pixbuf);
+
+ finish:
+  if (size == GIMP_THUMB_SIZE_FAIL ||
+      (state != GIMP_THUMB_STATE_OLD && state != GIMP_THUMB_STATE_OK))
+    {
+      g_object_unref (pixbuf);
+      pixbuf = NULL;
+    }
+
+  g_object_set (thumbnail,
+                "thumb-state", state,
+                NULL);
+
+  g_object_thaw_notify (G_OBJECT (thumbnail));
+
+  return pixbuf;
+}
+
+static void
+gimp_thumbnail_load_thumb_thread (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  ThumbLoadData *data  = task_data;
+  GdkPixbuf     *pixbuf;
+  GError        *error = NULL;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  pixbuf = gdk_pixbuf_new_from_file (data->filename, &error);
+
+  if (pixbuf)
+    g_task_return_pointer (task, pixbuf, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+gimp_thumbnail_load_data_free (ThumbLoadData *data)
+{
+  g_free (data->filename);
+  g_free (data);
+}
+
 static void
 gimp_thumbnail_update_thumb (GimpThumbnail *thumbnail,
                              GimpThumbSize  size)
@@ -1023,9 +1140,6 @@ gimp_thumbnail_load_thumb (GimpThumbnail  *thumbnail,
 {
   GimpThumbState  state;
   GdkPixbuf      *pixbuf;
-  const gchar    *option;
-  gint64          image_mtime;
-  gint64          image_size;
 
   g_return_val_if_fail (GIMP_IS_THUMBNAIL (thumbnail), NULL);
 
@@ -1039,7 +1153,7 @@ gimp_thumbnail_load_thumb (GimpThumbnail  *thumbnail,
   if (state < GIMP_THUMB_STATE_EXISTS || state == GIMP_THUMB_STATE_FAILED)
     return NULL;
 
-  pixbuf = gdk_pixbuf_new_from_file (thumbnail->thumb_filename, NULL);
+  pixbuf = gdk_pixbuf_new_from_file (thumbnail->thumb_filename, error);
   if (! pixbuf)
     return NULL;
 
@@ -1047,62 +1161,117 @@ gimp_thumbnail_load_thumb (GimpThumbnail  *thumbnail,
   g_printerr ("thumbnail loaded from %s\n", thumbnail->thumb_filename);
 #endif
 
-  g_object_freeze_notify (G_OBJECT (thumbnail));
-
-  /* URI and mtime from the thumbnail need to match our file */
-  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_URI);
-  if (!option)
-    goto finish;
-
-  if (strcmp (option, thumbnail->image_uri))
-    {
-      /*  might be a local thumbnail, try if the local part matches  */
-      const gchar *baseuri = strrchr (thumbnail->image_uri, '/');
+  return gimp_thumbnail_check_pixbuf (thumbnail, pixbuf,
+                                      thumbnail->thumb_size);
+}
 
-      if (!baseuri || strcmp (option, baseuri))
-        goto finish;
-    }
+/**
+ * gimp_thumbnail_load_thumb_async:
+ * @thumbnail: a #GimpThumbnail object
+ * @size: the preferred #GimpThumbSize for the preview
+ * @cancellable: (nullable): optional #GCancellable object
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            thumbnail is loaded
+ * @user_data: the data to pass to @callback
+ *
+ * Asynchronous version of gimp_thumbnail_load_thumb(). The thumbnail
+ * file is located in the calling thread, but reading and decoding it
+ * happens in a worker thread.
+ *
+ * When the operation is finished, @callback is called in the thread
+ * default main context of the calling thread. You should then call
+ * gimp_thumbnail_load_thumb_finish() to get the result.
+ *
+ * Since: 3.2
+ **/
+void
+gimp_thumbnail_load_thumb_async (GimpThumbnail       *thumbnail,
+                                 GimpThumbSize        size,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GTask          *task;
+  ThumbLoadData  *data;
+  GimpThumbState  state;
 
-  state = GIMP_THUMB_STATE_OLD;
+  g_return_if_fail (GIMP_IS_THUMBNAIL (thumbnail));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_MTIME);
-  if (!option || sscanf (option, "%" G_GINT64_FORMAT, &image_mtime) != 1)
-    goto finish;
+  GIMP_THUMB_DEBUG_CALL (thumbnail);
 
-  option = gdk_pixbuf_get_option (pixbuf, TAG_THUMB_FILESIZE);
-  if (option && sscanf (option, "%" G_GINT64_FORMAT, &image_size) != 1)
-    goto finish;
+  task = g_task_new (thumbnail, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gimp_thumbnail_load_thumb_async);
 
-  /* TAG_THUMB_FILESIZE is optional but must match if present */
-  if (image_mtime == thumbnail->image_mtime &&
-      (option == NULL || image_size == thumbnail->image_filesize))
+  if (! thumbnail->image_uri)
     {
-      if (thumbnail->thumb_size == GIMP_THUMB_SIZE_FAIL)
-        state = GIMP_THUMB_STATE_FAILED;
-      else
-        state = GIMP_THUMB_STATE_OK;
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+      return;
     }
 
-  if (state == GIMP_THUMB_STATE_FAILED)
-    gimp_thumbnail_reset_info (thumbnail);
-  else
-    gimp_thumbnail_set_info_from_pixbuf (thumbnail, pixbuf);
+  state = gimp_thumbnail_peek_thumb (thumbnail, size);
 
- finish:
-  if (thumbnail->thumb_size == GIMP_THUMB_SIZE_FAIL ||
-      (state != GIMP_THUMB_STATE_OLD && state != GIMP_THUMB_STATE_OK))
+  if (state < GIMP_THUMB_STATE_EXISTS || state == GIMP_THUMB_STATE_FAILED)
     {
-      g_object_unref (pixbuf);
-      pixbuf = NULL;
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+      return;
     }
 
-  g_object_set (thumbnail,
-                "thumb-state", state,
-                NULL);
+  data = g_new0 (ThumbLoadData, 1);
 
-  g_object_thaw_notify (G_OBJECT (thumbnail));
+  data->filename = g_strdup (thumbnail->thumb_filename);
+  data->size     = thumbnail->thumb_size;
 
-  return pixbuf;
+  g_task_set_task_data (task, data,
+                        (GDestroyNotify) gimp_thumbnail_load_data_free);
+  g_task_run_in_thread (task, gimp_thumbnail_load_thumb_thread);
+
+  g_object_unref (task);
+}
+
+/**
+ * gimp_thumbnail_load_thumb_finish:
+ * @thumbnail: a #GimpThumbnail object
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for possible errors
+ *
+ * Finishes an operation started with gimp_thumbnail_load_thumb_async().
+ * Like gimp_thumbnail_load_thumb(), this verifies the loaded preview
+ * against the image file and updates the "thumb-state" property.
+ *
+ * If the thumbnail file could not be read or decoded, or the operation
+ * was cancelled, %NULL is returned and @error is set.
+ *
+ * Returns: (nullable) (transfer full): a preview pixbuf or %NULL if no
+ *               thumbnail was found or it could not be loaded
+ *
+ * Since: 3.2
+ **/
+GdkPixbuf *
+gimp_thumbnail_load_thumb_finish (GimpThumbnail  *thumbnail,
+                                  GAsyncResult   *result,
+                                  GError        **error)
+{
+  ThumbLoadData *data;
+  GdkPixbuf     *pixbuf;
+
+  g_return_val_if_fail (GIMP_IS_THUMBNAIL (thumbnail), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, thumbnail), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  pixbuf = g_task_propagate_pointer (G_TASK (result), error);
+
+  if (! pixbuf)
+    return NULL;
+
+  data = g_task_get_task_data (G_TASK (result));
+
+  /*  the thumbnail may have been pointed to a different image
+   *  meanwhile, in which case the URI check fails
+   */
+  return gimp_thumbnail_check_pixbuf (thumbnail, pixbuf, data->size);
 }
 
 /**
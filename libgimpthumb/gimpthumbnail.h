@@ -58,6 +58,15 @@ GdkPixbuf      * gimp_thumbnail_load_thumb       (GimpThumbnail  *thumbnail,
                                                   GimpThumbSize   size,
                                                   GError        **error);
 
+void             gimp_thumbnail_load_thumb_async  (GimpThumbnail        *thumbnail,
+                                                   GimpThumbSize         size,
+                                                   GCancellable         *cancellable,
+                                                   GAsyncReadyCallback   callback,
+                                                   gpointer              user_data);
+GdkPixbuf      * gimp_thumbnail_load_thumb_finish (GimpThumbnail        *thumbnail,
+                                                   GAsyncResult         *result,
+                                                   GError              **error);
+
 gboolean         gimp_thumbnail_save_thumb       (GimpThumbnail  *thumbnail,
                                                   GdkPixbuf      *pixbuf,
                                                   const gchar    *software,
@@ -954,6 +954,13 @@ CODE
 CODE
 	}
 
+        if ($proc->{uses_data} ||
+            exists $main::grp{$proc->{group}}->{uses_data}) {
+	    $out->{register} .= <<CODE;
+  gimp_procedure_set_uses_data (procedure, TRUE);
+CODE
+	}
+
 	$argc = 0;
 
         foreach $arg (@inargs) {